@@ -39,6 +39,38 @@ JNIEXPORT jboolean JNICALL Java_com_opengamma_maths_materialisers_Materialisers_
 JNIEXPORT jobject JNICALL Java_com_opengamma_maths_materialisers_Materialisers_materialiseToOGTerminal
   (JNIEnv *, jclass, jobject);
 
+/*
+ * Class:     com_opengamma_maths_materialisers_Materialisers
+ * Method:    materialiseToOGTerminals
+ * Signature: ([Lcom/opengamma/maths/datacontainers/OGNumeric;)[Lcom/opengamma/maths/datacontainers/OGTerminal;
+ */
+JNIEXPORT jobjectArray JNICALL Java_com_opengamma_maths_materialisers_Materialisers_materialiseToOGTerminals
+  (JNIEnv *, jclass, jobjectArray);
+
+/*
+ * Class:     com_opengamma_maths_materialisers_Materialisers
+ * Method:    setTracingEnabled
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_com_opengamma_maths_materialisers_Materialisers_setTracingEnabled
+  (JNIEnv *, jclass, jboolean);
+
+/*
+ * Class:     com_opengamma_maths_materialisers_Materialisers
+ * Method:    clearTraceEvents
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_opengamma_maths_materialisers_Materialisers_clearTraceEvents
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     com_opengamma_maths_materialisers_Materialisers
+ * Method:    writeChromeTrace
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_com_opengamma_maths_materialisers_Materialisers_writeChromeTrace
+  (JNIEnv *, jclass, jstring);
+
 #ifdef __cplusplus
 }
 #endif
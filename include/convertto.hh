@@ -23,6 +23,14 @@
 //CplxSparse    |   No   |   No    | No  |  No    |  No   | No  |  No   |   Yes   | No   |  Yes  |
 //RealDense     |   No   |   No    | No  |  No    |  No   | No  |  No   |   No    | Yes  |  Yes  |
 //CplxDense     |   No   |   No    | No  |  No    |  No   | No  |  No   |   No    | No   |  Yes  |
+//RSingleDense  |   No   |   No    | No  |  No    |  No   | No  |  No   |   No    | Yes  |  Yes  |
+//CSingleDense  |   No   |   No    | No  |  No    |  No   | No  |  No   |   No    | No   |  Yes  |
+//RTransposed   |   No   |   No    | No  |  No    |  No   | No  |  No   |   No    | Yes  |  Yes  |
+//CTransposed   |   No   |   No    | No  |  No    |  No   | No  |  No   |   No    | No   |  Yes  |
+//
+// Single precision dense matrices are widened to double precision, which is how the
+// dispatcher computes any operation without a single precision runner. Likewise transposed
+// views are materialised for any operation without a runner that reads them in place.
 
 
 namespace librdag {
@@ -32,22 +40,30 @@ class OGComplexScalar;
 class OGIntegerScalar;
 class OGRealDenseMatrix;
 class OGComplexDenseMatrix;
+class OGRealSingleDenseMatrix;
+class OGComplexSingleDenseMatrix;
 class OGLogicalMatrix;
 class OGRealDiagonalMatrix;
 class OGComplexDiagonalMatrix;
 class OGRealSparseMatrix;
 class OGComplexSparseMatrix;
+class OGRealTransposedMatrix;
+class OGComplexTransposedMatrix;
 
 // conversion class, it need not be a class
 class ConvertTo
 {
   public:
     ConvertTo();
+    std::shared_ptr<const OGRealScalar> convertToOGRealScalar(std::shared_ptr<const OGIntegerScalar> thing) const;
+
     std::shared_ptr<const OGRealDenseMatrix> convertToOGRealDenseMatrix(std::shared_ptr<const OGRealScalar> thing) const;
     std::shared_ptr<const OGRealDenseMatrix> convertToOGRealDenseMatrix(std::shared_ptr<const OGIntegerScalar> thing) const;
     std::shared_ptr<const OGRealDenseMatrix> convertToOGRealDenseMatrix(std::shared_ptr<const OGRealDiagonalMatrix> thing) const;
     std::shared_ptr<const OGRealDenseMatrix> convertToOGRealDenseMatrix(std::shared_ptr<const OGLogicalMatrix> thing) const;
     std::shared_ptr<const OGRealDenseMatrix> convertToOGRealDenseMatrix(std::shared_ptr<const OGRealSparseMatrix> thing) const;
+    std::shared_ptr<const OGRealDenseMatrix> convertToOGRealDenseMatrix(std::shared_ptr<const OGRealSingleDenseMatrix> thing) const;
+    std::shared_ptr<const OGRealDenseMatrix> convertToOGRealDenseMatrix(std::shared_ptr<const OGRealTransposedMatrix> thing) const;
 
     std::shared_ptr<const OGComplexDenseMatrix> convertToOGComplexDenseMatrix(std::shared_ptr<const OGRealScalar> thing) const;
     std::shared_ptr<const OGComplexDenseMatrix> convertToOGComplexDenseMatrix(std::shared_ptr<const OGIntegerScalar> thing) const;
@@ -58,6 +74,10 @@ class ConvertTo
     std::shared_ptr<const OGComplexDenseMatrix> convertToOGComplexDenseMatrix(std::shared_ptr<const OGComplexSparseMatrix> thing) const;
     std::shared_ptr<const OGComplexDenseMatrix> convertToOGComplexDenseMatrix(std::shared_ptr<const OGRealDenseMatrix> thing) const;
     std::shared_ptr<const OGComplexDenseMatrix> convertToOGComplexDenseMatrix(std::shared_ptr<const OGLogicalMatrix> thing) const;
+    std::shared_ptr<const OGComplexDenseMatrix> convertToOGComplexDenseMatrix(std::shared_ptr<const OGRealSingleDenseMatrix> thing) const;
+    std::shared_ptr<const OGComplexDenseMatrix> convertToOGComplexDenseMatrix(std::shared_ptr<const OGComplexSingleDenseMatrix> thing) const;
+    std::shared_ptr<const OGComplexDenseMatrix> convertToOGComplexDenseMatrix(std::shared_ptr<const OGRealTransposedMatrix> thing) const;
+    std::shared_ptr<const OGComplexDenseMatrix> convertToOGComplexDenseMatrix(std::shared_ptr<const OGComplexTransposedMatrix> thing) const;
 };
 
 }
@@ -0,0 +1,40 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _CSE_HH
+#define _CSE_HH
+
+#include <vector>
+#include "numeric.hh"
+
+namespace librdag {
+
+/**
+ * Eliminates common subexpressions from a tree by hash-consing.
+ *
+ * Terminals are equal if they are the same object, or if they are of the same type
+ * and shape and view the same data (scalars compare by value). Expressions are equal
+ * if they are of the same type and have equal arguments. In the returned tree each
+ * set of equal nodes is replaced by a single shared node, so that it is computed once.
+ *
+ * The input tree is not modified; expression nodes above a merged node are rebuilt.
+ * @param tree the tree to eliminate common subexpressions from.
+ * @return a tree computing the same value as \a tree. If \a tree has no common
+ * subexpressions, this is \a tree itself.
+ */
+OGNumeric::Ptr eliminateCommonSubexpressions(const OGNumeric::Ptr& tree);
+
+/**
+ * Eliminates common subexpressions from a set of trees, as for a single tree, so that
+ * a subexpression the trees have in common is computed once for all of them.
+ * @param trees the trees to eliminate common subexpressions from.
+ * @return trees computing the same values as \a trees, in the same order.
+ */
+std::vector<OGNumeric::Ptr> eliminateCommonSubexpressions(const std::vector<OGNumeric::Ptr>& trees);
+
+} // end namespace librdag
+
+#endif // _CSE_HH
@@ -0,0 +1,75 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _DEMAND_HH
+#define _DEMAND_HH
+
+#include <cstdint>
+#include <vector>
+#include "numeric.hh"
+#include "uncopyable.hh"
+
+namespace librdag {
+
+class ExecutionList;
+
+/**
+ * Which results of a node with several, such as SVD and LU, are consumed, so that its
+ * runner need only compute those. A demand is a mask with bit i set if result i is
+ * needed. The registers of results that are not needed hold null pointers.
+ *
+ * Only the executor restricts the results computed, by dispatching a node inside a
+ * ResultDemand::Scope. Elsewhere every result is computed.
+ */
+class ResultDemand
+{
+  public:
+    /**
+     * The demand for all the results of a node.
+     */
+    static constexpr uint64_t ALL = ~static_cast<uint64_t>(0);
+    /**
+     * Find the results of each node of an execution list that are consumed. A result
+     * of SVD or LU is consumed if a SELECTRESULT selects it, the first result is
+     * consumed by any other node, and all are consumed if the node is a root.
+     * @param el the execution list.
+     * @return the demand for each position of the list, ALL for nodes other than
+     * SVD and LU.
+     */
+    static std::vector<uint64_t> analyse(ExecutionList& el);
+    /**
+     * Get the demand for the node being dispatched on the calling thread.
+     * @return the demand, ALL outside a Scope.
+     */
+    static uint64_t get();
+    /**
+     * Whether a result of the node being dispatched on the calling thread is needed.
+     * @param result the index of the result.
+     * @return true if the result must be computed.
+     */
+    static bool isNeeded(size_t result);
+    /**
+     * Sets the demand for the node being dispatched on the calling thread for its
+     * lifetime.
+     */
+    class Scope: private Uncopyable
+    {
+      public:
+        /**
+         * @param demand the demand for the node about to be dispatched.
+         */
+        Scope(uint64_t demand);
+        ~Scope();
+      private:
+        uint64_t _previous;
+    };
+  private:
+    ResultDemand() = delete;
+};
+
+} // end namespace librdag
+
+#endif // _DEMAND_HH
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _DIAGONAL_HH
+#define _DIAGONAL_HH
+
+#include "numeric.hh"
+#include "terminal.hh"
+
+namespace librdag {
+
+/**
+ * The diagonal namespace contains kernels operating directly on the diagonals of
+ * diagonal matrices, templated on the <real8,complex16> data type, so that diagonal
+ * arguments are not converted to dense matrices. As for the dense runners, an argument
+ * that is 1x1 is treated as a scalar.
+ */
+namespace diagonal
+{
+
+/**
+ * Elementwise addition or subtraction of diagonal matrices, y:=a+b or y:=a-b.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the first matrix.
+ * @param b the second matrix.
+ * @param subtract true to compute a-b.
+ * @return a diagonal matrix if \a a and \a b have the same shape, else a dense matrix.
+ * @throws rdag_error if the shapes mismatch.
+ */
+template<typename T>
+OGNumeric::Ptr plus(const OGDiagonalMatrix<T>& a, const OGDiagonalMatrix<T>& b, bool subtract);
+
+/**
+ * Multiplication of a diagonal matrix by a scalar, y:=s*a.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the diagonal matrix.
+ * @param s the scalar.
+ * @return a diagonal matrix, or a dense matrix if \a s is Inf or NaN, which makes NaN of
+ * the implicit zeros.
+ */
+template<typename T>
+OGNumeric::Ptr scale(const OGDiagonalMatrix<T>& a, T s);
+
+/**
+ * Matrix product of diagonal matrices, y:=a*b.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the first matrix.
+ * @param b the second matrix.
+ * @return a diagonal matrix, or a dense matrix if either holds an Inf or NaN.
+ * @throws rdag_error if the matrices do not commute.
+ */
+template<typename T>
+OGNumeric::Ptr mtimes(const OGDiagonalMatrix<T>& a, const OGDiagonalMatrix<T>& b);
+
+/**
+ * Matrix product of a diagonal and a dense matrix, y:=a*b, which scales the rows of
+ * \a b.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the diagonal matrix.
+ * @param b the dense matrix.
+ * @return a dense matrix, or a diagonal matrix if \a b is 1x1 and finite.
+ * @throws rdag_error if the matrices do not commute.
+ */
+template<typename T>
+OGNumeric::Ptr mtimes(const OGDiagonalMatrix<T>& a, const OGMatrix<T>& b);
+
+/**
+ * Matrix product of a dense and a diagonal matrix, y:=a*b, which scales the columns
+ * of \a a.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the dense matrix.
+ * @param b the diagonal matrix.
+ * @return a dense matrix, or a diagonal matrix if \a a is 1x1 and finite.
+ * @throws rdag_error if the matrices do not commute.
+ */
+template<typename T>
+OGNumeric::Ptr mtimes(const OGMatrix<T>& a, const OGDiagonalMatrix<T>& b);
+
+} // end namespace diagonal
+
+} // end namespace librdag
+
+#endif // _DIAGONAL_HH
@@ -7,6 +7,8 @@
 #ifndef _ENTRYPT_H
 #define _ENTRYPT_H
 
+#include <future>
+#include <vector>
 #include "numeric.hh"
 #include "terminal.hh"
 
@@ -14,6 +16,34 @@ namespace librdag {
 
 const OGTerminal::Ptr entrypt(const OGNumeric::Ptr& expr);
 
+/**
+ * Evaluate a batch of trees. The trees are rewritten one by one, then are executed
+ * together as a single graph, so that independent trees are computed concurrently and
+ * subexpressions and terminals the trees have in common are computed once.
+ * @param exprs the roots of the trees.
+ * @return the values of the trees, in the same order. If any tree fails to evaluate,
+ * the first exception thrown is rethrown and no values are returned.
+ */
+std::vector<OGTerminal::Ptr> entrypt(const std::vector<OGNumeric::Ptr>& exprs);
+
+/**
+ * Evaluate a tree asynchronously. The evaluation is queued on a native pool of threads
+ * shared by all asynchronous evaluations and the caller returns immediately, so that it
+ * can go on to build further trees while this one is computed. The tree must not be
+ * evaluated again, or modified, until the future is ready.
+ * @param expr the root of the tree.
+ * @return a future holding the value of the tree, or the exception thrown evaluating it.
+ */
+std::future<OGTerminal::Ptr> entryptAsync(const OGNumeric::Ptr& expr);
+
+/**
+ * Evaluate a batch of trees asynchronously, as one graph as entrypt does.
+ * @param exprs the roots of the trees.
+ * @return a future holding the values of the trees, in the same order, or the first
+ * exception thrown evaluating them.
+ */
+std::future<std::vector<OGTerminal::Ptr>> entryptAsync(const std::vector<OGNumeric::Ptr>& exprs);
+
 } // namespace librdag
 
 #endif
@@ -29,6 +29,12 @@ ArrayBitEquals(complex16 * arr1, complex16 * arr2, size_t count);
 extern template bool
 ArrayBitEquals(int4 * arr1, int4 * arr2, size_t count);
 
+extern template bool
+ArrayBitEquals(real4 * arr1, real4 * arr2, size_t count);
+
+extern template bool
+ArrayBitEquals(complex8 * arr1, complex8 * arr2, size_t count);
+
 /**
  * Fuzzy equals, equals within tolerance specified
  */
@@ -39,6 +45,10 @@ extern template bool
 ArrayFuzzyEquals(real8 * arr1, real8 * arr2, size_t count, real8 maxabserror, real8 maxrelerror);
 extern template bool
 ArrayFuzzyEquals(complex16 * arr1, complex16 * arr2, size_t count, real8 maxabserror, real8 maxrelerror);
+extern template bool
+ArrayFuzzyEquals(real4 * arr1, real4 * arr2, size_t count, real8 maxabserror, real8 maxrelerror);
+extern template bool
+ArrayFuzzyEquals(complex8 * arr1, complex8 * arr2, size_t count, real8 maxabserror, real8 maxrelerror);
 
 bool SingleValueFuzzyEquals(real8 val1, real8 val2, real8 maxabserror = FuzzyEquals_default_maxabserror, real8 maxrelerror = FuzzyEquals_default_maxrelerror);
 bool SingleValueFuzzyEquals(complex16 val1, complex16 val2, real8 maxabserror = FuzzyEquals_default_maxabserror, real8 maxrelerror = FuzzyEquals_default_maxrelerror);
@@ -20,19 +20,30 @@ typedef std::vector<OGNumeric::Ptr> _ExpressionList;
 
 // An ExecutionList holds a list of expression nodes that are in order such that
 // no node has inputs that are computed by a node further down the list. Thus,
-// the list can be executed in sequence to compute an expression
+// the list can be executed in sequence to compute an expression. A node that is
+// an argument of more than one expression appears in the list only once, so that
+// it is computed only once.
+//
+// A list may be built from several trees, which then share the nodes they have in
+// common. The roots of the trees are the results of executing the list.
 class ExecutionList
 {
   public:
     ExecutionList(const OGNumeric::Ptr& tree);
+    ExecutionList(const std::vector<OGNumeric::Ptr>& trees);
     ~ExecutionList();
     typedef typename _ExpressionList::const_iterator citerator;
     size_t size();
     citerator begin();
     citerator end();
     const OGNumeric::Ptr operator[](size_t n);
+    // The positions of the roots of the trees in the list, in the order the trees
+    // were given. A tree that is a subtree of another still has its own root.
+    const std::vector<size_t>& getRoots();
   private:
+    void append(const OGNumeric::Ptr& tree);
     _ExpressionList* _execList;
+    std::vector<size_t> _roots;
     ExecutionList() = delete;
 };
 
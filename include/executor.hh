@@ -0,0 +1,207 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _EXECUTOR_HH
+#define _EXECUTOR_HH
+
+#include <memory>
+#include <vector>
+#include "numeric.hh"
+#include "plan.hh"
+#include "uncopyable.hh"
+
+namespace librdag {
+
+class ExecutionList;
+class Dispatcher;
+class ThreadPool;
+class FusedKernel;
+
+/**
+ * How an ExecutionList is executed.
+ */
+enum class ExecutionMode
+{
+  /** Execute nodes one at a time in list order on the calling thread. */
+  SERIAL,
+  /** Execute independent nodes concurrently on a work-stealing thread pool. */
+  PARALLEL
+};
+
+/**
+ * Process-wide options controlling how trees are executed. These may be changed at
+ * any time; the change applies to executions started afterwards.
+ */
+class ExecutionOptions
+{
+  public:
+    /**
+     * Get the execution mode, the default is PARALLEL.
+     * @return the execution mode.
+     */
+    static ExecutionMode getMode();
+    /**
+     * Set the execution mode. SERIAL is useful for debugging, as nodes are then
+     * dispatched in a deterministic order on the calling thread.
+     * @param mode the execution mode.
+     */
+    static void setMode(ExecutionMode mode);
+    /**
+     * Get the number of threads used in PARALLEL mode.
+     * @return the number of threads.
+     */
+    static size_t getThreadCount();
+    /**
+     * Set the number of threads used in PARALLEL mode.
+     * @param nthreads the number of threads, 0 selects the number of hardware threads.
+     */
+    static void setThreadCount(size_t nthreads);
+    /**
+     * Get whether elementwise nodes are fused, the default is true.
+     * @return true if fusion is enabled.
+     */
+    static bool getFusion();
+    /**
+     * Set whether trees of elementwise nodes are evaluated as single fused kernels,
+     * see FusedKernel. This does not apply in SERIAL mode.
+     * @param fusion true to enable fusion.
+     */
+    static void setFusion(bool fusion);
+  private:
+    ExecutionOptions() = delete;
+};
+
+/**
+ * The dependencies between the expression nodes of an ExecutionList. Terminals are not
+ * part of the graph as they have nothing to compute, and a node reached more than once
+ * in the list appears once in the graph.
+ *
+ * When fusing, each maximal tree of elementwise nodes whose intermediate results have a
+ * single consumer is a single node of the graph, represented by the root of the tree,
+ * and is computed by a FusedKernel. Elementwise nodes that cannot be fused with any
+ * other are computed by a kernel of their own.
+ * The graph owns the arena of its plan, see ExecutionPlan::getArenaSize(), into which
+ * kernels that are not results of the execution write. Their registers are cleared
+ * when the graph is destroyed, so that nothing refers to the arena after it is freed.
+ */
+class DependencyGraph: private Uncopyable
+{
+  public:
+    /**
+     * Construct the graph.
+     * @param el the execution list to construct the graph from.
+     * @param fuse whether to fuse elementwise nodes.
+     */
+    DependencyGraph(ExecutionList& el, bool fuse = false);
+    /**
+     * Construct the graph from a plan made for an execution list with the same PlanKey.
+     * @param el the execution list whose nodes are to be computed.
+     * @param plan the plan.
+     */
+    DependencyGraph(ExecutionList& el, const ExecutionPlan::Ptr& plan);
+    ~DependencyGraph();
+    /**
+     * Get the number of nodes in the graph.
+     * @return the number of nodes.
+     */
+    size_t size() const;
+    /**
+     * Get a node. Nodes are numbered in an order that respects their dependencies.
+     * @param n the index of the node.
+     * @return the node.
+     */
+    const OGNumeric::Ptr& getNode(size_t n) const;
+    /**
+     * Get the number of distinct nodes that must be computed before a node can be.
+     * @param n the index of the node.
+     * @return the number of nodes that node \a n depends on.
+     */
+    size_t getDependencyCount(size_t n) const;
+    /**
+     * Get the nodes that depend on a node.
+     * @param n the index of the node.
+     * @return the indices of the nodes that consume the result of node \a n.
+     */
+    const std::vector<size_t>& getDependents(size_t n) const;
+    /**
+     * Get the nodes that a node depends on.
+     * @param n the index of the node.
+     * @return the indices of the distinct nodes whose results node \a n consumes.
+     */
+    const std::vector<size_t>& getDependencies(size_t n) const;
+    /**
+     * Whether a node is the root of one of the trees of the execution list.
+     * @param n the index of the node.
+     * @return true if the node is a result of the execution.
+     */
+    bool isResult(size_t n) const;
+    /**
+     * Whether the graph is a simple chain, in which case there is nothing to be gained
+     * by executing it in parallel.
+     * @return true if no two nodes in the graph could run concurrently.
+     */
+    bool isSequential() const;
+    /**
+     * Get the fused kernel computing a node.
+     * @param n the index of the node.
+     * @return the kernel, or nullptr if the node is dispatched directly.
+     */
+    const FusedKernel * getKernel(size_t n) const;
+    /**
+     * Compute a node, pushing its result to its registers.
+     * @param n the index of the node.
+     * @param disp the dispatcher to dispatch with.
+     * @param expiring the dependencies of the node whose results are not needed once it
+     * is computed, their buffers may be reused for the result.
+     */
+    void dispatch(size_t n, const Dispatcher& disp,
+                  const std::vector<const OGNumeric*>& expiring = {}) const;
+  private:
+    void compute(size_t n, const Dispatcher& disp, const std::vector<const OGNumeric*>& expiring) const;
+    ExecutionPlan::Ptr _plan;
+    std::vector<OGNumeric::Ptr> _nodes;
+    std::vector<std::shared_ptr<const FusedKernel>> _kernels;
+    std::unique_ptr<char[]> _arena;
+};
+
+/**
+ * Execute the nodes of an execution list, in the manner given by ExecutionOptions.
+ * On return the registers of the roots of the trees hold their results. The registers
+ * of the other expressions are released as soon as the last node using them is complete,
+ * so that only the live working set is held in memory.
+ * The types and shapes of all the nodes are inferred before any is dispatched, see
+ * TypeInference, so a tree whose arguments do not conform throws without computing
+ * anything. Each node computed is recorded if tracing is enabled, see Tracer.
+ * @param el the execution list.
+ * @param disp the dispatcher to dispatch nodes with.
+ * @throws rdag_error if the arguments of a node do not conform, or a node fails.
+ */
+void execute(ExecutionList& el, const Dispatcher& disp);
+
+/**
+ * Execute the nodes of an execution list in order on the calling thread. Nothing is
+ * fused or released, so on return the registers of every expression in the list hold
+ * their results.
+ * @param el the execution list.
+ * @param disp the dispatcher to dispatch nodes with.
+ */
+void executeSerial(ExecutionList& el, const Dispatcher& disp);
+
+/**
+ * Execute the nodes of an execution list concurrently on a thread pool. Each node is
+ * dispatched as soon as all of the nodes it depends on are complete. The calling thread
+ * also executes tasks until the whole graph is complete. If any node throws, nodes not
+ * yet started are skipped and the first exception thrown is rethrown to the caller.
+ * Registers are released as in execute().
+ * @param el the execution list.
+ * @param disp the dispatcher to dispatch nodes with.
+ * @param pool the pool to execute on.
+ */
+void executeParallel(ExecutionList& el, const Dispatcher& disp, ThreadPool& pool);
+
+} // end namespace librdag
+
+#endif // _EXECUTOR_HH
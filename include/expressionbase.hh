@@ -35,6 +35,14 @@ class OGExpr: public OGNumeric
     const ArgContainer& getArgs() const;
     RegContainer& getRegs() const;
     size_t getNArgs() const;
+    /**
+     * Create a node of the same type as this one, with different arguments. This is
+     * for passes that rewrite a tree, which cannot otherwise know the concrete type
+     * of the nodes they rebuild.
+     * @param args the arguments of the new node.
+     * @return the new node.
+     */
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const = 0;
     virtual OGExpr::Ptr asOGExpr() const override;
     virtual void debug_print() const override;
   protected:
@@ -70,6 +78,7 @@ class COPY: public OGUnaryExpr
     typedef std::shared_ptr<const COPY> Ptr;
     static COPY::Ptr create(const OGNumeric::Ptr& arg);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual COPY::Ptr asCOPY() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -83,6 +92,7 @@ class SELECTRESULT: public OGExpr
     typedef std::shared_ptr<const SELECTRESULT> Ptr;
     static SELECTRESULT::Ptr create(const OGNumeric::Ptr& arg0, const OGNumeric::Ptr& arg1);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual SELECTRESULT::Ptr asSELECTRESULT() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -96,6 +106,7 @@ class NORM2: public OGUnaryExpr
     typedef std::shared_ptr<const NORM2> Ptr;
     static NORM2::Ptr create(const OGNumeric::Ptr& arg);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual NORM2::Ptr asNORM2() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -110,6 +121,7 @@ class PINV: public OGUnaryExpr
     typedef std::shared_ptr<const PINV> Ptr;
     static PINV::Ptr create(const OGNumeric::Ptr& arg);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual PINV::Ptr asPINV() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -123,6 +135,7 @@ class INV: public OGUnaryExpr
     typedef std::shared_ptr<const INV> Ptr;
     static INV::Ptr create(const OGNumeric::Ptr& arg);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual INV::Ptr asINV() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -137,6 +150,7 @@ class TRANSPOSE: public OGUnaryExpr
     typedef std::shared_ptr<const TRANSPOSE> Ptr;
     static TRANSPOSE::Ptr create(const OGNumeric::Ptr& arg);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual TRANSPOSE::Ptr asTRANSPOSE() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -150,6 +164,7 @@ class CTRANSPOSE: public OGUnaryExpr
     typedef std::shared_ptr<const CTRANSPOSE> Ptr;
     static CTRANSPOSE::Ptr create(const OGNumeric::Ptr& arg);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual CTRANSPOSE::Ptr asCTRANSPOSE() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -164,6 +179,7 @@ class SVD: public OGUnaryExpr
     typedef std::shared_ptr<const SVD> Ptr;
     static SVD::Ptr create(const OGNumeric::Ptr& arg);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual SVD::Ptr asSVD() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -177,6 +193,7 @@ class MTIMES: public OGBinaryExpr
     typedef std::shared_ptr<const MTIMES> Ptr;
     static MTIMES::Ptr create(const OGNumeric::Ptr& arg0, const OGNumeric::Ptr& arg1);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual MTIMES::Ptr asMTIMES() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -190,6 +207,7 @@ class LU: public OGUnaryExpr
     typedef std::shared_ptr<const LU> Ptr;
     static LU::Ptr create(const OGNumeric::Ptr& arg);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual LU::Ptr asLU() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -203,6 +221,7 @@ class MLDIVIDE: public OGBinaryExpr
     typedef std::shared_ptr<const MLDIVIDE> Ptr;
     static MLDIVIDE::Ptr create(const OGNumeric::Ptr& arg0, const OGNumeric::Ptr& arg1);
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual MLDIVIDE::Ptr asMLDIVIDE() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
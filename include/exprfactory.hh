@@ -13,6 +13,13 @@ using librdag::OGNumeric;
 namespace convert {
 
 OGNumeric::Ptr createExpression(jobject obj);
+/**
+ * Generates RDAG expression trees from an array of Java objects. Nodes that the trees
+ * have in common are translated once and shared between the RDAG trees.
+ * @param objs an array of Java OGNumeric types
+ * @return the equivalent RDAG expressions, in the same order
+ */
+std::vector<OGNumeric::Ptr> createExpressions(jobjectArray objs);
 OGNumeric::Ptr translateNode(JNIEnv* env, jobject obj, OGNumeric::Ptr arg0 = OGNumeric::Ptr{}, OGNumeric::Ptr arg1 = OGNumeric::Ptr{});
 
 } // namespace convert
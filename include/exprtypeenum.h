@@ -35,6 +35,10 @@ typedef enum
   COMPLEX_DIAGONAL_MATRIX_ENUM  = 0X0013L ,
   LOGICAL_MATRIX_ENUM           = 0X0017L ,
   INTEGER_SCALAR_ENUM           = 0X001DL ,
+  REAL_SINGLE_DENSE_MATRIX_ENUM    = 0X001FL ,
+  COMPLEX_SINGLE_DENSE_MATRIX_ENUM = 0X0025L ,
+  REAL_TRANSPOSED_MATRIX_ENUM      = 0X0029L ,
+  COMPLEX_TRANSPOSED_MATRIX_ENUM   = 0X002BL ,
 
   /*
   * EXPR TOKENS FOR FUNCTIONS, set in bits higher than 8, min prime 257_d = 0x0101
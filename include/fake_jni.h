@@ -135,6 +135,7 @@ static _jclass allClasses;
 static _jobject allGlobalRefs;
 static _jfieldID allFieldIds;
 static _jthrowable allThrows;
+static _jmethodID allStaticMethodIds;
 
 
 class _JNIEnv
@@ -167,6 +168,13 @@ class _JNIEnv
     {
       return nullptr;
     }
+    virtual jint CallStaticIntMethod(jclass SUPPRESS_UNUSED clazz, jmethodID SUPPRESS_UNUSED methodID, ...) {
+      return 0;
+    }
+    virtual jboolean IsSameObject(jobject ref1, jobject ref2)
+    {
+      return ref1 == ref2 ? JNI_TRUE : JNI_FALSE;
+    }
     virtual void * GetPrimitiveArrayCritical(jarray SUPPRESS_UNUSED array, jboolean SUPPRESS_UNUSED *isCopy)
     {
       return nullptr;
@@ -212,6 +220,10 @@ class _JNIEnv
     {
       return nullptr;
     }
+    virtual jmethodID GetStaticMethodID(jclass SUPPRESS_UNUSED clazz, const char SUPPRESS_UNUSED *name, const char SUPPRESS_UNUSED *sig)
+    {
+      return &allStaticMethodIds;
+    }
     virtual jobject NewGlobalRef(jobject SUPPRESS_UNUSED lobj)
     {
       return &allGlobalRefs;
@@ -228,6 +240,13 @@ class _JNIEnv
     {
       return nullptr;
     }
+    virtual const char * GetStringUTFChars(jstring SUPPRESS_UNUSED str, jboolean SUPPRESS_UNUSED *isCopy)
+    {
+      return nullptr;
+    }
+    virtual void ReleaseStringUTFChars(jstring SUPPRESS_UNUSED str, const char SUPPRESS_UNUSED *chars)
+    {
+    }
     virtual jint ThrowNew(jclass SUPPRESS_UNUSED clazz, const char SUPPRESS_UNUSED *msg)
     {
       return 0;
@@ -251,6 +270,10 @@ class _JNIEnv
     virtual void DeleteLocalRef(jobject SUPPRESS_UNUSED lref)
     {
 
+    }
+    virtual void DeleteGlobalRef(jobject SUPPRESS_UNUSED gref)
+    {
+
     }
     virtual void ExceptionClear()
     {
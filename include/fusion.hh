@@ -0,0 +1,135 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _FUSION_HH
+#define _FUSION_HH
+
+#include <vector>
+#include "numeric.hh"
+#include "uncopyable.hh"
+
+namespace librdag {
+
+class Dispatcher;
+
+namespace detail {
+
+/**
+ * The elementwise operations a FusedKernel can evaluate.
+ */
+enum class FusedOp
+{
+  PLUS, MINUS, TIMES, RDIVIDE, NEGATE,
+  ACOS, ASINH, ATAN, COS, EXP, SIN, SINH, TAN, TANH
+};
+
+/**
+ * One operation of a FusedKernel. Operands index the kernel's values, which are its
+ * leaves followed by the results of its instructions.
+ */
+struct FusedInstruction
+{
+  FusedOp op;
+  size_t nargs;
+  size_t args[2];
+};
+
+} // end namespace detail
+
+/**
+ * A tree of elementwise expression nodes evaluated as a single kernel.
+ *
+ * Executing the nodes one at a time makes a pass over memory and an allocation for
+ * every node. A fused kernel instead walks the output in cache sized blocks, computing
+ * every node of the tree for one block before moving on to the next, so intermediate
+ * results never leave the cache and only the result of the root is allocated.
+ *
+ * The fused loop is used when every leaf is a real or complex scalar or dense matrix
+ * (at least one being a matrix) and the shapes conform. Otherwise, the members are
+ * dispatched individually, exactly as if they had not been fused. Either way the
+ * result is pushed to the registers of the root; the other members' registers are
+ * left empty by the fused loop.
+ *
+ * A kernel may have a single member, in which case there is nothing to fuse but the
+ * result may still be computed in place.
+ */
+class FusedKernel: private Uncopyable
+{
+  public:
+    /**
+     * Whether a node is an elementwise operation that may be part of a fused kernel.
+     * @param node the node.
+     * @return true if the node can be fused.
+     */
+    static bool isFusible(const OGNumeric::Ptr& node);
+    /**
+     * Construct a kernel.
+     * @param members the fusible nodes of the tree in an order that respects their
+     * dependencies, the root last. Every member except the root must be the argument
+     * of exactly one other member.
+     */
+    FusedKernel(const std::vector<OGNumeric::Ptr>& members);
+    /**
+     * Construct a kernel from code already compiled for members of the same structure.
+     * @param members the members, as for the other constructor.
+     * @param leaves the leaves, in the order the code expects.
+     * @param code the compiled code.
+     */
+    FusedKernel(const std::vector<OGNumeric::Ptr>& members, const std::vector<OGNumeric::Ptr>& leaves,
+                const std::vector<detail::FusedInstruction>& code);
+    /**
+     * Get the root of the kernel, which receives the result.
+     * @return the root node.
+     */
+    const OGNumeric::Ptr& getRoot() const;
+    /**
+     * Get the nodes computed by the kernel.
+     * @return the members in execution order, the root last.
+     */
+    const std::vector<OGNumeric::Ptr>& getMembers() const;
+    /**
+     * Get the arguments of the members that are not themselves members. These must
+     * have been computed before the kernel is executed.
+     * @return the leaves.
+     */
+    const std::vector<OGNumeric::Ptr>& getLeaves() const;
+    /**
+     * Get the compiled code of the kernel.
+     * @return the instructions, one per member.
+     */
+    const std::vector<detail::FusedInstruction>& getCode() const;
+    /**
+     * Execute the kernel, pushing the result to the registers of the root.
+     * @param disp the dispatcher used if the leaves cannot be handled by the fused loop.
+     * @param expiring leaves whose results are not used after this kernel. The fused
+     * loop may compute the result in place in the buffer of one of these, if nothing
+     * else references it.
+     * @param buffer space the fused loop may compute the result in, if it is large
+     * enough and no leaf can be written over. The result is then a VIEWER of the space,
+     * so the space must outlive every use of the result.
+     * @param bytes the size of \a buffer in bytes.
+     */
+    void execute(const Dispatcher& disp, const std::vector<const OGNumeric*>& expiring = {},
+                 void * buffer = nullptr, size_t bytes = 0) const;
+    /**
+     * Try to execute the kernel with the fused loop, without falling back.
+     * @param expiring leaves whose results are not used after this kernel.
+     * @param buffer space the result may be computed in, as for execute().
+     * @param bytes the size of \a buffer in bytes.
+     * @return true if the result was computed and pushed to the registers of the root,
+     * false if the leaves are of a type or shape the fused loop does not handle.
+     */
+    bool executeFused(const std::vector<const OGNumeric*>& expiring = {}, void * buffer = nullptr,
+                      size_t bytes = 0) const;
+  private:
+    std::vector<OGNumeric::Ptr> _members;
+    std::vector<OGNumeric::Ptr> _leaves;
+    std::vector<detail::FusedInstruction> _code;
+};
+
+} // end namespace librdag
+
+#endif // _FUSION_HH
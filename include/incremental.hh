@@ -0,0 +1,97 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _INCREMENTAL_HH
+#define _INCREMENTAL_HH
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+#include "numeric.hh"
+#include "terminal.hh"
+#include "uncopyable.hh"
+
+namespace librdag {
+
+class ExecutionList;
+class DependencyGraph;
+
+/**
+ * Evaluates trees repeatedly as their terminals change, recomputing only the nodes
+ * downstream of a changed terminal, the dirty cone, and reusing the results held in
+ * the registers of every other node. This makes bumping one input of a large tree and
+ * revaluing it about as cheap as computing the nodes that input reaches.
+ *
+ * The trees are evaluated as given, without rewriting or eliminating common
+ * subexpressions, so that every terminal of the trees can be referred to. The
+ * registers of all the nodes are kept until the evaluator is destroyed, when they are
+ * cleared. The trees must not be evaluated by anything else while an evaluator refers
+ * to them, and an evaluator must not be used from more than one thread at a time.
+ */
+class IncrementalEvaluator: private Uncopyable
+{
+  public:
+    /**
+     * Construct an evaluator for a tree. Nothing is computed until evaluate().
+     * @param expr the root of the tree.
+     * @throws rdag_error if the arguments of a node do not conform.
+     */
+    IncrementalEvaluator(const OGNumeric::Ptr& expr);
+    /**
+     * Construct an evaluator for a batch of trees, which share the nodes they have in
+     * common.
+     * @param exprs the roots of the trees.
+     * @throws rdag_error if the arguments of a node do not conform.
+     */
+    IncrementalEvaluator(const std::vector<OGNumeric::Ptr>& exprs);
+    ~IncrementalEvaluator();
+    /**
+     * Compute the nodes that are dirty, which on the first call is all of them.
+     * If a node fails, it and the nodes not yet computed stay dirty.
+     * @return the values of the trees, in the order they were given.
+     * @throws rdag_error if a node fails.
+     */
+    std::vector<OGTerminal::Ptr> evaluate();
+    /**
+     * Record that the data of a terminal has been written in place, marking every node
+     * that depends on it dirty.
+     * @param terminal a terminal of the trees.
+     * @throws rdag_error if the terminal is not in the trees.
+     */
+    void changed(const OGTerminal::Ptr& terminal);
+    /**
+     * Replace a terminal with another, for terminals such as scalars that cannot be
+     * written in place. The nodes that depend on the terminal are rebuilt with the
+     * replacement, and are dirty. The replacement may differ in type and shape, as long
+     * as the trees still conform.
+     * @param terminal a terminal of the trees.
+     * @param replacement the terminal to use in its place.
+     * @throws rdag_error if the terminal is not in the trees, or if the arguments of a
+     * node no longer conform, in which case the evaluator is unchanged.
+     */
+    void replace(const OGTerminal::Ptr& terminal, const OGTerminal::Ptr& replacement);
+    /**
+     * Get the roots of the trees as they now are, after any replacements.
+     * @return the roots, in the order the trees were given.
+     */
+    const std::vector<OGNumeric::Ptr>& getRoots() const;
+    /**
+     * Get the number of nodes that the next call to evaluate() will compute.
+     * @return the number of dirty nodes.
+     */
+    size_t getDirtyCount() const;
+  private:
+    void build();
+    std::vector<size_t> getCone(const OGTerminal::Ptr& terminal) const;
+    std::vector<OGNumeric::Ptr> _roots;
+    std::unique_ptr<ExecutionList> _el;
+    std::unique_ptr<DependencyGraph> _graph;
+    std::unordered_set<const OGNumeric*> _dirty;
+};
+
+} // end namespace librdag
+
+#endif // _INCREMENTAL_HH
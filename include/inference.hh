@@ -0,0 +1,100 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _INFERENCE_HH
+#define _INFERENCE_HH
+
+#include <unordered_map>
+#include <vector>
+#include "numeric.hh"
+#include "uncopyable.hh"
+
+namespace librdag {
+
+class ExecutionList;
+
+/**
+ * What is known about a value before it is computed: the type of terminal it will be
+ * and its shape.
+ */
+struct ValueInfo
+{
+  /**
+   * Construct an unknown value.
+   */
+  ValueInfo();
+  /**
+   * Construct a value of known type and shape.
+   * @param type the type of the terminal.
+   * @param rows the number of rows.
+   * @param cols the number of columns.
+   */
+  ValueInfo(ExprType_t type, size_t rows, size_t cols);
+  /**
+   * Whether the value is known to be a dense matrix, of either kind.
+   * @return true if the type is REAL_DENSE_MATRIX_ENUM or COMPLEX_DENSE_MATRIX_ENUM.
+   */
+  bool isDense() const;
+  /** The type of the terminal, UNKNOWN_EXPR_ENUM if it is not known */
+  ExprType_t type;
+  /** Whether the shape is known */
+  bool shapeKnown;
+  /** The number of rows, if the shape is known */
+  size_t rows;
+  /** The number of columns, if the shape is known */
+  size_t cols;
+};
+
+/**
+ * Infers the type and shape of the result of every node of an ExecutionList from the
+ * types and shapes of its terminals, following the conversions made by the dispatcher
+ * and the rules of the runners, without computing anything.
+ *
+ * A node whose arguments do not conform, for example a matrix product of matrices
+ * that do not commute, is reported with the exception its runner would throw, so
+ * that a bad tree is rejected before any of it is executed. Where the result depends
+ * on the data, or on a node that has no runner, it is left unknown and the runner has
+ * the final say.
+ */
+class TypeInference: private Uncopyable
+{
+  public:
+    /**
+     * Infer the results of a node from those of its arguments.
+     * @param node the node.
+     * @param args the results of each of the arguments of the node, in order. Empty
+     * for a terminal.
+     * @return the results of the node, one for each register it fills. A node whose
+     * results are unknown has a single unknown result.
+     * @throws rdag_error if the arguments are known not to conform.
+     */
+    static std::vector<ValueInfo> infer(const OGNumeric::Ptr& node,
+                                        const std::vector<std::vector<ValueInfo>>& args);
+    /**
+     * Infer the results of every node of an execution list.
+     * @param el the execution list.
+     * @throws rdag_error for the first node in the list whose arguments do not conform.
+     */
+    TypeInference(ExecutionList& el);
+    /**
+     * Get the results of a node.
+     * @param node a node of the execution list.
+     * @return the results, one for each register the node fills.
+     */
+    const std::vector<ValueInfo>& getResults(const OGNumeric::Ptr& node) const;
+    /**
+     * Get the first result of a node, which is the value of a node filling one register.
+     * @param node a node of the execution list.
+     * @return the result.
+     */
+    const ValueInfo& getResult(const OGNumeric::Ptr& node) const;
+  private:
+    std::unordered_map<const OGNumeric*, std::vector<ValueInfo>> _results;
+};
+
+} // end namespace librdag
+
+#endif // _INFERENCE_HH
@@ -55,6 +55,7 @@ class JVMManager {
     DLLEXPORT_C static jclass getMathsExceptionNativeConversionClazz();
     DLLEXPORT_C static jclass getMathsExceptionNativeComputationClazz();
     DLLEXPORT_C static jclass getMathsExceptionNativeUnspecifiedClazz();
+    DLLEXPORT_C static jclass getSystemClazz();
     DLLEXPORT_C static jmethodID getOGRealScalarClazz_init();
     DLLEXPORT_C static jmethodID getOGComplexScalarClazz_init();
     DLLEXPORT_C static jmethodID getOGRealDenseMatrixClazz_init();
@@ -73,6 +74,7 @@ class JVMManager {
     DLLEXPORT_C static jmethodID getOGSparseMatrixClazz_getColPtr();
     DLLEXPORT_C static jmethodID getOGSparseMatrixClazz_getRowIdx();
     DLLEXPORT_C static jmethodID getComplexArrayContainerClazz_ctor_DAoA_DAoA();
+    DLLEXPORT_C static jmethodID getSystemClazz_identityHashCode();
     DLLEXPORT_C static jfieldID  getOGExprEnumClazz__hashdefined();
     // Wrappers for JNIEnv and JavaVM methods
     DLLEXPORT_C static jobjectArray newObjectArray(JNIEnv *env, jsize len, jclass clazz, jobject init);
@@ -89,6 +91,7 @@ class JVMManager {
     static void registerReferences(JNIEnv * env);
     static void registerGlobalClassReference(JNIEnv * env, const char* FQclassname, jclass *globalRef);
     static void registerGlobalMethodReference(JNIEnv * env, jclass *globalRef, jmethodID* methodToSet, const char* methodName, const char* methodSignature);
+    static void registerGlobalStaticMethodReference(JNIEnv * env, jclass *globalRef, jmethodID* methodToSet, const char* methodName, const char* methodSignature);
     static void registerGlobalFieldReference(JNIEnv * env, jclass *globalRef, jfieldID* fieldIDToSet, const char* fieldIDName, const char* fieldIDSignature);
     static JavaVM* _jvm;
 
@@ -115,6 +118,7 @@ class JVMManager {
     static jclass _MathsExceptionNativeConversionClazz;
     static jclass _MathsExceptionNativeComputationClazz;
     static jclass _MathsExceptionNativeUnspecifiedClazz;
+    static jclass _SystemClazz;
     static jmethodID _DoubleClazz_init;
     static jmethodID _OGRealScalarClazz_init;
     static jmethodID _OGComplexScalarClazz_init;
@@ -134,6 +138,7 @@ class JVMManager {
     static jmethodID _OGSparseMatrixClazz_getColPtr;
     static jmethodID _OGSparseMatrixClazz_getRowIdx;
     static jmethodID _ComplexArrayContainerClazz_ctor_DAoA_DAoA;
+    static jmethodID _SystemClazz_identityHashCode;
     static jfieldID  _OGExprEnumClazz__hashdefined;
 };
 
@@ -41,6 +41,7 @@ namespace detail
 extern char N;
 extern char A;
 extern char T;
+extern char C;
 extern char L;
 extern char U;
 extern char D;
@@ -107,6 +108,10 @@ extern char * A;
  * The F77 character 'T'
  */
 extern char * T;
+/**
+ * The F77 character 'C'
+ */
+extern char * C;
 /**
  * The F77 character 'L'
  */
@@ -200,7 +205,7 @@ template<typename T> void xgemv(char * TRANS, int4 * M, int4 * N, T * ALPHA, T *
 
 /**
  * xgemm generalised matrix matrix multiplication.
- * @tparam T the type of the underlying data real8 and complex16 are accepted
+ * @tparam T the type of the underlying data real8, complex16, real4 and complex8 are accepted
  * @param TRANSA as BLAS dgemm TRANSA
  * @param TRANSB as BLAS dgemm TRANSB
  * @param M as BLAS dgemm M
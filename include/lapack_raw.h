@@ -69,6 +69,14 @@ void F77FUNC(dgemm)(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K,
 extern "C"
 #endif
 void F77FUNC(zgemm)(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K, complex16 * ALPHA, complex16 * A, int4 * LDA, complex16 * B, int4 * LDB, complex16 * BETA, complex16 * C, int4 * LDC );
+#ifdef __cplusplus
+extern "C"
+#endif
+void F77FUNC(sgemm)(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K, real4 * ALPHA, real4 * A, int4 * LDA, real4 * B, int4 * LDB, real4 * BETA, real4 * C, int4 * LDC );
+#ifdef __cplusplus
+extern "C"
+#endif
+void F77FUNC(cgemm)(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K, complex8 * ALPHA, complex8 * A, int4 * LDA, complex8 * B, int4 * LDB, complex8 * BETA, complex8 * C, int4 * LDC );
 
 // Standard NORM2 implementations.
 #ifdef __cplusplus
@@ -0,0 +1,233 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _PLAN_HH
+#define _PLAN_HH
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "numeric.hh"
+#include "fusion.hh"
+#include "uncopyable.hh"
+
+namespace librdag {
+
+class ExecutionList;
+class TypeInference;
+
+/**
+ * The result of analysing an ExecutionList for execution: which nodes are computed,
+ * what they depend on, which elementwise nodes are fused into kernels, where the
+ * intermediate results of the kernels are placed in memory and which results of nodes
+ * with several are consumed.
+ *
+ * A plan refers to nodes by their position in the execution list rather than holding
+ * the nodes themselves, so it can be applied to any execution list with the same
+ * PlanKey and holds on to no data.
+ */
+class ExecutionPlan: private Uncopyable
+{
+  public:
+    typedef std::shared_ptr<const ExecutionPlan> Ptr;
+    /**
+     * A fused kernel of the plan.
+     */
+    struct Kernel
+    {
+      /** Positions of the members, root last */
+      std::vector<size_t> members;
+      /** Positions of the leaves */
+      std::vector<size_t> leaves;
+      /** The compiled kernel */
+      std::vector<detail::FusedInstruction> code;
+    };
+    /**
+     * Analyse an execution list. The types and shapes of all the nodes are inferred
+     * first, see TypeInference, so that a tree that cannot be executed is rejected
+     * before anything is computed.
+     * @param el the execution list.
+     * @param fuse whether to fuse elementwise nodes.
+     * @return the plan.
+     * @throws rdag_error if the arguments of a node do not conform.
+     */
+    static Ptr create(ExecutionList& el, bool fuse);
+    /**
+     * Get the number of nodes computed, fused kernels counting as one.
+     * @return the number of nodes.
+     */
+    size_t size() const;
+    /**
+     * Get the position of a node in the execution list.
+     * @param n the index of the node.
+     * @return its position in the execution list.
+     */
+    size_t getPosition(size_t n) const;
+    /**
+     * Get the number of distinct nodes that must be computed before a node can be.
+     * @param n the index of the node.
+     * @return the number of nodes that node \a n depends on.
+     */
+    size_t getDependencyCount(size_t n) const;
+    /**
+     * Get the nodes that depend on a node.
+     * @param n the index of the node.
+     * @return the indices of the nodes that consume the result of node \a n.
+     */
+    const std::vector<size_t>& getDependents(size_t n) const;
+    /**
+     * Get the nodes that a node depends on.
+     * @param n the index of the node.
+     * @return the indices of the distinct nodes whose results node \a n consumes.
+     */
+    const std::vector<size_t>& getDependencies(size_t n) const;
+    /**
+     * Whether a node is the root of one of the trees of the execution list, so that
+     * its result must be kept even if other nodes consume it.
+     * @param n the index of the node.
+     * @return true if the node is a result of the execution.
+     */
+    bool isResult(size_t n) const;
+    /**
+     * Get the kernel computing a node.
+     * @param n the index of the node.
+     * @return the kernel, or nullptr if the node is dispatched directly.
+     */
+    const Kernel * getKernel(size_t n) const;
+    /**
+     * Whether the nodes form a simple chain, in which case there is nothing to be
+     * gained by executing them in parallel.
+     * @return true if no two nodes could run concurrently.
+     */
+    bool isSequential() const;
+    /**
+     * Get the size of the arena holding the intermediate results of the fused kernels,
+     * which is allocated once for each execution. Results may share space in the arena
+     * if one is no longer needed by the time the other is computed, whatever order
+     * the nodes are executed in.
+     * @return the size of the arena in bytes, 0 if no result is placed in it.
+     */
+    size_t getArenaSize() const;
+    /**
+     * Get where the result of a node is placed in the arena. Only fused kernels that
+     * are not results of the execution, and whose results are dense matrices of known
+     * shape, are placed in the arena.
+     * @param n the index of the node.
+     * @param offset set to the offset of the space for the result, in bytes.
+     * @param bytes set to the size of the space for the result, in bytes.
+     * @return true if the result of the node is placed in the arena.
+     */
+    bool getArenaSlot(size_t n, size_t& offset, size_t& bytes) const;
+    /**
+     * Get which results of a node are consumed, see ResultDemand.
+     * @param n the index of the node.
+     * @return the demand for the node, ResultDemand::ALL unless it is an SVD or LU
+     * some of whose results are not used.
+     */
+    uint64_t getDemand(size_t n) const;
+  private:
+    ExecutionPlan() = default;
+    void planArena(ExecutionList& el, const TypeInference& types);
+    std::vector<size_t> _positions;
+    std::vector<size_t> _dependencyCount;
+    std::vector<std::vector<size_t>> _dependents;
+    std::vector<std::vector<size_t>> _dependencies;
+    std::vector<bool> _results;
+    std::vector<std::unique_ptr<Kernel>> _kernels;
+    std::vector<size_t> _arenaOffsets;
+    std::vector<size_t> _arenaBytes;
+    size_t _arenaSize;
+    std::vector<uint64_t> _demand;
+};
+
+/**
+ * The structure of an execution list: the type of every node, how the nodes are
+ * connected, the shapes of the terminals, the values of the integer terminals (which
+ * select results) and which nodes are roots. Execution lists with equal keys have
+ * the same ExecutionPlan.
+ */
+class PlanKey
+{
+  public:
+    /**
+     * Construct the key for an execution list.
+     * @param el the execution list.
+     * @param fuse whether the plan fuses elementwise nodes.
+     */
+    PlanKey(ExecutionList& el, bool fuse);
+    /**
+     * Get the hash of the key.
+     * @return the hash.
+     */
+    size_t getHash() const;
+    bool operator==(const PlanKey& other) const;
+  private:
+    std::vector<size_t> _tokens;
+    size_t _hash;
+};
+
+/**
+ * A process-wide, thread-safe cache of execution plans, so that evaluating the same
+ * structure again with different data does not repeat the analysis. The least
+ * recently used plan is evicted when the cache is full.
+ */
+class PlanCache
+{
+  public:
+    /**
+     * Get the plan for an execution list, from the cache if present, otherwise by
+     * analysing the list and adding the result to the cache.
+     * @param el the execution list.
+     * @param fuse whether to fuse elementwise nodes.
+     * @return the plan.
+     */
+    static ExecutionPlan::Ptr getPlan(ExecutionList& el, bool fuse);
+    /**
+     * Get whether the cache is used, the default is true.
+     * @return true if the cache is enabled.
+     */
+    static bool getEnabled();
+    /**
+     * Set whether the cache is used. Disabling the cache also empties it.
+     * @param enabled true to enable the cache.
+     */
+    static void setEnabled(bool enabled);
+    /**
+     * Get the maximum number of plans held.
+     * @return the capacity.
+     */
+    static size_t getCapacity();
+    /**
+     * Set the maximum number of plans held, evicting plans if necessary.
+     * @param capacity the capacity.
+     */
+    static void setCapacity(size_t capacity);
+    /**
+     * Get the number of plans held.
+     * @return the number of plans.
+     */
+    static size_t size();
+    /**
+     * Remove all plans and reset the statistics.
+     */
+    static void clear();
+    /**
+     * Get the number of times getPlan() found a plan in the cache.
+     * @return the number of hits.
+     */
+    static size_t getHits();
+    /**
+     * Get the number of times getPlan() had to analyse an execution list.
+     * @return the number of misses.
+     */
+    static size_t getMisses();
+  private:
+    PlanCache() = delete;
+};
+
+} // end namespace librdag
+
+#endif // _PLAN_HH
@@ -0,0 +1,214 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _REWRITE_HH
+#define _REWRITE_HH
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "expressionbase.hh"
+#include "inference.hh"
+
+namespace librdag {
+
+/**
+ * What is known about the values of the nodes of a tree being rewritten, without
+ * computing them. Realness and shape are derived from the terminals, shapes by
+ * TypeInference, so they are not known for a node if they are not known for its
+ * arguments, or if they depend on the data.
+ */
+class RewriteContext
+{
+  public:
+    /**
+     * Record a node. Its arguments must already have been recorded.
+     * @param node the node.
+     * @param uses the number of times the node is an argument in the tree.
+     */
+    void add(const OGNumeric::Ptr& node, size_t uses = 1);
+    /**
+     * Whether a node is known to have a real value.
+     * @param node a recorded node.
+     * @return true if the value is known to be real.
+     */
+    bool isReal(const OGNumeric::Ptr& node) const;
+    /**
+     * Get the shape of the value of a node, if it is known.
+     * @param node a recorded node.
+     * @param rows set to the number of rows, if known.
+     * @param cols set to the number of columns, if known.
+     * @return true if the shape is known.
+     */
+    bool getShape(const OGNumeric::Ptr& node, size_t& rows, size_t& cols) const;
+    /**
+     * Whether the value of a node is known to be a dense matrix, real or complex, that is
+     * not 1x1. Such a value keeps its type and shape through TRANSPOSE, CTRANSPOSE and
+     * NEGATE, which other values, such as scalars, may not.
+     * @param node a recorded node.
+     * @return true if the value is known to be such a matrix.
+     */
+    bool isDenseMatrix(const OGNumeric::Ptr& node) const;
+    /**
+     * Get the number of times a node is an argument in the tree. Nodes made by rules
+     * are assumed to be used once, unless they replace a node used more often.
+     * @param node a recorded node.
+     * @return the number of uses.
+     */
+    size_t getUseCount(const OGNumeric::Ptr& node) const;
+  private:
+    struct Info
+    {
+      // Keeps the node alive, so that its address is not reused for a different node
+      OGNumeric::Ptr node;
+      bool real;
+      std::vector<ValueInfo> results;
+      size_t uses;
+    };
+    const Info& getInfo(const OGNumeric::Ptr& node) const;
+    std::unordered_map<const OGNumeric*, Info> _info;
+};
+
+/**
+ * A rule replacing an expression by a cheaper one computing the same value.
+ *
+ * To add a rule, derive from this class and pass an instance to the Rewriter along
+ * with (or instead of) the default rules. A rule must make progress - it must not
+ * produce a tree that it, or another rule, rewrites back again.
+ */
+class RewriteRule
+{
+  public:
+    typedef std::shared_ptr<const RewriteRule> Ptr;
+    virtual ~RewriteRule();
+    /**
+     * Get the name of the rule, for debugging.
+     * @return the name.
+     */
+    virtual const char * getName() const = 0;
+    /**
+     * Apply the rule to a node, whose arguments have already been rewritten.
+     * @param node the node.
+     * @param context what is known about the node and its descendants.
+     * @return the replacement for the node, or a null pointer if the rule does not
+     * apply to it.
+     */
+    virtual OGNumeric::Ptr apply(const OGExpr::Ptr& node, const RewriteContext& context) const = 0;
+};
+
+/**
+ * TRANSPOSE(TRANSPOSE(x)) and CTRANSPOSE(CTRANSPOSE(x)) are x. Applies only when x is
+ * known to be a dense matrix that is not 1x1, as the value of the transposes is.
+ */
+class DoubleTransposeRule: public RewriteRule
+{
+  public:
+    virtual const char * getName() const override;
+    virtual OGNumeric::Ptr apply(const OGExpr::Ptr& node, const RewriteContext& context) const override;
+};
+
+/**
+ * NEGATE(NEGATE(x)) is x. Applies only when x is known to be a dense matrix that is not
+ * 1x1, as other types, such as integer scalars, are not kept by NEGATE.
+ */
+class DoubleNegateRule: public RewriteRule
+{
+  public:
+    virtual const char * getName() const override;
+    virtual OGNumeric::Ptr apply(const OGExpr::Ptr& node, const RewriteContext& context) const override;
+};
+
+/**
+ * CTRANSPOSE(x) is TRANSPOSE(x) when x is real, which saves conjugating every element.
+ */
+class RealCTransposeRule: public RewriteRule
+{
+  public:
+    virtual const char * getName() const override;
+    virtual OGNumeric::Ptr apply(const OGExpr::Ptr& node, const RewriteContext& context) const override;
+};
+
+/**
+ * MTIMES(INV(A), B) is MLDIVIDE(A, B), a solve being cheaper and more accurate than
+ * forming the inverse. Applies only when A is known to be square with as many rows as
+ * B, so that the matrix product does not broadcast a scalar, and when INV(A) is used
+ * only by this product, as its other consumers would need the inverse formed anyway.
+ *
+ * The results differ for a singular A: INV warns and gives Inf, so the product is Inf
+ * or NaN, whereas MLDIVIDE gives the least squares solution.
+ */
+class InverseTimesRule: public RewriteRule
+{
+  public:
+    virtual const char * getName() const override;
+    virtual OGNumeric::Ptr apply(const OGExpr::Ptr& node, const RewriteContext& context) const override;
+};
+
+/**
+ * Reassociates a chain of matrix products, A*B*...*Z, so that it costs the fewest
+ * multiplications, using the classic dynamic programming algorithm. For example
+ * (A*B)*x becomes A*(B*x), two matrix-vector products rather than a matrix-matrix
+ * product. The chain is flattened through MTIMES arguments used only by the chain,
+ * and is reassociated only if the shapes of all its factors are known and none is a
+ * scalar.
+ */
+class MatrixChainRule: public RewriteRule
+{
+  public:
+    virtual const char * getName() const override;
+    virtual OGNumeric::Ptr apply(const OGExpr::Ptr& node, const RewriteContext& context) const override;
+};
+
+/**
+ * Rewrites trees with a set of rules, before they are executed.
+ *
+ * The tree is rewritten bottom up: the arguments of a node are rewritten before the
+ * node, then the rules are tried on the node in order. When a rule applies, its
+ * replacement is itself rewritten. The input tree is not modified; expression nodes
+ * above a rewritten node are rebuilt.
+ */
+class Rewriter
+{
+  public:
+    /**
+     * Get the default rules, which are those declared above.
+     * @return the rules.
+     */
+    static const std::vector<RewriteRule::Ptr>& getDefaultRules();
+    /**
+     * Get whether the rewriter is applied by entrypt(), the default is true.
+     * @return true if trees are rewritten.
+     */
+    static bool getEnabled();
+    /**
+     * Set whether the rewriter is applied by entrypt().
+     * @param enabled true to rewrite trees.
+     */
+    static void setEnabled(bool enabled);
+    /**
+     * Construct a rewriter.
+     * @param rules the rules to apply, in order of preference.
+     */
+    Rewriter(const std::vector<RewriteRule::Ptr>& rules = getDefaultRules());
+    /**
+     * Get the rules.
+     * @return the rules, in order of preference.
+     */
+    const std::vector<RewriteRule::Ptr>& getRules() const;
+    /**
+     * Rewrite a tree.
+     * @param tree the tree to rewrite.
+     * @return a tree computing the same value as \a tree. If no rule applies, this is
+     * \a tree itself. It may be a terminal.
+     */
+    OGNumeric::Ptr rewrite(const OGNumeric::Ptr& tree) const;
+  private:
+    std::vector<RewriteRule::Ptr> _rules;
+};
+
+} // end namespace librdag
+
+#endif // _REWRITE_HH
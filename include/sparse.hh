@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _SPARSE_HH
+#define _SPARSE_HH
+
+#include "numeric.hh"
+#include "terminal.hh"
+
+namespace librdag {
+
+/**
+ * The sparse namespace contains kernels operating directly on matrices in compressed
+ * sparse column (CSC) form, templated on the <real8,complex16> data type, so that sparse
+ * arguments are not converted to dense matrices. A result that is sparse is returned as
+ * an OGSparseMatrix with the row indices of each column in increasing order and without
+ * explicit zeros. As for the dense runners, an argument that is 1x1 is treated as a
+ * scalar. An implicit zero of a sparse argument multiplied by an Inf or NaN is NaN, as it
+ * would be were the argument dense, so such products may fill in entries.
+ */
+namespace sparse
+{
+
+/**
+ * Elementwise addition or subtraction of sparse matrices, y:=a+b or y:=a-b.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the first matrix.
+ * @param b the second matrix.
+ * @param subtract true to compute a-b.
+ * @return a sparse matrix if \a a and \a b have the same shape, else a dense matrix.
+ * @throws rdag_error if the shapes mismatch.
+ */
+template<typename T>
+OGNumeric::Ptr plus(const OGSparseMatrix<T>& a, const OGSparseMatrix<T>& b, bool subtract);
+
+/**
+ * Elementwise multiplication of sparse matrices, y:=a.*b.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the first matrix.
+ * @param b the second matrix.
+ * @return a sparse matrix, holding only entries present in both, or made NaN by an
+ * Inf or NaN in one of them.
+ * @throws rdag_error if the shapes mismatch.
+ */
+template<typename T>
+OGNumeric::Ptr times(const OGSparseMatrix<T>& a, const OGSparseMatrix<T>& b);
+
+/**
+ * Elementwise multiplication of a sparse and a dense matrix, y:=a.*b.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the sparse matrix.
+ * @param b the dense matrix.
+ * @return a sparse matrix with the pattern of \a a plus any entries made NaN by an Inf
+ * or NaN in \a b, or a dense matrix if \a a is 1x1.
+ * @throws rdag_error if the shapes mismatch.
+ */
+template<typename T>
+OGNumeric::Ptr times(const OGSparseMatrix<T>& a, const OGMatrix<T>& b);
+
+/**
+ * Multiplication of a sparse matrix by a scalar, y:=s*a.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the sparse matrix.
+ * @param s the scalar.
+ * @return a sparse matrix with the pattern of \a a, less any entries made zero. If \a s
+ * is Inf or NaN every implicit zero is made NaN.
+ */
+template<typename T>
+OGNumeric::Ptr scale(const OGSparseMatrix<T>& a, T s);
+
+/**
+ * Matrix product of a sparse and a dense matrix, y:=a*b, which is a sparse matrix
+ * vector product (SpMV) if \a b has one column.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the sparse matrix.
+ * @param b the dense matrix.
+ * @return a dense matrix, or a sparse matrix if \a b is 1x1.
+ * @throws rdag_error if the matrices do not commute.
+ */
+template<typename T>
+OGNumeric::Ptr mtimes(const OGSparseMatrix<T>& a, const OGMatrix<T>& b);
+
+/**
+ * Matrix product of a dense and a sparse matrix, y:=a*b.
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the dense matrix.
+ * @param b the sparse matrix.
+ * @return a dense matrix, or a sparse matrix if \a a is 1x1.
+ * @throws rdag_error if the matrices do not commute.
+ */
+template<typename T>
+OGNumeric::Ptr mtimes(const OGMatrix<T>& a, const OGSparseMatrix<T>& b);
+
+/**
+ * Matrix product of sparse matrices (SpGEMM), y:=a*b, computed a column at a time
+ * with a dense accumulator (Gustavson's algorithm).
+ * @param T the data types <real8> and <complex16> are accepted.
+ * @param a the first matrix.
+ * @param b the second matrix.
+ * @return a sparse matrix.
+ * @throws rdag_error if the matrices do not commute.
+ */
+template<typename T>
+OGNumeric::Ptr mtimes(const OGSparseMatrix<T>& a, const OGSparseMatrix<T>& b);
+
+} // end namespace sparse
+
+} // end namespace librdag
+
+#endif // _SPARSE_HH
@@ -48,6 +48,84 @@ enum DATA_ACCESS
   OWNER
 };
 
+/**
+ * The structural properties of the data of a matrix that are known from how it was
+ * computed, so that consumers can exploit them without scanning the data. A property
+ * that is not recorded is not known, rather than known not to hold.
+ */
+class Structure
+{
+  public:
+    /**
+     * The properties, which are combined as a mask.
+     */
+    enum Property: unsigned
+    {
+      /**
+       * Zero below the diagonal.
+       */
+      UPPER_TRIANGULAR = 1 << 0,
+      /**
+       * Zero above the diagonal.
+       */
+      LOWER_TRIANGULAR = 1 << 1,
+      /**
+       * Ones on the diagonal, recorded only for triangular matrices.
+       */
+      UNIT_DIAGONAL = 1 << 2,
+      /**
+       * Equal to its conjugate transpose, symmetric if real.
+       */
+      HERMITIAN = 1 << 3,
+      /**
+       * Hermitian and positive definite.
+       */
+      POSITIVE_DEFINITE = 1 << 4
+    };
+    /**
+     * The bandwidth of a matrix whose bandwidth is not known.
+     */
+    static constexpr size_t UNKNOWN_BANDWIDTH = std::numeric_limits<size_t>::max();
+    /**
+     * Creates the structure of a matrix of which nothing is known.
+     */
+    Structure();
+    /**
+     * Creates a structure. Triangular matrices have a bandwidth of zero on their zero
+     * side, and positive definite ones are Hermitian, whether or not that is given.
+     * @param properties the mask of properties known to hold.
+     * @param lowerBandwidth the number of diagonals below the main one that may be nonzero.
+     * @param upperBandwidth the number of diagonals above the main one that may be nonzero.
+     */
+    Structure(unsigned properties, size_t lowerBandwidth = UNKNOWN_BANDWIDTH,
+              size_t upperBandwidth = UNKNOWN_BANDWIDTH);
+    /**
+     * Whether a property is known to hold.
+     */
+    bool has(Property property) const;
+    /**
+     * Gets the mask of properties known to hold.
+     */
+    unsigned getProperties() const;
+    /**
+     * Gets the number of diagonals below the main one that may be nonzero.
+     */
+    size_t getLowerBandwidth() const;
+    /**
+     * Gets the number of diagonals above the main one that may be nonzero.
+     */
+    size_t getUpperBandwidth() const;
+    /**
+     * Gets the structure of the transpose of a matrix of this structure, which is also
+     * that of its conjugate transpose.
+     */
+    Structure transposed() const;
+  private:
+    unsigned _properties;
+    size_t _lowerBandwidth;
+    size_t _upperBandwidth;
+};
+
 /*
  * Base class for terminal nodes in the AST
  */
@@ -147,10 +225,23 @@ class OGTerminal: public OGNumeric
     virtual detail::FuzzyCompareOGTerminalContainer operator~(void) const;
     virtual bool operator==(const detail::FuzzyCompareOGTerminalContainer&) const;
     virtual bool operator!=(const detail::FuzzyCompareOGTerminalContainer&) const;
+    /**
+     * Gets the structural properties known of the data, none unless recorded.
+     */
+    const Structure& getStructure() const;
+    /**
+     * Records the structural properties known of the data. Terminals are shared as
+     * const, but the structure describes the data rather than being part of it, so the
+     * runner creating a terminal records it before pushing the terminal into a register.
+     * @param structure the structure, which must hold for the data.
+     */
+    void setStructure(const Structure& structure) const;
     OGTerminal();
     virtual ~OGTerminal();
   protected:
     ConvertTo _converter;
+  private:
+    mutable Structure _structure;
 };
 
 /**
@@ -263,6 +354,7 @@ template <typename T> class OGArray: public OGTerminal
     virtual ~OGArray() override;
     T * getData() const; // Returns a pointer to the underlying data
     T * toArray() const; // Returns a pointer to a copy of the underlying data
+    T * releaseData(); // Gives up ownership of the underlying data to the caller, which must free it
     virtual size_t getRows() const override;
     virtual size_t getCols() const override;
     virtual size_t getDatalen() const override;
@@ -323,11 +415,18 @@ template <typename T> class OGMatrix: public OGArray<T>
 template<> real8 ** OGMatrix<real8>::toReal8ArrayOfArrays() const;
 template<> real8 ** OGMatrix<complex16>::toReal8ArrayOfArrays() const;
 
+template<> real8 ** OGMatrix<real4>::toReal8ArrayOfArrays() const;
+template<> real8 ** OGMatrix<complex8>::toReal8ArrayOfArrays() const;
+
 template<> ExprType_t OGMatrix<real8>::getType() const ;
 template<> ExprType_t OGMatrix<complex16>::getType() const ;
+template<> ExprType_t OGMatrix<real4>::getType() const ;
+template<> ExprType_t OGMatrix<complex8>::getType() const ;
 
 extern template class OGMatrix<real8>;
 extern template class OGMatrix<complex16>;
+extern template class OGMatrix<real4>;
+extern template class OGMatrix<complex8>;
 
 class OGRealDenseMatrix: public OGMatrix<real8>
 {
@@ -374,6 +473,56 @@ class OGComplexDenseMatrix: public OGMatrix<complex16>
 };
 
 
+/**
+ * A real dense matrix held in single precision, for data that tolerates it, at half the
+ * memory traffic of an OGRealDenseMatrix. Operations without a single precision runner
+ * widen it to an OGRealDenseMatrix and give a double precision result.
+ */
+class OGRealSingleDenseMatrix: public OGMatrix<real4>
+{
+  public:
+    /**
+     * Pointer type.
+     */
+    typedef std::shared_ptr<const OGRealSingleDenseMatrix> Ptr;
+    static OGRealSingleDenseMatrix::Ptr create(real4* data, size_t rows, size_t cols, DATA_ACCESS access_spec=VIEWER);
+    static OGRealSingleDenseMatrix::Ptr create(std::initializer_list<std::initializer_list<real4>> list);
+    virtual OGNumeric::Ptr copy() const override;
+    virtual OGRealSingleDenseMatrix::Ptr asOGRealSingleDenseMatrix() const override;
+    virtual ExprType_t getType() const override;
+    virtual std::shared_ptr<const OGRealDenseMatrix> asFullOGRealDenseMatrix() const override;
+    virtual std::shared_ptr<const OGComplexDenseMatrix> asFullOGComplexDenseMatrix() const override;
+    virtual OGTerminal::Ptr createOwningCopy() const override;
+    virtual OGTerminal::Ptr createComplexOwningCopy() const override;
+  protected:
+    using OGMatrix::OGMatrix;
+};
+
+
+/**
+ * A complex dense matrix held in single precision, see OGRealSingleDenseMatrix.
+ */
+class OGComplexSingleDenseMatrix: public OGMatrix<complex8>
+{
+  public:
+    /**
+     * Pointer type.
+     */
+    typedef std::shared_ptr<const OGComplexSingleDenseMatrix> Ptr;
+    static OGComplexSingleDenseMatrix::Ptr create(complex8* data, size_t rows, size_t cols, DATA_ACCESS access_spec=VIEWER);
+    static OGComplexSingleDenseMatrix::Ptr create(std::initializer_list<std::initializer_list<complex8>> list);
+    virtual OGNumeric::Ptr copy() const override;
+    virtual OGComplexSingleDenseMatrix::Ptr asOGComplexSingleDenseMatrix() const override;
+    virtual ExprType_t getType() const override;
+    virtual std::shared_ptr<const OGRealDenseMatrix> asFullOGRealDenseMatrix() const override;
+    virtual std::shared_ptr<const OGComplexDenseMatrix> asFullOGComplexDenseMatrix() const override;
+    virtual OGTerminal::Ptr createOwningCopy() const override;
+    virtual OGTerminal::Ptr createComplexOwningCopy() const override;
+  protected:
+    using OGMatrix::OGMatrix;
+};
+
+
 class OGLogicalMatrix: public OGRealDenseMatrix
 {
   public:
@@ -525,6 +674,98 @@ class OGComplexSparseMatrix: public OGSparseMatrix<complex16>
     using OGSparseMatrix::OGSparseMatrix;
 };
 
+
+/**
+ * Things that extend OGTransposedMatrix
+ */
+
+/**
+ * The transpose, or conjugate transpose, of a dense matrix held as a view of the data of
+ * that matrix rather than a copy. Runners backed by BLAS pass the transposition on as
+ * the TRANS argument, the dispatcher converts the view to a dense matrix for the rest.
+ * The data is that of the source matrix, so is the transpose of this in column major
+ * order.
+ */
+template <typename T> class OGTransposedMatrix: public OGArray<T>
+{
+  public:
+    typedef std::shared_ptr<const OGTransposedMatrix<T>> Ptr;
+    /**
+     * Gets the matrix this is the transpose of.
+     */
+    typename OGMatrix<T>::Ptr getSource() const;
+    /**
+     * Whether the entries of the source are conjugated as well as transposed.
+     */
+    bool isConjugate() const;
+    /**
+     * Writes the entries of this in column major order, as a dense matrix holds them.
+     * @param dest space for getDatalen() entries.
+     */
+    void materialise(T * dest) const;
+    virtual bool equals(const OGTerminal::Ptr&) const override; // override OGArray equals to check the conjugation too
+    virtual bool fuzzyequals(const OGTerminal::Ptr& term) const override;
+    virtual bool fuzzyequals(const OGTerminal::Ptr&, real8 maxabserror, real8 maxrelerror) const override;
+  protected:
+    OGTransposedMatrix(typename OGMatrix<T>::Ptr source, bool conjugate);
+  private:
+    typename OGMatrix<T>::Ptr _source; // keeps the viewed data alive
+    bool _conjugate;
+};
+
+extern template class OGTransposedMatrix<real8>;
+extern template class OGTransposedMatrix<complex16>;
+
+class OGRealTransposedMatrix: public OGTransposedMatrix<real8>
+{
+  public:
+    /**
+     * Pointer type.
+     */
+    typedef std::shared_ptr<const OGRealTransposedMatrix> Ptr;
+    static OGRealTransposedMatrix::Ptr create(OGMatrix<real8>::Ptr source);
+    virtual void debug_print() const override;
+    virtual real8** toReal8ArrayOfArrays() const override;
+    virtual complex16** toComplex16ArrayOfArrays() const override;
+    virtual OGNumeric::Ptr copy() const override;
+    virtual OGRealTransposedMatrix::Ptr asOGRealTransposedMatrix() const override;
+    virtual ExprType_t getType() const override;
+    virtual std::shared_ptr<const OGRealDenseMatrix> asFullOGRealDenseMatrix() const override;
+    virtual std::shared_ptr<const OGComplexDenseMatrix> asFullOGComplexDenseMatrix() const override;
+    /*
+     * A view owns no data, so its owning copies are dense matrices.
+     */
+    virtual OGTerminal::Ptr createOwningCopy() const override;
+    virtual OGTerminal::Ptr createComplexOwningCopy() const override;
+  protected:
+    using OGTransposedMatrix::OGTransposedMatrix;
+};
+
+
+class OGComplexTransposedMatrix: public OGTransposedMatrix<complex16>
+{
+  public:
+    /**
+     * Pointer type.
+     */
+    typedef std::shared_ptr<const OGComplexTransposedMatrix> Ptr;
+    static OGComplexTransposedMatrix::Ptr create(OGMatrix<complex16>::Ptr source, bool conjugate);
+    virtual void debug_print() const override;
+    virtual complex16** toComplex16ArrayOfArrays() const override;
+    virtual OGNumeric::Ptr copy() const override;
+    virtual OGComplexTransposedMatrix::Ptr asOGComplexTransposedMatrix() const override;
+    virtual ExprType_t getType() const override;
+    virtual std::shared_ptr<const OGRealDenseMatrix> asFullOGRealDenseMatrix() const override;
+    virtual std::shared_ptr<const OGComplexDenseMatrix> asFullOGComplexDenseMatrix() const override;
+    /*
+     * A view owns no data, so its owning copies are dense matrices.
+     */
+    virtual OGTerminal::Ptr createOwningCopy() const override;
+    virtual OGTerminal::Ptr createComplexOwningCopy() const override;
+  protected:
+    using OGTransposedMatrix::OGTransposedMatrix;
+};
+
 /**
  * Creates a non-templated OGMatrix object based on the type of data \a T.
  * e.g. creates an OGRealDenseMatrix from real8 type \a data.
@@ -540,6 +781,69 @@ template<>
 OGNumeric::Ptr makeConcreteDenseMatrix(real8 * data, size_t rows, size_t cols, DATA_ACCESS access);
 template<>
 OGNumeric::Ptr makeConcreteDenseMatrix(complex16 * data, size_t rows, size_t cols, DATA_ACCESS access);
+template<>
+OGNumeric::Ptr makeConcreteDenseMatrix(real4 * data, size_t rows, size_t cols, DATA_ACCESS access);
+template<>
+OGNumeric::Ptr makeConcreteDenseMatrix(complex8 * data, size_t rows, size_t cols, DATA_ACCESS access);
+
+/**
+ * Creates a non-templated OGDiagonalMatrix object based on the type of data \a T.
+ * e.g. creates an OGRealDiagonalMatrix from real8 type \a data.
+ * @param data the diagonal from which an OGDiagonalMatrix shall be constructed.
+ * @param rows the number of rows in the matrix.
+ * @param cols the number of columns in the matrix.
+ * @return a non-templated OGDiagonalMatrix object.
+ */
+template<typename T>
+OGNumeric::Ptr makeConcreteDiagonalMatrix(T * data, size_t rows, size_t cols, DATA_ACCESS access);
+// PTS
+template<>
+OGNumeric::Ptr makeConcreteDiagonalMatrix(real8 * data, size_t rows, size_t cols, DATA_ACCESS access);
+template<>
+OGNumeric::Ptr makeConcreteDiagonalMatrix(complex16 * data, size_t rows, size_t cols, DATA_ACCESS access);
+
+/**
+ * Creates a non-templated OGSparseMatrix object based on the type of data \a T.
+ * e.g. creates an OGRealSparseMatrix from real8 type \a data.
+ * @param colPtr the column pointer index.
+ * @param rowIdx the row index.
+ * @param data the data from which an OGSparseMatrix shall be constructed.
+ * @param rows the number of rows in the matrix.
+ * @param cols the number of columns in the matrix.
+ * @return a non-templated OGSparseMatrix object.
+ */
+template<typename T>
+OGNumeric::Ptr makeConcreteSparseMatrix(int4 * colPtr, int4 * rowIdx, T * data, size_t rows, size_t cols, DATA_ACCESS access);
+// PTS
+template<>
+OGNumeric::Ptr makeConcreteSparseMatrix(int4 * colPtr, int4 * rowIdx, real8 * data, size_t rows, size_t cols, DATA_ACCESS access);
+template<>
+OGNumeric::Ptr makeConcreteSparseMatrix(int4 * colPtr, int4 * rowIdx, complex16 * data, size_t rows, size_t cols, DATA_ACCESS access);
+
+/**
+ * Creates a non-templated OGTransposedMatrix object based on the type of data \a T.
+ * e.g. creates an OGRealTransposedMatrix from an OGMatrix<real8>.
+ * @param source the matrix to view the transpose of.
+ * @param conjugate whether to view the conjugate transpose, which is the transpose for
+ * real data.
+ * @return a non-templated OGTransposedMatrix object.
+ */
+template<typename T>
+OGNumeric::Ptr makeConcreteTransposedMatrix(typename OGMatrix<T>::Ptr source, bool conjugate);
+// PTS
+template<>
+OGNumeric::Ptr makeConcreteTransposedMatrix<real8>(OGMatrix<real8>::Ptr source, bool conjugate);
+template<>
+OGNumeric::Ptr makeConcreteTransposedMatrix<complex16>(OGMatrix<complex16>::Ptr source, bool conjugate);
+
+/**
+ * Gets a terminal holding its data in the layout of its own shape, as callers outside
+ * the library expect. A transposed view is materialised as a dense matrix, anything else
+ * is returned as is.
+ * @param terminal the terminal.
+ * @return the terminal, or a dense matrix equal to it.
+ */
+OGTerminal::Ptr materialiseView(const OGTerminal::Ptr& terminal);
 
 /**
  * Creates a non-templated OGScalar object based on the type of data \a T.
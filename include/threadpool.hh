@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _THREADPOOL_HH
+#define _THREADPOOL_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "uncopyable.hh"
+
+namespace librdag {
+
+/**
+ * A work-stealing pool of threads.
+ *
+ * Each worker owns a queue of tasks. A worker takes work from the back of its own
+ * queue (most recently submitted first, so that a task's continuations run hot in
+ * cache) and, when that queue is empty, steals from the front of the other queues.
+ * Tasks submitted from a worker go on to that worker's queue, tasks submitted from
+ * outside the pool go on to a separate injection queue that all workers steal from.
+ *
+ * Tasks must not throw; anything escaping a task is swallowed so that a worker is
+ * never lost. Callers wanting to see errors must catch them inside the task.
+ */
+class ThreadPool: private Uncopyable
+{
+  public:
+    typedef std::function<void()> Task;
+    /**
+     * Construct a pool.
+     * @param nthreads the number of worker threads to start, must be at least 1.
+     */
+    explicit ThreadPool(size_t nthreads);
+    /**
+     * Destroys the pool. Queued tasks that have not started are discarded and the
+     * workers are joined.
+     */
+    ~ThreadPool();
+    /**
+     * Get the number of worker threads in the pool.
+     * @return the number of worker threads.
+     */
+    size_t getThreadCount() const;
+    /**
+     * Submit a task for execution.
+     * @param task the task to run.
+     */
+    void submit(Task task);
+    /**
+     * Run tasks from the pool on the calling thread until a condition is met.
+     * This allows a thread (including a worker of this pool) to wait for work it
+     * has submitted without blocking a worker, so waits may be nested.
+     * @param done the condition to wait for. It is re-tested whenever a task
+     * completes or wakeAll() is called.
+     */
+    void runUntil(const std::function<bool()>& done);
+    /**
+     * Wake all threads waiting in the pool so that they re-test their conditions.
+     */
+    void wakeAll();
+    /**
+     * Get the number of threads the hardware supports, this is at least 1.
+     * @return the number of hardware threads.
+     */
+    static size_t getHardwareThreadCount();
+  private:
+    struct WorkQueue
+    {
+      std::mutex lock;
+      std::deque<Task> tasks;
+    };
+    bool tryPop(size_t self, Task& task);
+    void runTask(Task& task);
+    size_t getOwnQueue() const;
+    void workerLoop(size_t id);
+    std::vector<std::unique_ptr<WorkQueue>> _queues;
+    std::vector<std::thread> _threads;
+    std::mutex _sleepLock;
+    std::condition_variable _wakeup;
+    std::atomic<size_t> _queued;
+    std::atomic<bool> _shutdown;
+};
+
+} // end namespace librdag
+
+#endif // _THREADPOOL_HH
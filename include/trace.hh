@@ -0,0 +1,146 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#ifndef _TRACE_HH
+#define _TRACE_HH
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "numeric.hh"
+#include "terminal.hh"
+#include "inference.hh"
+#include "uncopyable.hh"
+
+namespace librdag {
+
+/**
+ * The record of one node, or fused kernel, computed while tracing.
+ */
+struct TraceEvent
+{
+  /** The type of the node, the root of the kernel for a fused kernel */
+  ExprType_t type;
+  /** The number of nodes computed, more than one for a fused kernel */
+  size_t nodes;
+  /** The types and shapes of the arguments, the leaves for a fused kernel */
+  std::vector<ValueInfo> args;
+  /** The types and shapes of the results */
+  std::vector<ValueInfo> results;
+  /** The number of arguments converted by ConvertTo before running */
+  size_t conversions;
+  /** The bytes of array data allocated for the results and the conversions */
+  size_t bytes;
+  /** The start time, in nanoseconds since an arbitrary epoch */
+  uint64_t start;
+  /** The wall time taken, in nanoseconds */
+  uint64_t duration;
+  /** A small number identifying the thread the node was computed on */
+  size_t thread;
+  /** Whether computing the node threw */
+  bool failed;
+};
+
+namespace detail {
+
+extern std::atomic<bool> trace_enabled;
+
+} // end namespace detail
+
+/**
+ * Process-wide tracing of the nodes computed by the executor. When tracing is enabled
+ * each node dispatched, and each fused kernel, is recorded as a TraceEvent. The events
+ * can be written in the Chrome trace event format, which is read by about:tracing and
+ * Perfetto. When tracing is disabled the cost is one branch per node.
+ */
+class Tracer
+{
+  public:
+    /**
+     * Get whether tracing is enabled, the default is false.
+     * @return true if nodes are being traced.
+     */
+    static bool getEnabled()
+    {
+      return detail::trace_enabled.load(std::memory_order_relaxed);
+    }
+    /**
+     * Set whether tracing is enabled. Events already recorded are kept.
+     * @param enabled true to trace nodes computed from now on.
+     */
+    static void setEnabled(bool enabled);
+    /**
+     * Get the events recorded so far.
+     * @return the events, in the order the nodes completed.
+     */
+    static std::vector<TraceEvent> getEvents();
+    /**
+     * Discard the events recorded so far.
+     */
+    static void clear();
+    /**
+     * Write the events recorded so far as a Chrome trace, a JSON object with one
+     * complete ("X") event per node, on a track for each thread.
+     * @param out the stream to write to.
+     */
+    static void writeChromeTrace(std::ostream& out);
+    /**
+     * Write the events recorded so far as a Chrome trace to a file.
+     * @param filename the name of the file.
+     * @throws rdag_error if the file cannot be written.
+     */
+    static void writeChromeTrace(const std::string& filename);
+    /**
+     * Get the name of a type of node or terminal, as used in traces.
+     * @param type the type.
+     * @return the name, or "UNKNOWN" if the type is not known.
+     */
+    static const char * getTypeName(ExprType_t type);
+  private:
+    Tracer() = delete;
+};
+
+namespace detail {
+
+/**
+ * Records a node as it is computed. It is constructed before the node is dispatched
+ * and destroyed afterwards, when the event is recorded. Only construct one when
+ * tracing is enabled.
+ */
+class NodeTrace: private Uncopyable
+{
+  public:
+    /**
+     * Start tracing a node.
+     * @param node the node, or root of a fused kernel.
+     * @param args the arguments of the node, or the leaves of a fused kernel.
+     * @param nodes the number of nodes computed.
+     */
+    NodeTrace(const OGNumeric::Ptr& node, const std::vector<OGNumeric::Ptr>& args, size_t nodes = 1);
+    /**
+     * Record that the node was computed. An event destroyed without completing is
+     * recorded as failed.
+     */
+    void complete();
+    ~NodeTrace();
+  private:
+    OGNumeric::Ptr _node;
+    TraceEvent _event;
+};
+
+/**
+ * Record a conversion of an argument made for the node being traced on this thread.
+ * @param converted the result of the conversion.
+ */
+void traceConversion(const OGTerminal::Ptr& converted);
+
+} // end namespace detail
+
+} // end namespace librdag
+
+#endif // _TRACE_HH
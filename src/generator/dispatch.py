@@ -9,17 +9,19 @@ from dispatchtemplates import dispatch_header, dispatcher_class, dispatcher_forw
                               dispatchunaryop_class, dispatchunaryop_run, \
                               dispatchbinaryop_class, dispatchbinaryop_run, \
                               dispatcher_methods, dispatch_cc, dispatcher_member_initialiser, \
-                              dispatcher_member_deleter, dispatcher_constructor, \
-                              dispatcher_destructor, dispatcher_case, dispatcher_dispatch, \
+                              dispatcher_constructor, dispatcher_destructor, \
+                              dispatcher_case, dispatcher_dispatch, \
                               dispatcher_dispatch_numeric, dispatcher_unary_implementation, \
                               dispatcher_binary_implementation, dispatchunaryop_methods, \
                               dispatchunaryop_destructor, dispatchunaryop_eval, \
-                              dispatchunaryop_eval_case, dispatchunaryop_terminal_method, \
+                              dispatchunaryop_eval_entry, dispatchunaryop_terminal_method, \
                               dispatchbinaryop_methods, dispatchbinaryop_destructor, \
-                              dispatchbinaryop_eval, dispatchbinaryop_eval_case_arg0, \
-                              dispatchbinaryop_eval_case_arg1, dispatchbinaryop_terminal_method, \
+                              dispatchbinaryop_eval, dispatchbinaryop_eval_row, \
+                              dispatchbinaryop_eval_entry, dispatchbinaryop_terminal_method, \
                               dispatchop_class, dispatchbinaryop_conv_arg, dispatchop_methods, \
-                              dispatchbinaryop_noconv_arg, dispatcher_select_implementation
+                              dispatchbinaryop_noconv_arg, dispatcher_select_implementation, \
+                              terminal_ordinals, terminal_ordinal_case, unary_trampoline, \
+                              binary_trampoline
 
 class Dispatcher(object):
     """Generates the Dispatcher class definition and method implementations"""
@@ -53,15 +55,12 @@ class Dispatcher(object):
     def method_definitions(self):
         # Constructor/destructor
         initialisers = ''
-        deleters = ''
         for n in self._nodes:
             d = { 'nodetype': n.typename }
             initialisers += dispatcher_member_initialiser % d
-            deleters += dispatcher_member_deleter % d
         d = { 'member_initialisers': initialisers }
         constructor = dispatcher_constructor % d
-        d = { 'member_deleters': deleters }
-        destructor = dispatcher_destructor % d
+        destructor = dispatcher_destructor
         # Dispatch method
         dispatch_terminal_cases = ''
         for t in self._terminals:
@@ -98,6 +97,22 @@ class Dispatcher(object):
               'dispatcher_node_dispatches':     dispatch_exprs }
         return dispatcher_methods % d
 
+def is_complex(terminal):
+    """Whether a terminal holds complex data, of either precision."""
+    return terminal.datatype.startswith('Complex')
+
+def unary_promotion(terminal):
+    """The type a terminal is converted to when a unary runner has no method for it:
+    the cheapest type that represents it, so real data stays real. Integers become real
+    scalars, which are in turn converted to real dense matrices if need be, so a runner
+    with a method for an intermediate type is preferred to converting further. Single
+    precision matrices are widened to double."""
+    if terminal.datatype == 'Integer':
+        return 'OGRealScalar'
+    if is_complex(terminal):
+        return 'OGComplexDenseMatrix'
+    return 'OGRealDenseMatrix'
+
 class DispatchUnaryOp(object):
     """Generates the DispatchUnaryOp class definition and method implementations"""
     def __init__(self, terminals, nodes):
@@ -118,16 +133,16 @@ class DispatchUnaryOp(object):
 
     @property
     def method_definitions(self):
-        eval_cases = ''
+        eval_entries = []
         terminal_methods = ''
         for t in self._terminals:
             d = { 'nodetype': t.typename, 'nodeenumtype': t.enumname, \
-                  'typetoconvertto': 'OGComplexDenseMatrix' }
-                  # FIXME: This is the dumbest possible choice.
-            eval_cases += dispatchunaryop_eval_case % d
+                  'typetoconvertto': unary_promotion(t) }
+            eval_entries.append(dispatchunaryop_eval_entry % d)
             if t.typename not in self._backstop_terminals:
                 terminal_methods += dispatchunaryop_terminal_method % d
-        d = { 'eval_cases': eval_cases }
+        d = { 'terminal_count': len(self._terminals),
+              'eval_entries': ',\n'.join(eval_entries) }
         eval_method = dispatchunaryop_eval % d
         # DispatchUnaryOp methods
         d = { 'dispatchunaryop_destructor': dispatchunaryop_destructor,
@@ -157,13 +172,13 @@ class DispatchBinaryOp(object):
 
     @property
     def method_definitions(self):
-        eval_cases = ''
+        eval_rows = []
         terminal_methods = ''
         for t0 in self._terminals:
-            eval_arg1_cases = ''
+            eval_entries = []
             for t1 in self._terminals:
                 # Figure out which type we need to convert to
-                if 'Complex' in (t0.datatype, t1.datatype):
+                if is_complex(t0) or is_complex(t1):
                     type_to_convert_to = 'OGComplexDenseMatrix'
                 else:
                     type_to_convert_to = 'OGRealDenseMatrix'
@@ -185,13 +200,13 @@ class DispatchBinaryOp(object):
                       'node1type': t1.typename, 'node1enumtype': t1.enumname,
                       'conv0': conv0,
                       'conv1': conv1 }
-                eval_arg1_cases += dispatchbinaryop_eval_case_arg1 % d
+                eval_entries.append(dispatchbinaryop_eval_entry % d)
                 if t0.typename not in self._backstop_terminals or t0 != t1:
                     terminal_methods += dispatchbinaryop_terminal_method %d
-            d = { 'node0type': t0.typename, 'node0enumtype': t0.enumname,
-                  'eval_arg1_cases': eval_arg1_cases }
-            eval_cases += dispatchbinaryop_eval_case_arg0 % d
-        d = { 'eval_cases': eval_cases }
+            d = { 'eval_entries': ',\n'.join(eval_entries) }
+            eval_rows.append(dispatchbinaryop_eval_row % d)
+        d = { 'terminal_count': len(self._terminals),
+              'eval_rows': ',\n'.join(eval_rows) }
         eval_method = dispatchbinaryop_eval % d
         # DispatchBinaryOp methods
         d = { 'dispatchbinaryop_destructor': dispatchbinaryop_destructor,
@@ -216,9 +231,22 @@ class Dispatch(object):
               'dispatchbinary_definition': self._dispatchbinaryop.class_definition }
         return dispatch_header % d
 
+    @property
+    def terminal_ordinals(self):
+        # The position of each terminal in the dispatch tables is its position in the list
+        ordinal_cases = ''
+        for ordinal, t in enumerate(self._terminals):
+            d = { 'nodeenumtype': t.enumname, 'ordinal': ordinal }
+            ordinal_cases += terminal_ordinal_case % d
+        d = { 'ordinal_cases': ordinal_cases }
+        return terminal_ordinals % d
+
     @property
     def source(self):
-        d = { 'dispatcher_methods':       self._dispatcher.method_definitions,
+        d = { 'terminal_ordinals':        self.terminal_ordinals,
+              'unary_trampoline':         unary_trampoline,
+              'binary_trampoline':        binary_trampoline,
+              'dispatcher_methods':       self._dispatcher.method_definitions,
               'dispatchop_methods':       dispatchop_methods,
               'dispatchunaryop_methods':  self._dispatchunaryop.method_definitions,
               'dispatchbinaryop_methods': self._dispatchbinaryop.method_definitions }
@@ -58,13 +58,21 @@ dispatcher_class = """\
 %(dispatcher_forward_decls)s
 
 /**
- * The class for dispatching execution based on OGNumeric type
+ * The class for dispatching execution based on OGNumeric type. A Dispatcher holds no
+ * state of its own and its runners are shared by every Dispatcher, so one can be used
+ * by many threads at once.
  */
 class Dispatcher
 {
   public:
     Dispatcher();
     virtual ~Dispatcher();
+    /**
+     * Get the Dispatcher shared by the whole process, which avoids constructing one for
+     * each evaluation.
+     * @return the shared Dispatcher.
+     */
+    static const Dispatcher& getInstance();
     void dispatch(OGNumeric::Ptr thing) const;
 
     // Specific terminal dispatches
@@ -87,7 +95,7 @@ dispatcher_dispatch_prototype = """\
 """
 
 dispatcher_private_member = """\
-    %(nodetype)sRunner* _%(nodetype)sRunner;
+    const %(nodetype)sRunner* _%(nodetype)sRunner;
 """
 
 dispatchop_class = """\
@@ -99,8 +107,6 @@ class DispatchOp
     DispatchOp();
     virtual ~DispatchOp();
     const ConvertTo * getConvertTo() const;
-  private:
-    const ConvertTo * _convert;
 };
 """
 
@@ -167,6 +173,7 @@ dispatch_cc = """\
 #include "runners.hh"
 #include "expression.hh"
 #include "terminal.hh"
+#include "trace.hh"
 #include "warningmacros.h"
 #include "uncopyable.hh"
 #include <iostream>
@@ -176,6 +183,24 @@ using namespace std;
 
 namespace librdag {
 
+namespace detail {
+
+/**
+ * Get the runner of a type, which is shared by every Dispatcher. Runners hold no state
+ * so are safe to use from many threads. They are never destroyed, so that nodes can be
+ * dispatched on other threads while the process exits.
+ */
+template<typename R> const R * getRunner()
+{
+  static const R * const runner = new R();
+  return runner;
+}
+
+%(terminal_ordinals)s
+%(unary_trampoline)s
+%(binary_trampoline)s
+} // end namespace detail
+
 /**
  *  Dispatcher
  */
@@ -217,6 +242,14 @@ dispatcher_methods = """\
 
 %(dispatcher_destructor)s
 
+const Dispatcher&
+Dispatcher::getInstance()
+{
+  // Never destroyed, like the runners
+  static const Dispatcher * const instance = new Dispatcher();
+  return *instance;
+}
+
 %(dispatcher_dispatch)s
 
 // Specific terminal dispatches
@@ -236,17 +269,11 @@ Dispatcher::Dispatcher()
 """
 
 dispatcher_member_initialiser = """\
-  _%(nodetype)sRunner = new %(nodetype)sRunner();
-"""
-
-dispatcher_member_deleter = """\
-  delete _%(nodetype)sRunner;
+  _%(nodetype)sRunner = detail::getRunner<%(nodetype)sRunner>();
 """
 
 dispatcher_destructor = """\
-Dispatcher::~Dispatcher(){
-%(member_deleters)s\
-}
+Dispatcher::~Dispatcher() {}
 """
 
 dispatcher_dispatch_numeric = """\
@@ -343,27 +370,72 @@ dispatcher_select_implementation = """\
   this->_%(nodetype)sRunner->eval(regs, arg0r, arg1i);
 """
 
+# Dispatch tables
+
+terminal_ordinals = """\
+/**
+ * Get the position of a terminal type in the dispatch tables.
+ * @param type the type of the terminal.
+ * @return the position, or -1 if the type is not a terminal.
+ */
+static inline int getTerminalOrdinal(ExprType_t type)
+{
+  switch(type)
+  {
+%(ordinal_cases)s
+    default:
+      return -1;
+  }
+}
+"""
+
+terminal_ordinal_case = """\
+    case %(nodeenumtype)s:
+      return %(ordinal)d;
+"""
+
+unary_trampoline = """\
+/**
+ * An entry of the unary dispatch tables, which runs an op on a terminal already known
+ * to be of type A.
+ */
+template<typename T, typename A>
+T runUnary(const DispatchUnaryOp<T>& op, RegContainer& reg, const OGTerminal::Ptr& arg)
+{
+  return op.run(reg, static_pointer_cast<const A>(arg));
+}
+"""
+
+binary_trampoline = """\
+/**
+ * An entry of the binary dispatch tables, which runs an op on terminals already known
+ * to be of types A0 and A1.
+ */
+template<typename T, typename A0, typename A1>
+T runBinary(const DispatchBinaryOp<T>& op, RegContainer& reg0, const OGTerminal::Ptr& arg0,
+            const OGTerminal::Ptr& arg1)
+{
+  return op.run(reg0, static_pointer_cast<const A0>(arg0), static_pointer_cast<const A1>(arg1));
+}
+"""
+
 # DispatchOp methods
 
 dispatchop_methods = """\
 template <typename T>
-DispatchOp<T>::DispatchOp()
-{
-  _convert = new ConvertTo();
-}
+DispatchOp<T>::DispatchOp() {}
 
 template <typename T>
 const ConvertTo *
 DispatchOp<T>::getConvertTo() const
 {
-  return _convert;
+  // ConvertTo holds no state, so one is shared by every runner
+  static const ConvertTo convert;
+  return &convert;
 }
 
 template <typename T>
-DispatchOp<T>::~DispatchOp()
-{
-  delete _convert;
-}
+DispatchOp<T>::~DispatchOp() {}
 """
 
 # DispatchUnaryOp methods
@@ -386,24 +458,21 @@ template<typename T>
 T
 DispatchUnaryOp<T>::eval(RegContainer& reg, OGTerminal::Ptr arg) const
 {
-  ExprType_t argID = arg->getType();
-  T ret = nullptr;
-  switch(argID)
+  typedef T (*Run)(const DispatchUnaryOp<T>&, RegContainer&, const OGTerminal::Ptr&);
+  static constexpr Run table[%(terminal_count)d] = {
+%(eval_entries)s
+  };
+  int ordinal = detail::getTerminalOrdinal(arg->getType());
+  if (ordinal < 0)
   {
-%(eval_cases)s
-    default:
-        throw rdag_error("Unknown type in dispatch on arg");
+    throw rdag_error("Unknown type in dispatch on arg");
   }
-  return ret;
+  return table[ordinal](*this, reg, arg);
 }
 """
 
-dispatchunaryop_eval_case = """\
-    case %(nodeenumtype)s:
-      DEBUG_PRINT("running with run(reg, arg->as%(nodetype)s);\\n");
-      ret = run(reg, arg->as%(nodetype)s());
-      break;
-"""
+dispatchunaryop_eval_entry = """\
+    &detail::runUnary<T, %(nodetype)s>"""
 
 dispatchunaryop_terminal_method = """\
 template<typename T>
@@ -411,6 +480,10 @@ T
 DispatchUnaryOp<T>::run(RegContainer& reg, %(nodetype)s::Ptr arg) const
 {
   %(typetoconvertto)s::Ptr conv = this->getConvertTo()->convertTo%(typetoconvertto)s(arg);
+  if (Tracer::getEnabled())
+  {
+    detail::traceConversion(conv);
+  }
   T ret = run(reg, conv);
   return ret;
 }
@@ -436,41 +509,35 @@ template <typename T>
 T
 DispatchBinaryOp<T>::eval(RegContainer& reg0, OGTerminal::Ptr arg0, OGTerminal::Ptr arg1) const
 {
-  ExprType_t arg0ID = arg0->getType();
-  ExprType_t arg1ID = arg1->getType();
-  T ret = nullptr;
-  // MASSIVE SWITCH TABLE
-  switch(arg0ID)
+  typedef T (*Run)(const DispatchBinaryOp<T>&, RegContainer&, const OGTerminal::Ptr&, const OGTerminal::Ptr&);
+  static constexpr Run table[%(terminal_count)d][%(terminal_count)d] = {
+%(eval_rows)s
+  };
+  int ordinal0 = detail::getTerminalOrdinal(arg0->getType());
+  if (ordinal0 < 0)
   {
-%(eval_cases)s
-    default:
-        stringstream message;
-        message << "Unknown type in dispatch on arg0. Type is: " << arg0->getType() << ".";
-        throw rdag_error(message.str());
+    stringstream message;
+    message << "Unknown type in dispatch on arg0. Type is: " << arg0->getType() << ".";
+    throw rdag_error(message.str());
   }
-  return ret;
+  int ordinal1 = detail::getTerminalOrdinal(arg1->getType());
+  if (ordinal1 < 0)
+  {
+    stringstream message;
+    message << "Unknown type in dispatch on arg1. Type is: " << arg1->getType() << ".";
+    throw rdag_error(message.str());
+  }
+  return table[ordinal0][ordinal1](*this, reg0, arg0, arg1);
 }
 """
 
-dispatchbinaryop_eval_case_arg0 = """\
-    case %(node0enumtype)s:
-      switch(arg1ID)
-      {
-%(eval_arg1_cases)s
-        default:
-        stringstream message;
-        message << "Unknown type in dispatch on arg1. Type is: " << arg1->getType() << ".";
-        throw rdag_error(message.str());
-      }
-      break;
-"""
+dispatchbinaryop_eval_row = """\
+    {
+%(eval_entries)s
+    }"""
 
-dispatchbinaryop_eval_case_arg1 = """\
-        case %(node1enumtype)s:
-          DEBUG_PRINT("running with run(reg0, arg0->as%(node0type)s(), arg1->as%(node1type)s());\\n");
-          ret = run(reg0, arg0->as%(node0type)s(), arg1->as%(node1type)s());
-          break;
-"""
+dispatchbinaryop_eval_entry = """\
+      &detail::runBinary<T, %(node0type)s, %(node1type)s>"""
 
 dispatchbinaryop_terminal_method = """\
 template<typename T>
@@ -488,6 +555,10 @@ DispatchBinaryOp<T>::run(RegContainer& reg0,
 
 dispatchbinaryop_conv_arg = """\
   %(typetoconvertto)s::Ptr conv%(argno)s = this->getConvertTo()->convertTo%(typetoconvertto)s(arg%(argno)s);
+  if (Tracer::getEnabled())
+  {
+    detail::traceConversion(conv%(argno)s);
+  }
 """
 
 dispatchbinaryop_noconv_arg = """\
@@ -44,6 +44,13 @@ class ExprEnums(object):
             p = p + 1
         return ',\n'.join(enums);
 
+    @property
+    def names(self):
+        names = []
+        for node in self.nodes:
+            names.append('{ %s, "%s" }' % (node.enumname, node.typename))
+        return ',\n'.join(names)
+
     @property
     def java(self):
         enums = []
@@ -9,7 +9,8 @@ from exprtemplates import expression_hh, expr_class, expression_cc, expr_methods
                           numeric_cc, numeric_method, unary_constructor, \
                           binary_constructor, unary_copy_method, binary_copy_method, \
                           unary_ctor_method, binary_ctor_method, unary_factory, \
-                          binary_factory, unary_factory_method, binary_factory_method
+                          binary_factory, unary_factory_method, binary_factory_method, \
+                          unary_withargs_method, binary_withargs_method
 
 class Expressions(object):
     def __init__(self, nodes):
@@ -43,13 +44,16 @@ class Expressions(object):
             d = { 'classname': node.typename, 'parentclass': node.parentclass }
             if node.argcount == 1:
                 copy_method = unary_copy_method % d
+                withargs_method = unary_withargs_method % d
                 ctor_method = unary_ctor_method % d
                 factory_method = unary_factory_method % d
             else: # 2 or -1 (selectresult) - is binary in either case
                 copy_method = binary_copy_method % d
+                withargs_method = binary_withargs_method % d
                 ctor_method = binary_ctor_method % d
                 factory_method = binary_factory_method % d
             d['copy_method'] = copy_method
+            d['withargs_method'] = withargs_method
             d['ctor_method'] = ctor_method
             d['factory_method'] = factory_method
             methods += expr_methods % d
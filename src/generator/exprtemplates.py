@@ -49,6 +49,7 @@ class %(classname)s: public %(parentclass)s
     typedef std::shared_ptr<const %(classname)s> Ptr;
 %(factory)s
     virtual OGNumeric::Ptr copy() const override;
+    virtual OGExpr::Ptr withArgs(const ArgContainer& args) const override;
     virtual %(classname)s::Ptr as%(classname)s() const override;
     virtual void debug_print() const override;
     virtual ExprType_t getType() const override;
@@ -113,6 +114,12 @@ OGNumeric::Ptr
 %(copy_method)s
 }
 
+OGExpr::Ptr
+%(classname)s::withArgs(const ArgContainer& args) const
+{
+%(withargs_method)s
+}
+
 %(classname)s::Ptr
 %(classname)s::as%(classname)s() const
 {
@@ -158,6 +165,20 @@ unary_copy_method = """\
 binary_copy_method = """\
   return OGNumeric::Ptr{new %(classname)s(_args[0]->copy(), _args[1]->copy())};"""
 
+unary_withargs_method = """\
+  if (args.size() != 1)
+  {
+    throw rdag_error("%(classname)s requires 1 argument");
+  }
+  return %(classname)s::create(args[0]);"""
+
+binary_withargs_method = """\
+  if (args.size() != 2)
+  {
+    throw rdag_error("%(classname)s requires 2 arguments");
+  }
+  return %(classname)s::create(args[0], args[1]);"""
+
 # Numeric header file
 
 numeric_hh = """\
@@ -187,6 +208,10 @@ class OGComplexScalar;
 class OGIntegerScalar;
 class OGRealDenseMatrix;
 class OGComplexDenseMatrix;
+class OGRealSingleDenseMatrix;
+class OGComplexSingleDenseMatrix;
+class OGRealTransposedMatrix;
+class OGComplexTransposedMatrix;
 class OGLogicalMatrix;
 class OGRealDiagonalMatrix;
 class OGComplexDiagonalMatrix;
@@ -237,6 +262,10 @@ class OGNumeric: private Uncopyable, public std::enable_shared_from_this<OGNumer
     virtual std::shared_ptr<const OGIntegerScalar> asOGIntegerScalar() const;
     virtual std::shared_ptr<const OGRealDenseMatrix> asOGRealDenseMatrix() const;
     virtual std::shared_ptr<const OGComplexDenseMatrix> asOGComplexDenseMatrix() const;
+    virtual std::shared_ptr<const OGRealSingleDenseMatrix> asOGRealSingleDenseMatrix() const;
+    virtual std::shared_ptr<const OGComplexSingleDenseMatrix> asOGComplexSingleDenseMatrix() const;
+    virtual std::shared_ptr<const OGRealTransposedMatrix> asOGRealTransposedMatrix() const;
+    virtual std::shared_ptr<const OGComplexTransposedMatrix> asOGComplexTransposedMatrix() const;
     virtual std::shared_ptr<const OGLogicalMatrix> asOGLogicalMatrix() const;
     virtual std::shared_ptr<const OGRealDiagonalMatrix> asOGRealDiagonalMatrix() const;
     virtual std::shared_ptr<const OGComplexDiagonalMatrix> asOGComplexDiagonalMatrix() const;
@@ -39,7 +39,7 @@ class Terminal(Numeric):
     """A terminal is a numeric. It also has a datatype and a storage type."""
     def __init__(self, datatype, storagetype):
         typename = "OG%s%s" % (datatype, storagetype)
-        enumname = '%s_%s_ENUM' % (datatype.upper(), camel2underscore(storagetype).upper())
+        enumname = '%s_%s_ENUM' % (camel2underscore(datatype).upper(), camel2underscore(storagetype).upper())
         super(Terminal, self).__init__(typename, enumname)
         self._datatype = datatype
         self._storagetype = storagetype
@@ -9,7 +9,8 @@
 from dispatch import Dispatch
 from runners import Runners, Runners, InfixOpRunner, PrefixOpRunner, UnaryFunctionRunner, \
                     UnimplementedUnary, UnimplementedBinary, UnaryExpressionRunner, \
-                    SelectResultRunner, BinaryExpression, BinaryExpressionRunner
+                    SelectResultRunner, BinaryExpression, BinaryExpressionRunner, \
+                    mtimes_overloads, mldivide_overloads, diagonal_unary_overloads
 from exprtree import Terminal
 from expression import Expressions, Numeric
 from enums import ExprEnums
@@ -23,8 +24,8 @@ nodes = [ UnimplementedUnary ('ABS'),
           UnimplementedUnary ('ACOSH'),
           UnimplementedUnary ('ANGLE'),
           UnimplementedUnary ('ASIN'),
-          UnaryFunctionRunner('ASINH', 'ASINH_ENUM', 'asinh'),
-          UnaryFunctionRunner('ATAN', 'ATAN_ENUM', 'atan'),
+          UnaryFunctionRunner('ASINH', 'ASINH_ENUM', 'asinh', zero_preserving=True),
+          UnaryFunctionRunner('ATAN', 'ATAN_ENUM', 'atan', zero_preserving=True),
           UnimplementedUnary ('ATANH'),
           UnimplementedUnary ('CONJ'),
           UnaryFunctionRunner('COS', 'COS_ENUM', 'cos'),
@@ -44,18 +45,18 @@ nodes = [ UnimplementedUnary ('ABS'),
           UnimplementedUnary ('INVHILB'),
           UnimplementedUnary ('LOG'),
           InfixOpRunner      ('MINUS', 'MINUS_ENUM', '-', 'sub','subx','xsub'),
-          PrefixOpRunner     ('NEGATE', 'NEGATE_ENUM', '-'),
+          PrefixOpRunner     ('NEGATE', 'NEGATE_ENUM', '-', zero_preserving=True),
           UnimplementedUnary ('NORMCDF'),
           UnimplementedBinary('POWER'),
           InfixOpRunner      ('PLUS', 'PLUS_ENUM', '+', 'add','addx','addx'),
           InfixOpRunner      ('RDIVIDE', 'RDIVIDE_ENUM', '/', 'div','divx','xdiv'),
           UnimplementedUnary ('REAL'),
           UnimplementedUnary ('ROUND'),
-          UnaryFunctionRunner('SIN', 'SIN_ENUM', 'sin'),
-          UnaryFunctionRunner('SINH', 'SINH_ENUM', 'sinh'),
+          UnaryFunctionRunner('SIN', 'SIN_ENUM', 'sin', zero_preserving=True),
+          UnaryFunctionRunner('SINH', 'SINH_ENUM', 'sinh', zero_preserving=True),
           UnimplementedUnary ('SQRT'),
-          UnaryFunctionRunner('TAN', 'TAN_ENUM', 'tan'),
-          UnaryFunctionRunner('TANH', 'TANH_ENUM', 'tanh'),
+          UnaryFunctionRunner('TAN', 'TAN_ENUM', 'tan', zero_preserving=True),
+          UnaryFunctionRunner('TANH', 'TANH_ENUM', 'tanh', zero_preserving=True),
           InfixOpRunner      ('TIMES', 'TIMES_ENUM', '*', 'mul','mulx','mulx'),
           UnimplementedBinary('VERTCAT'),
           UnimplementedUnary ('WILKINSON')
@@ -64,28 +65,40 @@ nodes = [ UnimplementedUnary ('ABS'),
 # The list of nodes to generate headers and wiring for, but not the implementations
 custom_nodes = [
                 UnaryExpressionRunner('NORM2', 'NORM2_ENUM'),
-                UnaryExpressionRunner('PINV', 'PINV_ENUM'),
-                UnaryExpressionRunner('INV', 'INV_ENUM'),
+                UnaryExpressionRunner('PINV', 'PINV_ENUM', diagonal_unary_overloads),
+                UnaryExpressionRunner('INV', 'INV_ENUM', diagonal_unary_overloads),
                 UnaryExpressionRunner('SVD', 'SVD_ENUM'),
                 SelectResultRunner('SELECTRESULT', 'SELECTRESULT_ENUM'),
-                BinaryExpressionRunner('MTIMES','MTIMES_ENUM'),
+                BinaryExpressionRunner('MTIMES','MTIMES_ENUM', mtimes_overloads),
                 UnaryExpressionRunner('TRANSPOSE','TRANSPOSE_ENUM'),
                 UnaryExpressionRunner('CTRANSPOSE','CTRANSPOSE_ENUM'),
                 UnaryExpressionRunner('LU','LU_ENUM'),
-                BinaryExpressionRunner('MLDIVIDE','MLDIVIDE_ENUM'),
+                BinaryExpressionRunner('MLDIVIDE','MLDIVIDE_ENUM', mldivide_overloads),
                ]
 
+# The list of terminals with a Java counterpart
+java_terminals = [ Terminal('Real', 'Scalar'),
+                   Terminal('Complex', 'Scalar'),
+                   Terminal('Integer', 'Scalar'),
+                   Terminal('Real', 'DenseMatrix'),
+                   Terminal('Logical', 'Matrix'),
+                   Terminal('Complex', 'DenseMatrix'),
+                   Terminal('Real', 'DiagonalMatrix'),
+                   Terminal('Complex', 'DiagonalMatrix'),
+                   Terminal('Real', 'SparseMatrix'),
+                   Terminal('Complex', 'SparseMatrix') ]
+
+# The single precision terminals, which are created natively only
+single_terminals = [ Terminal('RealSingle', 'DenseMatrix'),
+                     Terminal('ComplexSingle', 'DenseMatrix') ]
+
+# The transposed views of dense matrices, which are created by the TRANSPOSE and
+# CTRANSPOSE runners only
+view_terminals = [ Terminal('Real', 'TransposedMatrix'),
+                   Terminal('Complex', 'TransposedMatrix') ]
+
 # The list of terminals
-terminals = [ Terminal('Real', 'Scalar'),
-              Terminal('Complex', 'Scalar'),
-              Terminal('Integer', 'Scalar'),
-              Terminal('Real', 'DenseMatrix'),
-              Terminal('Logical', 'Matrix'),
-              Terminal('Complex', 'DenseMatrix'),
-              Terminal('Real', 'DiagonalMatrix'),
-              Terminal('Complex', 'DiagonalMatrix'),
-              Terminal('Real', 'SparseMatrix'),
-              Terminal('Complex', 'SparseMatrix') ]
+terminals = java_terminals + single_terminals + view_terminals
 
 def get_parser():
     """Creates a suitable parser for the options to the generator."""
@@ -103,6 +116,7 @@ def get_parser():
     action.add_argument('--numeric-cc', action='store_true', help='Generate numeric.cc')
     action.add_argument('--exprenum-hh', action='store_true', help='Generate exprenum.hh')
     action.add_argument('--exprenum-java', action='store_true', help='Generate ExprTypeEnum.java')
+    action.add_argument('--exprnames-hh', action='store_true', help='Generate exprnames.hh')
     action.add_argument('--createexpr-cc', action='store_true', help='Generate createexpr.cc')
     return parser
 
@@ -129,8 +143,10 @@ def main(args):
             code = ExprEnums(nodes).code
         elif args.exprenum_java:
             code = ExprEnums(nodes).java
+        elif args.exprnames_hh:
+            code = ExprEnums(terminals + nodes + custom_nodes).names
         elif args.createexpr_cc:
-            code = CreateExpressions(terminals + nodes + custom_nodes).source
+            code = CreateExpressions(java_terminals + nodes + custom_nodes).source
         f.writelines(code)
 
 if __name__ == '__main__':
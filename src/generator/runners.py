@@ -1,6 +1,7 @@
 from runnertemplates import runners_header, runners_cc, binary_runner_class_definition, \
                             binary_runner_function, infix_scalar_runner_implementation, \
                             infix_matrix_runner_implementation,                         \
+                            infix_scalar_matrix_runner_implementation, \
                             unary_runner_class_definition, unary_runner_function,       \
                             prefix_scalar_runner_implementation, \
                             prefix_matrix_runner_implementation, \
@@ -8,19 +9,149 @@ from runnertemplates import runners_header, runners_cc, binary_runner_class_defi
                             unaryfunction_matrix_runner_implementation, \
                             unimplementedunary_runner_function, \
                             unimplementedbinary_runner_function, \
-                            integer_parameter_runner_class_definition
+                            integer_parameter_runner_class_definition, \
+                            binary_runner_extra_run, unary_runner_extra_run, \
+                            kernel_runner_implementation, \
+                            prefix_structured_runner_implementation, \
+                            unaryfunction_structured_runner_implementation, \
+                            diagonal_runner_create, sparse_runner_create
 from exprtree import UnaryExpression, BinaryExpression
 from jinja2 import Environment, DictLoader
 
+def typed_overloads(kinds):
+    """The real and complex terminal types of pairs of storage kinds, e.g.
+    ('Sparse', 'Dense') gives OGRealSparseMatrix with OGRealDenseMatrix and
+    OGComplexSparseMatrix with OGComplexDenseMatrix."""
+    storage = { 'Scalar': 'Scalar', 'Dense': 'DenseMatrix', 'Sparse': 'SparseMatrix',
+                'Diagonal': 'DiagonalMatrix', 'Transposed': 'TransposedMatrix' }
+    overloads = []
+    for datatype in ('Real', 'Complex'):
+        for kind0, kind1 in kinds:
+            overloads.append(('OG%s%s' % (datatype, storage[kind0]),
+                              'OG%s%s' % (datatype, storage[kind1])))
+    return overloads
+
+# The sparse.hh and diagonal.hh kernels called by the infix runners, by symbol, as pairs
+# of storage kinds and the call to make. Other pairs involving sparse or diagonal
+# matrices are converted to dense.
+infix_kernels = {
+    '+': [ (('Sparse', 'Sparse'), 'sparse::plus(*arg0, *arg1, false)'),
+           (('Diagonal', 'Diagonal'), 'diagonal::plus(*arg0, *arg1, false)') ],
+    '-': [ (('Sparse', 'Sparse'), 'sparse::plus(*arg0, *arg1, true)'),
+           (('Diagonal', 'Diagonal'), 'diagonal::plus(*arg0, *arg1, true)') ],
+    '*': [ (('Sparse', 'Sparse'), 'sparse::times(*arg0, *arg1)'),
+           (('Sparse', 'Dense'),  'sparse::times(*arg0, *arg1)'),
+           (('Dense',  'Sparse'), 'sparse::times(*arg1, *arg0)'),
+           (('Sparse', 'Scalar'), 'sparse::scale(*arg0, arg1->getValue())'),
+           (('Scalar', 'Sparse'), 'sparse::scale(*arg1, arg0->getValue())') ]
+}
+
+# The pairs of real and complex dense matrices, which the infix runners and MTIMES
+# compute without promoting the real argument to a complex copy
+mixed_dense_overloads = [ ('OGRealDenseMatrix', 'OGComplexDenseMatrix'),
+                          ('OGComplexDenseMatrix', 'OGRealDenseMatrix') ]
+
+# The pairs of single precision dense matrices, which the infix runners and MTIMES
+# compute in single precision. Every other pair involving one is widened to double by
+# the dispatcher.
+single_dense_overloads = [ ('OGRealSingleDenseMatrix', 'OGRealSingleDenseMatrix'),
+                           ('OGComplexSingleDenseMatrix', 'OGComplexSingleDenseMatrix') ]
+single_datatypes = { 'OGRealSingleDenseMatrix': 'real4', 'OGComplexSingleDenseMatrix': 'complex8' }
+
+# The data types the scalar and dense matrix terminals are computed in, integers being
+# computed as reals
+scalar_datatypes = { 'OGRealScalar': 'real8', 'OGComplexScalar': 'complex16',
+                     'OGIntegerScalar': 'real8' }
+dense_datatypes = { 'OGRealDenseMatrix': 'real8', 'OGComplexDenseMatrix': 'complex16' }
+
+def scalar_value(argtype, argno):
+    """The expression for the value of scalar argument argno, of its data type."""
+    if argtype == 'OGIntegerScalar':
+        return 'static_cast<real8>(arg%s->getValue())' % argno
+    return 'arg%s->getValue()' % argno
+
+def result_datatype(arg0type, arg1type):
+    """The data type of the result of an elementwise operation, complex if either
+    argument is."""
+    datatypes = dict(scalar_datatypes, **dense_datatypes)
+    if 'complex16' in (datatypes[arg0type], datatypes[arg1type]):
+        return 'complex16'
+    return 'real8'
+
+# The pairs involving a scalar for which the infix runners and MTIMES compute directly,
+# rather than having the scalar converted to a 1x1 dense matrix: every pair of scalars
+# bar the real one, which has a runner anyway, and every scalar with a dense matrix.
+scalar_scalar_overloads = [ (t0, t1) for t0 in sorted(scalar_datatypes)
+                                     for t1 in sorted(scalar_datatypes)
+                                     if (t0, t1) != ('OGRealScalar', 'OGRealScalar') ]
+scalar_dense_overloads = [ (s, m) for s in sorted(scalar_datatypes) for m in sorted(dense_datatypes) ] + \
+                         [ (m, s) for s in sorted(scalar_datatypes) for m in sorted(dense_datatypes) ]
+scalar_overloads = scalar_scalar_overloads + scalar_dense_overloads
+
+# The pairs for which MTIMES has sparse, diagonal, mixed dense, scalar, single
+# precision and transposed view runners, implemented in mtimesrunner.cc
+mtimes_overloads = mixed_dense_overloads + scalar_overloads + single_dense_overloads + typed_overloads([ ('Sparse', 'Sparse'), ('Sparse', 'Dense'),
+                                     ('Dense', 'Sparse'), ('Sparse', 'Scalar'),
+                                     ('Scalar', 'Sparse'), ('Diagonal', 'Diagonal'),
+                                     ('Diagonal', 'Dense'), ('Dense', 'Diagonal'),
+                                     ('Diagonal', 'Scalar'), ('Scalar', 'Diagonal'),
+                                     ('Transposed', 'Dense'), ('Dense', 'Transposed'),
+                                     ('Transposed', 'Transposed') ])
+
+# The pairs for which MLDIVIDE has diagonal and transposed view runners, implemented in
+# mldividerunner.cc
+mldivide_overloads = typed_overloads([ ('Diagonal', 'Dense'), ('Transposed', 'Dense') ])
+
+# The argument types for which INV and PINV have diagonal runners, implemented in
+# invrunner.cc and pinvrunner.cc
+diagonal_unary_overloads = [ 'OGRealDiagonalMatrix', 'OGComplexDiagonalMatrix' ]
+
+# The diagonal and sparse argument types of the runners of zero preserving unary
+# functions, with their data types and the template creating the result
+structured_unary_types = [ ('OGRealDiagonalMatrix', 'real8', diagonal_runner_create),
+                           ('OGComplexDiagonalMatrix', 'complex16', diagonal_runner_create),
+                           ('OGRealSparseMatrix', 'real8', sparse_runner_create),
+                           ('OGComplexSparseMatrix', 'complex16', sparse_runner_create) ]
+
 class UnaryExpressionRunner(UnaryExpression):
-    """For generating the runner code for a UnaryExpression."""
-    def __init__(self, nodename, enumname):
+    """For generating the runner code for a UnaryExpression. Runners for argument types
+    beyond the real scalar and dense matrices may be declared in extra_overloads, as
+    terminal type names, and are implemented by hand."""
+    def __init__(self, nodename, enumname, extra_overloads=()):
         super(UnaryExpressionRunner, self).__init__(nodename, enumname)
         self._class_definition_template = unary_runner_class_definition
+        self._extra_overloads = extra_overloads
 
     @property
     def class_definition(self):
-        return self._class_definition_template % { 'nodename': self.typename }
+        extra_runs = ''
+        for argtype in self._extra_overloads:
+            extra_runs += unary_runner_extra_run % { 'argtype': argtype }
+        return self._class_definition_template % { 'nodename': self.typename,
+                                                   'extra_runs': extra_runs }
+
+    @property
+    def zero_preserving(self):
+        """Whether the function maps zero to zero, so that it need only be applied to the
+        stored entries of diagonal and sparse matrices."""
+        return False
+
+    @property
+    def extra_runner_functions(self):
+        """Implementations of the extra overloads. Those of zero preserving functions are
+        generated from structured_implementation, others are implemented by hand."""
+        if not self.zero_preserving:
+            return ''
+        functions = ''
+        for argtype, datatype, create in structured_unary_types:
+            implementation = self.structured_implementation(datatype)
+            implementation += create % { 'returntype': argtype }
+            d = { 'implementation': implementation,
+                  'nodename': self.typename,
+                  'argtype': argtype,
+                  'returntype': argtype }
+            functions += unary_runner_function % d
+        return functions
 
     @property
     def scalar_runner_function(self):
@@ -50,14 +181,30 @@ class UnaryExpressionRunner(UnaryExpression):
         return unary_runner_function % d
 
 class BinaryExpressionRunner(BinaryExpression):
-    """A BinaryFunction is for a node that takes two arguments."""
-    def __init__(self, nodename, enumname):
+    """A BinaryFunction is for a node that takes two arguments. Runners for pairs of
+    argument types beyond the real scalar and dense matrix pairs may be declared in
+    extra_overloads, as pairs of terminal type names."""
+    def __init__(self, nodename, enumname, extra_overloads=()):
         super(BinaryExpressionRunner, self).__init__(nodename, enumname)
         self._class_definition_template = binary_runner_class_definition
+        self._extra_overloads = extra_overloads
+
+    @property
+    def extra_overloads(self):
+        return self._extra_overloads
 
     @property
     def class_definition(self):
-        return self._class_definition_template % { 'nodename': self.typename }
+        extra_runs = ''
+        for arg0type, arg1type in self.extra_overloads:
+            extra_runs += binary_runner_extra_run % { 'arg0type': arg0type, 'arg1type': arg1type }
+        return self._class_definition_template % { 'nodename': self.typename,
+                                                   'extra_runs': extra_runs }
+
+    @property
+    def extra_runner_functions(self):
+        """Implementations of the extra overloads, empty for those implemented by hand."""
+        return ''
 
     @property
     def scalar_runner_function(self):
@@ -147,12 +294,20 @@ class InfixOpRunner(BinaryExpressionRunner):
     """An InfixOp is a BinaryExpression that has a particular symbol that is
     placed infix in its two arguments in the generated code."""
     def __init__(self, nodename, enumname, symbol, izysymbol_vv, izysymbol_vs, izysymbol_sv):
-        super(InfixOpRunner, self).__init__(nodename, enumname)
+        self._kernels = []
+        for kinds, call in infix_kernels.get(symbol, []):
+            for overload in typed_overloads([kinds]):
+                self._kernels.append((overload, call))
+        super(InfixOpRunner, self).__init__(nodename, enumname,
+                                            [ overload for overload, call in self._kernels ] +
+                                            mixed_dense_overloads + scalar_overloads +
+                                            single_dense_overloads)
         self._symbol = symbol
         self._izysymbol_vv = izysymbol_vv
         self._izysymbol_vs = izysymbol_vs
         self._izysymbol_sv = izysymbol_sv
-        self._env = Environment(loader=DictLoader({'infix_matrix_runner_implementation': infix_matrix_runner_implementation}))
+        self._env = Environment(loader=DictLoader({'infix_matrix_runner_implementation': infix_matrix_runner_implementation,
+                                                   'infix_scalar_matrix_runner_implementation': infix_scalar_matrix_runner_implementation}))
 
     @property
     def env(self):
@@ -176,16 +331,48 @@ class InfixOpRunner(BinaryExpressionRunner):
 
     @property
     def scalar_implementation(self):
+        return self.scalar_scalar_implementation('OGRealScalar', 'OGRealScalar')
+
+    def scalar_scalar_implementation(self, arg0type, arg1type):
+        returntypes = { 'real8': 'OGRealScalar', 'complex16': 'OGComplexScalar' }
         d = { 'symbol':     self.symbol,
-              'returntype': 'OGRealScalar' }
+              'value0':     scalar_value(arg0type, '0'),
+              'value1':     scalar_value(arg1type, '1'),
+              'returntype': returntypes[result_datatype(arg0type, arg1type)] }
         return infix_scalar_runner_implementation % d
 
+    def scalar_matrix_implementation(self, arg0type, arg1type):
+        returntypes = { 'real8': 'OGRealDenseMatrix', 'complex16': 'OGComplexDenseMatrix' }
+        scalararg = '0' if arg0type in scalar_datatypes else '1'
+        matrixarg = '1' if scalararg == '0' else '0'
+        scalartype = arg0type if scalararg == '0' else arg1type
+        matrixtype = arg1type if scalararg == '0' else arg0type
+        datatype = result_datatype(arg0type, arg1type)
+        # izy computes in the data type of the matrix, and takes the scalar first only
+        # when the operation does not commute
+        izysymbol = None
+        if scalar_datatypes[scalartype] == dense_datatypes[matrixtype]:
+            izysymbol = self.izysymbol_sv if scalararg == '0' else self.izysymbol_vs
+        d = { 'symbol':         self.symbol,
+              'izysymbol':      izysymbol,
+              'scalarfirst':    scalararg == '0' and self.izysymbol_sv != self.izysymbol_vs,
+              'scalararg':      scalararg,
+              'matrixarg':      matrixarg,
+              'scalarvalue':    scalar_value(scalartype, scalararg),
+              'scalardatatype': scalar_datatypes[scalartype],
+              'matrixdatatype': dense_datatypes[matrixtype],
+              'datatype':       datatype,
+              'returntype':     returntypes[datatype] }
+        template = self.env.get_template('infix_scalar_matrix_runner_implementation');
+        return template.render(d);
+
     @property
     def real_matrix_implementation(self):
         d = { 'symbol':     self.symbol,
               'izysymbol_vv':     self.izysymbol_vv,
               'izysymbol_vs':     self.izysymbol_vs,
               'izysymbol_sv':     self.izysymbol_sv,
+              'loop':       False,
               'datatype':   'real8',
               'returntype': 'OGRealDenseMatrix' }
         template = self.env.get_template('infix_matrix_runner_implementation');
@@ -197,23 +384,97 @@ class InfixOpRunner(BinaryExpressionRunner):
               'izysymbol_vv':     self.izysymbol_vv,
               'izysymbol_vs':     self.izysymbol_vs,
               'izysymbol_sv':     self.izysymbol_sv,
+              'loop':       False,
+              'datatype':   'complex16',
+              'returntype': 'OGComplexDenseMatrix' }
+        template = self.env.get_template('infix_matrix_runner_implementation');
+        return template.render(d);
+
+    def mixed_matrix_implementation(self, arg0type, arg1type):
+        datatypes = { 'OGRealDenseMatrix': 'real8', 'OGComplexDenseMatrix': 'complex16' }
+        d = { 'symbol':     self.symbol,
+              'loop':       True,
+              'loopcomment': 'Real and complex arguments, the real one is read in place rather than promoted',
+              'datatype0':  datatypes[arg0type],
+              'datatype1':  datatypes[arg1type],
               'datatype':   'complex16',
               'returntype': 'OGComplexDenseMatrix' }
         template = self.env.get_template('infix_matrix_runner_implementation');
         return template.render(d);
 
+    def single_matrix_implementation(self, argtype):
+        """izy computes in double precision only, so single precision is computed in a loop
+        the compiler can vectorise at twice the width."""
+        datatype = single_datatypes[argtype]
+        d = { 'symbol':     self.symbol,
+              'loop':       True,
+              'loopcomment': 'Single precision arguments, computed without widening',
+              'datatype0':  datatype,
+              'datatype1':  datatype,
+              'datatype':   datatype,
+              'returntype': argtype }
+        template = self.env.get_template('infix_matrix_runner_implementation');
+        return template.render(d);
+
+    @property
+    def extra_runner_functions(self):
+        functions = ''
+        for arg0type, arg1type in single_dense_overloads:
+            d = { 'implementation': self.single_matrix_implementation(arg0type),
+                  'nodename': self.typename,
+                  'arg0type': arg0type,
+                  'arg1type': arg1type }
+            functions += binary_runner_function % d
+        for arg0type, arg1type in mixed_dense_overloads:
+            d = { 'implementation': self.mixed_matrix_implementation(arg0type, arg1type),
+                  'nodename': self.typename,
+                  'arg0type': arg0type,
+                  'arg1type': arg1type }
+            functions += binary_runner_function % d
+        for arg0type, arg1type in scalar_scalar_overloads:
+            d = { 'implementation': self.scalar_scalar_implementation(arg0type, arg1type),
+                  'nodename': self.typename,
+                  'arg0type': arg0type,
+                  'arg1type': arg1type }
+            functions += binary_runner_function % d
+        for arg0type, arg1type in scalar_dense_overloads:
+            d = { 'implementation': self.scalar_matrix_implementation(arg0type, arg1type),
+                  'nodename': self.typename,
+                  'arg0type': arg0type,
+                  'arg1type': arg1type }
+            functions += binary_runner_function % d
+        for (arg0type, arg1type), call in self._kernels:
+            d = { 'implementation': kernel_runner_implementation % { 'call': call },
+                  'nodename': self.typename,
+                  'arg0type': arg0type,
+                  'arg1type': arg1type }
+            functions += binary_runner_function % d
+        return functions
+
 
 class PrefixOpRunner(UnaryExpressionRunner):
     """A PrefixOp is a UnaryFunction whose symbol is placed just before its
-    argument in the code."""
-    def __init__(self, nodename, enumname, symbol):
-        super(PrefixOpRunner, self).__init__(nodename, enumname)
+    argument in the code. If zero_preserving, see UnaryExpressionRunner, it also has
+    runners for diagonal and sparse matrices."""
+    def __init__(self, nodename, enumname, symbol, zero_preserving=False):
+        extra_overloads = [ t[0] for t in structured_unary_types ] if zero_preserving else ()
+        super(PrefixOpRunner, self).__init__(nodename, enumname, extra_overloads)
         self._symbol = symbol
+        self._zero_preserving = zero_preserving
 
     @property
     def symbol(self):
         return self._symbol
 
+    @property
+    def zero_preserving(self):
+        return self._zero_preserving
+
+    def structured_implementation(self, datatype):
+        d = { 'symbol':   self.symbol,
+              'datatype': datatype }
+        return prefix_structured_runner_implementation % d
+
     @property
     def scalar_implementation(self):
         d = { 'symbol':     self.symbol,
@@ -236,16 +497,28 @@ class PrefixOpRunner(UnaryExpressionRunner):
 
 class UnaryFunctionRunner(UnaryExpressionRunner):
     """A UnaryFunction is one that is implemented with a call to a function
-    that takes a single argument (e.g. cos, sin, etc)."""
+    that takes a single argument (e.g. cos, sin, etc). If zero_preserving, see
+    UnaryExpressionRunner, it also has runners for diagonal and sparse matrices."""
 
-    def __init__(self, nodename, enumname, function):
-        super(UnaryFunctionRunner, self).__init__(nodename, enumname)
+    def __init__(self, nodename, enumname, function, zero_preserving=False):
+        extra_overloads = [ t[0] for t in structured_unary_types ] if zero_preserving else ()
+        super(UnaryFunctionRunner, self).__init__(nodename, enumname, extra_overloads)
         self._function = function
+        self._zero_preserving = zero_preserving
 
     @property
     def function(self):
         return self._function
 
+    @property
+    def zero_preserving(self):
+        return self._zero_preserving
+
+    def structured_implementation(self, datatype):
+        d = { 'function': self.function,
+              'datatype': datatype }
+        return unaryfunction_structured_runner_implementation % d
+
     @property
     def scalar_implementation(self):
         d = { 'function': self.function,
@@ -345,5 +618,7 @@ class Runners(object):
             function_definitions += node.scalar_runner_function
             function_definitions += node.real_matrix_runner_function
             function_definitions += node.complex_matrix_runner_function
+            if isinstance(node, (UnaryExpressionRunner, BinaryExpressionRunner)):
+                function_definitions += node.extra_runner_functions
         d = { 'function_definitions': function_definitions }
         return runners_cc % d
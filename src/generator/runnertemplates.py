@@ -45,6 +45,10 @@ runners_cc = """\
 #include "terminal.hh"
 #include "uncopyable.hh"
 #include "izy.hh"
+#include "sparse.hh"
+#include "diagonal.hh"
+
+#include <algorithm>
 
 using namespace std;
 
@@ -63,8 +67,12 @@ class %(nodename)sRunner: public DispatchVoidBinaryOp, private Uncopyable
     virtual void * run(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const override;
     virtual void * run(RegContainer& reg0, OGRealDenseMatrix::Ptr    arg0, OGRealDenseMatrix::Ptr    arg1) const override;
     virtual void * run(RegContainer& reg0, OGRealScalar::Ptr    arg0, OGRealScalar::Ptr    arg1) const override;
-};
+%(extra_runs)s};
+
+"""
 
+binary_runner_extra_run = """\
+    virtual void * run(RegContainer& reg0, %(arg0type)s::Ptr arg0, %(arg1type)s::Ptr arg1) const override;
 """
 
 binary_runner_function =  """\
@@ -94,7 +102,33 @@ class %(nodename)sRunner: public DispatchVoidOp, private Uncopyable
 # Infix runner
 
 infix_scalar_runner_implementation = """\
-  ret = %(returntype)s::create(arg0->getValue() %(symbol)s arg1->getValue());\
+  ret = %(returntype)s::create(%(value0)s %(symbol)s %(value1)s);\
+"""
+
+# this is a jinja2 template
+infix_scalar_matrix_runner_implementation = """\
+  // The scalar is used as it is, rather than converted to a 1x1 matrix
+  {{ scalardatatype }} value = {{ scalarvalue }};
+  {{ matrixdatatype }}* data = arg{{ matrixarg }}->getData();
+  size_t datalen = arg{{ matrixarg }}->getDatalen();
+  {% if izysymbol %}
+  {% if scalarfirst %}
+  unique_ptr<{{ datatype }}[]> newData = izy::vx_{{ izysymbol }}(datalen, value, data);
+  {% else %}
+  unique_ptr<{{ datatype }}[]> newData = izy::vx_{{ izysymbol }}(datalen, data, value);
+  {% endif %}
+  {% else %}
+  unique_ptr<{{ datatype }}[]> newData(new {{ datatype }}[datalen]);
+  for (size_t i = 0; i < datalen; i++)
+  {
+    {% if scalararg == '0' %}
+    newData[i] = value {{ symbol }} data[i];
+    {% else %}
+    newData[i] = data[i] {{ symbol }} value;
+    {% endif %}
+  }
+  {% endif %}
+  ret = {{ returntype }}::create(newData.release(), arg{{ matrixarg }}->getRows(), arg{{ matrixarg }}->getCols(), OWNER);
 """
 
 # this is a jinja2 template
@@ -139,6 +173,34 @@ infix_matrix_runner_implementation = """\
 
   unique_ptr<{{ datatype }}[]> newData = nullptr;
 
+  {% if loop %}
+  // {{ loopcomment }}
+  {{ datatype0 }}* data0 = arg0->getData();
+  {{ datatype1 }}* data1 = arg1->getData();
+  size_t datalen = newRows * newCols;
+  newData = unique_ptr<{{ datatype }}[]>(new {{ datatype }}[datalen]);
+  if (arg0scalar)
+  {
+    for (size_t i = 0; i < datalen; i++)
+    {
+      newData[i] = data0[0] {{ symbol }} data1[i];
+    }
+  }
+  else if (arg1scalar)
+  {
+    for (size_t i = 0; i < datalen; i++)
+    {
+      newData[i] = data0[i] {{ symbol }} data1[0];
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < datalen; i++)
+    {
+      newData[i] = data0[i] {{ symbol }} data1[i];
+    }
+  }
+  {% else %}
   if (arg0scalar)
   {
     size_t datalen = arg1->getDatalen();
@@ -164,11 +226,18 @@ infix_matrix_runner_implementation = """\
     {{ datatype }}* data1 = arg1->getData();
     newData = izy::vx_{{ izysymbol_vv }}(datalen, data0, data1);
   }
+  {% endif %}
 
   ret = {{ returntype }}::create(newData.release(), newRows, newCols, OWNER);
 """
 
 
+# Runner calling one of the kernels in sparse.hh or diagonal.hh
+
+kernel_runner_implementation = """\
+  ret = %(call)s;\
+"""
+
 # Unary runner
 
 unary_runner_class_definition = """\
@@ -178,7 +247,11 @@ class %(nodename)sRunner: public DispatchVoidUnaryOp, private Uncopyable
     virtual void * run(RegContainer& reg, OGRealScalar::Ptr    arg) const override;
     virtual void * run(RegContainer& reg, OGRealDenseMatrix::Ptr    arg) const override;
     virtual void * run(RegContainer& reg, OGComplexDenseMatrix::Ptr arg) const override;
-};
+%(extra_runs)s};
+"""
+
+unary_runner_extra_run = """\
+    virtual void * run(RegContainer& reg, %(argtype)s::Ptr arg) const override;
 """
 
 unary_runner_function = """\
@@ -210,6 +283,16 @@ prefix_matrix_runner_implementation = """\
   ret = %(returntype)s::create(newData, arg->getRows(), arg->getCols(), OWNER);
 """
 
+prefix_structured_runner_implementation = """\
+  %(datatype)s* data = arg->getData();
+  size_t datalen = arg->getDatalen();
+  std::unique_ptr<%(datatype)s[]> newData(new %(datatype)s[datalen]);
+  for (size_t i = 0; i < datalen; ++i)
+  {
+    newData[i] = %(symbol)sdata[i];
+  }
+"""
+
 # UnaryFunction runner
 
 unaryfunction_scalar_runner_implementation = """\
@@ -223,6 +306,30 @@ unaryfunction_matrix_runner_implementation = """\
   ret = %(returntype)s::create(newData.release(), arg->getRows(), arg->getCols(), OWNER);
 """
 
+unaryfunction_structured_runner_implementation = """\
+  %(datatype)s* data = arg->getData();
+  const int datalen = arg->getDatalen();
+  std::unique_ptr<%(datatype)s[]> newData = izy::vx_%(function)s(datalen, data);
+"""
+
+# Zero preserving runners, applying the function to the stored entries of a diagonal
+# or sparse matrix only, in newData
+
+diagonal_runner_create = """\
+  ret = %(returntype)s::create(newData.release(), arg->getRows(), arg->getCols(), OWNER);\
+"""
+
+sparse_runner_create = """\
+  // The pattern is unchanged, but the result owns its own copy
+  size_t cols = arg->getCols();
+  size_t nnz = arg->getDatalen();
+  std::unique_ptr<int4[]> colPtr(new int4[cols + 1]);
+  std::copy(arg->getColPtr(), arg->getColPtr() + cols + 1, colPtr.get());
+  std::unique_ptr<int4[]> rowIdx(new int4[nnz]);
+  std::copy(arg->getRowIdx(), arg->getRowIdx() + nnz, rowIdx.get());
+  ret = %(returntype)s::create(colPtr.release(), rowIdx.release(), newData.release(), arg->getRows(), cols, OWNER);\
+"""
+
 # Unimplemented runners
 
 unimplementedunary_runner_function = """\
@@ -6,6 +6,14 @@
 
 package com.opengamma.maths.materialisers;
 
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.Executor;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.function.Supplier;
+
 import com.opengamma.maths.datacontainers.OGNumeric;
 import com.opengamma.maths.datacontainers.OGTerminal;
 import com.opengamma.maths.datacontainers.lazy.OGExpr;
@@ -28,6 +36,25 @@ public class Materialisers {
     NativeLibraries.initialize();
   }
 
+  /**
+   * The threads asynchronous materialisations are run on. Each one makes a blocking
+   * native call, which must be made from a Java thread as the native terminals refer
+   * to the Java arrays through references that are only valid for the duration of
+   * the call. The nodes of the tree are computed on the native executor. The threads
+   * are daemons so that pending materialisations do not hold up the exit of the JVM.
+   */
+  private static final ExecutorService ASYNC_EXECUTOR = Executors.newFixedThreadPool(
+      Runtime.getRuntime().availableProcessors(), new ThreadFactory() {
+        private final AtomicInteger _count = new AtomicInteger();
+
+        @Override
+        public Thread newThread(Runnable r) {
+          Thread thread = new Thread(r, "og-maths-materialiser-" + _count.incrementAndGet());
+          thread.setDaemon(true);
+          return thread;
+        }
+      });
+
   /* native library bindings */
   private static native double[][] materialiseToJDoubleArrayOfArrays(OGNumeric arg0);
 
@@ -37,6 +64,14 @@ public class Materialisers {
 
   private static native OGTerminal materialiseToOGTerminal(OGNumeric arg0);
 
+  private static native OGTerminal[] materialiseToOGTerminals(OGNumeric[] args);
+
+  private static native void setTracingEnabled(boolean enabled);
+
+  private static native void clearTraceEvents();
+
+  private static native void writeChromeTrace(String filename);
+
   /**
    * Materialise the tree at arg0 to a complex array stored in a ComplexArrayContainer.
    * @param arg0 the root of the tree to materialise.
@@ -113,4 +148,119 @@ public class Materialisers {
     Catchers.catchNullFromArgList(arg0, 1);
     return materialiseToOGTerminal(arg0);
   }
+
+  /**
+   * Materialise a batch of trees in one native call. The trees are evaluated together,
+   * concurrently where they are independent, and nodes or terminals that appear in more
+   * than one of them are computed once. This is much cheaper than materialising many
+   * small trees one at a time.
+   * @param args the roots of the trees to materialise.
+   * @return the materialised trees, in the same order as args.
+   */
+  public static OGTerminal[] toOGTerminals(OGNumeric[] args) {
+    Catchers.catchNullFromArgList(args, 1);
+    for (int i = 0; i < args.length; i++) {
+      Catchers.catchNull(args[i], "args[" + i + "]");
+    }
+    return materialiseToOGTerminals(args);
+  }
+
+  /**
+   * Materialise the tree at arg0 to an array of arrays asynchronously. The calling
+   * thread returns immediately and can go on to build further trees while this one
+   * is evaluated. The tree must not be modified until the future is complete.
+   * @param arg0 the root of the tree to materialise.
+   * @return a future completed with the materialised tree, or exceptionally with the
+   * exception materialising it threw.
+   */
+  public static CompletableFuture<double[][]> toDoubleArrayOfArraysAsync(final OGNumeric arg0) {
+    return toDoubleArrayOfArraysAsync(arg0, ASYNC_EXECUTOR);
+  }
+
+  /**
+   * Materialise the tree at arg0 to an array of arrays asynchronously, making the
+   * blocking native call on a thread of the given executor.
+   * @param arg0 the root of the tree to materialise.
+   * @param executor the executor to make the native call on.
+   * @return a future completed with the materialised tree, or exceptionally with the
+   * exception materialising it threw.
+   */
+  public static CompletableFuture<double[][]> toDoubleArrayOfArraysAsync(final OGNumeric arg0, Executor executor) {
+    Catchers.catchNullFromArgList(arg0, 1);
+    Catchers.catchNullFromArgList(executor, 2);
+    return CompletableFuture.supplyAsync(new Supplier<double[][]>() {
+      @Override
+      public double[][] get() {
+        return materialiseToJDoubleArrayOfArrays(arg0);
+      }
+    }, executor);
+  }
+
+  /**
+   * Materialise the tree at arg0 to an OGTerminal asynchronously. The calling thread
+   * returns immediately and can go on to build further trees while this one is
+   * evaluated. The tree must not be modified until the future is complete.
+   * @param arg0 the root of the tree to materialise.
+   * @return a future completed with the materialised tree, or exceptionally with the
+   * exception materialising it threw.
+   */
+  public static CompletableFuture<OGTerminal> toOGTerminalAsync(final OGNumeric arg0) {
+    Catchers.catchNullFromArgList(arg0, 1);
+    return CompletableFuture.supplyAsync(new Supplier<OGTerminal>() {
+      @Override
+      public OGTerminal get() {
+        return materialiseToOGTerminal(arg0);
+      }
+    }, ASYNC_EXECUTOR);
+  }
+
+  /**
+   * Materialise a batch of trees asynchronously, in one native call as toOGTerminals
+   * does. This lets a large batch be pipelined: the next batch can be built while the
+   * previous one is evaluated.
+   * @param args the roots of the trees to materialise.
+   * @return a future completed with the materialised trees, in the same order as args,
+   * or exceptionally with the exception materialising them threw.
+   */
+  public static CompletableFuture<OGTerminal[]> toOGTerminalsAsync(OGNumeric[] args) {
+    Catchers.catchNullFromArgList(args, 1);
+    for (int i = 0; i < args.length; i++) {
+      Catchers.catchNull(args[i], "args[" + i + "]");
+    }
+    // Copy so that the caller may reuse the array
+    final OGNumeric[] trees = args.clone();
+    return CompletableFuture.supplyAsync(new Supplier<OGTerminal[]>() {
+      @Override
+      public OGTerminal[] get() {
+        return materialiseToOGTerminals(trees);
+      }
+    }, ASYNC_EXECUTOR);
+  }
+
+  /**
+   * Enable or disable tracing of the native evaluation. While tracing, each node
+   * computed is recorded with the types and shapes of its arguments and results, the
+   * conversions made, the wall time taken and the bytes allocated.
+   * @param enabled true to trace the nodes computed from now on.
+   */
+  public static void setTracing(boolean enabled) {
+    setTracingEnabled(enabled);
+  }
+
+  /**
+   * Discard the nodes traced so far.
+   */
+  public static void clearTrace() {
+    clearTraceEvents();
+  }
+
+  /**
+   * Write the nodes traced so far to a file in the Chrome trace event format, which
+   * can be loaded into about:tracing or Perfetto.
+   * @param filename the name of the file to write.
+   */
+  public static void writeTrace(String filename) {
+    Catchers.catchNullFromArgList(filename, 1);
+    writeChromeTrace(filename);
+  }
 }
@@ -0,0 +1,97 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+package com.opengamma.maths.materialisers;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ExecutionException;
+
+import org.testng.annotations.Test;
+
+import com.opengamma.maths.datacontainers.OGNumeric;
+import com.opengamma.maths.datacontainers.OGTerminal;
+import com.opengamma.maths.datacontainers.matrix.OGRealDenseMatrix;
+import com.opengamma.maths.datacontainers.scalar.OGRealScalar;
+import com.opengamma.maths.exceptions.MathsException;
+import com.opengamma.maths.exceptions.MathsExceptionNativeComputation;
+import com.opengamma.maths.exceptions.MathsExceptionNullPointer;
+import com.opengamma.maths.nodes.NEGATE;
+import com.opengamma.maths.nodes.PLUS;
+import com.opengamma.maths.nodes.TIMES;
+
+public class TestAsyncMaterialise {
+
+  private static final int NTREES = 200;
+
+  private static final OGRealDenseMatrix M = new OGRealDenseMatrix(new double[][] { { 1, 2, 3 }, { 4, 5, 6 } });
+
+  private static OGNumeric tree(int i) {
+    return new PLUS(new TIMES(M, new OGRealScalar(i)), new NEGATE(M));
+  }
+
+  @Test
+  public void asyncMatchesSync() throws InterruptedException, ExecutionException {
+    // Keep many materialisations in flight while building the next tree
+    List<CompletableFuture<OGTerminal>> terminals = new ArrayList<CompletableFuture<OGTerminal>>();
+    List<CompletableFuture<double[][]>> arrays = new ArrayList<CompletableFuture<double[][]>>();
+    for (int i = 0; i < NTREES; i++) {
+      terminals.add(Materialisers.toOGTerminalAsync(tree(i)));
+      arrays.add(Materialisers.toDoubleArrayOfArraysAsync(tree(i)));
+    }
+    for (int i = 0; i < NTREES; i++) {
+      if (!Arrays.equals(Materialisers.toOGTerminal(tree(i)).getData(), terminals.get(i).get().getData())) {
+        throw new MathsException("Arrays not equal for tree " + i);
+      }
+      if (!Arrays.deepEquals(Materialisers.toDoubleArrayOfArrays(tree(i)), arrays.get(i).get())) {
+        throw new MathsException("Arrays of arrays not equal for tree " + i);
+      }
+    }
+  }
+
+  @Test
+  public void asyncBatchMatchesSync() throws InterruptedException, ExecutionException {
+    OGNumeric[] trees = new OGNumeric[NTREES];
+    for (int i = 0; i < NTREES; i++) {
+      trees[i] = tree(i);
+    }
+    CompletableFuture<OGTerminal[]> future = Materialisers.toOGTerminalsAsync(trees);
+    // The caller may reuse its array straight away
+    Arrays.fill(trees, null);
+    OGTerminal[] answer = future.get();
+    if (answer.length != NTREES) {
+      throw new MathsException("Expected " + NTREES + " results, got " + answer.length);
+    }
+    for (int i = 0; i < NTREES; i++) {
+      if (!Arrays.equals(Materialisers.toOGTerminal(tree(i)).getData(), answer[i].getData())) {
+        throw new MathsException("Arrays not equal for tree " + i);
+      }
+    }
+  }
+
+  @Test(expectedExceptions = MathsExceptionNativeComputation.class)
+  public void asyncErrorCompletesExceptionally() throws Throwable {
+    OGRealDenseMatrix other = new OGRealDenseMatrix(new double[][] { { 1, 2 }, { 3, 4 }, { 5, 6 } });
+    try {
+      Materialisers.toOGTerminalAsync(new PLUS(M, other)).get();
+    } catch (ExecutionException e) {
+      throw e.getCause();
+    }
+  }
+
+  @Test(expectedExceptions = MathsExceptionNullPointer.class)
+  public void asyncNullTree() {
+    Materialisers.toOGTerminalAsync(null);
+  }
+
+  @Test(expectedExceptions = MathsExceptionNullPointer.class)
+  public void asyncNullTreeInBatch() {
+    Materialisers.toOGTerminalsAsync(new OGNumeric[] { new OGRealScalar(1), null });
+  }
+
+}
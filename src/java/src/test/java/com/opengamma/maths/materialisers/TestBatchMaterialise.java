@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+package com.opengamma.maths.materialisers;
+
+import java.util.Arrays;
+
+import org.testng.annotations.Test;
+
+import com.opengamma.maths.datacontainers.OGNumeric;
+import com.opengamma.maths.datacontainers.OGTerminal;
+import com.opengamma.maths.datacontainers.matrix.OGRealDenseMatrix;
+import com.opengamma.maths.datacontainers.scalar.OGRealScalar;
+import com.opengamma.maths.exceptions.MathsException;
+import com.opengamma.maths.exceptions.MathsExceptionNullPointer;
+import com.opengamma.maths.nodes.NEGATE;
+import com.opengamma.maths.nodes.PLUS;
+import com.opengamma.maths.nodes.TIMES;
+
+public class TestBatchMaterialise {
+
+  private static final int NTREES = 1000;
+
+  @Test
+  public void materialiseEmptyBatch() {
+    OGTerminal[] answer = Materialisers.toOGTerminals(new OGNumeric[0]);
+    if (answer.length != 0) {
+      throw new MathsException("Expected no results, got " + answer.length);
+    }
+  }
+
+  @Test
+  public void materialiseBatchMatchesSingle() {
+    // Many small trees sharing a terminal and a subtree
+    OGRealDenseMatrix m = new OGRealDenseMatrix(new double[][] { { 1, 2, 3 }, { 4, 5, 6 } });
+    OGNumeric negated = new NEGATE(m);
+    OGNumeric[] trees = new OGNumeric[NTREES];
+    for (int i = 0; i < NTREES; i++) {
+      OGNumeric scaled = new TIMES(m, new OGRealScalar(i % 100));
+      trees[i] = (i % 2 == 0) ? scaled : new PLUS(scaled, negated);
+    }
+    // Terminals and repeated roots are allowed
+    trees[1] = m;
+    trees[3] = negated;
+    trees[5] = negated;
+
+    OGTerminal[] answer = Materialisers.toOGTerminals(trees);
+    if (answer.length != NTREES) {
+      throw new MathsException("Expected " + NTREES + " results, got " + answer.length);
+    }
+    for (int i = 0; i < NTREES; i++) {
+      OGTerminal expected = Materialisers.toOGTerminal(trees[i]);
+      if (!Arrays.equals(expected.getData(), answer[i].getData())) {
+        throw new MathsException("Arrays not equal for tree " + i);
+      }
+    }
+  }
+
+  @Test(expectedExceptions = MathsExceptionNullPointer.class)
+  public void nullBatch() {
+    Materialisers.toOGTerminals(null);
+  }
+
+  @Test(expectedExceptions = MathsExceptionNullPointer.class)
+  public void nullTreeInBatch() {
+    Materialisers.toOGTerminals(new OGNumeric[] { new OGRealScalar(1), null });
+  }
+
+}
@@ -0,0 +1,54 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+package com.opengamma.maths.materialisers;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+
+import org.testng.annotations.Test;
+
+import com.opengamma.maths.datacontainers.matrix.OGRealDenseMatrix;
+import com.opengamma.maths.exceptions.MathsException;
+import com.opengamma.maths.exceptions.MathsExceptionNativeComputation;
+import com.opengamma.maths.exceptions.MathsExceptionNullPointer;
+import com.opengamma.maths.nodes.MTIMES;
+
+public class TestTracing {
+
+  @Test
+  public void writeTrace() throws IOException {
+    OGRealDenseMatrix m = new OGRealDenseMatrix(new double[][] { { 1, 2 }, { 3, 4 } });
+    File file = File.createTempFile("trace", ".json");
+    file.deleteOnExit();
+    Materialisers.clearTrace();
+    Materialisers.setTracing(true);
+    try {
+      Materialisers.toOGTerminal(new MTIMES(m, m));
+    } finally {
+      Materialisers.setTracing(false);
+    }
+    Materialisers.writeTrace(file.getPath());
+    Materialisers.clearTrace();
+    String json = new String(Files.readAllBytes(file.toPath()), StandardCharsets.UTF_8);
+    if (!json.contains("\"name\":\"MTIMES\"")) {
+      throw new MathsException("MTIMES not traced: " + json);
+    }
+  }
+
+  @Test(expectedExceptions = MathsExceptionNativeComputation.class)
+  public void writeTraceBadFile() {
+    Materialisers.writeTrace(new File(new File("nonexistent"), "trace.json").getPath());
+  }
+
+  @Test(expectedExceptions = MathsExceptionNullPointer.class)
+  public void writeTraceNull() {
+    Materialisers.writeTrace(null);
+  }
+
+}
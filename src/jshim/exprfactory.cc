@@ -5,6 +5,8 @@
  */
 
 #include <stack>
+#include <unordered_map>
+#include <utility>
 #include "numeric.hh"
 #include "exprfactory.hh"
 #include "jvmmanager.hh"
@@ -45,7 +47,9 @@ jlong getType(JNIEnv* env, jobject obj)
 {
   jobject typeobj = env->CallObjectMethod(obj, JVMManager::getOGNumericClazz_getType());
   checkEx(env);
-  return env->GetLongField(typeobj, JVMManager::getOGExprEnumClazz__hashdefined());
+  jlong type = env->GetLongField(typeobj, JVMManager::getOGExprEnumClazz__hashdefined());
+  env->DeleteLocalRef(typeobj);
+  return type;
 }
 
 /**
@@ -82,16 +86,101 @@ struct jnode
   }
 };
 
+/**
+ * Records the Java nodes that have already been translated, so that a node that is
+ * an argument in more than one place in the Java tree becomes a single shared node in
+ * the RDAG tree (and is therefore only evaluated once). Nodes are keyed on their
+ * System.identityHashCode(), with IsSameObject() used to resolve collisions.
+ *
+ * A tree may have far more nodes than the JVM guarantees local references for, so the
+ * Java nodes of expressions are held as global references, which are released when
+ * this is destroyed.
+ */
+class TranslatedNodes
+{
+  public:
+    TranslatedNodes(JNIEnv* env): _env{env} {}
+    ~TranslatedNodes()
+    {
+      for (auto& entry: _nodes)
+      {
+        if (entry.second.ownsRef)
+        {
+          _env->DeleteGlobalRef(entry.second.obj);
+        }
+      }
+    }
+    /**
+     * Find the translation of a Java node.
+     * @param obj the Java node
+     * @return the translated node, or a null pointer if \a obj has not been translated.
+     */
+    OGNumeric::Ptr find(jobject obj)
+    {
+      auto range = _nodes.equal_range(identityHashCode(obj));
+      for (auto it = range.first; it != range.second; ++it)
+      {
+        if (_env->IsSameObject(it->second.obj, obj))
+        {
+          return it->second.node;
+        }
+      }
+      return OGNumeric::Ptr{};
+    }
+    /**
+     * Record the translation of a Java node.
+     * @param obj the Java node
+     * @param node the translated node
+     * @param ownsRef true if the local reference \a obj is handed over, in which case
+     * it is replaced by a global reference held until this is destroyed. Terminals hold
+     * on to their Java objects, so should pass false.
+     */
+    void insert(jobject obj, const OGNumeric::Ptr& node, bool ownsRef)
+    {
+      jint hash = identityHashCode(obj);
+      if (ownsRef)
+      {
+        jobject global = _env->NewGlobalRef(obj);
+        _env->DeleteLocalRef(obj);
+        if (global == nullptr)
+        {
+          throw convert_error("Cannot create global reference.");
+        }
+        obj = global;
+      }
+      _nodes.insert(std::make_pair(hash, Entry{obj, node, ownsRef}));
+    }
+  private:
+    struct Entry
+    {
+      jobject obj;
+      OGNumeric::Ptr node;
+      bool ownsRef;
+    };
+    jint identityHashCode(jobject obj)
+    {
+      jint hash = _env->CallStaticIntMethod(JVMManager::getSystemClazz(),
+                                            JVMManager::getSystemClazz_identityHashCode(), obj);
+      checkEx(_env);
+      return hash;
+    }
+    JNIEnv* _env;
+    std::unordered_multimap<jint, Entry> _nodes;
+};
+
 /**
  * Generates an RDAG expression tree from a java object
- * @param obj a Java OGNumeric type
+ * @param env the JNI environment pointer
+ * @param jexpr a Java OGNumeric type
+ * @param translated the Java nodes already translated, which are reused rather than
+ * translated again
+ * @param recordRoot true if \a jexpr is to be recorded in \a translated, in which
+ * case its local reference is kept until \a translated is destroyed
  * @return the equivalent RDAG expression
  */
-OGNumeric::Ptr createExpression(jobject jexpr)
+static OGNumeric::Ptr createExpression(JNIEnv* env, jobject jexpr, TranslatedNodes& translated,
+                                       bool recordRoot)
 {
-  JNIEnv* env = nullptr;
-  JVMManager::getEnv((void **) &env);
-
   // This function implements a procedural depth-first traversal of the expression tree,
   // building the RDAG expression tree as it travels. Since it visits nodes in reverse
   // Polish order, we can use a stack to place tree components whilst we're constructing
@@ -125,6 +214,10 @@ OGNumeric::Ptr createExpression(jobject jexpr)
       // the expression stack so it is ready to be picked up by its operator
       OGNumeric::Ptr n = translateNode(env, current.obj);
       exprStack.push(n);
+      if (workJexprs.size() > 1 || recordRoot)
+      {
+        translated.insert(current.obj, n, false);
+      }
       // Go back up to where we came from, by removing this node from the work stacks
       workJexprs.pop();
       argPos.pop();
@@ -149,10 +242,21 @@ OGNumeric::Ptr createExpression(jobject jexpr)
           // No, so go down that child now
           jobject nextObj = (jobject) env->GetObjectArrayElement(current.args, pos);
           checkEx(env);
-          jnode nextNode{ env, nextObj };
-          workJexprs.push(nextNode);
-          argPos.push(0);
-          dir = Direction::DOWN;
+          OGNumeric::Ptr seen = translated.find(nextObj);
+          if (seen != OGNumeric::Ptr{})
+          {
+            // Already translated, so the arg is ready. Stay on our way up so the
+            // next arg gets looked at.
+            exprStack.push(seen);
+            env->DeleteLocalRef(nextObj);
+          }
+          else
+          {
+            jnode nextNode{ env, nextObj };
+            workJexprs.push(nextNode);
+            argPos.push(0);
+            dir = Direction::DOWN;
+          }
         }
         else
         {
@@ -176,11 +280,21 @@ OGNumeric::Ptr createExpression(jobject jexpr)
             break;
           }
           exprStack.push(n);
+          env->DeleteLocalRef(current.args);
           
           argPos.pop();
           workJexprs.pop();
-          // We're finished with the current node, so we can clean up the local ref
-          env->DeleteLocalRef(current.obj);
+          if (!workJexprs.empty() || recordRoot)
+          {
+            // Keep a ref until we're done, it's needed to recognise this node if we
+            // meet it again
+            translated.insert(current.obj, n, true);
+          }
+          else
+          {
+            // We're finished with the root node, so we can clean up the local ref
+            env->DeleteLocalRef(current.obj);
+          }
         }
       }
       else
@@ -190,9 +304,21 @@ OGNumeric::Ptr createExpression(jobject jexpr)
         // Get the first arg and go down to it
         jobject nextObj = (jobject) env->GetObjectArrayElement(current.args, 0);
         checkEx(env);
-        jnode nextNode{ env, nextObj };
-        workJexprs.push(nextNode);
-        argPos.push(0);
+        OGNumeric::Ptr seen = translated.find(nextObj);
+        if (seen != OGNumeric::Ptr{})
+        {
+          // Already translated, so the first arg is ready and we can head back up
+          // to this node to look at the next one.
+          exprStack.push(seen);
+          env->DeleteLocalRef(nextObj);
+          dir = Direction::UP;
+        }
+        else
+        {
+          jnode nextNode{ env, nextObj };
+          workJexprs.push(nextNode);
+          argPos.push(0);
+        }
       }
     }
   }
@@ -206,5 +332,47 @@ OGNumeric::Ptr createExpression(jobject jexpr)
   return exprStack.top();
 }
 
+OGNumeric::Ptr createExpression(jobject jexpr)
+{
+  JNIEnv* env = nullptr;
+  JVMManager::getEnv((void **) &env);
+  // Nodes we have already translated. When we meet one of these again we reuse its
+  // translation rather than descending into it.
+  TranslatedNodes translated{env};
+  return createExpression(env, jexpr, translated, false);
+}
+
+std::vector<OGNumeric::Ptr> createExpressions(jobjectArray jexprs)
+{
+  JNIEnv* env = nullptr;
+  JVMManager::getEnv((void **) &env);
+  // Shared by all the trees, so that a node or terminal appearing in more than one
+  // of them is translated once.
+  TranslatedNodes translated{env};
+  jsize n = env->GetArrayLength(jexprs);
+  std::vector<OGNumeric::Ptr> exprs;
+  exprs.reserve(n);
+  for (jsize i = 0; i < n; i++)
+  {
+    jobject jexpr = env->GetObjectArrayElement(jexprs, i);
+    checkEx(env);
+    if (jexpr == nullptr)
+    {
+      throw convert_error("Null expression in array passed to createExpressions");
+    }
+    OGNumeric::Ptr seen = translated.find(jexpr);
+    if (seen != OGNumeric::Ptr{})
+    {
+      exprs.push_back(seen);
+      env->DeleteLocalRef(jexpr);
+    }
+    else
+    {
+      exprs.push_back(createExpression(env, jexpr, translated, true));
+    }
+  }
+  return exprs;
+}
+
 
 } // namespace convert
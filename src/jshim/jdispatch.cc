@@ -33,6 +33,8 @@ Real8AoA::Real8AoA(const OGNumeric::Ptr& node)
   case REAL_DENSE_MATRIX_ENUM:
   case REAL_DIAGONAL_MATRIX_ENUM:
   case REAL_SPARSE_MATRIX_ENUM:
+  case REAL_SINGLE_DENSE_MATRIX_ENUM:
+  case REAL_TRANSPOSED_MATRIX_ENUM:
     _data = node->asOGTerminal()->toReal8ArrayOfArrays();
     _rows = node->asOGTerminal()->getRows();
     _cols = node->asOGTerminal()->getCols();
@@ -122,6 +124,10 @@ Complex16AoA::Complex16AoA(const OGNumeric::Ptr& node)
   case COMPLEX_DENSE_MATRIX_ENUM:
   case COMPLEX_DIAGONAL_MATRIX_ENUM:
   case COMPLEX_SPARSE_MATRIX_ENUM:
+  case REAL_SINGLE_DENSE_MATRIX_ENUM:
+  case COMPLEX_SINGLE_DENSE_MATRIX_ENUM:
+  case REAL_TRANSPOSED_MATRIX_ENUM:
+  case COMPLEX_TRANSPOSED_MATRIX_ENUM:
     _data = node->asOGTerminal()->toComplex16ArrayOfArrays();
     _rows = node->asOGTerminal()->getRows();
     _cols = node->asOGTerminal()->getCols();
@@ -243,6 +249,20 @@ JavaTerminal::JavaTerminal(JNIEnv* env, const OGNumeric::Ptr& node)
   case COMPLEX_SPARSE_MATRIX_ENUM:
     createComplexSparseMatrix(env, node);
     break;
+  // Java has no single precision matrices, so these are widened
+  case REAL_SINGLE_DENSE_MATRIX_ENUM:
+    createRealDenseMatrix(env, node);
+    break;
+  case COMPLEX_SINGLE_DENSE_MATRIX_ENUM:
+    createComplexDenseMatrix(env, node);
+    break;
+  // Nor views, so transposed views are materialised
+  case REAL_TRANSPOSED_MATRIX_ENUM:
+    createRealDenseMatrix(env, node);
+    break;
+  case COMPLEX_TRANSPOSED_MATRIX_ENUM:
+    createComplexDenseMatrix(env, node);
+    break;
   default:
     stringstream message;
     message << "Unsupported type for JavaTerminal. Type is " << type << ".";
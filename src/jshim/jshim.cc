@@ -7,6 +7,7 @@
 #include <sstream>
 #include "com_opengamma_maths_materialisers_Materialisers.h"
 #include "entrypt.hh"
+#include "trace.hh"
 #include "jvmmanager.hh"
 #include "expression.hh"
 #include "exprfactory.hh"
@@ -375,6 +376,111 @@ Java_com_opengamma_maths_materialisers_Materialisers_materialiseToOGTerminal(JNI
   return result;
 }
 
+/*
+ * Class:     com_opengamma_maths_materialisers_Materialisers
+ * Method:    materialiseToOGTerminals
+ * Signature: ([Lcom/opengamma/maths/datacontainers/OGNumeric;)[Lcom/opengamma/maths/datacontainers/OGTerminal;
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_com_opengamma_maths_materialisers_Materialisers_materialiseToOGTerminals(JNIEnv *env, jclass SUPPRESS_UNUSED clazz, jobjectArray objs)
+{
+  DEBUG_PRINT("materialiseToOGTerminals\n");
+  DEBUG_PRINT("Calling convert::createExpressions\n");
+  jobjectArray result;
+
+  try
+  {
+    // convert objs to OGNumeric objs, sharing the nodes they have in common
+    vector<librdag::OGNumeric::Ptr> chains = convert::createExpressions(objs);
+
+    DEBUG_PRINT("Check for exception before entrypt\n");
+    checkEx(env);
+    DEBUG_PRINT("Calling entrypt function\n");
+    vector<librdag::OGTerminal::Ptr> answers = entrypt(chains);
+
+    result = env->NewObjectArray(answers.size(), JVMManager::getOGTerminalClazz(), nullptr);
+    checkEx(env);
+    for (size_t i = 0; i < answers.size(); i++)
+    {
+      jobject answer = JavaTerminal{env, answers[i]}.getObject();
+      env->SetObjectArrayElement(result, i, answer);
+      checkEx(env);
+      // A batch can be large, so don't hold on to a local ref per result
+      env->DeleteLocalRef(answer);
+    }
+  }
+  catch (convert_error& e)
+  {
+    convertExceptionJava(env, e);
+    return nullptr;
+  }
+  catch (rdag_error& e)
+  {
+    rdagExceptionJava(env, e);
+    return nullptr;
+  }
+  catch (exception& e)
+  {
+    unspecifiedExceptionJava(env, e);
+    return nullptr;
+  }
+
+  DEBUG_PRINT("Returning\n");
+  return result;
+}
+
+/*
+ * Class:     com_opengamma_maths_materialisers_Materialisers
+ * Method:    setTracingEnabled
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL
+Java_com_opengamma_maths_materialisers_Materialisers_setTracingEnabled(JNIEnv SUPPRESS_UNUSED *env, jclass SUPPRESS_UNUSED clazz, jboolean enabled)
+{
+  librdag::Tracer::setEnabled(enabled == JNI_TRUE);
+}
+
+/*
+ * Class:     com_opengamma_maths_materialisers_Materialisers
+ * Method:    clearTraceEvents
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL
+Java_com_opengamma_maths_materialisers_Materialisers_clearTraceEvents(JNIEnv SUPPRESS_UNUSED *env, jclass SUPPRESS_UNUSED clazz)
+{
+  librdag::Tracer::clear();
+}
+
+/*
+ * Class:     com_opengamma_maths_materialisers_Materialisers
+ * Method:    writeChromeTrace
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL
+Java_com_opengamma_maths_materialisers_Materialisers_writeChromeTrace(JNIEnv *env, jclass SUPPRESS_UNUSED clazz, jstring filename)
+{
+  const char * chars = env->GetStringUTFChars(filename, nullptr);
+  if (chars == nullptr)
+  {
+    // An OutOfMemoryError is pending
+    return;
+  }
+  string name{chars};
+  env->ReleaseStringUTFChars(filename, chars);
+  try
+  {
+    librdag::Tracer::writeChromeTrace(name);
+  }
+  catch (rdag_error& e)
+  {
+    rdagExceptionJava(env, e);
+  }
+  catch (exception& e)
+  {
+    unspecifiedExceptionJava(env, e);
+  }
+}
+
 #ifdef __cplusplus
 }
 #endif
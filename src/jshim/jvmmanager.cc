@@ -107,6 +107,7 @@ JVMManager::registerReferences(JNIEnv * env)
   registerGlobalClassReference(env, "com/opengamma/maths/exceptions/MathsExceptionNativeConversion", &_MathsExceptionNativeConversionClazz);
   registerGlobalClassReference(env, "com/opengamma/maths/exceptions/MathsExceptionNativeComputation", &_MathsExceptionNativeComputationClazz);
   registerGlobalClassReference(env, "com/opengamma/maths/exceptions/MathsExceptionNativeUnspecified", &_MathsExceptionNativeUnspecifiedClazz);
+  registerGlobalClassReference(env, "java/lang/System", &_SystemClazz);
 
   //
   // REGISTER METHOD REFERENCES
@@ -131,6 +132,7 @@ JVMManager::registerReferences(JNIEnv * env)
   registerGlobalMethodReference(env, &_OGComplexDiagonalMatrixClazz, &_OGComplexDiagonalMatrixClazz_init, "<init>", "([D[DII)V");
   registerGlobalMethodReference(env, &_OGRealSparseMatrixClazz, &_OGRealSparseMatrixClazz_init, "<init>", "([I[I[DII)V");
   registerGlobalMethodReference(env, &_OGComplexSparseMatrixClazz, &_OGComplexSparseMatrixClazz_init, "<init>", "([I[I[D[DII)V");
+  registerGlobalStaticMethodReference(env, &_SystemClazz, &_SystemClazz_identityHashCode, "identityHashCode", "(Ljava/lang/Object;)I");
 
   //
   // REGISTER FIELD REFERENCES
@@ -184,6 +186,25 @@ JVMManager::registerGlobalMethodReference(JNIEnv * env, jclass * globalRef, jmet
   }
 }
 
+void
+JVMManager::registerGlobalStaticMethodReference(JNIEnv * env, jclass * globalRef, jmethodID * methodToSet, const char * methodName, const char * methodSignature)
+{
+  jmethodID tmp = nullptr;
+
+  tmp = env->GetStaticMethodID(*globalRef, methodName, methodSignature);
+  if (tmp == nullptr)
+  {
+    DEBUG_PRINT("ERROR: static method %s() not found.\n",methodName);
+    throw convert_error("Static method not found");
+  }
+  else
+  {
+    *methodToSet = tmp;
+    DEBUG_PRINT("Static method found: %s()\n\t", methodName);
+    VAL64BIT_PRINT("method pointer", methodToSet);
+  }
+}
+
 void
 JVMManager::registerGlobalClassReference(JNIEnv * env, const char * FQclassname, jclass * globalRef)
 {
@@ -252,6 +273,8 @@ jclass JVMManager::getMathsExceptionNativeComputationClazz()
 { return _MathsExceptionNativeComputationClazz; }
 jclass JVMManager::getMathsExceptionNativeUnspecifiedClazz()
 { return _MathsExceptionNativeUnspecifiedClazz; }
+jclass JVMManager::getSystemClazz()
+{ return _SystemClazz; }
 jmethodID JVMManager::getOGRealScalarClazz_init()
 { return _OGRealScalarClazz_init; }
 jmethodID JVMManager::getOGComplexScalarClazz_init()
@@ -288,6 +311,8 @@ jmethodID JVMManager::getOGSparseMatrixClazz_getRowIdx()
 { return _OGSparseMatrixClazz_getRowIdx; }
 jmethodID JVMManager::getComplexArrayContainerClazz_ctor_DAoA_DAoA()
 { return _ComplexArrayContainerClazz_ctor_DAoA_DAoA; }
+jmethodID JVMManager::getSystemClazz_identityHashCode()
+{ return _SystemClazz_identityHashCode; }
 jfieldID JVMManager:: getOGExprEnumClazz__hashdefined()
 { return _OGExprEnumClazz__hashdefined; }
 
@@ -317,6 +342,7 @@ jclass JVMManager::_OGComplexSparseMatrixClazz = nullptr;
 jclass JVMManager::_MathsExceptionNativeConversionClazz = nullptr;
 jclass JVMManager::_MathsExceptionNativeComputationClazz = nullptr;
 jclass JVMManager::_MathsExceptionNativeUnspecifiedClazz = nullptr;
+jclass JVMManager::_SystemClazz = nullptr;
 jmethodID JVMManager::_DoubleClazz_init = nullptr;
 jmethodID JVMManager::_OGRealScalarClazz_init = nullptr;
 jmethodID JVMManager::_OGComplexScalarClazz_init = nullptr;
@@ -336,6 +362,7 @@ jmethodID JVMManager::_OGArrayClazz_getCols = nullptr;
 jmethodID JVMManager::_OGSparseMatrixClazz_getColPtr = nullptr;
 jmethodID JVMManager::_OGSparseMatrixClazz_getRowIdx = nullptr;
 jmethodID JVMManager::_ComplexArrayContainerClazz_ctor_DAoA_DAoA = nullptr;
+jmethodID JVMManager::_SystemClazz_identityHashCode = nullptr;
 jfieldID  JVMManager::_OGExprEnumClazz__hashdefined = nullptr;
 
 // Wrappers to JavaVM and JNIEnv methods
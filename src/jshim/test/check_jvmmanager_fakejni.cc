@@ -129,6 +129,8 @@ TEST(JVMManagerFakeJNITest, Test_JVMManager_test_registerReferences)
     ASSERT_TRUE(jvm_manager->getOGComplexDiagonalMatrixClazz_init()!=nullptr);
     ASSERT_TRUE(jvm_manager->getOGRealSparseMatrixClazz_init()!=nullptr);
     ASSERT_TRUE(jvm_manager->getOGComplexSparseMatrixClazz_init()!=nullptr);
+    ASSERT_TRUE(jvm_manager->getSystemClazz()!=nullptr);
+    ASSERT_TRUE(jvm_manager->getSystemClazz_identityHashCode()!=nullptr);
 
     delete env;
     delete jvm;
@@ -18,6 +18,13 @@ namespace librdag {
 ConvertTo::ConvertTo()
 {}
 
+// things that convert to OGRealScalar
+OGRealScalar::Ptr
+ConvertTo::convertToOGRealScalar(OGIntegerScalar::Ptr thing) const
+{
+  return OGRealScalar::create(thing->getValue());
+}
+
 // things that convert to OGRealDenseMatrix
 OGRealDenseMatrix::Ptr
 ConvertTo::convertToOGRealDenseMatrix(OGRealScalar::Ptr thing) const
@@ -87,6 +94,35 @@ ConvertTo::convertToOGRealDenseMatrix(OGRealSparseMatrix::Ptr thing) const
   return ret;
 }
 
+OGRealDenseMatrix::Ptr
+ConvertTo::convertToOGRealDenseMatrix(OGRealSingleDenseMatrix::Ptr thing) const
+{
+  size_t rows = thing->getRows();
+  size_t cols = thing->getCols();
+  size_t wlen = thing->getDatalen();
+  OGRealDenseMatrix::Ptr ret = OGRealDenseMatrix::create(new real8[wlen](),rows,cols, OWNER);
+  real4 * densedata = thing->getData();
+  real8 * data = ret->getData();
+  for(size_t i=0;i<wlen;i++)
+  {
+    data[i]=densedata[i];
+  }
+  ret->setStructure(thing->getStructure());
+  return ret;
+}
+
+OGRealDenseMatrix::Ptr
+ConvertTo::convertToOGRealDenseMatrix(OGRealTransposedMatrix::Ptr thing) const
+{
+  size_t rows = thing->getRows();
+  size_t cols = thing->getCols();
+  size_t wlen = thing->getDatalen();
+  OGRealDenseMatrix::Ptr ret = OGRealDenseMatrix::create(new real8[wlen](),rows,cols, OWNER);
+  thing->materialise(ret->getData());
+  ret->setStructure(thing->getStructure());
+  return ret;
+}
+
 
 // things that convert to OGComplexDenseMatrix
 
@@ -218,4 +254,68 @@ ConvertTo::convertToOGComplexDenseMatrix(OGLogicalMatrix::Ptr thing) const
   return ret;
 }
 
+OGComplexDenseMatrix::Ptr
+ConvertTo::convertToOGComplexDenseMatrix(OGRealSingleDenseMatrix::Ptr thing) const
+{
+  size_t rows = thing->getRows();
+  size_t cols = thing->getCols();
+  size_t wlen = thing->getDatalen();
+  OGComplexDenseMatrix::Ptr ret = OGComplexDenseMatrix::create(new complex16[wlen](),rows,cols, OWNER);
+  real4 * densedata = thing->getData();
+  complex16 * data = ret->getData();
+  for(size_t i=0;i<wlen;i++)
+  {
+    data[i]=densedata[i];
+  }
+  ret->setStructure(thing->getStructure());
+  return ret;
+}
+
+OGComplexDenseMatrix::Ptr
+ConvertTo::convertToOGComplexDenseMatrix(OGComplexSingleDenseMatrix::Ptr thing) const
+{
+  size_t rows = thing->getRows();
+  size_t cols = thing->getCols();
+  size_t wlen = thing->getDatalen();
+  OGComplexDenseMatrix::Ptr ret = OGComplexDenseMatrix::create(new complex16[wlen](),rows,cols, OWNER);
+  complex8 * densedata = thing->getData();
+  complex16 * data = ret->getData();
+  for(size_t i=0;i<wlen;i++)
+  {
+    data[i]=densedata[i];
+  }
+  ret->setStructure(thing->getStructure());
+  return ret;
+}
+
+OGComplexDenseMatrix::Ptr
+ConvertTo::convertToOGComplexDenseMatrix(OGRealTransposedMatrix::Ptr thing) const
+{
+  size_t rows = thing->getRows();
+  size_t cols = thing->getCols();
+  size_t wlen = thing->getDatalen();
+  OGComplexDenseMatrix::Ptr ret = OGComplexDenseMatrix::create(new complex16[wlen](),rows,cols, OWNER);
+  unique_ptr<real8[]> densedata{new real8[wlen]};
+  thing->materialise(densedata.get());
+  complex16 * data = ret->getData();
+  for(size_t i=0;i<wlen;i++)
+  {
+    data[i]=densedata[i];
+  }
+  ret->setStructure(thing->getStructure());
+  return ret;
+}
+
+OGComplexDenseMatrix::Ptr
+ConvertTo::convertToOGComplexDenseMatrix(OGComplexTransposedMatrix::Ptr thing) const
+{
+  size_t rows = thing->getRows();
+  size_t cols = thing->getCols();
+  size_t wlen = thing->getDatalen();
+  OGComplexDenseMatrix::Ptr ret = OGComplexDenseMatrix::create(new complex16[wlen](),rows,cols, OWNER);
+  thing->materialise(ret->getData());
+  ret->setStructure(thing->getStructure());
+  return ret;
+}
+
 } // end namespace
@@ -0,0 +1,179 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "cse.hh"
+#include "execution.hh"
+#include "expression.hh"
+#include "terminal.hh"
+
+namespace librdag {
+
+namespace detail {
+
+/**
+ * Identifies a node for hash-consing. For expressions, the type and the (canonical)
+ * arguments. For terminals, the type, shape and data: arrays by the address of their
+ * data, scalars by their value.
+ */
+struct NodeKey
+{
+  ExprType_t type;
+  size_t rows;
+  size_t cols;
+  std::vector<const void*> refs;
+  complex16 value;
+
+  bool operator==(const NodeKey& other) const
+  {
+    return type == other.type && rows == other.rows && cols == other.cols
+        && refs == other.refs
+        && std::memcmp(&value, &other.value, sizeof(complex16)) == 0;
+  }
+};
+
+struct NodeKeyHash
+{
+  size_t operator()(const NodeKey& key) const
+  {
+    size_t h = std::hash<long>()(key.type);
+    auto combine = [&h](size_t v) { h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2); };
+    combine(key.rows);
+    combine(key.cols);
+    for (const void* ref: key.refs)
+    {
+      combine(std::hash<const void*>()(ref));
+    }
+    combine(std::hash<real8>()(key.value.real()));
+    combine(std::hash<real8>()(key.value.imag()));
+    return h;
+  }
+};
+
+static NodeKey terminalKey(const OGTerminal::Ptr& term)
+{
+  NodeKey key{term->getType(), term->getRows(), term->getCols(), {}, complex16(0.0)};
+  switch (key.type)
+  {
+    case REAL_SCALAR_ENUM:
+      key.value = term->asOGRealScalar()->getValue();
+      break;
+    case COMPLEX_SCALAR_ENUM:
+      key.value = term->asOGComplexScalar()->getValue();
+      break;
+    case INTEGER_SCALAR_ENUM:
+      key.value = term->asOGIntegerScalar()->getValue();
+      break;
+    case REAL_DENSE_MATRIX_ENUM:
+      key.refs.push_back(term->asOGRealDenseMatrix()->getData());
+      break;
+    case COMPLEX_DENSE_MATRIX_ENUM:
+      key.refs.push_back(term->asOGComplexDenseMatrix()->getData());
+      break;
+    case LOGICAL_MATRIX_ENUM:
+      key.refs.push_back(term->asOGLogicalMatrix()->getData());
+      break;
+    case REAL_SINGLE_DENSE_MATRIX_ENUM:
+      key.refs.push_back(term->asOGRealSingleDenseMatrix()->getData());
+      break;
+    case COMPLEX_SINGLE_DENSE_MATRIX_ENUM:
+      key.refs.push_back(term->asOGComplexSingleDenseMatrix()->getData());
+      break;
+    case REAL_DIAGONAL_MATRIX_ENUM:
+      key.refs.push_back(term->asOGRealDiagonalMatrix()->getData());
+      break;
+    case COMPLEX_DIAGONAL_MATRIX_ENUM:
+      key.refs.push_back(term->asOGComplexDiagonalMatrix()->getData());
+      break;
+    case REAL_SPARSE_MATRIX_ENUM:
+    {
+      OGRealSparseMatrix::Ptr sp = term->asOGRealSparseMatrix();
+      key.refs.push_back(sp->getData());
+      key.refs.push_back(sp->getColPtr());
+      key.refs.push_back(sp->getRowIdx());
+      break;
+    }
+    case COMPLEX_SPARSE_MATRIX_ENUM:
+    {
+      OGComplexSparseMatrix::Ptr sp = term->asOGComplexSparseMatrix();
+      key.refs.push_back(sp->getData());
+      key.refs.push_back(sp->getColPtr());
+      key.refs.push_back(sp->getRowIdx());
+      break;
+    }
+    default:
+      // Unknown terminal, only identical objects are equal.
+      key.refs.push_back(term.get());
+      break;
+  }
+  return key;
+}
+
+} // end namespace detail
+
+OGNumeric::Ptr
+eliminateCommonSubexpressions(const OGNumeric::Ptr& tree)
+{
+  return eliminateCommonSubexpressions(std::vector<OGNumeric::Ptr>{tree})[0];
+}
+
+std::vector<OGNumeric::Ptr>
+eliminateCommonSubexpressions(const std::vector<OGNumeric::Ptr>& trees)
+{
+  // The execution list presents each distinct node once, after its arguments, so
+  // every argument already has its canonical node by the time we look at a node.
+  ExecutionList el{trees};
+  // Canonical node for each node in the input tree
+  std::unordered_map<const OGNumeric*, OGNumeric::Ptr> canonical;
+  // Canonical node for each key
+  std::unordered_map<detail::NodeKey, OGNumeric::Ptr, detail::NodeKeyHash> seen;
+
+  for (auto it = el.begin(); it != el.end(); ++it)
+  {
+    const OGNumeric::Ptr& node = *it;
+    OGExpr::Ptr expr = node->asOGExpr();
+    detail::NodeKey key;
+    ArgContainer args;
+    bool argsChanged = false;
+    if (expr == OGExpr::Ptr{})
+    {
+      key = detail::terminalKey(node->asOGTerminal());
+    }
+    else
+    {
+      key = detail::NodeKey{node->getType(), 0, 0, {}, complex16(0.0)};
+      for (auto& arg: expr->getArgs())
+      {
+        const OGNumeric::Ptr& canonArg = canonical.at(arg.get());
+        argsChanged |= canonArg != arg;
+        args.push_back(canonArg);
+        key.refs.push_back(canonArg.get());
+      }
+    }
+
+    auto found = seen.find(key);
+    if (found != seen.end())
+    {
+      canonical[node.get()] = found->second;
+      continue;
+    }
+    OGNumeric::Ptr canon = argsChanged ? expr->withArgs(args) : node;
+    seen.emplace(std::move(key), canon);
+    canonical[node.get()] = canon;
+  }
+  std::vector<OGNumeric::Ptr> result;
+  result.reserve(trees.size());
+  for (auto& tree: trees)
+  {
+    result.push_back(canonical.at(tree.get()));
+  }
+  return result;
+}
+
+} // end namespace librdag
@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <unordered_map>
+#include "demand.hh"
+#include "execution.hh"
+#include "expression.hh"
+#include "terminal.hh"
+
+namespace librdag {
+
+constexpr uint64_t ResultDemand::ALL;
+
+namespace detail {
+
+static thread_local uint64_t current_demand = ResultDemand::ALL;
+
+static bool hasSeveralResults(const OGNumeric::Ptr& node)
+{
+  ExprType_t type = node->getType();
+  return type == SVD_ENUM || type == LU_ENUM;
+}
+
+} // end namespace detail
+
+/*
+ * ResultDemand
+ */
+
+std::vector<uint64_t>
+ResultDemand::analyse(ExecutionList& el)
+{
+  std::vector<uint64_t> demand(el.size(), ALL);
+  std::unordered_map<const OGNumeric*, size_t> positions;
+  for (size_t i = 0; i < el.size(); i++)
+  {
+    positions[el[i].get()] = i;
+    if (detail::hasSeveralResults(el[i]))
+    {
+      demand[i] = 0;
+    }
+  }
+  for (size_t i = 0; i < el.size(); i++)
+  {
+    OGExpr::Ptr expr = el[i]->asOGExpr();
+    if (expr == OGExpr::Ptr{})
+    {
+      continue;
+    }
+    const ArgContainer& args = expr->getArgs();
+    for (size_t a = 0; a < args.size(); a++)
+    {
+      if (!detail::hasSeveralResults(args[a]))
+      {
+        continue;
+      }
+      size_t pos = positions[args[a].get()];
+      if (expr->getType() == SELECTRESULT_ENUM && a == 0)
+      {
+        // An index out of range is reported when the node is run
+        OGIntegerScalar::Ptr index = args[1]->asOGIntegerScalar();
+        bool inRange = index != OGIntegerScalar::Ptr{} && index->getValue() >= 0 && index->getValue() < 64;
+        demand[pos] |= inRange ? static_cast<uint64_t>(1) << index->getValue() : ALL;
+      }
+      else
+      {
+        demand[pos] |= 1;
+      }
+    }
+  }
+  for (size_t root: el.getRoots())
+  {
+    demand[root] = ALL;
+  }
+  return demand;
+}
+
+uint64_t
+ResultDemand::get()
+{
+  return detail::current_demand;
+}
+
+bool
+ResultDemand::isNeeded(size_t result)
+{
+  return result >= 64 || ((detail::current_demand >> result) & 1) != 0;
+}
+
+/*
+ * ResultDemand::Scope
+ */
+
+ResultDemand::Scope::Scope(uint64_t demand): _previous{detail::current_demand}
+{
+  detail::current_demand = demand;
+}
+
+ResultDemand::Scope::~Scope()
+{
+  detail::current_demand = _previous;
+}
+
+} // end namespace librdag
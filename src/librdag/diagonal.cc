@@ -0,0 +1,312 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "diagonal.hh"
+#include "exceptions.hh"
+
+namespace librdag {
+
+namespace diagonal {
+
+namespace detail {
+
+template<typename T> bool isScalar(const OGArray<T>& a)
+{
+  return a.getRows() == 1 && a.getCols() == 1;
+}
+
+bool isFinite(real8 x)
+{
+  return std::isfinite(x);
+}
+
+bool isFinite(complex16 x)
+{
+  return std::isfinite(x.real()) && std::isfinite(x.imag());
+}
+
+/**
+ * The positions of the entries of a column major array that are Inf or NaN. These are
+ * the entries that make a product with an implicit zero of a diagonal operand nonzero.
+ */
+template<typename T> std::vector<size_t> nonFinite(const T * data, size_t n)
+{
+  std::vector<size_t> ret;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (!isFinite(data[i]))
+    {
+      ret.push_back(i);
+    }
+  }
+  return ret;
+}
+
+template<typename T> void throwMismatch(const OGArray<T>& a, const OGArray<T>& b, const char * symbol)
+{
+  std::stringstream s;
+  s << "Matrix dimensions ";
+  s << "(" << a.getRows() << "," << a.getCols() << ")";
+  s << " and ";
+  s << "(" << b.getRows() << "," << b.getCols() << ")";
+  s << " mismatch for operation: " << symbol;
+  throw rdag_error(s.str());
+}
+
+template<typename T> void checkCommute(const OGArray<T>& a, const OGArray<T>& b)
+{
+  if (a.getCols() != b.getRows())
+  {
+    std::stringstream message;
+    message << "Matrices do not commute. First is: " << a.getRows() << "x" << a.getCols() << ". Second is: " << b.getRows() << "x" << b.getCols();
+    throw rdag_error(message.str());
+  }
+}
+
+/**
+ * Allocates the diagonal of a rows x cols matrix, zeroed. The terminal requires data
+ * even when the diagonal is empty.
+ */
+template<typename T> std::unique_ptr<T[]> newDiagonal(size_t rows, size_t cols)
+{
+  return std::unique_ptr<T[]>(new T[std::max(std::min(rows, cols), static_cast<size_t>(1))]());
+}
+
+/**
+ * Multiplies a dense matrix by a scalar.
+ */
+template<typename T> OGNumeric::Ptr scaleDense(const OGMatrix<T>& a, T s)
+{
+  size_t n = a.getDatalen();
+  std::unique_ptr<T[]> data(new T[n]);
+  for (size_t i = 0; i < n; i++)
+  {
+    data[i] = s * a.getData()[i];
+  }
+  return makeConcreteDenseMatrix(data.release(), a.getRows(), a.getCols(), OWNER);
+}
+
+} // end namespace detail
+
+template<typename T>
+OGNumeric::Ptr plus(const OGDiagonalMatrix<T>& a, const OGDiagonalMatrix<T>& b, bool subtract)
+{
+  T sign = subtract ? -1.e0 : 1.e0;
+  bool sameShape = a.getRows() == b.getRows() && a.getCols() == b.getCols();
+  if (!sameShape && (detail::isScalar(a) || detail::isScalar(b)))
+  {
+    // Adding a scalar fills in every entry
+    const OGDiagonalMatrix<T>& m = detail::isScalar(a) ? b : a;
+    T s = detail::isScalar(a) ? a.getData()[0] : sign * b.getData()[0];
+    T msign = detail::isScalar(a) ? sign : static_cast<T>(1.e0);
+    size_t rows = m.getRows();
+    size_t n = rows * m.getCols();
+    std::unique_ptr<T[]> data(new T[n]);
+    std::fill(data.get(), data.get() + n, s);
+    for (size_t i = 0; i < m.getDatalen(); i++)
+    {
+      data[i + i * rows] += msign * m.getData()[i];
+    }
+    return makeConcreteDenseMatrix(data.release(), rows, m.getCols(), OWNER);
+  }
+  if (!sameShape)
+  {
+    detail::throwMismatch(a, b, subtract ? "-" : "+");
+  }
+  std::unique_ptr<T[]> data = detail::newDiagonal<T>(a.getRows(), a.getCols());
+  for (size_t i = 0; i < a.getDatalen(); i++)
+  {
+    data[i] = a.getData()[i] + sign * b.getData()[i];
+  }
+  return makeConcreteDiagonalMatrix(data.release(), a.getRows(), a.getCols(), OWNER);
+}
+
+template<typename T>
+OGNumeric::Ptr scale(const OGDiagonalMatrix<T>& a, T s)
+{
+  if (!detail::isFinite(s))
+  {
+    // An Inf or NaN scale makes NaN of the implicit zeros, which fills in the result
+    size_t rows = a.getRows();
+    size_t n = rows * a.getCols();
+    std::unique_ptr<T[]> data(new T[n]);
+    std::fill(data.get(), data.get() + n, s * T());
+    for (size_t i = 0; i < a.getDatalen(); i++)
+    {
+      data[i + i * rows] = s * a.getData()[i];
+    }
+    return makeConcreteDenseMatrix(data.release(), rows, a.getCols(), OWNER);
+  }
+  std::unique_ptr<T[]> data = detail::newDiagonal<T>(a.getRows(), a.getCols());
+  for (size_t i = 0; i < a.getDatalen(); i++)
+  {
+    data[i] = s * a.getData()[i];
+  }
+  return makeConcreteDiagonalMatrix(data.release(), a.getRows(), a.getCols(), OWNER);
+}
+
+template<typename T>
+OGNumeric::Ptr mtimes(const OGDiagonalMatrix<T>& a, const OGDiagonalMatrix<T>& b)
+{
+  if (detail::isScalar(a))
+  {
+    return scale(b, a.getData()[0]);
+  }
+  if (detail::isScalar(b))
+  {
+    return scale(a, b.getData()[0]);
+  }
+  detail::checkCommute(a, b);
+  size_t m = a.getRows();
+  size_t n = b.getCols();
+  size_t alen = a.getDatalen();
+  size_t blen = b.getDatalen();
+  const T * adata = a.getData();
+  const T * bdata = b.getData();
+  if (!detail::nonFinite(adata, alen).empty() || !detail::nonFinite(bdata, blen).empty())
+  {
+    // An Inf or NaN on one diagonal makes NaN against the implicit zeros of the other, so
+    // the result is dense. Only the terms a(i,i)*b(i,j) and a(i,j)*b(j,j) of entry (i,j)
+    // can differ from zero.
+    size_t k = a.getCols();
+    std::unique_ptr<T[]> data(new T[m * n]());
+    for (size_t j = 0; j < n; j++)
+    {
+      T bjj = j < blen ? bdata[j] : T();
+      for (size_t i = 0; i < m; i++)
+      {
+        T aii = i < alen ? adata[i] : T();
+        T& c = data[i + j * m];
+        if (i < k)
+        {
+          c += aii * (i == j ? bjj : T());
+        }
+        if (j < k && j != i)
+        {
+          c += T() * bjj;
+        }
+      }
+    }
+    return makeConcreteDenseMatrix(data.release(), m, n, OWNER);
+  }
+  // Entries beyond the shorter diagonal are zero
+  size_t len = std::min(alen, blen);
+  std::unique_ptr<T[]> data = detail::newDiagonal<T>(m, n);
+  for (size_t i = 0; i < len; i++)
+  {
+    data[i] = adata[i] * bdata[i];
+  }
+  return makeConcreteDiagonalMatrix(data.release(), m, n, OWNER);
+}
+
+template<typename T>
+OGNumeric::Ptr mtimes(const OGDiagonalMatrix<T>& a, const OGMatrix<T>& b)
+{
+  if (detail::isScalar(a))
+  {
+    return detail::scaleDense(b, a.getData()[0]);
+  }
+  if (detail::isScalar(b))
+  {
+    return scale(a, b.getData()[0]);
+  }
+  detail::checkCommute(a, b);
+  size_t m = a.getRows();
+  size_t k = a.getCols();
+  size_t n = b.getCols();
+  size_t len = a.getDatalen();
+  std::unique_ptr<T[]> data(new T[m * n]());
+  T * c = data.get();
+  const T * d = a.getData();
+  const T * bdata = b.getData();
+  for (size_t j = 0; j < n; j++)
+  {
+    for (size_t i = 0; i < len; i++)
+    {
+      c[i + j * m] = d[i] * bdata[i + j * k];
+    }
+  }
+  // An Inf or NaN in b makes NaN against the implicit zeros of a in every other row
+  for (size_t p: detail::nonFinite(bdata, b.getDatalen()))
+  {
+    size_t r = p % k;
+    size_t j = p / k;
+    for (size_t i = 0; i < m; i++)
+    {
+      if (i != r || i >= len)
+      {
+        c[i + j * m] += T() * bdata[p];
+      }
+    }
+  }
+  return makeConcreteDenseMatrix(data.release(), m, n, OWNER);
+}
+
+template<typename T>
+OGNumeric::Ptr mtimes(const OGMatrix<T>& a, const OGDiagonalMatrix<T>& b)
+{
+  if (detail::isScalar(a))
+  {
+    return scale(b, a.getData()[0]);
+  }
+  if (detail::isScalar(b))
+  {
+    return detail::scaleDense(a, b.getData()[0]);
+  }
+  detail::checkCommute(a, b);
+  size_t m = a.getRows();
+  size_t n = b.getCols();
+  size_t len = b.getDatalen();
+  std::unique_ptr<T[]> data(new T[m * n]());
+  T * c = data.get();
+  const T * adata = a.getData();
+  const T * d = b.getData();
+  for (size_t j = 0; j < len; j++)
+  {
+    for (size_t i = 0; i < m; i++)
+    {
+      c[i + j * m] = adata[i + j * m] * d[j];
+    }
+  }
+  // An Inf or NaN in a makes NaN against the implicit zeros of b in every other column
+  for (size_t p: detail::nonFinite(adata, a.getDatalen()))
+  {
+    size_t i = p % m;
+    size_t r = p / m;
+    for (size_t j = 0; j < n; j++)
+    {
+      if (j != r || j >= len)
+      {
+        c[i + j * m] += adata[p] * T();
+      }
+    }
+  }
+  return makeConcreteDenseMatrix(data.release(), m, n, OWNER);
+}
+
+/**
+ * Template instantiations
+ */
+
+template OGNumeric::Ptr plus<real8>(const OGDiagonalMatrix<real8>& a, const OGDiagonalMatrix<real8>& b, bool subtract);
+template OGNumeric::Ptr plus<complex16>(const OGDiagonalMatrix<complex16>& a, const OGDiagonalMatrix<complex16>& b, bool subtract);
+template OGNumeric::Ptr scale<real8>(const OGDiagonalMatrix<real8>& a, real8 s);
+template OGNumeric::Ptr scale<complex16>(const OGDiagonalMatrix<complex16>& a, complex16 s);
+template OGNumeric::Ptr mtimes<real8>(const OGDiagonalMatrix<real8>& a, const OGDiagonalMatrix<real8>& b);
+template OGNumeric::Ptr mtimes<complex16>(const OGDiagonalMatrix<complex16>& a, const OGDiagonalMatrix<complex16>& b);
+template OGNumeric::Ptr mtimes<real8>(const OGDiagonalMatrix<real8>& a, const OGMatrix<real8>& b);
+template OGNumeric::Ptr mtimes<complex16>(const OGDiagonalMatrix<complex16>& a, const OGMatrix<complex16>& b);
+template OGNumeric::Ptr mtimes<real8>(const OGMatrix<real8>& a, const OGDiagonalMatrix<real8>& b);
+template OGNumeric::Ptr mtimes<complex16>(const OGMatrix<complex16>& a, const OGDiagonalMatrix<complex16>& b);
+
+} // end namespace diagonal
+
+} // end namespace librdag
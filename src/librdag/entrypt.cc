@@ -6,11 +6,15 @@
 
 #include <stdio.h>
 #include "entrypt.hh"
+#include "cse.hh"
+#include "rewrite.hh"
 #include "dispatch.hh"
 #include "numeric.hh"
 #include "expression.hh"
 #include "execution.hh"
+#include "executor.hh"
 #include "terminal.hh"
+#include "threadpool.hh"
 #include "exprtypeenum.h"
 #include <typeinfo>
 #include <iostream>
@@ -21,43 +25,118 @@ using namespace std;
 namespace librdag
 {
 
+namespace detail
+{
+
+/**
+ * The pool asynchronous evaluations are queued on. It is separate from the pool used to
+ * execute graphs, which is recreated when the thread count changes and would then drop
+ * queued evaluations. Its threads spend most of their time in an execution, helping to
+ * run the nodes of their graph on the execution pool.
+ */
+static ThreadPool& getAsyncPool()
+{
+  static ThreadPool pool(ThreadPool::getHardwareThreadCount());
+  return pool;
+}
+
+/**
+ * Queue a call to entrypt on the asynchronous pool. Any exception is passed to the
+ * future, as tasks on a pool must not throw.
+ */
+template<typename T, typename A>
+std::future<T> submitEntrypt(const A& arg)
+{
+  std::shared_ptr<std::promise<T>> promise = std::make_shared<std::promise<T>>();
+  std::future<T> future = promise->get_future();
+  getAsyncPool().submit([promise, arg]()
+  {
+    try
+    {
+      promise->set_value(entrypt(arg));
+    }
+    catch (...)
+    {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return future;
+}
+
+} // namespace detail
+
 const OGTerminal::Ptr
 entrypt(const OGNumeric::Ptr& expr)
+{
+  return entrypt(vector<OGNumeric::Ptr>{expr})[0];
+}
+
+vector<OGTerminal::Ptr>
+entrypt(const vector<OGNumeric::Ptr>& exprs)
 {
   // Sort out LAPACK so xerbla calls don't kill the processes.
   int4 zero = 0;
   set_xerbla_death_switch(&zero);
 
-  OGTerminal::Ptr terminal = expr->asOGTerminal();
-  if (terminal != OGTerminal::Ptr{})
+  vector<OGTerminal::Ptr> results(exprs.size());
+  // The trees that need executing, and where their results go
+  vector<OGNumeric::Ptr> trees;
+  vector<size_t> slots;
+  for (size_t i = 0; i < exprs.size(); i++)
   {
-    // If we were passed a terminal, simply return it.
-    return terminal;
+    OGNumeric::Ptr tree = exprs[i];
+    if (Rewriter::getEnabled() && tree->asOGExpr() != OGExpr::Ptr{})
+    {
+      tree = Rewriter().rewrite(tree);
+    }
+    // If we were passed a terminal, or the tree simplified to one of its terminals,
+    // simply return it.
+    OGTerminal::Ptr terminal = tree->asOGTerminal();
+    if (terminal != OGTerminal::Ptr{})
+    {
+      results[i] = terminal;
+      continue;
+    }
+    trees.push_back(tree);
+    slots.push_back(i);
   }
-  else
+  if (trees.empty())
   {
-    ExecutionList el{expr};
-    Dispatcher disp;
-    
-    DEBUG_PRINT("Dispatching from entrypt\n");
+    return results;
+  }
 
-    for (auto it = el.begin(); it != el.end(); ++it)
-    {
-      OGExpr::Ptr expr = (*it)->asOGExpr();
-      if (expr != OGExpr::Ptr{})
-      {
-        disp.dispatch(expr);
-      }
-    }
+  // Identical subtrees only need computing once, within and across trees
+  trees = eliminateCommonSubexpressions(trees);
+  ExecutionList el{trees};
+  const Dispatcher& disp = Dispatcher::getInstance();
+
+  DEBUG_PRINT("Dispatching %d trees from entrypt\n", static_cast<int>(trees.size()));
 
-    const RegContainer& regs = expr->asOGExpr()->getRegs();
+  execute(el, disp);
+
+  for (size_t i = 0; i < trees.size(); i++)
+  {
+    const RegContainer& regs = trees[i]->asOGExpr()->getRegs();
     if(regs[0]->asOGTerminal() == nullptr)
     {
       throw rdag_error("Evaluated terminal is not casting asOGTerminal correctly.");
     }
-
-    return static_pointer_cast<const OGTerminal, const OGNumeric>(regs[0]);
+    // Transposed views are internal to the library, so are handed back as dense matrices
+    results[slots[i]] = materialiseView(static_pointer_cast<const OGTerminal, const OGNumeric>(regs[0]));
   }
+  return results;
+}
+
+future<OGTerminal::Ptr>
+entryptAsync(const OGNumeric::Ptr& expr)
+{
+  return detail::submitEntrypt<OGTerminal::Ptr>(expr);
+}
+
+future<vector<OGTerminal::Ptr>>
+entryptAsync(const vector<OGNumeric::Ptr>& exprs)
+{
+  return detail::submitEntrypt<vector<OGTerminal::Ptr>>(exprs);
 }
 
 } // namespace librdag
@@ -32,6 +32,8 @@ template <typename T> bool ArrayBitEquals(T * arr1, T * arr2, size_t count)
 template bool ArrayBitEquals(real8 * arr1, real8 * arr2, size_t count);
 template bool ArrayBitEquals(complex16 * arr1, complex16 * arr2, size_t count);
 template bool ArrayBitEquals(int4 * arr1, int4 * arr2, size_t count);
+template bool ArrayBitEquals(real4 * arr1, real4 * arr2, size_t count);
+template bool ArrayBitEquals(complex8 * arr1, complex8 * arr2, size_t count);
 
 template <typename T> bool ArrayFuzzyEquals(T * arr1, T * arr2, size_t count, real8 maxabserror, real8 maxrelerror)
 {
@@ -46,6 +48,8 @@ template <typename T> bool ArrayFuzzyEquals(T * arr1, T * arr2, size_t count, re
 
 template bool ArrayFuzzyEquals(real8 * arr1, real8 * arr2, size_t count, real8 maxabserror, real8 maxrelerror);
 template bool ArrayFuzzyEquals(complex16 * arr1, complex16 * arr2, size_t count, real8 maxabserror, real8 maxrelerror);
+template bool ArrayFuzzyEquals(real4 * arr1, real4 * arr2, size_t count, real8 maxabserror, real8 maxrelerror);
+template bool ArrayFuzzyEquals(complex8 * arr1, complex8 * arr2, size_t count, real8 maxabserror, real8 maxrelerror);
 
 
 /**
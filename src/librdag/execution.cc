@@ -5,6 +5,7 @@
  */
 
 #include <stack>
+#include <unordered_map>
 #include "expression.hh"
 #include "terminal.hh"
 #include "execution.hh"
@@ -14,6 +15,22 @@ namespace librdag {
 enum class Direction { UP, DOWN };
 
 ExecutionList::ExecutionList(const OGNumeric::Ptr& tree)
+{
+  _execList = new _ExpressionList();
+  append(tree);
+}
+
+ExecutionList::ExecutionList(const std::vector<OGNumeric::Ptr>& trees)
+{
+  _execList = new _ExpressionList();
+  for (auto& tree: trees)
+  {
+    append(tree);
+  }
+}
+
+void
+ExecutionList::append(const OGNumeric::Ptr& tree)
 {
   // Procedural construction of an execution list. The algorithm performs
   // a depth-first traversal of the tree, pushing nodes on to the execution
@@ -22,13 +39,23 @@ ExecutionList::ExecutionList(const OGNumeric::Ptr& tree)
   // children. In order to keep track of which child we got to when we
   // revisit an expression node, we keep a stack of argument positions
   // as well as a stack of nodes that we are visiting. 
-  
-  _execList = new _ExpressionList();
+  //
+  // A node may be reachable through more than one parent (the tree is really
+  // a DAG), but it must only be computed once. Nodes are recorded in a visited
+  // set, keyed on identity, as they are added to the list, and we turn straight
+  // back up whenever we arrive at one that is already there. Trees appended
+  // later see the nodes of earlier trees as visited.
 
   // treePos contains the list of nodes we've visited but not finished with
   std::stack<OGNumeric::Ptr> treePos;
   // argPos records how far down the arg of the node in a given position we've got
   std::stack<size_t> argPos;
+  // visited maps the nodes already in the execution list to their positions
+  std::unordered_map<const OGNumeric*, size_t> visited;
+  for (size_t pos = 0; pos < _execList->size(); pos++)
+  {
+    visited[(*_execList)[pos].get()] = pos;
+  }
 
   // Start by going downwards
   Direction dir = Direction::DOWN;
@@ -42,10 +69,21 @@ ExecutionList::ExecutionList(const OGNumeric::Ptr& tree)
     // Get the next work item
     OGNumeric::Ptr current = treePos.top();
 
+    if (dir == Direction::DOWN && visited.count(current.get()) != 0)
+    {
+      // We've already been here through another parent, so there is nothing
+      // more to do for this node. Go back up to where we came from.
+      treePos.pop();
+      argPos.pop();
+      dir = Direction::UP;
+      continue;
+    }
+
     ExprType_t type = current->getType();
     if (!(type & IS_NODE_MASK))
     {
       // We've got a terminal, This node is next to execute
+      visited[current.get()] = _execList->size();
       _execList->push_back(current);
       // Go back up to where we came from, by removing this node from the work stacks
       treePos.pop();
@@ -80,6 +118,7 @@ ExecutionList::ExecutionList(const OGNumeric::Ptr& tree)
           // Yes, so current node is next in execution list and we need to carry on upwards
           
           // Current node is next in the execution list
+          visited[current.get()] = _execList->size();
           _execList->push_back(current);
           // Go back to the previous node by removing this one from the stack
           argPos.pop();
@@ -97,6 +136,7 @@ ExecutionList::ExecutionList(const OGNumeric::Ptr& tree)
       }
     }
   }
+  _roots.push_back(visited.at(tree.get()));
 }
 
 ExecutionList::~ExecutionList()
@@ -128,4 +168,10 @@ ExecutionList::operator[](size_t n)
   return _execList->operator[](n);
 }
 
+const std::vector<size_t>&
+ExecutionList::getRoots()
+{
+  return _roots;
+}
+
 } // namespace librdag
@@ -0,0 +1,417 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include "executor.hh"
+#include "execution.hh"
+#include "dispatch.hh"
+#include "expression.hh"
+#include "threadpool.hh"
+#include "fusion.hh"
+#include "inference.hh"
+#include "trace.hh"
+#include "demand.hh"
+#include "debug.h"
+
+namespace librdag {
+
+namespace detail {
+
+static std::atomic<ExecutionMode> execution_mode{ExecutionMode::PARALLEL};
+static std::atomic<size_t> execution_threads{0};
+static std::atomic<bool> execution_fusion{true};
+
+// The pool shared by all parallel executions. It is (re)created on demand so that
+// changes to the thread count are picked up by the next execution.
+static std::mutex execution_pool_lock;
+static std::shared_ptr<ThreadPool> execution_pool;
+
+static std::shared_ptr<ThreadPool> getExecutionPool()
+{
+  std::lock_guard<std::mutex> lk(execution_pool_lock);
+  size_t nthreads = ExecutionOptions::getThreadCount();
+  if (execution_pool == nullptr || execution_pool->getThreadCount() != nthreads)
+  {
+    execution_pool = std::make_shared<ThreadPool>(nthreads);
+  }
+  return execution_pool;
+}
+
+/**
+ * Tracks which results are still needed during an execution of a graph. A node's
+ * registers are released once every node that depends on it is complete, unless it
+ * is a result of the execution, which counts as one more consumer that never completes.
+ */
+class Liveness: private Uncopyable
+{
+  public:
+    Liveness(const DependencyGraph& graph):
+      _graph(graph), _consumers(new std::atomic<size_t>[graph.size()])
+    {
+      for (size_t i = 0; i < graph.size(); i++)
+      {
+        _consumers[i] = graph.getDependents(i).size() + (graph.isResult(i) ? 1 : 0);
+      }
+    }
+
+    /**
+     * Get the dependencies of a node for which it is the last consumer still to run.
+     * Their results may be overwritten by the node.
+     */
+    std::vector<const OGNumeric*> getExpiring(size_t n) const
+    {
+      std::vector<const OGNumeric*> expiring;
+      for (size_t dep: _graph.getDependencies(n))
+      {
+        if (_consumers[dep].load() == 1)
+        {
+          expiring.push_back(_graph.getNode(dep).get());
+        }
+      }
+      return expiring;
+    }
+
+    /**
+     * Record that a node is complete, releasing the results no longer needed.
+     */
+    void complete(size_t n)
+    {
+      for (size_t dep: _graph.getDependencies(n))
+      {
+        if (--_consumers[dep] == 0)
+        {
+          DEBUG_PRINT("Releasing registers of node %d\n", static_cast<int>(dep));
+          _graph.getNode(dep)->asOGExpr()->getRegs().clear();
+        }
+      }
+    }
+
+  private:
+    const DependencyGraph& _graph;
+    std::unique_ptr<std::atomic<size_t>[]> _consumers;
+};
+
+/**
+ * State shared between the tasks of one parallel execution.
+ */
+class ParallelExecution: private Uncopyable
+{
+  public:
+    ParallelExecution(const DependencyGraph& graph, const Dispatcher& disp, ThreadPool& pool):
+      _graph(graph), _disp(disp), _pool(pool), _liveness(graph),
+      _pending(new std::atomic<size_t>[graph.size()]), _remaining{graph.size()}, _failed{false}
+    {
+      for (size_t i = 0; i < graph.size(); i++)
+      {
+        _pending[i] = graph.getDependencyCount(i);
+      }
+    }
+
+    void run()
+    {
+      for (size_t i = 0; i < _graph.size(); i++)
+      {
+        if (_graph.getDependencyCount(i) == 0)
+        {
+          submit(i);
+        }
+      }
+      _pool.runUntil([this]{ return _remaining.load() == 0; });
+      if (_error != nullptr)
+      {
+        std::rethrow_exception(_error);
+      }
+    }
+
+  private:
+    void submit(size_t n)
+    {
+      _pool.submit([this, n]{ runNode(n); });
+    }
+
+    void runNode(size_t n)
+    {
+      // Once something has failed the rest of the graph is drained without
+      // dispatching, so that run() sees every node complete.
+      if (!_failed)
+      {
+        try
+        {
+          _graph.dispatch(n, _disp, _liveness.getExpiring(n));
+          _liveness.complete(n);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lk(_errorLock);
+          if (!_failed)
+          {
+            _error = std::current_exception();
+            _failed = true;
+          }
+        }
+      }
+      for (size_t dependent: _graph.getDependents(n))
+      {
+        if (--_pending[dependent] == 0)
+        {
+          submit(dependent);
+        }
+      }
+      // Last, as this object may be destroyed as soon as _remaining reaches zero. The
+      // pool wakes the waiting caller once this task returns.
+      --_remaining;
+    }
+
+    const DependencyGraph& _graph;
+    const Dispatcher& _disp;
+    ThreadPool& _pool;
+    Liveness _liveness;
+    std::unique_ptr<std::atomic<size_t>[]> _pending;
+    std::atomic<size_t> _remaining;
+    std::atomic<bool> _failed;
+    std::mutex _errorLock;
+    std::exception_ptr _error;
+};
+
+static void runGraphSerial(const DependencyGraph& graph, const Dispatcher& disp)
+{
+  Liveness liveness(graph);
+  for (size_t i = 0; i < graph.size(); i++)
+  {
+    graph.dispatch(i, disp, liveness.getExpiring(i));
+    liveness.complete(i);
+  }
+}
+
+} // end namespace detail
+
+/*
+ * ExecutionOptions
+ */
+
+ExecutionMode
+ExecutionOptions::getMode()
+{
+  return detail::execution_mode.load();
+}
+
+void
+ExecutionOptions::setMode(ExecutionMode mode)
+{
+  detail::execution_mode = mode;
+}
+
+size_t
+ExecutionOptions::getThreadCount()
+{
+  size_t nthreads = detail::execution_threads.load();
+  return nthreads == 0 ? ThreadPool::getHardwareThreadCount() : nthreads;
+}
+
+void
+ExecutionOptions::setThreadCount(size_t nthreads)
+{
+  detail::execution_threads = nthreads;
+}
+
+bool
+ExecutionOptions::getFusion()
+{
+  return detail::execution_fusion.load();
+}
+
+void
+ExecutionOptions::setFusion(bool fusion)
+{
+  detail::execution_fusion = fusion;
+}
+
+/*
+ * DependencyGraph
+ */
+
+DependencyGraph::DependencyGraph(ExecutionList& el, bool fuse):
+  DependencyGraph(el, ExecutionPlan::create(el, fuse)) {}
+
+DependencyGraph::DependencyGraph(ExecutionList& el, const ExecutionPlan::Ptr& plan): _plan{plan}
+{
+  // Bind the positions of the plan to the nodes of this list
+  size_t nnodes = _plan->size();
+  _nodes.reserve(nnodes);
+  _kernels.reserve(nnodes);
+  for (size_t n = 0; n < nnodes; n++)
+  {
+    _nodes.push_back(el[_plan->getPosition(n)]);
+    const ExecutionPlan::Kernel * kernel = _plan->getKernel(n);
+    if (kernel == nullptr)
+    {
+      _kernels.push_back(nullptr);
+      continue;
+    }
+    std::vector<OGNumeric::Ptr> members;
+    for (size_t pos: kernel->members)
+    {
+      members.push_back(el[pos]);
+    }
+    std::vector<OGNumeric::Ptr> leaves;
+    for (size_t pos: kernel->leaves)
+    {
+      leaves.push_back(el[pos]);
+    }
+    _kernels.push_back(std::make_shared<const FusedKernel>(members, leaves, kernel->code));
+  }
+  if (_plan->getArenaSize() != 0)
+  {
+    _arena.reset(new char[_plan->getArenaSize()]);
+  }
+}
+
+DependencyGraph::~DependencyGraph()
+{
+  // Normally released as soon as they were consumed, unless execution failed
+  size_t offset, bytes;
+  for (size_t n = 0; n < _nodes.size(); n++)
+  {
+    if (_plan->getArenaSlot(n, offset, bytes))
+    {
+      _nodes[n]->asOGExpr()->getRegs().clear();
+    }
+  }
+}
+
+size_t
+DependencyGraph::size() const
+{
+  return _nodes.size();
+}
+
+const OGNumeric::Ptr&
+DependencyGraph::getNode(size_t n) const
+{
+  return _nodes[n];
+}
+
+size_t
+DependencyGraph::getDependencyCount(size_t n) const
+{
+  return _plan->getDependencyCount(n);
+}
+
+const std::vector<size_t>&
+DependencyGraph::getDependents(size_t n) const
+{
+  return _plan->getDependents(n);
+}
+
+const std::vector<size_t>&
+DependencyGraph::getDependencies(size_t n) const
+{
+  return _plan->getDependencies(n);
+}
+
+bool
+DependencyGraph::isResult(size_t n) const
+{
+  return _plan->isResult(n);
+}
+
+bool
+DependencyGraph::isSequential() const
+{
+  return _plan->isSequential();
+}
+
+const FusedKernel *
+DependencyGraph::getKernel(size_t n) const
+{
+  return _kernels[n].get();
+}
+
+void
+DependencyGraph::dispatch(size_t n, const Dispatcher& disp, const std::vector<const OGNumeric*>& expiring) const
+{
+  if (Tracer::getEnabled())
+  {
+    const FusedKernel * kernel = _kernels[n].get();
+    detail::NodeTrace trace(_nodes[n], kernel == nullptr ? _nodes[n]->asOGExpr()->getArgs() : kernel->getLeaves(),
+                            kernel == nullptr ? 1 : kernel->getMembers().size());
+    compute(n, disp, expiring);
+    trace.complete();
+    return;
+  }
+  compute(n, disp, expiring);
+}
+
+void
+DependencyGraph::compute(size_t n, const Dispatcher& disp, const std::vector<const OGNumeric*>& expiring) const
+{
+  size_t offset, bytes;
+  if (_kernels[n] != nullptr && _plan->getArenaSlot(n, offset, bytes))
+  {
+    _kernels[n]->execute(disp, expiring, _arena.get() + offset, bytes);
+  }
+  else if (_kernels[n] != nullptr)
+  {
+    _kernels[n]->execute(disp, expiring);
+  }
+  else
+  {
+    ResultDemand::Scope demand(_plan->getDemand(n));
+    disp.dispatch(_nodes[n]);
+  }
+}
+
+/*
+ * Execution
+ */
+
+void execute(ExecutionList& el, const Dispatcher& disp)
+{
+  if (ExecutionOptions::getMode() == ExecutionMode::SERIAL)
+  {
+    executeSerial(el, disp);
+    return;
+  }
+  DependencyGraph graph(el, PlanCache::getPlan(el, ExecutionOptions::getFusion()));
+  if (graph.isSequential() || ExecutionOptions::getThreadCount() == 1)
+  {
+    DEBUG_PRINT("Executing %d nodes serially\n", static_cast<int>(graph.size()));
+    detail::runGraphSerial(graph, disp);
+    return;
+  }
+  std::shared_ptr<ThreadPool> pool = detail::getExecutionPool();
+  DEBUG_PRINT("Executing %d nodes on %d threads\n", static_cast<int>(graph.size()),
+              static_cast<int>(pool->getThreadCount()));
+  detail::ParallelExecution(graph, disp, *pool).run();
+}
+
+void executeSerial(ExecutionList& el, const Dispatcher& disp)
+{
+  // Reject a bad tree before anything is run
+  TypeInference types(el);
+  for (auto it = el.begin(); it != el.end(); ++it)
+  {
+    if (Tracer::getEnabled() && (*it)->asOGExpr() != OGExpr::Ptr{})
+    {
+      detail::NodeTrace trace(*it, (*it)->asOGExpr()->getArgs());
+      disp.dispatch(*it);
+      trace.complete();
+      continue;
+    }
+    disp.dispatch(*it);
+  }
+}
+
+void executeParallel(ExecutionList& el, const Dispatcher& disp, ThreadPool& pool)
+{
+  DependencyGraph graph(el, PlanCache::getPlan(el, ExecutionOptions::getFusion()));
+  detail::ParallelExecution(graph, disp, pool).run();
+}
+
+} // end namespace librdag
@@ -102,6 +102,16 @@ COPY::copy() const
   return OGNumeric::Ptr{new COPY(_args[0]->copy())};
 }
 
+OGExpr::Ptr
+COPY::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 1)
+  {
+    throw rdag_error("COPY requires 1 argument");
+  }
+  return COPY::create(args[0]);
+}
+
 COPY::Ptr
 COPY::asCOPY() const
 {
@@ -153,6 +163,16 @@ SELECTRESULT::copy() const
   return OGNumeric::Ptr{new SELECTRESULT(_args[0]->copy(), _args[1]->copy())};
 }
 
+OGExpr::Ptr
+SELECTRESULT::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 2)
+  {
+    throw rdag_error("SELECTRESULT requires 2 arguments");
+  }
+  return SELECTRESULT::create(args[0], args[1]);
+}
+
 SELECTRESULT::Ptr
 SELECTRESULT::asSELECTRESULT() const
 {
@@ -191,6 +211,16 @@ NORM2::copy() const
   return OGNumeric::Ptr{new NORM2(_args[0]->copy())};
 }
 
+OGExpr::Ptr
+NORM2::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 1)
+  {
+    throw rdag_error("NORM2 requires 1 argument");
+  }
+  return NORM2::create(args[0]);
+}
+
 NORM2::Ptr
 NORM2::asNORM2() const
 {
@@ -228,6 +258,16 @@ PINV::copy() const
   return OGNumeric::Ptr{new PINV(_args[0]->copy())};
 }
 
+OGExpr::Ptr
+PINV::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 1)
+  {
+    throw rdag_error("PINV requires 1 argument");
+  }
+  return PINV::create(args[0]);
+}
+
 PINV::Ptr
 PINV::asPINV() const
 {
@@ -266,6 +306,16 @@ INV::copy() const
   return OGNumeric::Ptr{new INV(_args[0]->copy())};
 }
 
+OGExpr::Ptr
+INV::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 1)
+  {
+    throw rdag_error("INV requires 1 argument");
+  }
+  return INV::create(args[0]);
+}
+
 INV::Ptr
 INV::asINV() const
 {
@@ -304,6 +354,16 @@ TRANSPOSE::copy() const
   return OGNumeric::Ptr{new TRANSPOSE(_args[0]->copy())};
 }
 
+OGExpr::Ptr
+TRANSPOSE::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 1)
+  {
+    throw rdag_error("TRANSPOSE requires 1 argument");
+  }
+  return TRANSPOSE::create(args[0]);
+}
+
 TRANSPOSE::Ptr
 TRANSPOSE::asTRANSPOSE() const
 {
@@ -342,6 +402,16 @@ CTRANSPOSE::copy() const
   return OGNumeric::Ptr{new CTRANSPOSE(_args[0]->copy())};
 }
 
+OGExpr::Ptr
+CTRANSPOSE::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 1)
+  {
+    throw rdag_error("CTRANSPOSE requires 1 argument");
+  }
+  return CTRANSPOSE::create(args[0]);
+}
+
 CTRANSPOSE::Ptr
 CTRANSPOSE::asCTRANSPOSE() const
 {
@@ -378,6 +448,16 @@ SVD::copy() const
   return OGNumeric::Ptr{new SVD(_args[0]->copy())};
 }
 
+OGExpr::Ptr
+SVD::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 1)
+  {
+    throw rdag_error("SVD requires 1 argument");
+  }
+  return SVD::create(args[0]);
+}
+
 SVD::Ptr
 SVD::asSVD() const
 {
@@ -414,6 +494,16 @@ LU::copy() const
   return OGNumeric::Ptr{new LU(_args[0]->copy())};
 }
 
+OGExpr::Ptr
+LU::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 1)
+  {
+    throw rdag_error("LU requires 1 argument");
+  }
+  return LU::create(args[0]);
+}
+
 LU::Ptr
 LU::asLU() const
 {
@@ -452,6 +542,16 @@ MTIMES::copy() const
   return OGNumeric::Ptr{new MTIMES(_args[0]->copy(), _args[1]->copy())};
 }
 
+OGExpr::Ptr
+MTIMES::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 2)
+  {
+    throw rdag_error("MTIMES requires 2 arguments");
+  }
+  return MTIMES::create(args[0], args[1]);
+}
+
 MTIMES::Ptr
 MTIMES::asMTIMES() const
 {
@@ -490,6 +590,16 @@ MLDIVIDE::copy() const
   return OGNumeric::Ptr{new MLDIVIDE(_args[0]->copy(), _args[1]->copy())};
 }
 
+OGExpr::Ptr
+MLDIVIDE::withArgs(const ArgContainer& args) const
+{
+  if (args.size() != 2)
+  {
+    throw rdag_error("MLDIVIDE requires 2 arguments");
+  }
+  return MLDIVIDE::create(args[0], args[1]);
+}
+
 MLDIVIDE::Ptr
 MLDIVIDE::asMLDIVIDE() const
 {
@@ -0,0 +1,598 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <unordered_map>
+#include "fusion.hh"
+#include "dispatch.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "exceptions.hh"
+#include "debug.h"
+
+namespace librdag {
+
+namespace detail {
+
+// Number of elements computed per node before moving to the next node. Small enough
+// that the intermediates of a modest tree stay in L1.
+static const size_t FUSED_BLOCK_SIZE = 512;
+
+static bool getFusedOp(ExprType_t type, FusedOp& op)
+{
+  switch (type)
+  {
+    case PLUS_ENUM:    op = FusedOp::PLUS;    return true;
+    case MINUS_ENUM:   op = FusedOp::MINUS;   return true;
+    case TIMES_ENUM:   op = FusedOp::TIMES;   return true;
+    case RDIVIDE_ENUM: op = FusedOp::RDIVIDE; return true;
+    case NEGATE_ENUM:  op = FusedOp::NEGATE;  return true;
+    case ACOS_ENUM:    op = FusedOp::ACOS;    return true;
+    case ASINH_ENUM:   op = FusedOp::ASINH;   return true;
+    case ATAN_ENUM:    op = FusedOp::ATAN;    return true;
+    case COS_ENUM:     op = FusedOp::COS;     return true;
+    case EXP_ENUM:     op = FusedOp::EXP;     return true;
+    case SIN_ENUM:     op = FusedOp::SIN;     return true;
+    case SINH_ENUM:    op = FusedOp::SINH;    return true;
+    case TAN_ENUM:     op = FusedOp::TAN;     return true;
+    case TANH_ENUM:    op = FusedOp::TANH;    return true;
+    default:
+      return false;
+  }
+}
+
+/*
+ * Elementwise operations
+ */
+
+struct Plus    { template<typename T> T operator()(const T& a, const T& b) const { return a + b; } };
+struct Minus   { template<typename T> T operator()(const T& a, const T& b) const { return a - b; } };
+struct Times   { template<typename T> T operator()(const T& a, const T& b) const { return a * b; } };
+struct Rdivide { template<typename T> T operator()(const T& a, const T& b) const { return a / b; } };
+struct Negate  { template<typename T> T operator()(const T& a) const { return -a; } };
+struct Acos    { template<typename T> T operator()(const T& a) const { return std::acos(a); } };
+struct Asinh   { template<typename T> T operator()(const T& a) const { return std::asinh(a); } };
+struct Atan    { template<typename T> T operator()(const T& a) const { return std::atan(a); } };
+struct Cos     { template<typename T> T operator()(const T& a) const { return std::cos(a); } };
+struct Exp     { template<typename T> T operator()(const T& a) const { return std::exp(a); } };
+struct Sin     { template<typename T> T operator()(const T& a) const { return std::sin(a); } };
+struct Sinh    { template<typename T> T operator()(const T& a) const { return std::sinh(a); } };
+struct Tan     { template<typename T> T operator()(const T& a) const { return std::tan(a); } };
+struct Tanh    { template<typename T> T operator()(const T& a) const { return std::tanh(a); } };
+
+/**
+ * A value during execution of a kernel: a leaf, or the result of an instruction.
+ * Values with a single element are broadcast against the others, as the individual
+ * runners do.
+ */
+struct FusedValue
+{
+  bool complex;
+  size_t rows;
+  size_t cols;
+  // The data of a leaf, or the start of the block buffer of an instruction
+  real8 * realData;
+  complex16 * complexData;
+  // Storage for scalar leaves
+  real8 realValue;
+  complex16 complexValue;
+  bool leaf;
+  // Whether the data of a leaf may be overwritten and taken over by the result
+  bool donor;
+  size_t slot;
+
+  bool isBroadcast() const
+  {
+    return rows == 1 && cols == 1;
+  }
+};
+
+/**
+ * A pointer to the elements of a value for the current block. A broadcast value has
+ * a single element used for every position.
+ */
+template<typename T> struct Operand
+{
+  const T * data;
+  bool vector;
+};
+
+template<typename T> Operand<T> getOperand(const FusedValue& v, T * data, size_t start)
+{
+  if (v.isBroadcast())
+  {
+    return Operand<T>{data, false};
+  }
+  return Operand<T>{v.leaf ? data + start : data, true};
+}
+
+template<typename T, typename A, typename B, typename Op>
+void binaryLoop(const Op& op, size_t n, T * out, Operand<A> a, Operand<B> b)
+{
+  if (a.vector && b.vector)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      out[i] = op(T(a.data[i]), T(b.data[i]));
+    }
+  }
+  else if (a.vector)
+  {
+    const T bval = T(b.data[0]);
+    for (size_t i = 0; i < n; i++)
+    {
+      out[i] = op(T(a.data[i]), bval);
+    }
+  }
+  else if (b.vector)
+  {
+    const T aval = T(a.data[0]);
+    for (size_t i = 0; i < n; i++)
+    {
+      out[i] = op(aval, T(b.data[i]));
+    }
+  }
+  else
+  {
+    out[0] = op(T(a.data[0]), T(b.data[0]));
+  }
+}
+
+template<typename T, typename Op>
+void unaryLoop(const Op& op, size_t n, T * out, Operand<T> a)
+{
+  if (a.vector)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      out[i] = op(a.data[i]);
+    }
+  }
+  else
+  {
+    out[0] = op(a.data[0]);
+  }
+}
+
+template<typename Op>
+void applyBinary(const Op& op, size_t n, size_t start, FusedValue& out, const FusedValue& a,
+                 const FusedValue& b)
+{
+  if (!out.complex)
+  {
+    binaryLoop(op, n, out.realData, getOperand(a, a.realData, start), getOperand(b, b.realData, start));
+  }
+  else if (a.complex && b.complex)
+  {
+    binaryLoop(op, n, out.complexData, getOperand(a, a.complexData, start),
+               getOperand(b, b.complexData, start));
+  }
+  else if (a.complex)
+  {
+    binaryLoop(op, n, out.complexData, getOperand(a, a.complexData, start),
+               getOperand(b, b.realData, start));
+  }
+  else
+  {
+    binaryLoop(op, n, out.complexData, getOperand(a, a.realData, start),
+               getOperand(b, b.complexData, start));
+  }
+}
+
+template<typename Op>
+void applyUnary(const Op& op, size_t n, size_t start, FusedValue& out, const FusedValue& a)
+{
+  if (!out.complex)
+  {
+    unaryLoop(op, n, out.realData, getOperand(a, a.realData, start));
+  }
+  else
+  {
+    unaryLoop(op, n, out.complexData, getOperand(a, a.complexData, start));
+  }
+}
+
+static void apply(FusedOp op, size_t n, size_t start, FusedValue& out, const FusedValue& a,
+                  const FusedValue& b)
+{
+  switch (op)
+  {
+    case FusedOp::PLUS:    applyBinary(Plus(), n, start, out, a, b);    break;
+    case FusedOp::MINUS:   applyBinary(Minus(), n, start, out, a, b);   break;
+    case FusedOp::TIMES:   applyBinary(Times(), n, start, out, a, b);   break;
+    case FusedOp::RDIVIDE: applyBinary(Rdivide(), n, start, out, a, b); break;
+    case FusedOp::NEGATE:  applyUnary(Negate(), n, start, out, a);      break;
+    case FusedOp::ACOS:    applyUnary(Acos(), n, start, out, a);        break;
+    case FusedOp::ASINH:   applyUnary(Asinh(), n, start, out, a);       break;
+    case FusedOp::ATAN:    applyUnary(Atan(), n, start, out, a);        break;
+    case FusedOp::COS:     applyUnary(Cos(), n, start, out, a);         break;
+    case FusedOp::EXP:     applyUnary(Exp(), n, start, out, a);         break;
+    case FusedOp::SIN:     applyUnary(Sin(), n, start, out, a);         break;
+    case FusedOp::SINH:    applyUnary(Sinh(), n, start, out, a);        break;
+    case FusedOp::TAN:     applyUnary(Tan(), n, start, out, a);         break;
+    case FusedOp::TANH:    applyUnary(Tanh(), n, start, out, a);        break;
+  }
+}
+
+/**
+ * Set up a value for a leaf.
+ * @param leaf the leaf.
+ * @param expiring whether the leaf is the result of an expression that is not needed
+ * after the kernel.
+ * @param v the value to set up.
+ * @param term set to the terminal holding the value of the leaf.
+ * @param anyMatrix set to true if the leaf is a matrix.
+ * @return false if the fused loop cannot handle the leaf.
+ */
+static bool bindLeaf(const OGNumeric::Ptr& leaf, bool expiring, FusedValue& v, OGTerminal::Ptr& term,
+                     bool& anyMatrix)
+{
+  term = leaf->asOGTerminal();
+  if (term == OGTerminal::Ptr{})
+  {
+    const RegContainer& regs = leaf->asOGExpr()->getRegs();
+    // Only a buffer referenced by nothing but the register may be reused
+    expiring = expiring && regs.size() == 1 && regs[0].use_count() == 1;
+    term = regs[0]->asOGTerminal();
+  }
+  else
+  {
+    expiring = false;
+  }
+  v.leaf = true;
+  v.rows = term->getRows();
+  v.cols = term->getCols();
+  switch (term->getType())
+  {
+    case REAL_SCALAR_ENUM:
+      v.complex = false;
+      v.realValue = term->asOGRealScalar()->getValue();
+      v.realData = &v.realValue;
+      break;
+    case COMPLEX_SCALAR_ENUM:
+      v.complex = true;
+      v.complexValue = term->asOGComplexScalar()->getValue();
+      v.complexData = &v.complexValue;
+      break;
+    case REAL_DENSE_MATRIX_ENUM:
+      v.complex = false;
+      v.realData = term->asOGRealDenseMatrix()->getData();
+      v.donor = expiring && term->asOGRealDenseMatrix()->getDataAccess() == OWNER;
+      anyMatrix = true;
+      break;
+    case COMPLEX_DENSE_MATRIX_ENUM:
+      v.complex = true;
+      v.complexData = term->asOGComplexDenseMatrix()->getData();
+      v.donor = expiring && term->asOGComplexDenseMatrix()->getDataAccess() == OWNER;
+      anyMatrix = true;
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Allocates block buffers to instruction results, reusing those of consumed results.
+ */
+class SlotAllocator
+{
+  public:
+    SlotAllocator(): _count{0} {}
+    size_t acquire()
+    {
+      if (_free.empty())
+      {
+        return _count++;
+      }
+      size_t slot = _free.back();
+      _free.pop_back();
+      return slot;
+    }
+    void release(size_t slot)
+    {
+      _free.push_back(slot);
+    }
+    size_t getCount() const
+    {
+      return _count;
+    }
+  private:
+    size_t _count;
+    std::vector<size_t> _free;
+};
+
+} // end namespace detail
+
+bool
+FusedKernel::isFusible(const OGNumeric::Ptr& node)
+{
+  detail::FusedOp op;
+  return detail::getFusedOp(node->getType(), op);
+}
+
+FusedKernel::FusedKernel(const std::vector<OGNumeric::Ptr>& members): _members(members)
+{
+  if (_members.empty())
+  {
+    throw rdag_error("FusedKernel requires at least one member.");
+  }
+  // Values are numbered leaves first, then instructions, but the number of leaves is
+  // only known once all members have been seen, so instruction operands are first
+  // recorded as leaf indices or (complemented) member indices.
+  std::unordered_map<const OGNumeric*, size_t> memberIndex;
+  std::unordered_map<const OGNumeric*, size_t> leafIndex;
+  for (size_t i = 0; i < _members.size(); i++)
+  {
+    const OGNumeric::Ptr& member = _members[i];
+    detail::FusedInstruction ins;
+    if (!detail::getFusedOp(member->getType(), ins.op))
+    {
+      throw rdag_error("FusedKernel member is not an elementwise operation.");
+    }
+    const ArgContainer& args = member->asOGExpr()->getArgs();
+    ins.nargs = args.size();
+    for (size_t j = 0; j < args.size(); j++)
+    {
+      const OGNumeric * arg = args[j].get();
+      auto m = memberIndex.find(arg);
+      if (m != memberIndex.end())
+      {
+        ins.args[j] = ~m->second;
+        continue;
+      }
+      auto l = leafIndex.find(arg);
+      if (l == leafIndex.end())
+      {
+        l = leafIndex.insert(std::make_pair(arg, _leaves.size())).first;
+        _leaves.push_back(args[j]);
+      }
+      ins.args[j] = l->second;
+    }
+    _code.push_back(ins);
+    memberIndex[member.get()] = i;
+  }
+  size_t nleaves = _leaves.size();
+  for (auto& ins: _code)
+  {
+    for (size_t j = 0; j < ins.nargs; j++)
+    {
+      if (ins.args[j] >= nleaves)
+      {
+        ins.args[j] = nleaves + ~ins.args[j];
+      }
+    }
+  }
+}
+
+FusedKernel::FusedKernel(const std::vector<OGNumeric::Ptr>& members, const std::vector<OGNumeric::Ptr>& leaves,
+                         const std::vector<detail::FusedInstruction>& code):
+  _members(members), _leaves(leaves), _code(code)
+{
+  if (_members.empty() || _members.size() != _code.size())
+  {
+    throw rdag_error("FusedKernel requires one instruction per member.");
+  }
+}
+
+const OGNumeric::Ptr&
+FusedKernel::getRoot() const
+{
+  return _members.back();
+}
+
+const std::vector<OGNumeric::Ptr>&
+FusedKernel::getMembers() const
+{
+  return _members;
+}
+
+const std::vector<OGNumeric::Ptr>&
+FusedKernel::getLeaves() const
+{
+  return _leaves;
+}
+
+const std::vector<detail::FusedInstruction>&
+FusedKernel::getCode() const
+{
+  return _code;
+}
+
+void
+FusedKernel::execute(const Dispatcher& disp, const std::vector<const OGNumeric*>& expiring,
+                     void * buffer, size_t bytes) const
+{
+  if (executeFused(expiring, buffer, bytes))
+  {
+    return;
+  }
+  DEBUG_PRINT("Fused kernel of %d nodes falling back to dispatch\n", static_cast<int>(_members.size()));
+  for (auto& member: _members)
+  {
+    disp.dispatch(member);
+  }
+}
+
+bool
+FusedKernel::executeFused(const std::vector<const OGNumeric*>& expiring, void * buffer, size_t bytes) const
+{
+  using detail::FusedValue;
+  size_t nleaves = _leaves.size();
+  std::vector<FusedValue> values(nleaves + _code.size());
+
+  // Bind the leaves
+  std::vector<OGTerminal::Ptr> terms(nleaves);
+  bool anyMatrix = false;
+  for (size_t i = 0; i < nleaves; i++)
+  {
+    bool isExpiring = std::find(expiring.begin(), expiring.end(), _leaves[i].get()) != expiring.end();
+    if (!detail::bindLeaf(_leaves[i], isExpiring, values[i], terms[i], anyMatrix))
+    {
+      return false;
+    }
+  }
+  // All scalar trees produce scalars when run individually
+  if (!anyMatrix)
+  {
+    return false;
+  }
+
+  // Propagate types and shapes, and allocate block buffers for the intermediates
+  detail::SlotAllocator realSlots, complexSlots;
+  for (size_t i = 0; i < _code.size(); i++)
+  {
+    const detail::FusedInstruction& ins = _code[i];
+    FusedValue& v = values[nleaves + i];
+    const FusedValue& a = values[ins.args[0]];
+    v.leaf = false;
+    v.complex = a.complex;
+    v.rows = a.rows;
+    v.cols = a.cols;
+    if (ins.nargs == 2)
+    {
+      const FusedValue& b = values[ins.args[1]];
+      v.complex = a.complex || b.complex;
+      if (a.isBroadcast())
+      {
+        v.rows = b.rows;
+        v.cols = b.cols;
+      }
+      else if (!b.isBroadcast() && (a.rows != b.rows || a.cols != b.cols))
+      {
+        // Let the runner report the mismatch
+        return false;
+      }
+    }
+    v.slot = v.complex ? complexSlots.acquire() : realSlots.acquire();
+    for (size_t j = 0; j < ins.nargs; j++)
+    {
+      const FusedValue& arg = values[ins.args[j]];
+      if (!arg.leaf)
+      {
+        if (arg.complex)
+        {
+          complexSlots.release(arg.slot);
+        }
+        else
+        {
+          realSlots.release(arg.slot);
+        }
+      }
+    }
+  }
+
+  FusedValue& root = values.back();
+  size_t datalen = root.rows * root.cols;
+  if (datalen == 0)
+  {
+    return false;
+  }
+
+  const size_t blocksize = detail::FUSED_BLOCK_SIZE;
+  std::vector<real8> realBuffers(realSlots.getCount() * blocksize);
+  std::vector<complex16> complexBuffers(complexSlots.getCount() * blocksize);
+  for (size_t i = nleaves; i < values.size() - 1; i++)
+  {
+    FusedValue& v = values[i];
+    if (v.complex)
+    {
+      v.complexData = complexBuffers.data() + v.slot * blocksize;
+    }
+    else
+    {
+      v.realData = realBuffers.data() + v.slot * blocksize;
+    }
+  }
+
+  // The result is written over a leaf of the same type and size that is no longer
+  // needed if there is one; it is never read at an index after being written.
+  size_t donor = nleaves;
+  for (size_t i = 0; i < nleaves; i++)
+  {
+    const FusedValue& v = values[i];
+    if (v.donor && v.complex == root.complex && v.rows * v.cols == datalen)
+    {
+      donor = i;
+      break;
+    }
+  }
+  std::unique_ptr<real8[]> realResult;
+  std::unique_ptr<complex16[]> complexResult;
+  bool inBuffer = donor == nleaves && buffer != nullptr &&
+                  datalen * (root.complex ? sizeof(complex16) : sizeof(real8)) <= bytes;
+  if (donor != nleaves)
+  {
+    // The donor is referenced by nothing but its register, which is released after
+    // this kernel, so its data may be taken over.
+    DEBUG_PRINT("Fused kernel computing in place\n");
+    if (root.complex)
+    {
+      complexResult.reset(std::const_pointer_cast<OGComplexDenseMatrix>(
+                            terms[donor]->asOGComplexDenseMatrix())->releaseData());
+    }
+    else
+    {
+      realResult.reset(std::const_pointer_cast<OGRealDenseMatrix>(
+                         terms[donor]->asOGRealDenseMatrix())->releaseData());
+    }
+  }
+  else if (inBuffer)
+  {
+    DEBUG_PRINT("Fused kernel computing into a planned buffer\n");
+  }
+  else if (root.complex)
+  {
+    complexResult.reset(new complex16[datalen]);
+  }
+  else
+  {
+    realResult.reset(new real8[datalen]);
+  }
+
+  real8 * realOut = inBuffer ? static_cast<real8 *>(buffer) : realResult.get();
+  complex16 * complexOut = inBuffer ? static_cast<complex16 *>(buffer) : complexResult.get();
+  for (size_t start = 0; start < datalen; start += blocksize)
+  {
+    size_t len = std::min(blocksize, datalen - start);
+    if (root.complex)
+    {
+      root.complexData = complexOut + start;
+    }
+    else
+    {
+      root.realData = realOut + start;
+    }
+    for (size_t i = 0; i < _code.size(); i++)
+    {
+      const detail::FusedInstruction& ins = _code[i];
+      FusedValue& v = values[nleaves + i];
+      const FusedValue& a = values[ins.args[0]];
+      const FusedValue& b = values[ins.args[ins.nargs - 1]];
+      detail::apply(ins.op, v.isBroadcast() ? 1 : len, start, v, a, b);
+    }
+  }
+
+  OGNumeric::Ptr result;
+  // Space in a planned buffer belongs to the buffer
+  DATA_ACCESS access = inBuffer ? VIEWER : OWNER;
+  realResult.release();
+  complexResult.release();
+  if (root.complex)
+  {
+    result = OGComplexDenseMatrix::create(complexOut, root.rows, root.cols, access);
+  }
+  else
+  {
+    result = OGRealDenseMatrix::create(realOut, root.rows, root.cols, access);
+  }
+  getRoot()->asOGExpr()->getRegs().push_back(result);
+  return true;
+}
+
+} // end namespace librdag
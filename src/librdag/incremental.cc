@@ -0,0 +1,207 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <unordered_map>
+#include "incremental.hh"
+#include "dispatch.hh"
+#include "execution.hh"
+#include "executor.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "exceptions.hh"
+#include "lapack_raw.h"
+#include "debug.h"
+
+using namespace std;
+
+namespace librdag {
+
+/*
+ * IncrementalEvaluator
+ */
+
+IncrementalEvaluator::IncrementalEvaluator(const OGNumeric::Ptr& expr):
+  IncrementalEvaluator(vector<OGNumeric::Ptr>{expr}) {}
+
+IncrementalEvaluator::IncrementalEvaluator(const vector<OGNumeric::Ptr>& exprs): _roots{exprs}
+{
+  build();
+  for (size_t n = 0; n < _graph->size(); n++)
+  {
+    _dirty.insert(_graph->getNode(n).get());
+  }
+}
+
+IncrementalEvaluator::~IncrementalEvaluator()
+{
+  for (size_t n = 0; n < _graph->size(); n++)
+  {
+    _graph->getNode(n)->asOGExpr()->getRegs().clear();
+  }
+}
+
+void
+IncrementalEvaluator::build()
+{
+  // Nothing is fused, so that every node has registers of its own to keep, and
+  // nothing is placed in an arena.
+  unique_ptr<ExecutionList> el{new ExecutionList(_roots)};
+  unique_ptr<DependencyGraph> graph{new DependencyGraph(*el, PlanCache::getPlan(*el, false))};
+  _el = std::move(el);
+  _graph = std::move(graph);
+}
+
+vector<OGTerminal::Ptr>
+IncrementalEvaluator::evaluate()
+{
+  // Sort out LAPACK so xerbla calls don't kill the processes.
+  int4 zero = 0;
+  set_xerbla_death_switch(&zero);
+
+  DEBUG_PRINT("Recomputing %d of %d nodes\n", static_cast<int>(_dirty.size()),
+              static_cast<int>(_graph->size()));
+  const Dispatcher& disp = Dispatcher::getInstance();
+  // Graph order respects dependencies, so a dirty node is computed after its arguments
+  for (size_t n = 0; n < _graph->size() && !_dirty.empty(); n++)
+  {
+    const OGNumeric::Ptr& node = _graph->getNode(n);
+    if (_dirty.count(node.get()) == 0)
+    {
+      continue;
+    }
+    RegContainer& regs = node->asOGExpr()->getRegs();
+    regs.clear();
+    _graph->dispatch(n, disp);
+    _dirty.erase(node.get());
+  }
+
+  vector<OGTerminal::Ptr> results;
+  for (const OGNumeric::Ptr& root: _roots)
+  {
+    OGTerminal::Ptr terminal = root->asOGTerminal();
+    if (terminal == OGTerminal::Ptr{})
+    {
+      terminal = root->asOGExpr()->getRegs()[0]->asOGTerminal();
+    }
+    // Transposed views are internal to the library, so are handed back as dense matrices
+    results.push_back(materialiseView(terminal));
+  }
+  return results;
+}
+
+vector<size_t>
+IncrementalEvaluator::getCone(const OGTerminal::Ptr& terminal) const
+{
+  bool found = false;
+  for (const OGNumeric::Ptr& root: _roots)
+  {
+    found = found || root.get() == terminal.get();
+  }
+  vector<bool> reached(_graph->size(), false);
+  vector<size_t> cone;
+  for (size_t n = 0; n < _graph->size(); n++)
+  {
+    for (const OGNumeric::Ptr& arg: _graph->getNode(n)->asOGExpr()->getArgs())
+    {
+      reached[n] = reached[n] || arg.get() == terminal.get();
+    }
+    found = found || reached[n];
+    if (!reached[n])
+    {
+      continue;
+    }
+    cone.push_back(n);
+    for (size_t dependent: _graph->getDependents(n))
+    {
+      reached[dependent] = true;
+    }
+  }
+  if (!found)
+  {
+    throw rdag_error("Terminal is not in the trees being evaluated.");
+  }
+  return cone;
+}
+
+void
+IncrementalEvaluator::changed(const OGTerminal::Ptr& terminal)
+{
+  for (size_t n: getCone(terminal))
+  {
+    _dirty.insert(_graph->getNode(n).get());
+  }
+}
+
+void
+IncrementalEvaluator::replace(const OGTerminal::Ptr& terminal, const OGTerminal::Ptr& replacement)
+{
+  if (replacement == OGTerminal::Ptr{})
+  {
+    throw rdag_error("Null replacement terminal.");
+  }
+  vector<size_t> cone = getCone(terminal);
+
+  // Rebuild the cone, from the terminal up, over the replacement
+  unordered_map<const OGNumeric*, OGNumeric::Ptr> rebuilt;
+  rebuilt[terminal.get()] = replacement;
+  vector<OGNumeric::Ptr> replaced;
+  for (size_t n: cone)
+  {
+    const OGNumeric::Ptr& node = _graph->getNode(n);
+    ArgContainer args;
+    for (const OGNumeric::Ptr& arg: node->asOGExpr()->getArgs())
+    {
+      auto it = rebuilt.find(arg.get());
+      args.push_back(it == rebuilt.end() ? arg : it->second);
+    }
+    rebuilt[node.get()] = node->asOGExpr()->withArgs(args);
+    replaced.push_back(node);
+  }
+  vector<OGNumeric::Ptr> roots = _roots;
+  for (OGNumeric::Ptr& root: roots)
+  {
+    auto it = rebuilt.find(root.get());
+    if (it != rebuilt.end())
+    {
+      root = it->second;
+    }
+  }
+
+  // Check the new trees before anything is changed
+  swap(roots, _roots);
+  try
+  {
+    build();
+  }
+  catch (...)
+  {
+    swap(roots, _roots);
+    throw;
+  }
+
+  // The nodes replaced are no longer part of the trees, so their results are dropped
+  // and their replacements are computed instead
+  for (const OGNumeric::Ptr& node: replaced)
+  {
+    _dirty.erase(node.get());
+    node->asOGExpr()->getRegs().clear();
+    _dirty.insert(rebuilt[node.get()].get());
+  }
+}
+
+const vector<OGNumeric::Ptr>&
+IncrementalEvaluator::getRoots() const
+{
+  return _roots;
+}
+
+size_t
+IncrementalEvaluator::getDirtyCount() const
+{
+  return _dirty.size();
+}
+
+} // end namespace librdag
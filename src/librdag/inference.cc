@@ -0,0 +1,588 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <algorithm>
+#include <sstream>
+#include "inference.hh"
+#include "execution.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "exceptions.hh"
+
+namespace librdag {
+
+namespace detail {
+
+static bool isComplexType(ExprType_t type)
+{
+  switch (type)
+  {
+    case COMPLEX_SCALAR_ENUM:
+    case COMPLEX_DENSE_MATRIX_ENUM:
+    case COMPLEX_DIAGONAL_MATRIX_ENUM:
+    case COMPLEX_SPARSE_MATRIX_ENUM:
+    case COMPLEX_SINGLE_DENSE_MATRIX_ENUM:
+    case COMPLEX_TRANSPOSED_MATRIX_ENUM:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool isSingleType(ExprType_t type)
+{
+  return type == REAL_SINGLE_DENSE_MATRIX_ENUM || type == COMPLEX_SINGLE_DENSE_MATRIX_ENUM;
+}
+
+/**
+ * Whether a binary node has runners computing a pair of single precision matrices of the
+ * same kind in single precision. Every other node widens them to double.
+ */
+static bool hasSingleRunner(ExprType_t node)
+{
+  switch (node)
+  {
+    case PLUS_ENUM:
+    case MINUS_ENUM:
+    case TIMES_ENUM:
+    case RDIVIDE_ENUM:
+    case MTIMES_ENUM:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * The type the dispatcher converts the argument of a unary node to. Runners handle
+ * real scalars and dense matrices. Integers are made real scalars, everything else a
+ * dense matrix, complex only if the argument is. Single precision is widened.
+ */
+static ExprType_t unaryArgType(ExprType_t type)
+{
+  switch (type)
+  {
+    case UNKNOWN_EXPR_ENUM:
+    case REAL_SCALAR_ENUM:
+    case REAL_DENSE_MATRIX_ENUM:
+    case COMPLEX_DENSE_MATRIX_ENUM:
+      return type;
+    case INTEGER_SCALAR_ENUM:
+      return REAL_SCALAR_ENUM;
+    default:
+      return isComplexType(type) ? COMPLEX_DENSE_MATRIX_ENUM : REAL_DENSE_MATRIX_ENUM;
+  }
+}
+
+/**
+ * The type the dispatcher converts both arguments of a binary node to. Runners handle
+ * pairs of real scalars and of dense matrices of the same kind, everything else is
+ * made a dense matrix, complex if either argument is.
+ */
+static ExprType_t binaryArgType(ExprType_t type0, ExprType_t type1)
+{
+  if (type0 == UNKNOWN_EXPR_ENUM || type1 == UNKNOWN_EXPR_ENUM)
+  {
+    return UNKNOWN_EXPR_ENUM;
+  }
+  if (type0 == type1 && unaryArgType(type0) == type0)
+  {
+    return type0;
+  }
+  return isComplexType(type0) || isComplexType(type1) ? COMPLEX_DENSE_MATRIX_ENUM : REAL_DENSE_MATRIX_ENUM;
+}
+
+static bool isScalarType(ExprType_t type)
+{
+  switch (type)
+  {
+    case REAL_SCALAR_ENUM:
+    case COMPLEX_SCALAR_ENUM:
+    case INTEGER_SCALAR_ENUM:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * The storage of a terminal type, as far as the sparse and diagonal runners are
+ * concerned.
+ */
+enum class Storage { OTHER, SCALAR, DENSE, SPARSE, DIAGONAL };
+
+static Storage getStorage(ExprType_t type)
+{
+  switch (type)
+  {
+    case REAL_SCALAR_ENUM:
+    case COMPLEX_SCALAR_ENUM:
+      return Storage::SCALAR;
+    case REAL_DENSE_MATRIX_ENUM:
+    case COMPLEX_DENSE_MATRIX_ENUM:
+      return Storage::DENSE;
+    case REAL_SPARSE_MATRIX_ENUM:
+    case COMPLEX_SPARSE_MATRIX_ENUM:
+      return Storage::SPARSE;
+    case REAL_DIAGONAL_MATRIX_ENUM:
+    case COMPLEX_DIAGONAL_MATRIX_ENUM:
+      return Storage::DIAGONAL;
+    default:
+      return Storage::OTHER;
+  }
+}
+
+static bool isStructured(Storage storage)
+{
+  return storage == Storage::SPARSE || storage == Storage::DIAGONAL;
+}
+
+/**
+ * Whether a binary node has runners for a structured storage, see sparse.hh and
+ * diagonal.hh.
+ */
+static bool hasStructuredRunner(ExprType_t node, Storage storage)
+{
+  switch (node)
+  {
+    case PLUS_ENUM:
+    case MINUS_ENUM:
+    case MTIMES_ENUM:
+      return true;
+    case TIMES_ENUM:
+      return storage == Storage::SPARSE;
+    default:
+      return false;
+  }
+}
+
+/**
+ * The type of the result of an infix node or MTIMES. A pair of scalars of any kind gives
+ * a scalar, and a pair of single precision matrices of the same kind stays in single
+ * precision. Arguments with a sparse or diagonal runner give a type that can depend on
+ * which argument is 1x1. Other arguments are converted as binaryArgType describes.
+ * @return the type, UNKNOWN_EXPR_ENUM if it depends on a shape that is not known.
+ */
+static ExprType_t binaryResultType(ExprType_t node, const ValueInfo& a, const ValueInfo& b)
+{
+  if (isScalarType(a.type) && isScalarType(b.type))
+  {
+    return isComplexType(a.type) || isComplexType(b.type) ? COMPLEX_SCALAR_ENUM : REAL_SCALAR_ENUM;
+  }
+  if (a.type == b.type && isSingleType(a.type) && hasSingleRunner(node))
+  {
+    return a.type;
+  }
+  Storage s0 = getStorage(a.type);
+  Storage s1 = getStorage(b.type);
+  // The structured storage, of which there may be only one kind
+  Storage structured = isStructured(s0) ? s0 : s1;
+  bool native = isStructured(structured) && hasStructuredRunner(node, structured) &&
+                (s0 == structured || s0 == Storage::SCALAR || s0 == Storage::DENSE) &&
+                (s1 == structured || s1 == Storage::SCALAR || s1 == Storage::DENSE) &&
+                isComplexType(a.type) == isComplexType(b.type);
+  bool bothStructured = s0 == structured && s1 == structured;
+  if (!native || ((node == PLUS_ENUM || node == MINUS_ENUM) && !bothStructured))
+  {
+    return binaryArgType(a.type, b.type);
+  }
+  bool complex = isComplexType(a.type);
+  ExprType_t structuredType = structured == Storage::SPARSE ?
+                              (complex ? COMPLEX_SPARSE_MATRIX_ENUM : REAL_SPARSE_MATRIX_ENUM) :
+                              (complex ? COMPLEX_DIAGONAL_MATRIX_ENUM : REAL_DIAGONAL_MATRIX_ENUM);
+  ExprType_t denseType = complex ? COMPLEX_DENSE_MATRIX_ENUM : REAL_DENSE_MATRIX_ENUM;
+  if (s0 == Storage::SCALAR || s1 == Storage::SCALAR || (bothStructured && node != PLUS_ENUM && node != MINUS_ENUM))
+  {
+    return structuredType;
+  }
+  if (!a.shapeKnown || !b.shapeKnown)
+  {
+    return UNKNOWN_EXPR_ENUM;
+  }
+  bool scalar0 = a.rows == 1 && a.cols == 1;
+  bool scalar1 = b.rows == 1 && b.cols == 1;
+  if (bothStructured)
+  {
+    // Adding a 1x1 matrix to a larger one fills it in
+    return (scalar0 || scalar1) && (a.rows != b.rows || a.cols != b.cols) ? denseType : structuredType;
+  }
+  // One structured and one dense matrix, a 1x1 dense one scales the structured one
+  bool denseScalar = s0 == Storage::DENSE ? scalar0 : scalar1;
+  bool structuredScalar = s0 == structured ? scalar0 : scalar1;
+  if (node == TIMES_ENUM)
+  {
+    return !denseScalar && structuredScalar ? denseType : structuredType;
+  }
+  // MTIMES checks whether its first argument is 1x1 first
+  if (scalar0)
+  {
+    return s0 == structured ? denseType : structuredType;
+  }
+  if (scalar1)
+  {
+    return s1 == structured ? denseType : structuredType;
+  }
+  return denseType;
+}
+
+/**
+ * The type of the scalar a runner makes of a 1x1 dense matrix, where it does not
+ * depend on the data.
+ */
+static ExprType_t scalarType(ExprType_t denseType)
+{
+  return denseType == REAL_DENSE_MATRIX_ENUM ? REAL_SCALAR_ENUM : COMPLEX_SCALAR_ENUM;
+}
+
+static bool isOneByOne(const ValueInfo& v)
+{
+  return v.shapeKnown && v.rows == 1 && v.cols == 1;
+}
+
+static ValueInfo withType(ExprType_t type)
+{
+  ValueInfo v;
+  v.type = type;
+  return v;
+}
+
+static ValueInfo inferInfix(ExprType_t node, const char * symbol, const ValueInfo& a, const ValueInfo& b)
+{
+  ExprType_t type = binaryResultType(node, a, b);
+  if (a.shapeKnown && b.shapeKnown)
+  {
+    if (isOneByOne(a))
+    {
+      return ValueInfo(type, b.rows, b.cols);
+    }
+    if (!isOneByOne(b) && (a.rows != b.rows || a.cols != b.cols))
+    {
+      std::stringstream s;
+      s << "Matrix dimensions ";
+      s << "(" << a.rows << "," << a.cols << ")";
+      s << " and ";
+      s << "(" << b.rows << "," << b.cols << ")";
+      s << " mismatch for operation: " << symbol;
+      throw rdag_error(s.str());
+    }
+    return ValueInfo(type, a.rows, a.cols);
+  }
+  // Whichever is not broadcast gives the shape, if the runner does not throw
+  if (a.shapeKnown && !isOneByOne(a))
+  {
+    return ValueInfo(type, a.rows, a.cols);
+  }
+  if (b.shapeKnown && !isOneByOne(b))
+  {
+    return ValueInfo(type, b.rows, b.cols);
+  }
+  return withType(type);
+}
+
+static ValueInfo inferMtimes(const ValueInfo& a, const ValueInfo& b)
+{
+  ExprType_t type = binaryResultType(MTIMES_ENUM, a, b);
+  if (type == REAL_DIAGONAL_MATRIX_ENUM || type == COMPLEX_DIAGONAL_MATRIX_ENUM)
+  {
+    // The product is diagonal unless an Inf or NaN makes NaN of its implicit zeros,
+    // which depends on the data
+    type = UNKNOWN_EXPR_ENUM;
+  }
+  if (type == REAL_SCALAR_ENUM || type == COMPLEX_SCALAR_ENUM)
+  {
+    return ValueInfo(type, 1, 1);
+  }
+  if (!a.shapeKnown || !b.shapeKnown)
+  {
+    return withType(type);
+  }
+  if (isOneByOne(a))
+  {
+    return ValueInfo(type, b.rows, b.cols);
+  }
+  if (isOneByOne(b))
+  {
+    return ValueInfo(type, a.rows, a.cols);
+  }
+  if (a.cols != b.rows)
+  {
+    std::stringstream message;
+    message << "Matrices do not commute. First is: " << a.rows << "x" << a.cols << ". Second is: " << b.rows << "x" << b.cols;
+    throw rdag_error(message.str());
+  }
+  return ValueInfo(type, a.rows, b.cols);
+}
+
+static ValueInfo inferMldivide(const ValueInfo& a, const ValueInfo& b)
+{
+  ExprType_t type = binaryArgType(a.type, b.type);
+  if (type == REAL_SCALAR_ENUM)
+  {
+    return ValueInfo(type, 1, 1);
+  }
+  if (!a.shapeKnown || !b.shapeKnown)
+  {
+    return withType(type);
+  }
+  if (a.rows != b.rows)
+  {
+    std::stringstream msg;
+    msg << "System does not commute. Rows in arg0: " << a.rows << ". Rows in arg1 " << b.rows << std::endl;
+    throw rdag_unrecoverable_error(msg.str());
+  }
+  // The shape of a least squares solution is left to the runner
+  return a.rows == a.cols ? ValueInfo(type, b.rows, b.cols) : withType(type);
+}
+
+/**
+ * TRANSPOSE, CTRANSPOSE, INV and PINV make a scalar of a 1x1 matrix.
+ * @param a the argument.
+ * @param swap whether the shape of the result is that of the argument transposed.
+ * @param scalarKnown whether the type of the scalar made does not depend on the data.
+ */
+static ValueInfo inferMatrixFunction(const ValueInfo& a, bool swap, bool scalarKnown)
+{
+  ExprType_t type = unaryArgType(a.type);
+  if (type == REAL_SCALAR_ENUM)
+  {
+    return ValueInfo(type, 1, 1);
+  }
+  if (type == UNKNOWN_EXPR_ENUM || !a.shapeKnown)
+  {
+    // Could yet be a scalar
+    return ValueInfo();
+  }
+  if (isOneByOne(a))
+  {
+    if (scalarKnown || type == REAL_DENSE_MATRIX_ENUM)
+    {
+      return ValueInfo(scalarType(type), 1, 1);
+    }
+    ValueInfo v;
+    v.shapeKnown = true;
+    v.rows = 1;
+    v.cols = 1;
+    return v;
+  }
+  return swap ? ValueInfo(type, a.cols, a.rows) : ValueInfo(type, a.rows, a.cols);
+}
+
+/**
+ * TRANSPOSE and CTRANSPOSE view a dense matrix transposed rather than copying it.
+ * @param v the result as inferMatrixFunction gives it.
+ * @return the result, a transposed view if \a v is a dense matrix.
+ */
+static ValueInfo inferTransposedView(ValueInfo v)
+{
+  if (v.type == REAL_DENSE_MATRIX_ENUM)
+  {
+    v.type = REAL_TRANSPOSED_MATRIX_ENUM;
+  }
+  else if (v.type == COMPLEX_DENSE_MATRIX_ENUM)
+  {
+    v.type = COMPLEX_TRANSPOSED_MATRIX_ENUM;
+  }
+  return v;
+}
+
+/**
+ * INV and PINV keep a diagonal matrix diagonal, see diagonal.hh.
+ * @param a the argument.
+ * @return the result, of the shape of the argument transposed.
+ */
+static ValueInfo inferDiagonalInverse(const ValueInfo& a)
+{
+  return a.shapeKnown ? ValueInfo(a.type, a.cols, a.rows) : withType(a.type);
+}
+
+static std::vector<ValueInfo> inferSelectResult(const OGExpr::Ptr& expr, const std::vector<ValueInfo>& results)
+{
+  OGIntegerScalar::Ptr index = expr->getArgs()[1]->asOGIntegerScalar();
+  if (index->getValue() >= 0 && static_cast<size_t>(index->getValue()) < results.size())
+  {
+    return {results[index->getValue()]};
+  }
+  // Only the nodes filling more than one register are known to fill no more
+  ExprType_t from = expr->getArgs()[0]->getType();
+  if (from == SVD_ENUM || from == LU_ENUM)
+  {
+    std::stringstream message;
+    message << "Cannot select result " << index->getValue() << " of a node with " << results.size() << " results.";
+    throw rdag_error(message.str());
+  }
+  return {ValueInfo()};
+}
+
+} // end namespace detail
+
+/*
+ * ValueInfo
+ */
+
+ValueInfo::ValueInfo(): type{UNKNOWN_EXPR_ENUM}, shapeKnown{false}, rows{0}, cols{0} {}
+
+ValueInfo::ValueInfo(ExprType_t type, size_t rows, size_t cols):
+  type{type}, shapeKnown{true}, rows{rows}, cols{cols} {}
+
+bool
+ValueInfo::isDense() const
+{
+  return type == REAL_DENSE_MATRIX_ENUM || type == COMPLEX_DENSE_MATRIX_ENUM;
+}
+
+/*
+ * TypeInference
+ */
+
+std::vector<ValueInfo>
+TypeInference::infer(const OGNumeric::Ptr& node, const std::vector<std::vector<ValueInfo>>& args)
+{
+  OGTerminal::Ptr term = node->asOGTerminal();
+  if (term != OGTerminal::Ptr{})
+  {
+    return {ValueInfo(term->getType(), term->getRows(), term->getCols())};
+  }
+  const ValueInfo& a = args[0][0];
+  const ValueInfo& b = args[args.size() - 1][0];
+  switch (node->getType())
+  {
+    case PLUS_ENUM:
+      return {detail::inferInfix(PLUS_ENUM, "+", a, b)};
+    case MINUS_ENUM:
+      return {detail::inferInfix(MINUS_ENUM, "-", a, b)};
+    case TIMES_ENUM:
+      return {detail::inferInfix(TIMES_ENUM, "*", a, b)};
+    case RDIVIDE_ENUM:
+      return {detail::inferInfix(RDIVIDE_ENUM, "/", a, b)};
+    case NEGATE_ENUM:
+    case ASINH_ENUM:
+    case ATAN_ENUM:
+    case SIN_ENUM:
+    case SINH_ENUM:
+    case TAN_ENUM:
+    case TANH_ENUM:
+    {
+      // These map zero to zero, so have runners keeping diagonal and sparse matrices so
+      ValueInfo v = a;
+      if (!detail::isStructured(detail::getStorage(a.type)))
+      {
+        v.type = detail::unaryArgType(a.type);
+      }
+      return {v};
+    }
+    case ACOS_ENUM:
+    case COS_ENUM:
+    case EXP_ENUM:
+    {
+      ValueInfo v = a;
+      v.type = detail::unaryArgType(a.type);
+      return {v};
+    }
+    case MTIMES_ENUM:
+      return {detail::inferMtimes(a, b)};
+    case MLDIVIDE_ENUM:
+      return {detail::inferMldivide(a, b)};
+    case TRANSPOSE_ENUM:
+    case CTRANSPOSE_ENUM:
+      return {detail::inferTransposedView(detail::inferMatrixFunction(a, true, true))};
+    case INV_ENUM:
+      if (a.shapeKnown && a.rows != a.cols)
+      {
+        std::stringstream message;
+        message << "Cannot invert a matrix that is not square. Matrix presented has shape: [" << a.rows <<"x"<< a.cols <<"].";
+        throw rdag_error(message.str());
+      }
+      if (detail::getStorage(a.type) == detail::Storage::DIAGONAL)
+      {
+        return {detail::inferDiagonalInverse(a)};
+      }
+      return {detail::inferMatrixFunction(a, false, false)};
+    case PINV_ENUM:
+      if (detail::getStorage(a.type) == detail::Storage::DIAGONAL)
+      {
+        return {detail::inferDiagonalInverse(a)};
+      }
+      return {detail::inferMatrixFunction(a, true, false)};
+    case NORM2_ENUM:
+      return {ValueInfo(REAL_SCALAR_ENUM, 1, 1)};
+    case SVD_ENUM:
+    {
+      ExprType_t type = detail::unaryArgType(a.type);
+      if (type == REAL_SCALAR_ENUM)
+      {
+        return std::vector<ValueInfo>(3, ValueInfo(type, 1, 1));
+      }
+      if (type == UNKNOWN_EXPR_ENUM || !a.shapeKnown)
+      {
+        return {detail::withType(type), detail::withType(REAL_DIAGONAL_MATRIX_ENUM), detail::withType(type)};
+      }
+      return {ValueInfo(type, a.rows, a.rows), ValueInfo(REAL_DIAGONAL_MATRIX_ENUM, a.rows, a.cols),
+              ValueInfo(type, a.cols, a.cols)};
+    }
+    case LU_ENUM:
+    {
+      ExprType_t type = detail::unaryArgType(a.type);
+      if (type == REAL_SCALAR_ENUM)
+      {
+        return std::vector<ValueInfo>(2, ValueInfo(type, 1, 1));
+      }
+      if (type == UNKNOWN_EXPR_ENUM || !a.shapeKnown)
+      {
+        return std::vector<ValueInfo>(2, detail::withType(type));
+      }
+      size_t k = std::min(a.rows, a.cols);
+      return {ValueInfo(type, a.rows, k), ValueInfo(type, k, a.cols)};
+    }
+    case SELECTRESULT_ENUM:
+      return detail::inferSelectResult(node->asOGExpr(), args[0]);
+    default:
+      // No runner, or one that is not modelled
+      return {ValueInfo()};
+  }
+}
+
+TypeInference::TypeInference(ExecutionList& el)
+{
+  std::vector<std::vector<ValueInfo>> args;
+  for (auto it = el.begin(); it != el.end(); ++it)
+  {
+    const OGNumeric::Ptr& node = *it;
+    if (_results.count(node.get()) != 0)
+    {
+      continue;
+    }
+    args.clear();
+    OGExpr::Ptr expr = node->asOGExpr();
+    if (expr != OGExpr::Ptr{})
+    {
+      // The list is in execution order so every argument is already inferred.
+      for (auto& arg: expr->getArgs())
+      {
+        args.push_back(_results.at(arg.get()));
+      }
+    }
+    _results.emplace(node.get(), infer(node, args));
+  }
+}
+
+const std::vector<ValueInfo>&
+TypeInference::getResults(const OGNumeric::Ptr& node) const
+{
+  auto found = _results.find(node.get());
+  if (found == _results.end())
+  {
+    throw rdag_error("Node is not in the execution list the types were inferred for.");
+  }
+  return found->second;
+}
+
+const ValueInfo&
+TypeInference::getResult(const OGNumeric::Ptr& node) const
+{
+  return getResults(node)[0];
+}
+
+} // end namespace librdag
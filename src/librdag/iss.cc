@@ -64,6 +64,14 @@ bool isReal(const OGTerminal::Ptr& terminal)
   {
     return true;
   }
+  if(terminal->asOGRealSingleDenseMatrix()!=nullptr)
+  {
+    return true;
+  }
+  if(terminal->asOGRealTransposedMatrix()!=nullptr)
+  {
+    return true;
+  }
   if(terminal->asOGIntegerScalar()!=nullptr)
   {
     return true;
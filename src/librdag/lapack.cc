@@ -19,6 +19,7 @@ namespace detail
   char N = 'N';
   char A = 'A';
   char T = 'T';
+  char C = 'C';
   char L = 'L';
   char U = 'U';
   char D = 'D';
@@ -98,6 +99,18 @@ namespace detail
     F77FUNC(zgemm)(TRANSA, TRANSB, M, N, K, ALPHA, A, LDA, B, LDB, BETA, C, LDC );
   }
 
+  template<> void
+  xgemm(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K, real4 * ALPHA, real4 * A, int4 * LDA, real4 * B, int4 * LDB, real4 * BETA, real4 * C, int4 * LDC )
+  {
+    F77FUNC(sgemm)(TRANSA, TRANSB, M, N, K, ALPHA, A, LDA, B, LDB, BETA, C, LDC );
+  }
+
+  template<> void
+  xgemm(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K, complex8 * ALPHA, complex8 * A, int4 * LDA, complex8 * B, int4 * LDB, complex8 * BETA, complex8 * C, int4 * LDC )
+  {
+    F77FUNC(cgemm)(TRANSA, TRANSB, M, N, K, ALPHA, A, LDA, B, LDB, BETA, C, LDC );
+  }
+
   // xNORM2 specialisations
   template<> real8 xnrm2(int4 * N, real8 * X, int4 * INCX)
   {
@@ -336,6 +349,7 @@ namespace detail
 char *      N     = &detail::N;
 char *      A     = &detail::A;
 char *      T     = &detail::T;
+char *      C     = &detail::C;
 char *      L     = &detail::L;
 char *      U     = &detail::U;
 char *      D     = &detail::D;
@@ -387,6 +401,8 @@ xgemm(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K, T * ALPHA, T *
 }
 template void xgemm<real8>(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K, real8 * ALPHA, real8 * A, int4 * LDA, real8 * B, int4 * LDB, real8 * BETA, real8 * C, int4 * LDC );
 template void xgemm<complex16>(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K, complex16 * ALPHA, complex16 * A, int4 * LDA, complex16 * B, int4 * LDB, complex16 * BETA, complex16 * C, int4 * LDC );
+template void xgemm<real4>(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K, real4 * ALPHA, real4 * A, int4 * LDA, real4 * B, int4 * LDB, real4 * BETA, real4 * C, int4 * LDC );
+template void xgemm<complex8>(char * TRANSA, char * TRANSB, int4 * M, int4 * N, int4 * K, complex8 * ALPHA, complex8 * A, int4 * LDA, complex8 * B, int4 * LDB, complex8 * BETA, complex8 * C, int4 * LDC );
 
 // xNORM2
 template<typename T> real8
@@ -130,6 +130,30 @@ OGNumeric::asOGComplexDenseMatrix() const
   return OGComplexDenseMatrix::Ptr{};
 }
 
+OGRealSingleDenseMatrix::Ptr
+OGNumeric::asOGRealSingleDenseMatrix() const
+{
+  return OGRealSingleDenseMatrix::Ptr{};
+}
+
+OGComplexSingleDenseMatrix::Ptr
+OGNumeric::asOGComplexSingleDenseMatrix() const
+{
+  return OGComplexSingleDenseMatrix::Ptr{};
+}
+
+OGRealTransposedMatrix::Ptr
+OGNumeric::asOGRealTransposedMatrix() const
+{
+  return OGRealTransposedMatrix::Ptr{};
+}
+
+OGComplexTransposedMatrix::Ptr
+OGNumeric::asOGComplexTransposedMatrix() const
+{
+  return OGComplexTransposedMatrix::Ptr{};
+}
+
 OGLogicalMatrix::Ptr
 OGNumeric::asOGLogicalMatrix() const
 {
@@ -0,0 +1,546 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "plan.hh"
+#include "demand.hh"
+#include "execution.hh"
+#include "expression.hh"
+#include "inference.hh"
+#include "terminal.hh"
+#include "debug.h"
+
+namespace librdag {
+
+namespace detail {
+
+/**
+ * Results in the arena start on cache line boundaries.
+ */
+constexpr size_t ARENA_ALIGNMENT = 64;
+
+/**
+ * Sharing space in the arena needs the ancestors of every node, which take space
+ * quadratic in the number of nodes. Larger graphs allocate results as they go.
+ */
+constexpr size_t ARENA_MAX_NODES = 4096;
+
+} // end namespace detail
+
+/*
+ * ExecutionPlan
+ */
+
+ExecutionPlan::Ptr
+ExecutionPlan::create(ExecutionList& el, bool fuse)
+{
+  // Reject a bad tree before anything is run
+  TypeInference types(el);
+  std::shared_ptr<ExecutionPlan> plan(new ExecutionPlan());
+
+  // Index the distinct expressions, recording which expressions use each and how often
+  std::unordered_map<const OGNumeric*, size_t> position;
+  std::vector<OGExpr::Ptr> exprs;
+  std::vector<size_t> exprPosition;
+  std::vector<std::vector<size_t>> exprArgs;
+  std::vector<size_t> uses;
+  std::vector<size_t> consumer;
+  std::unordered_map<const OGNumeric*, size_t> index;
+  for (size_t pos = 0; pos < el.size(); pos++)
+  {
+    OGNumeric::Ptr node = el[pos];
+    position[node.get()] = pos;
+    OGExpr::Ptr expr = node->asOGExpr();
+    if (expr == OGExpr::Ptr{})
+    {
+      continue;
+    }
+    size_t n = exprs.size();
+    exprs.push_back(expr);
+    exprPosition.push_back(pos);
+    exprArgs.push_back(std::vector<size_t>());
+    uses.push_back(0);
+    consumer.push_back(0);
+    for (auto& arg: expr->getArgs())
+    {
+      if (arg->asOGExpr() == OGExpr::Ptr{})
+      {
+        continue;
+      }
+      // The list is in execution order so every argument is already indexed.
+      size_t dep = index.at(arg.get());
+      exprArgs[n].push_back(dep);
+      uses[dep]++;
+      consumer[dep] = n;
+    }
+    index[expr.get()] = n;
+  }
+  // Roots are results, which must not disappear into a fused kernel
+  std::vector<bool> result(exprs.size(), false);
+  for (size_t pos: el.getRoots())
+  {
+    auto found = index.find(el[pos].get());
+    if (found != index.end())
+    {
+      result[found->second] = true;
+    }
+  }
+
+  // An elementwise expression used once, by another elementwise expression, is fused
+  // into its consumer. Consumers follow their arguments so the group root is known.
+  size_t nexprs = exprs.size();
+  std::vector<bool> fused(nexprs, false);
+  std::vector<size_t> groupRoot(nexprs);
+  for (size_t i = nexprs; i-- > 0;)
+  {
+    fused[i] = fuse && !result[i] && uses[i] == 1 && FusedKernel::isFusible(exprs[i]) &&
+               FusedKernel::isFusible(exprs[consumer[i]]);
+    groupRoot[i] = fused[i] ? groupRoot[consumer[i]] : i;
+  }
+
+  std::vector<size_t> graphIndex(nexprs);
+  std::vector<std::vector<OGNumeric::Ptr>> groupMembers(nexprs);
+  std::vector<std::vector<size_t>> groupDeps(nexprs);
+  for (size_t i = 0; i < nexprs; i++)
+  {
+    size_t root = groupRoot[i];
+    groupMembers[root].push_back(exprs[i]);
+    for (size_t dep: exprArgs[i])
+    {
+      if (!fused[dep])
+      {
+        groupDeps[root].push_back(graphIndex[dep]);
+      }
+    }
+    if (fused[i])
+    {
+      continue;
+    }
+    size_t n = plan->_positions.size();
+    graphIndex[i] = n;
+    plan->_positions.push_back(exprPosition[i]);
+    plan->_dependents.push_back(std::vector<size_t>());
+    plan->_dependencies.push_back(std::vector<size_t>());
+    for (size_t dep: groupDeps[i])
+    {
+      std::vector<size_t>& deps = plan->_dependents[dep];
+      // The same node may be passed as more than one argument
+      if (deps.empty() || deps.back() != n)
+      {
+        deps.push_back(n);
+        plan->_dependencies[n].push_back(dep);
+      }
+    }
+    plan->_dependencyCount.push_back(plan->_dependencies[n].size());
+    plan->_results.push_back(result[i]);
+    // A lone elementwise node gains nothing from a kernel, and its runner may well be
+    // better than the fused loop, so is dispatched as usual
+    if (groupMembers[i].size() > 1)
+    {
+      FusedKernel compiled(groupMembers[i]);
+      std::unique_ptr<Kernel> kernel(new Kernel());
+      for (auto& member: compiled.getMembers())
+      {
+        kernel->members.push_back(position.at(member.get()));
+      }
+      for (auto& leaf: compiled.getLeaves())
+      {
+        kernel->leaves.push_back(position.at(leaf.get()));
+      }
+      kernel->code = compiled.getCode();
+      plan->_kernels.push_back(std::move(kernel));
+    }
+    else
+    {
+      plan->_kernels.push_back(nullptr);
+    }
+    groupMembers[i].clear();
+    groupDeps[i].clear();
+  }
+  plan->planArena(el, types);
+
+  // Nodes with several results need only compute those consumed
+  std::vector<uint64_t> demand = ResultDemand::analyse(el);
+  for (size_t pos: plan->_positions)
+  {
+    plan->_demand.push_back(demand[pos]);
+  }
+  return plan;
+}
+
+void
+ExecutionPlan::planArena(ExecutionList& el, const TypeInference& types)
+{
+  size_t nnodes = _positions.size();
+  _arenaOffsets.assign(nnodes, 0);
+  _arenaBytes.assign(nnodes, 0);
+  _arenaSize = 0;
+  if (nnodes > detail::ARENA_MAX_NODES)
+  {
+    return;
+  }
+
+  // A result is dead by the time a node starts, in any order of execution, if every
+  // node consuming it is an ancestor of that node.
+  size_t words = (nnodes + 63) / 64;
+  std::vector<uint64_t> ancestors(nnodes * words, 0);
+  for (size_t n = 0; n < nnodes; n++)
+  {
+    uint64_t * mine = &ancestors[n * words];
+    for (size_t dep: _dependencies[n])
+    {
+      const uint64_t * theirs = &ancestors[dep * words];
+      for (size_t w = 0; w < words; w++)
+      {
+        mine[w] |= theirs[w];
+      }
+      mine[dep / 64] |= uint64_t(1) << (dep % 64);
+    }
+  }
+  auto isDeadBy = [&](size_t dead, size_t n)
+  {
+    const uint64_t * mine = &ancestors[n * words];
+    return std::all_of(_dependents[dead].begin(), _dependents[dead].end(), [mine](size_t consumer)
+    {
+      return (mine[consumer / 64] >> (consumer % 64)) & 1;
+    });
+  };
+
+  // Best fit into a block whose last occupant is dead, else a new block at the end
+  struct Block
+  {
+    size_t offset;
+    size_t bytes;
+    size_t occupant;
+  };
+  std::vector<Block> blocks;
+  for (size_t n = 0; n < nnodes; n++)
+  {
+    if (_kernels[n] == nullptr || _results[n])
+    {
+      continue;
+    }
+    // A transposed view aliases the data of its argument, which must outlive the view
+    if (std::any_of(_dependents[n].begin(), _dependents[n].end(), [&](size_t consumer)
+        {
+          ExprType_t type = el[_positions[consumer]]->getType();
+          return type == TRANSPOSE_ENUM || type == CTRANSPOSE_ENUM;
+        }))
+    {
+      continue;
+    }
+    const ValueInfo& value = types.getResult(el[_positions[n]]);
+    if (!value.isDense() || !value.shapeKnown || value.rows * value.cols == 0)
+    {
+      continue;
+    }
+    size_t bytes = value.rows * value.cols *
+                   (value.type == COMPLEX_DENSE_MATRIX_ENUM ? sizeof(complex16) : sizeof(real8));
+    bytes = (bytes + detail::ARENA_ALIGNMENT - 1) / detail::ARENA_ALIGNMENT * detail::ARENA_ALIGNMENT;
+    Block * best = nullptr;
+    for (auto& block: blocks)
+    {
+      if (block.bytes >= bytes && (best == nullptr || block.bytes < best->bytes) && isDeadBy(block.occupant, n))
+      {
+        best = &block;
+      }
+    }
+    if (best == nullptr)
+    {
+      blocks.push_back(Block{_arenaSize, bytes, n});
+      _arenaSize += bytes;
+      best = &blocks.back();
+    }
+    best->occupant = n;
+    _arenaOffsets[n] = best->offset;
+    _arenaBytes[n] = bytes;
+  }
+  DEBUG_PRINT("Arena of %d bytes in %d blocks\n", static_cast<int>(_arenaSize), static_cast<int>(blocks.size()));
+}
+
+size_t
+ExecutionPlan::size() const
+{
+  return _positions.size();
+}
+
+size_t
+ExecutionPlan::getPosition(size_t n) const
+{
+  return _positions[n];
+}
+
+size_t
+ExecutionPlan::getDependencyCount(size_t n) const
+{
+  return _dependencyCount[n];
+}
+
+const std::vector<size_t>&
+ExecutionPlan::getDependents(size_t n) const
+{
+  return _dependents[n];
+}
+
+const std::vector<size_t>&
+ExecutionPlan::getDependencies(size_t n) const
+{
+  return _dependencies[n];
+}
+
+bool
+ExecutionPlan::isResult(size_t n) const
+{
+  return _results[n];
+}
+
+const ExecutionPlan::Kernel *
+ExecutionPlan::getKernel(size_t n) const
+{
+  return _kernels[n].get();
+}
+
+size_t
+ExecutionPlan::getArenaSize() const
+{
+  return _arenaSize;
+}
+
+bool
+ExecutionPlan::getArenaSlot(size_t n, size_t& offset, size_t& bytes) const
+{
+  if (_arenaBytes[n] == 0)
+  {
+    return false;
+  }
+  offset = _arenaOffsets[n];
+  bytes = _arenaBytes[n];
+  return true;
+}
+
+uint64_t
+ExecutionPlan::getDemand(size_t n) const
+{
+  return _demand[n];
+}
+
+bool
+ExecutionPlan::isSequential() const
+{
+  for (size_t i = 0; i < _positions.size(); i++)
+  {
+    if (_dependencyCount[i] > 1 || _dependents[i].size() > 1)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * PlanKey
+ */
+
+PlanKey::PlanKey(ExecutionList& el, bool fuse): _hash{0}
+{
+  std::unordered_map<const OGNumeric*, size_t> position;
+  _tokens.push_back(fuse ? 1 : 0);
+  for (size_t pos = 0; pos < el.size(); pos++)
+  {
+    OGNumeric::Ptr node = el[pos];
+    position[node.get()] = pos;
+    _tokens.push_back(static_cast<size_t>(node->getType()));
+    OGTerminal::Ptr term = node->asOGTerminal();
+    if (term != OGTerminal::Ptr{})
+    {
+      _tokens.push_back(term->getRows());
+      _tokens.push_back(term->getCols());
+      if (term->getType() == INTEGER_SCALAR_ENUM)
+      {
+        _tokens.push_back(static_cast<size_t>(term->asOGIntegerScalar()->getValue()));
+      }
+    }
+    else
+    {
+      const ArgContainer& args = node->asOGExpr()->getArgs();
+      _tokens.push_back(args.size());
+      for (auto& arg: args)
+      {
+        _tokens.push_back(position.at(arg.get()));
+      }
+    }
+  }
+  for (size_t pos: el.getRoots())
+  {
+    _tokens.push_back(pos);
+  }
+  std::hash<size_t> hasher;
+  for (size_t token: _tokens)
+  {
+    _hash ^= hasher(token) + 0x9e3779b9 + (_hash << 6) + (_hash >> 2);
+  }
+}
+
+size_t
+PlanKey::getHash() const
+{
+  return _hash;
+}
+
+bool
+PlanKey::operator==(const PlanKey& other) const
+{
+  return _hash == other._hash && _tokens == other._tokens;
+}
+
+/*
+ * PlanCache
+ */
+
+namespace detail {
+
+struct PlanKeyHash
+{
+  size_t operator()(const PlanKey& key) const
+  {
+    return key.getHash();
+  }
+};
+
+struct PlanCacheEntry
+{
+  ExecutionPlan::Ptr plan;
+  // Position in the recency list
+  std::list<const PlanKey*>::iterator recency;
+};
+
+static std::mutex plan_cache_lock;
+static std::unordered_map<PlanKey, PlanCacheEntry, PlanKeyHash> plan_cache;
+// Most recently used first
+static std::list<const PlanKey*> plan_cache_recency;
+static std::atomic<bool> plan_cache_enabled{true};
+static size_t plan_cache_capacity = 1024;
+static std::atomic<size_t> plan_cache_hits{0};
+static std::atomic<size_t> plan_cache_misses{0};
+
+// Must be called with plan_cache_lock held
+static void evictPlans(size_t capacity)
+{
+  while (plan_cache.size() > capacity)
+  {
+    const PlanKey * oldest = plan_cache_recency.back();
+    plan_cache_recency.pop_back();
+    plan_cache.erase(*oldest);
+  }
+}
+
+} // end namespace detail
+
+ExecutionPlan::Ptr
+PlanCache::getPlan(ExecutionList& el, bool fuse)
+{
+  if (!getEnabled())
+  {
+    return ExecutionPlan::create(el, fuse);
+  }
+  PlanKey key(el, fuse);
+  {
+    std::lock_guard<std::mutex> lk(detail::plan_cache_lock);
+    auto it = detail::plan_cache.find(key);
+    if (it != detail::plan_cache.end())
+    {
+      detail::plan_cache_recency.splice(detail::plan_cache_recency.begin(), detail::plan_cache_recency,
+                                        it->second.recency);
+      ++detail::plan_cache_hits;
+      return it->second.plan;
+    }
+  }
+  // Analyse outside the lock; if another thread gets there first its plan is kept.
+  ++detail::plan_cache_misses;
+  DEBUG_PRINT("Plan cache miss for %d nodes\n", static_cast<int>(el.size()));
+  ExecutionPlan::Ptr plan = ExecutionPlan::create(el, fuse);
+  std::lock_guard<std::mutex> lk(detail::plan_cache_lock);
+  if (detail::plan_cache_capacity == 0)
+  {
+    return plan;
+  }
+  auto inserted = detail::plan_cache.insert(std::make_pair(std::move(key), detail::PlanCacheEntry{plan, {}}));
+  if (!inserted.second)
+  {
+    return inserted.first->second.plan;
+  }
+  detail::plan_cache_recency.push_front(&inserted.first->first);
+  inserted.first->second.recency = detail::plan_cache_recency.begin();
+  detail::evictPlans(detail::plan_cache_capacity);
+  return plan;
+}
+
+bool
+PlanCache::getEnabled()
+{
+  return detail::plan_cache_enabled.load();
+}
+
+void
+PlanCache::setEnabled(bool enabled)
+{
+  detail::plan_cache_enabled = enabled;
+  if (!enabled)
+  {
+    std::lock_guard<std::mutex> lk(detail::plan_cache_lock);
+    detail::evictPlans(0);
+  }
+}
+
+size_t
+PlanCache::getCapacity()
+{
+  std::lock_guard<std::mutex> lk(detail::plan_cache_lock);
+  return detail::plan_cache_capacity;
+}
+
+void
+PlanCache::setCapacity(size_t capacity)
+{
+  std::lock_guard<std::mutex> lk(detail::plan_cache_lock);
+  detail::plan_cache_capacity = capacity;
+  detail::evictPlans(capacity);
+}
+
+size_t
+PlanCache::size()
+{
+  std::lock_guard<std::mutex> lk(detail::plan_cache_lock);
+  return detail::plan_cache.size();
+}
+
+void
+PlanCache::clear()
+{
+  std::lock_guard<std::mutex> lk(detail::plan_cache_lock);
+  detail::evictPlans(0);
+  detail::plan_cache_hits = 0;
+  detail::plan_cache_misses = 0;
+}
+
+size_t
+PlanCache::getHits()
+{
+  return detail::plan_cache_hits.load();
+}
+
+size_t
+PlanCache::getMisses()
+{
+  return detail::plan_cache_misses.load();
+}
+
+} // end namespace librdag
@@ -0,0 +1,544 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <atomic>
+#include <limits>
+#include "rewrite.hh"
+#include "execution.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "exceptions.hh"
+#include "debug.h"
+
+namespace librdag {
+
+namespace detail {
+
+static std::atomic<bool> rewrite_enabled{true};
+
+static bool isRealTerminal(ExprType_t type)
+{
+  switch (type)
+  {
+    case REAL_SCALAR_ENUM:
+    case INTEGER_SCALAR_ENUM:
+    case REAL_DENSE_MATRIX_ENUM:
+    case LOGICAL_MATRIX_ENUM:
+    case REAL_DIAGONAL_MATRIX_ENUM:
+    case REAL_SPARSE_MATRIX_ENUM:
+    case REAL_SINGLE_DENSE_MATRIX_ENUM:
+    case REAL_TRANSPOSED_MATRIX_ENUM:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Rewrites the nodes of one tree, remembering the result for every node seen so that
+ * shared nodes are rewritten once.
+ */
+class RewritePass
+{
+  public:
+    RewritePass(const std::vector<RewriteRule::Ptr>& rules, ExecutionList& el);
+    OGNumeric::Ptr visit(const OGNumeric::Ptr& node);
+  private:
+    size_t getUseCount(const OGNumeric::Ptr& node) const;
+    const std::vector<RewriteRule::Ptr>& _rules;
+    RewriteContext _context;
+    // The number of uses of each node of the input tree, and of each replacement
+    std::unordered_map<const OGNumeric*, size_t> _uses;
+    // The rewritten node for each node seen. Rewritten nodes map to themselves.
+    std::unordered_map<const OGNumeric*, OGNumeric::Ptr> _result;
+    // Keeps the nodes seen alive, so that their addresses are not reused
+    std::vector<OGNumeric::Ptr> _seen;
+};
+
+RewritePass::RewritePass(const std::vector<RewriteRule::Ptr>& rules, ExecutionList& el): _rules(rules)
+{
+  for (auto it = el.begin(); it != el.end(); ++it)
+  {
+    OGExpr::Ptr expr = (*it)->asOGExpr();
+    if (expr == OGExpr::Ptr{})
+    {
+      continue;
+    }
+    for (auto& arg: expr->getArgs())
+    {
+      _uses[arg.get()]++;
+    }
+  }
+}
+
+size_t
+RewritePass::getUseCount(const OGNumeric::Ptr& node) const
+{
+  auto found = _uses.find(node.get());
+  return found == _uses.end() ? 1 : found->second;
+}
+
+OGNumeric::Ptr
+RewritePass::visit(const OGNumeric::Ptr& node)
+{
+  auto found = _result.find(node.get());
+  if (found != _result.end())
+  {
+    return found->second;
+  }
+  _seen.push_back(node);
+  OGExpr::Ptr expr = node->asOGExpr();
+  size_t uses = getUseCount(node);
+  if (expr == OGExpr::Ptr{})
+  {
+    _context.add(node, uses);
+    _result[node.get()] = node;
+    return node;
+  }
+
+  // Rewrite the arguments. When visiting the execution list of the tree they have
+  // already been seen; a replacement made by a rule may have new ones.
+  ArgContainer args;
+  bool argsChanged = false;
+  for (auto& arg: expr->getArgs())
+  {
+    OGNumeric::Ptr rewritten = visit(arg);
+    argsChanged |= rewritten != arg;
+    args.push_back(rewritten);
+  }
+  if (argsChanged)
+  {
+    expr = expr->withArgs(args);
+    _seen.push_back(expr);
+  }
+  _context.add(expr, uses);
+
+  OGNumeric::Ptr result = expr;
+  for (auto& rule: _rules)
+  {
+    OGNumeric::Ptr replacement = rule->apply(expr, _context);
+    if (replacement != OGNumeric::Ptr{})
+    {
+      DEBUG_PRINT("Rewrite rule %s applied\n", rule->getName());
+      // A new node replacing this one has its uses
+      _uses.emplace(replacement.get(), uses);
+      result = visit(replacement);
+      break;
+    }
+  }
+  _result[node.get()] = result;
+  _result[expr.get()] = result;
+  _result[result.get()] = result;
+  return result;
+}
+
+} // end namespace detail
+
+/*
+ * RewriteContext
+ */
+
+void
+RewriteContext::add(const OGNumeric::Ptr& node, size_t uses)
+{
+  if (_info.count(node.get()) != 0)
+  {
+    return;
+  }
+  Info info{node, false, {}, uses};
+  std::vector<std::vector<ValueInfo>> argResults;
+  OGTerminal::Ptr term = node->asOGTerminal();
+  if (term != OGTerminal::Ptr{})
+  {
+    info.real = detail::isRealTerminal(term->getType());
+  }
+  else
+  {
+    bool argsReal = true;
+    for (auto& arg: node->asOGExpr()->getArgs())
+    {
+      const Info& argInfo = getInfo(arg);
+      argsReal &= argInfo.real;
+      argResults.push_back(argInfo.results);
+    }
+    switch (node->getType())
+    {
+      case PLUS_ENUM:
+      case MINUS_ENUM:
+      case TIMES_ENUM:
+      case RDIVIDE_ENUM:
+      case NEGATE_ENUM:
+      case ACOS_ENUM:
+      case ASINH_ENUM:
+      case ATAN_ENUM:
+      case COS_ENUM:
+      case EXP_ENUM:
+      case SIN_ENUM:
+      case SINH_ENUM:
+      case TAN_ENUM:
+      case TANH_ENUM:
+      case COPY_ENUM:
+      case INV_ENUM:
+      case TRANSPOSE_ENUM:
+      case CTRANSPOSE_ENUM:
+      case PINV_ENUM:
+      case MTIMES_ENUM:
+      case MLDIVIDE_ENUM:
+        info.real = argsReal;
+        break;
+      case NORM2_ENUM:
+        info.real = true;
+        break;
+      default:
+        // Nothing known
+        break;
+    }
+  }
+  if (node->getType() == COPY_ENUM)
+  {
+    // There is no runner to infer from, but the value is that of the argument
+    info.results = argResults[0];
+  }
+  else
+  {
+    try
+    {
+      info.results = TypeInference::infer(node, argResults);
+    }
+    catch (rdag_error&)
+    {
+      // Non-conformant, left for the runner to report
+      info.results = {ValueInfo()};
+    }
+  }
+  _info.emplace(node.get(), info);
+}
+
+bool
+RewriteContext::isReal(const OGNumeric::Ptr& node) const
+{
+  return getInfo(node).real;
+}
+
+bool
+RewriteContext::getShape(const OGNumeric::Ptr& node, size_t& rows, size_t& cols) const
+{
+  const ValueInfo& value = getInfo(node).results[0];
+  if (!value.shapeKnown)
+  {
+    return false;
+  }
+  rows = value.rows;
+  cols = value.cols;
+  return true;
+}
+
+bool
+RewriteContext::isDenseMatrix(const OGNumeric::Ptr& node) const
+{
+  const ValueInfo& value = getInfo(node).results[0];
+  return value.isDense() && value.shapeKnown && (value.rows != 1 || value.cols != 1);
+}
+
+size_t
+RewriteContext::getUseCount(const OGNumeric::Ptr& node) const
+{
+  return getInfo(node).uses;
+}
+
+const RewriteContext::Info&
+RewriteContext::getInfo(const OGNumeric::Ptr& node) const
+{
+  auto found = _info.find(node.get());
+  if (found == _info.end())
+  {
+    throw rdag_error("Node has not been recorded in the rewrite context.");
+  }
+  return found->second;
+}
+
+/*
+ * RewriteRule
+ */
+
+RewriteRule::~RewriteRule() {}
+
+const char *
+DoubleTransposeRule::getName() const
+{
+  return "DoubleTranspose";
+}
+
+OGNumeric::Ptr
+DoubleTransposeRule::apply(const OGExpr::Ptr& node, const RewriteContext& context) const
+{
+  ExprType_t type = node->getType();
+  if (type != TRANSPOSE_ENUM && type != CTRANSPOSE_ENUM)
+  {
+    return OGNumeric::Ptr{};
+  }
+  const OGNumeric::Ptr& arg = node->getArgs()[0];
+  if (arg->getType() != type)
+  {
+    return OGNumeric::Ptr{};
+  }
+  const OGNumeric::Ptr& inner = arg->asOGExpr()->getArgs()[0];
+  if (!context.isDenseMatrix(inner))
+  {
+    return OGNumeric::Ptr{};
+  }
+  return inner;
+}
+
+const char *
+DoubleNegateRule::getName() const
+{
+  return "DoubleNegate";
+}
+
+OGNumeric::Ptr
+DoubleNegateRule::apply(const OGExpr::Ptr& node, const RewriteContext& context) const
+{
+  if (node->getType() != NEGATE_ENUM)
+  {
+    return OGNumeric::Ptr{};
+  }
+  const OGNumeric::Ptr& arg = node->getArgs()[0];
+  if (arg->getType() != NEGATE_ENUM)
+  {
+    return OGNumeric::Ptr{};
+  }
+  const OGNumeric::Ptr& inner = arg->asOGExpr()->getArgs()[0];
+  if (!context.isDenseMatrix(inner))
+  {
+    return OGNumeric::Ptr{};
+  }
+  return inner;
+}
+
+const char *
+RealCTransposeRule::getName() const
+{
+  return "RealCTranspose";
+}
+
+OGNumeric::Ptr
+RealCTransposeRule::apply(const OGExpr::Ptr& node, const RewriteContext& context) const
+{
+  if (node->getType() != CTRANSPOSE_ENUM)
+  {
+    return OGNumeric::Ptr{};
+  }
+  const OGNumeric::Ptr& arg = node->getArgs()[0];
+  if (!context.isReal(arg))
+  {
+    return OGNumeric::Ptr{};
+  }
+  return TRANSPOSE::create(arg);
+}
+
+const char *
+InverseTimesRule::getName() const
+{
+  return "InverseTimes";
+}
+
+OGNumeric::Ptr
+InverseTimesRule::apply(const OGExpr::Ptr& node, const RewriteContext& context) const
+{
+  if (node->getType() != MTIMES_ENUM)
+  {
+    return OGNumeric::Ptr{};
+  }
+  const ArgContainer& args = node->getArgs();
+  if (args[0]->getType() != INV_ENUM || context.getUseCount(args[0]) != 1)
+  {
+    return OGNumeric::Ptr{};
+  }
+  const OGNumeric::Ptr& A = args[0]->asOGExpr()->getArgs()[0];
+  const OGNumeric::Ptr& B = args[1];
+  size_t rowsA, colsA, rowsB, colsB;
+  if (!context.getShape(A, rowsA, colsA) || !context.getShape(B, rowsB, colsB) ||
+      rowsA != colsA || rowsA != rowsB)
+  {
+    return OGNumeric::Ptr{};
+  }
+  return MLDIVIDE::create(A, B);
+}
+
+namespace detail {
+
+/**
+ * A factor of a chain of matrix products.
+ */
+struct ChainFactor
+{
+  OGNumeric::Ptr node;
+  size_t rows;
+  size_t cols;
+};
+
+/**
+ * Flattens a product into its factors, accumulating the number of multiplications
+ * the product costs as it is associated now.
+ * @return false if the chain cannot be reassociated, as the shape of a factor is not
+ * known or is that of a scalar.
+ */
+static bool flattenChain(const OGNumeric::Ptr& node, bool isRoot, const RewriteContext& context,
+                         std::vector<ChainFactor>& factors, real8& cost)
+{
+  ExprType_t type = node->getType();
+  if (type == MTIMES_ENUM && (isRoot || context.getUseCount(node) == 1))
+  {
+    const ArgContainer& args = node->asOGExpr()->getArgs();
+    size_t first = factors.size();
+    if (!flattenChain(args[0], false, context, factors, cost))
+    {
+      return false;
+    }
+    size_t mid = factors.size();
+    if (!flattenChain(args[1], false, context, factors, cost))
+    {
+      return false;
+    }
+    cost += static_cast<real8>(factors[first].rows) * factors[mid - 1].cols * factors.back().cols;
+    return true;
+  }
+  size_t rows, cols;
+  if (!context.getShape(node, rows, cols) || (rows == 1 && cols == 1))
+  {
+    return false;
+  }
+  factors.push_back(ChainFactor{node, rows, cols});
+  return true;
+}
+
+static OGNumeric::Ptr buildChain(const std::vector<ChainFactor>& factors,
+                                 const std::vector<std::vector<size_t>>& split, size_t i, size_t j)
+{
+  if (i == j)
+  {
+    return factors[i].node;
+  }
+  size_t k = split[i][j];
+  return MTIMES::create(buildChain(factors, split, i, k), buildChain(factors, split, k + 1, j));
+}
+
+} // end namespace detail
+
+const char *
+MatrixChainRule::getName() const
+{
+  return "MatrixChain";
+}
+
+OGNumeric::Ptr
+MatrixChainRule::apply(const OGExpr::Ptr& node, const RewriteContext& context) const
+{
+  ExprType_t type = node->getType();
+  if (type != MTIMES_ENUM)
+  {
+    return OGNumeric::Ptr{};
+  }
+  std::vector<detail::ChainFactor> factors;
+  real8 currentCost = 0;
+  if (!detail::flattenChain(node, true, context, factors, currentCost) || factors.size() < 3)
+  {
+    return OGNumeric::Ptr{};
+  }
+  size_t n = factors.size();
+  for (size_t i = 0; i + 1 < n; i++)
+  {
+    if (factors[i].cols != factors[i + 1].rows)
+    {
+      // Leave it to the runner to report
+      return OGNumeric::Ptr{};
+    }
+  }
+
+  // cost[i][j] is the least number of multiplications computing factors i..j takes,
+  // achieved by splitting the product after factor split[i][j].
+  std::vector<std::vector<real8>> cost(n, std::vector<real8>(n, 0));
+  std::vector<std::vector<size_t>> split(n, std::vector<size_t>(n, 0));
+  for (size_t len = 2; len <= n; len++)
+  {
+    for (size_t i = 0; i + len <= n; i++)
+    {
+      size_t j = i + len - 1;
+      cost[i][j] = std::numeric_limits<real8>::infinity();
+      for (size_t k = i; k < j; k++)
+      {
+        real8 c = cost[i][k] + cost[k + 1][j] +
+                  static_cast<real8>(factors[i].rows) * factors[k].cols * factors[j].cols;
+        if (c < cost[i][j])
+        {
+          cost[i][j] = c;
+          split[i][j] = k;
+        }
+      }
+    }
+  }
+  if (cost[0][n - 1] >= currentCost)
+  {
+    return OGNumeric::Ptr{};
+  }
+  DEBUG_PRINT("Reassociating %d factor chain, cost %g down from %g\n", static_cast<int>(n),
+              cost[0][n - 1], currentCost);
+  return detail::buildChain(factors, split, 0, n - 1);
+}
+
+/*
+ * Rewriter
+ */
+
+const std::vector<RewriteRule::Ptr>&
+Rewriter::getDefaultRules()
+{
+  static const std::vector<RewriteRule::Ptr> rules{
+    std::make_shared<DoubleTransposeRule>(),
+    std::make_shared<DoubleNegateRule>(),
+    std::make_shared<RealCTransposeRule>(),
+    std::make_shared<InverseTimesRule>(),
+    std::make_shared<MatrixChainRule>()
+  };
+  return rules;
+}
+
+bool
+Rewriter::getEnabled()
+{
+  return detail::rewrite_enabled.load();
+}
+
+void
+Rewriter::setEnabled(bool enabled)
+{
+  detail::rewrite_enabled = enabled;
+}
+
+Rewriter::Rewriter(const std::vector<RewriteRule::Ptr>& rules): _rules(rules) {}
+
+const std::vector<RewriteRule::Ptr>&
+Rewriter::getRules() const
+{
+  return _rules;
+}
+
+OGNumeric::Ptr
+Rewriter::rewrite(const OGNumeric::Ptr& tree) const
+{
+  // Visit in execution order, so that arguments are rewritten before the nodes that
+  // use them without recursing down the whole tree.
+  ExecutionList el{tree};
+  detail::RewritePass pass(_rules, el);
+  for (auto it = el.begin(); it != el.end(); ++it)
+  {
+    pass.visit(*it);
+  }
+  return pass.visit(tree);
+}
+
+} // end namespace librdag
@@ -31,6 +31,19 @@ CTRANSPOSERunner::run(RegContainer& reg, OGRealScalar::Ptr arg) const
   return nullptr;
 }
 
+/**
+ * The conjugate of a value, which for real data is the value.
+ */
+static inline real8 conjugate(real8 value)
+{
+  return value;
+}
+
+static inline complex16 conjugate(complex16 value)
+{
+  return std::conj(value);
+}
+
 template<typename T>
 void
 ctranspose_dense_runner(RegContainer& reg, shared_ptr<const OGMatrix<T>>  arg)
@@ -40,23 +53,12 @@ ctranspose_dense_runner(RegContainer& reg, shared_ptr<const OGMatrix<T>>  arg)
   // Matrix in scalar context, i.e. a 1x1 matrix, transpose is simply value
   if(arg->getRows()==1 && arg->getCols()==1)
   {
-    ret = makeConcreteScalar(std::conj(arg->getData()[0]));
+    ret = makeConcreteScalar(conjugate(arg->getData()[0]));
   }
-  else // Matrix is a full matrix
+  else // Matrix is a full matrix, view it conjugate transposed rather than moving the data
   {
-    size_t m = arg->getRows();
-    size_t n = arg->getCols();
-    size_t retRows = n, retCols = m;
-    T * data = arg->getData();
-    T * tmp = new T[m * n];
-    size_t ir;
-    for (size_t i = 0; i < n; i++) {
-      ir = i * m;
-      for (size_t j = 0; j < m; j++) {
-        tmp[j * n + i] = std::conj(data[ir + j]);
-      }
-    }
-    ret = makeConcreteDenseMatrix(tmp, retRows, retCols, OWNER);
+    ret = makeConcreteTransposedMatrix<T>(arg, true);
+    ret->asOGTerminal()->setStructure(arg->getStructure().transposed());
   }
 
   // shove ret into register
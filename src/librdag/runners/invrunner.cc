@@ -19,6 +19,7 @@
 #include <complex>
 #include <sstream>
 #include <limits>
+#include <algorithm>
 
 using namespace std;
 
@@ -45,6 +46,80 @@ INVRunner::run(RegContainer& reg, OGRealScalar::Ptr arg) const
   return nullptr;
 }
 
+/**
+ * Inverts a square matrix known to be triangular by a triangular solve against the
+ * identity rather than an LU factorisation. The inverse has the same triangle.
+ * @return the inverse, null if the matrix is singular.
+ */
+template<typename T>
+OGNumeric::Ptr
+inv_triangular(shared_ptr<const OGMatrix<T>> arg, int4 size)
+{
+  const Structure& structure = arg->getStructure();
+  char uplo = structure.has(Structure::UPPER_TRIANGULAR) ? 'U' : 'L';
+  char diag = structure.has(Structure::UNIT_DIAGONAL) ? 'U' : 'N';
+  int4 info = 0;
+  unique_ptr<T[]> Xptr (new T[size*size]());
+  T * X = Xptr.get();
+  for (int4 i = 0; i < size; i++)
+  {
+    X[i*size+i] = 1.e0;
+  }
+  try
+  {
+    lapack::xtrtrs(&uplo, lapack::N, &diag, &size, &size, arg->getData(), &size, X, &size, &info);
+  }
+  catch (rdag_error& e)
+  {
+    if (info < 0)
+    {
+      throw;
+    }
+    return OGNumeric::Ptr{};
+  }
+  OGNumeric::Ptr ret = makeConcreteDenseMatrix(Xptr.release(), size, size, OWNER);
+  ret->asOGTerminal()->setStructure(Structure(structure.getProperties() &
+                                              (Structure::UPPER_TRIANGULAR | Structure::LOWER_TRIANGULAR | Structure::UNIT_DIAGONAL)));
+  return ret;
+}
+
+/**
+ * Inverts a matrix known to be positive definite by a Cholesky factorisation rather
+ * than an LU factorisation. The inverse is positive definite too.
+ * @return the inverse, null if the factorisation fails.
+ */
+template<typename T>
+OGNumeric::Ptr
+inv_positive_definite(shared_ptr<const OGMatrix<T>> arg, int4 size)
+{
+  int4 info = 0;
+  unique_ptr<T[]> Aptr (new T[size*size]);
+  T * A = Aptr.get();
+  std::memcpy(A, arg->getData(), sizeof(T)*size*size);
+  unique_ptr<T[]> Xptr (new T[size*size]());
+  T * X = Xptr.get();
+  for (int4 i = 0; i < size; i++)
+  {
+    X[i*size+i] = 1.e0;
+  }
+  try
+  {
+    lapack::xpotrf(lapack::L, &size, A, &size, &info);
+  }
+  catch (rdag_error& e)
+  {
+    if (info < 0)
+    {
+      throw;
+    }
+    return OGNumeric::Ptr{};
+  }
+  lapack::xpotrs(lapack::L, &size, &size, A, &size, X, &size, &info);
+  OGNumeric::Ptr ret = makeConcreteDenseMatrix(Xptr.release(), size, size, OWNER);
+  ret->asOGTerminal()->setStructure(Structure(Structure::POSITIVE_DEFINITE));
+  return ret;
+}
+
 template<typename T>
 void
 inv_dense_runner(RegContainer& reg, shared_ptr<const OGMatrix<T>> arg)
@@ -86,6 +161,22 @@ inv_dense_runner(RegContainer& reg, shared_ptr<const OGMatrix<T>> arg)
     int4 sizesize = size*size;
     int4 lda = size;
 
+    // exploit the structure of the matrix if it is known
+    const Structure& structure = arg->getStructure();
+    if (structure.has(Structure::UPPER_TRIANGULAR) || structure.has(Structure::LOWER_TRIANGULAR))
+    {
+      ret = inv_triangular(arg, size);
+    }
+    else if (structure.has(Structure::POSITIVE_DEFINITE))
+    {
+      ret = inv_positive_definite(arg, size);
+    }
+    if (ret != OGNumeric::Ptr{})
+    {
+      reg.push_back(ret);
+      return;
+    }
+
     // status
     int4 info = 0;
 
@@ -114,12 +205,60 @@ inv_dense_runner(RegContainer& reg, shared_ptr<const OGMatrix<T>> arg)
     // Else, exception propagates, stack unwinds
 
     ret = makeConcreteDenseMatrix(Aptr.release(), size, size, OWNER);
+    // the inverse of a Hermitian matrix is Hermitian
+    if (structure.has(Structure::HERMITIAN))
+    {
+      ret->asOGTerminal()->setStructure(Structure(Structure::HERMITIAN));
+    }
   }
 
   // shove ret into register
   reg.push_back(ret);
 }
 
+/**
+ * Inverts a diagonal matrix as the reciprocals of its diagonal, so the result stays
+ * diagonal and the cost is O(n).
+ */
+template<typename T>
+void
+inv_diagonal_runner(RegContainer& reg, shared_ptr<const OGDiagonalMatrix<T>> arg)
+{
+  size_t m = arg->getRows();
+  size_t n = arg->getCols();
+
+  // require matrix is square.
+  if(m!=n)
+  {
+    stringstream message;
+    message << "Cannot invert a matrix that is not square. Matrix presented has shape: [" << m <<"x"<< n <<"].";
+    throw rdag_error(message.str());
+  }
+
+  // as for a scalar, inv(0) = inf
+  bool singular = false;
+  const T * d = arg->getData();
+  unique_ptr<T[]> data (new T[std::max(n, static_cast<size_t>(1))]());
+  for(size_t i = 0; i < n; i++)
+  {
+    if(d[i] == 0.e0)
+    {
+      singular = true;
+      data[i] = std::numeric_limits<real8>::infinity();
+    }
+    else
+    {
+      data[i] = 1.e0/d[i];
+    }
+  }
+  if(singular)
+  {
+    cerr << "Warning: singular system detected in matrix inversion." << std::endl;
+  }
+
+  reg.push_back(makeConcreteDiagonalMatrix(data.release(), n, n, OWNER));
+}
+
 void *
 INVRunner::run(RegContainer& reg, OGRealDenseMatrix::Ptr arg) const
 {
@@ -134,4 +273,18 @@ INVRunner::run(RegContainer& reg, OGComplexDenseMatrix::Ptr arg) const
   return nullptr;
 }
 
+void *
+INVRunner::run(RegContainer& reg, OGRealDiagonalMatrix::Ptr arg) const
+{
+  inv_diagonal_runner<real8>(reg, arg);
+  return nullptr;
+}
+
+void *
+INVRunner::run(RegContainer& reg, OGComplexDiagonalMatrix::Ptr arg) const
+{
+  inv_diagonal_runner<complex16>(reg, arg);
+  return nullptr;
+}
+
 } // end namespace
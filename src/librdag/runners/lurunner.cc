@@ -12,6 +12,7 @@
 #include "terminal.hh"
 #include "uncopyable.hh"
 #include "lapack.hh"
+#include "demand.hh"
 #include "debug.h"
 
 using namespace std;
@@ -34,8 +35,12 @@ template<typename T> void lu_dense_runner(RegContainer& reg, shared_ptr<const OG
 //   L = [m x minmn ]
 //   U = [minmn x n]
 
-  unique_ptr<T[]> Lptr(new T[m*minmn]());
-  unique_ptr<T[]> Uptr(new T[minmn*n]());
+  // L and U are only extracted from the factorisation if they are selected
+  bool wantL = ResultDemand::isNeeded(0);
+  bool wantU = ResultDemand::isNeeded(1);
+
+  unique_ptr<T[]> Lptr(wantL ? new T[m*minmn]() : nullptr);
+  unique_ptr<T[]> Uptr(wantU ? new T[minmn*n]() : nullptr);
   unique_ptr<T[]> Aptr(new T[mn]());
   unique_ptr<int4[]> ipivptr(new int4[minmn]());
 
@@ -66,89 +71,100 @@ template<typename T> void lu_dense_runner(RegContainer& reg, shared_ptr<const OG
 
   // extract U, get triangle, then square
   // U strides in 'minmn', A strides in 'm'
-  int4 lim = minmn > n ? n : minmn;
-  for (int4 i = 0; i < lim - 1; i++)
+  if (wantU)
   {
-    int4 mi = m * i;
-    int4 ni = minmn * i;
-    for (int4 j = 0; j <= i; j++)
+    int4 lim = minmn > n ? n : minmn;
+    for (int4 i = 0; i < lim - 1; i++)
     {
-      U[ni + j] = A[mi + j];
+      int4 mi = m * i;
+      int4 ni = minmn * i;
+      for (int4 j = 0; j <= i; j++)
+      {
+        U[ni + j] = A[mi + j];
+      }
     }
-  }
-  for (int4 i = lim - 1; i < n; i++)
-  {
-    int4 mi = m * i;
-    int4 ni = minmn * i;
-    for (int4 j = 0; j < minmn; j++)
+    for (int4 i = lim - 1; i < n; i++)
     {
-      U[ni + j] = A[mi + j];
+      int4 mi = m * i;
+      int4 ni = minmn * i;
+      for (int4 j = 0; j < minmn; j++)
+      {
+        U[ni + j] = A[mi + j];
+      }
     }
   }
 
-  // Transpose the pivot... create as permutation
-  unique_ptr<int4[]> permptr (new int4[m]);
-  int4 * perm = permptr.get();
-  // 1) turn into 0 based indexing
-  for (int4 i = 0; i < minmn; i++)
-  {
-    ipiv[i] -= 1;
-  }
-  // 2) 0:m-1 range vector, will be permuted in a tick
-  for (int4 i = 0; i < m; i++)
+  if (wantL)
   {
-    perm[i] = i;
-  }
-  // 3) apply permutation to range indexed vector, just walk through in order and apply the swaps
-  int4 swp;
-  for (int4 i = 0; i < minmn; i++)
-  {
-    int4 piv = ipiv[i]; // get pivot at index "i"
-    // apply the pivot by swapping the corresponding "row" indices in the perm index vector
-    if (piv != i)
+    // Transpose the pivot... create as permutation
+    unique_ptr<int4[]> permptr (new int4[m]);
+    int4 * perm = permptr.get();
+    // 1) turn into 0 based indexing
+    for (int4 i = 0; i < minmn; i++)
     {
-      swp = perm[piv];
-      perm[piv] = perm[i];
-      perm[i] = swp;
+      ipiv[i] -= 1;
     }
-  }
-
-  // kill triu of A, write 1 onto diag of A too
-  A[0] = 1.e0;
-  for (int4 i = 1; i < minmn; i++)
-  {
-    A[m*i+i] = 1.e0;
-    for (int4 j = 0; j < i; j++)
+    // 2) 0:m-1 range vector, will be permuted in a tick
+    for (int4 i = 0; i < m; i++)
     {
-      A[i*m+j]=0.e0;
+      perm[i] = i;
+    }
+    // 3) apply permutation to range indexed vector, just walk through in order and apply the swaps
+    int4 swp;
+    for (int4 i = 0; i < minmn; i++)
+    {
+      int4 piv = ipiv[i]; // get pivot at index "i"
+      // apply the pivot by swapping the corresponding "row" indices in the perm index vector
+      if (piv != i)
+      {
+        swp = perm[piv];
+        perm[piv] = perm[i];
+        perm[i] = swp;
+      }
     }
-  }
 
-  // apply pivot during assign to L
-  for (int4 i = 0; i < m; i++)
-  {
-    int4 permi = perm[i];
-    int4 row = perm[permi];
-    if(row==i)
+    // kill triu of A, write 1 onto diag of A too
+    A[0] = 1.e0;
+    for (int4 i = 1; i < minmn; i++)
     {
-      for (int4 j = 0; j < minmn; j++)
+      A[m*i+i] = 1.e0;
+      for (int4 j = 0; j < i; j++)
       {
-        int4 jm = j*m;
-        L[jm+i] = A[jm+permi];
+        A[i*m+j]=0.e0;
       }
     }
-    else
+
+    // apply pivot during assign to L
+    for (int4 i = 0; i < m; i++)
     {
-      for (int4 j = 0; j < minmn; j++)
+      int4 permi = perm[i];
+      int4 row = perm[permi];
+      if(row==i)
       {
-        int4 jm = j*m;
-        L[jm+i] = A[jm+row];
+        for (int4 j = 0; j < minmn; j++)
+        {
+          int4 jm = j*m;
+          L[jm+i] = A[jm+permi];
+        }
+      }
+      else
+      {
+        for (int4 j = 0; j < minmn; j++)
+        {
+          int4 jm = j*m;
+          L[jm+i] = A[jm+row];
+        }
       }
     }
   }
 
-  OGNumeric::Ptr cL = makeConcreteDenseMatrix(Lptr.release(), m, minmn, OWNER);
-  OGNumeric::Ptr cU = makeConcreteDenseMatrix(Uptr.release(), minmn, n, OWNER);
+  OGNumeric::Ptr cL = wantL ? makeConcreteDenseMatrix(Lptr.release(), m, minmn, OWNER) : OGNumeric::Ptr{};
+  OGNumeric::Ptr cU = wantU ? makeConcreteDenseMatrix(Uptr.release(), minmn, n, OWNER) : OGNumeric::Ptr{};
+  // U is upper triangular by construction, L is only so up to the row permutation
+  if (wantU)
+  {
+    cU->asOGTerminal()->setStructure(Structure(Structure::UPPER_TRIANGULAR));
+  }
 
   reg.push_back(cL);
   reg.push_back(cU);
@@ -400,26 +400,74 @@ std::unique_ptr<TriangularStruct> isTriangular(T * data, size_t rows, size_t col
 }
 
 
+/**
+ * Finds the result of probing a matrix with \a isTriangular from the structure recorded
+ * for it, where the structure decides it, so that the probe can be skipped.
+ * @param structure the structure of the matrix.
+ * @return a unique_ptr to a \a TriangularStruct type containing the properties known,
+ * null if the structure does not decide whether the matrix is triangular.
+ */
+std::unique_ptr<TriangularStruct> knownTriangular(const Structure& structure)
+{
+  std::unique_ptr<TriangularStruct> tptr (new TriangularStruct());
+  if (structure.has(Structure::UPPER_TRIANGULAR))
+  {
+    tptr->flagUPLO = UPLO::UPPER;
+  }
+  else if (structure.has(Structure::LOWER_TRIANGULAR))
+  {
+    tptr->flagUPLO = UPLO::LOWER;
+  }
+  else if (!structure.has(Structure::HERMITIAN))
+  {
+    return nullptr;
+  }
+  // A Hermitian matrix that is not known to be triangular is left to Cholesky, which
+  // solves it as well if it happens to be diagonal
+  if (structure.has(Structure::UNIT_DIAGONAL))
+  {
+    tptr->flagDiag = UNITDIAG::UNIT;
+  }
+  return tptr;
+}
+
 } // end namespace detail
 
 
 // This is a rough translation of OG mldivide from OG-Maths_Legacy ~2012,
 //  which in turn is based on my libllsq from ~2011
 
+/**
+ * Copies the system matrix A into the working space of the solver, which destroys it.
+ * A transposed view is transposed as it is copied, so solving with it costs no more than
+ * solving with a dense matrix.
+ */
+template<typename T>
+void copySystem(const OGMatrix<T>& system, T * dest)
+{
+  std::copy(system.getData(), system.getData() + system.getDatalen(), dest);
+}
+
+template<typename T>
+void copySystem(const OGTransposedMatrix<T>& system, T * dest)
+{
+  system.materialise(dest);
+}
+
 /**
  * mldivide_dense_runner is the "super solver" routine. Will attempt to optimally (in terms of speed and accuracy) solve any valid linear system of the form AX=B, where A, X and B are all matrices.
  * @param T the data type, real8 or complex16 are valid.
+ * @param A the type of the pointer to A, a dense matrix or a transposed view of one.
  * @param reg0 the register for the return value, X.
  * @param arg0 the matrix A.
  * @param arg0 the matrix B.
  */
-template<typename T>
+template<typename T, typename A>
 void*
-mldivide_dense_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, shared_ptr<const OGMatrix<T>> arg1)
+mldivide_dense_runner(RegContainer& reg0, A arg0, shared_ptr<const OGMatrix<T>> arg1)
 {
 
   // data from array 1 (A)
-  T * ptrdata1 = arg0->getData();
   std::size_t rows1 = arg0->getRows();
   std::size_t cols1 = arg0->getCols();
   int4 int4rows1 = rows1;
@@ -427,7 +475,7 @@ mldivide_dense_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, sh
   std::size_t len1 = rows1 * cols1;
   std::unique_ptr<T[]> data1Ptr (new T[len1]);
   T * data1 = data1Ptr.get();
-  std::copy(ptrdata1,ptrdata1+len1,data1);
+  copySystem(*arg0, data1);
 
   // data from array 2 (B)
   T * ptrdata2 = arg1->getData();
@@ -524,8 +572,17 @@ mldivide_dense_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, sh
       cerr << "10. Matrix is square"  << std::endl;
     }
 
-    // Is the array1 triangular or permuted triangular, send probe and get back struct containing result
-    unique_ptr<detail::TriangularStruct> tptr = detail::isTriangular(data1, rows1, cols1);
+    // Is the array1 triangular or permuted triangular, trust its structure if that says,
+    // else send probe and get back struct containing result
+    unique_ptr<detail::TriangularStruct> tptr = detail::knownTriangular(arg0->getStructure());
+    if (tptr == nullptr)
+    {
+      tptr = detail::isTriangular(data1, rows1, cols1);
+    }
+    else if (detail::report_verbose)
+    {
+      cerr << "15. Triangular probe skipped, structure is known" << std::endl;
+    }
 
     // Set flags based on triangular probe
     detail::UPLO UPLO = tptr->flagUPLO;
@@ -685,8 +742,8 @@ mldivide_dense_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, sh
         cerr << "50. Not triangular" << std::endl;
       }
       bool cholesky_mangled_data = false;
-      // See if it's Hermitian (symmetric in the real case)
-      if (detail::isHermitian(data1, rows1, cols1))
+      // See if it's Hermitian (symmetric in the real case), known or probed
+      if (arg0->getStructure().has(Structure::HERMITIAN) || detail::isHermitian(data1, rows1, cols1))
       {
         if (detail::report_verbose)
         {
@@ -767,9 +824,12 @@ mldivide_dense_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, sh
         // Get new copy of the matrix data if cholesky ran
         if(cholesky_mangled_data)
         {
-          std::copy(arg0->getData(),arg0->getData()+len1,data1);
+          copySystem(*arg0, data1);
         }
 
+        // the 1 norm for the condition estimate, from A before it is decomposed
+        anorm = lapack::xlange(lapack::ONE, &int4rows1, &int4cols1, data1, &int4rows1);
+
         // try solving with generalised LUP solver, will need a pivot store first
         unique_ptr<int[]> ipivPtr (new int4[rows1]);
 
@@ -798,7 +858,6 @@ mldivide_dense_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, sh
           }
 
           // compute a reciprocal condition estimate based on decomposition
-          anorm = lapack::xlange(lapack::ONE, &int4rows1, &int4cols1, arg0->getData(), &int4rows1);
           lapack::xgecon(lapack::ONE, &int4rows1, data1, &int4rows1, &anorm, &rcond, &info);
 
           // if condition estimate isn't too bad then back solve
@@ -857,7 +916,7 @@ mldivide_dense_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, sh
       attemptQR = false;
     }
     // take a copy of the original data as it will have been destroyed above in the decomp trials
-    std::copy(arg0->getData(),arg0->getData()+len1,data1Ptr.get());
+    copySystem(*arg0, data1Ptr.get());
   }
 
   // needed for QR and SVD, the leading dimension of matrix "B"
@@ -925,7 +984,7 @@ mldivide_dense_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, sh
         }
       }
       // take a copy of the original data as it will have been destroyed above
-      std::copy(arg0->getData(),arg0->getData()+len1,data1);
+      copySystem(*arg0, data1);
     }
     else
     {
@@ -1014,6 +1073,58 @@ mldivide_dense_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, sh
   return nullptr;
 }
 
+/**
+ * mldivide_diagonal_runner solves AX=B for a diagonal A by dividing the rows of B, in
+ * O(n*k) rather than converting A to a dense matrix. Only square systems with a
+ * nonzero, finite diagonal are solved this way; the rest are left to
+ * mldivide_dense_runner so that errors and least squares solutions are as for dense A.
+ * @param T the data type, real8 or complex16 are valid.
+ * @param reg0 the register for the return value, X.
+ * @param arg0 the matrix A.
+ * @param arg1 the matrix B.
+ * @return true if the system was solved and X pushed into \a reg0.
+ */
+template<typename T>
+bool
+mldivide_diagonal_runner(RegContainer& reg0, shared_ptr<const OGDiagonalMatrix<T>> arg0, shared_ptr<const OGMatrix<T>> arg1)
+{
+  std::size_t rows1 = arg0->getRows();
+  std::size_t cols1 = arg0->getCols();
+  std::size_t rows2 = arg1->getRows();
+  std::size_t cols2 = arg1->getCols();
+  if (rows1 != cols1 || rows1 != rows2)
+  {
+    return false;
+  }
+  T * d = arg0->getData();
+  if (!isfinite(d, rows1))
+  {
+    return false;
+  }
+  for (std::size_t i = 0; i < rows1; i++)
+  {
+    if (d[i] == 0.e0)
+    {
+      return false;
+    }
+  }
+  if (detail::report_verbose)
+  {
+    cerr << "3. Matrix is diagonal, dividing rows" << std::endl;
+  }
+  const T * b = arg1->getData();
+  std::unique_ptr<T[]> data (new T[rows2 * cols2]);
+  for (std::size_t j = 0; j < cols2; j++)
+  {
+    for (std::size_t i = 0; i < rows2; i++)
+    {
+      data[i + j * rows2] = b[i + j * rows2] / d[i];
+    }
+  }
+  reg0.push_back(makeConcreteDenseMatrix(data.release(), rows2, cols2, OWNER));
+  return true;
+}
+
 
 // MLDIVIDE runner:
 void * MLDIVIDERunner::run(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
@@ -1029,6 +1140,37 @@ void * MLDIVIDERunner::run(RegContainer& reg0, OGRealDenseMatrix::Ptr arg0, OGRe
   return nullptr;
 }
 
+void * MLDIVIDERunner::run(RegContainer& reg0, OGRealDiagonalMatrix::Ptr arg0, OGRealDenseMatrix::Ptr arg1) const
+{
+  if (!mldivide_diagonal_runner<real8>(reg0, arg0, arg1))
+  {
+    mldivide_dense_runner<real8>(reg0, arg0->asFullOGRealDenseMatrix(), arg1);
+  }
+  return nullptr;
+}
+
+void * MLDIVIDERunner::run(RegContainer& reg0, OGComplexDiagonalMatrix::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
+{
+  if (!mldivide_diagonal_runner<complex16>(reg0, arg0, arg1))
+  {
+    mldivide_dense_runner<complex16>(reg0, arg0->asFullOGComplexDenseMatrix(), arg1);
+  }
+  return nullptr;
+}
+
+// Transposed view MLDIVIDE runners, the transpose is formed in the copy the solver works on
+void * MLDIVIDERunner::run(RegContainer& reg0, OGRealTransposedMatrix::Ptr arg0, OGRealDenseMatrix::Ptr arg1) const
+{
+  mldivide_dense_runner<real8>(reg0, arg0, arg1);
+  return nullptr;
+}
+
+void * MLDIVIDERunner::run(RegContainer& reg0, OGComplexTransposedMatrix::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
+{
+  mldivide_dense_runner<complex16>(reg0, arg0, arg1);
+  return nullptr;
+}
+
 void *
 MLDIVIDERunner::run(RegContainer& reg0, OGRealScalar::Ptr arg0, OGRealScalar::Ptr arg1) const
 {
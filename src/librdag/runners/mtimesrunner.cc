@@ -12,10 +12,14 @@
 #include "terminal.hh"
 #include "uncopyable.hh"
 #include "lapack.hh"
+#include "sparse.hh"
+#include "diagonal.hh"
 
 #include <stdio.h>
 #include <complex>
 #include <sstream>
+#include <memory>
+#include <type_traits>
 
 using namespace std;
 
@@ -87,7 +91,240 @@ mtimes_dense_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, shar
 }
 
 
+/**
+ * Multiplies every entry of a dense matrix by a scalar, which may be of the other data
+ * type, giving a complex matrix if either is complex.
+ */
+template<typename S, typename T>
+OGNumeric::Ptr scale_dense(S s, const OGMatrix<T>& m)
+{
+  typedef decltype(s * T()) R;
+  size_t n = m.getDatalen();
+  R * tmp = new R[n];
+  const T * data = m.getData();
+  for (size_t i = 0; i < n; i++)
+  {
+    tmp[i] = s * data[i];
+  }
+  return makeConcreteDenseMatrix(tmp, m.getRows(), m.getCols(), OWNER);
+}
+
+/**
+ * The values of the scalar terminals, integers being multiplied as reals.
+ */
+real8 scalar_value(const OGRealScalar& s)
+{
+  return s.getValue();
+}
+
+complex16 scalar_value(const OGComplexScalar& s)
+{
+  return s.getValue();
+}
+
+real8 scalar_value(const OGIntegerScalar& s)
+{
+  return static_cast<real8>(s.getValue());
+}
+
+void checkMixedCommute(int4 rowsArray1, int4 colsArray1, int4 rowsArray2, int4 colsArray2)
+{
+  if(colsArray1!=rowsArray2)
+  {
+    stringstream message;
+    message << "Matrices do not commute. First is: " << rowsArray1 <<"x"<< colsArray1 <<". Second is: " << rowsArray2 <<"x"<< colsArray2;
+    throw rdag_error(message.str());
+  }
+}
+
+/**
+ * Computes arg0 * arg1 for a complex arg0 and a real arg1 without promoting arg1. Viewed
+ * as reals, the data of arg0 is a matrix with twice the rows, alternating real and
+ * imaginary parts, and its product with arg1 is the result in the same layout, so one
+ * real GEMM does the work.
+ */
+void
+mtimes_complex_real_runner(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGRealDenseMatrix::Ptr arg1)
+{
+  int4 colsArray1 = arg0->getCols();
+  int4 colsArray2 = arg1->getCols();
+  int4 rowsArray1 = arg0->getRows();
+  int4 rowsArray2 = arg1->getRows();
+  OGNumeric::Ptr ret;
+  if (colsArray1 == 1 && rowsArray1 == 1) { // We have scalar * matrix
+    ret = scale_dense(arg0->getData()[0], *arg1);
+  } else if (colsArray2 == 1 && rowsArray2 == 1) { // We have matrix * scalar
+    ret = scale_dense(arg1->getData()[0], *arg0);
+  } else {
+    checkMixedCommute(rowsArray1, colsArray1, rowsArray2, colsArray2);
+    int4 fm = 2 * rowsArray1;
+    int4 fn = colsArray2;
+    int4 fk = colsArray1;
+    real8 fp_one = 1.e0;
+    real8 beta = 0.e0;
+    complex16 * tmp = new complex16[rowsArray1 * colsArray2];
+    lapack::xgemm(lapack::N, lapack::N, &fm, &fn, &fk, &fp_one, reinterpret_cast<real8 *>(arg0->getData()), &fm,
+                  arg1->getData(), &fk, &beta, reinterpret_cast<real8 *>(tmp), &fm);
+    ret = makeConcreteDenseMatrix(tmp, rowsArray1, colsArray2, OWNER);
+  }
+  reg0.push_back(ret);
+}
+
+/**
+ * Computes arg0 * arg1 for a real arg0 and a complex arg1 without promoting arg0. The
+ * real and imaginary parts of arg1 are split side by side into one real matrix, so a
+ * single real GEMM computes both arg0 * real(arg1) and arg0 * imag(arg1).
+ */
+void
+mtimes_real_complex_runner(RegContainer& reg0, OGRealDenseMatrix::Ptr arg0, OGComplexDenseMatrix::Ptr arg1)
+{
+  int4 colsArray1 = arg0->getCols();
+  int4 colsArray2 = arg1->getCols();
+  int4 rowsArray1 = arg0->getRows();
+  int4 rowsArray2 = arg1->getRows();
+  OGNumeric::Ptr ret;
+  if (colsArray1 == 1 && rowsArray1 == 1) { // We have scalar * matrix
+    ret = scale_dense(arg0->getData()[0], *arg1);
+  } else if (colsArray2 == 1 && rowsArray2 == 1) { // We have matrix * scalar
+    ret = scale_dense(arg1->getData()[0], *arg0);
+  } else {
+    checkMixedCommute(rowsArray1, colsArray1, rowsArray2, colsArray2);
+    int4 fm = rowsArray1;
+    int4 fn = 2 * colsArray2;
+    int4 fk = colsArray1;
+    size_t n = arg1->getDatalen();
+    const complex16 * data2 = arg1->getData();
+    unique_ptr<real8[]> parts(new real8[2 * n]);
+    for (size_t i = 0; i < n; i++)
+    {
+      parts[i] = data2[i].real();
+      parts[i + n] = data2[i].imag();
+    }
+    size_t len = static_cast<size_t>(rowsArray1) * colsArray2;
+    unique_ptr<real8[]> products(new real8[2 * len]);
+    real8 fp_one = 1.e0;
+    real8 beta = 0.e0;
+    lapack::xgemm(lapack::N, lapack::N, &fm, &fn, &fk, &fp_one, arg0->getData(), &fm,
+                  parts.get(), &fk, &beta, products.get(), &fm);
+    complex16 * tmp = new complex16[len];
+    for (size_t i = 0; i < len; i++)
+    {
+      tmp[i] = complex16(products[i], products[i + len]);
+    }
+    ret = makeConcreteDenseMatrix(tmp, rowsArray1, colsArray2, OWNER);
+  }
+  reg0.push_back(ret);
+}
+
+/**
+ * Computes arg0 * arg1 for single precision matrices in single precision, with xGEMM for
+ * matrix-vector products too since the BLAS wrappers have no single precision xGEMV.
+ */
+template<typename T>
+void
+mtimes_single_runner(RegContainer& reg0, shared_ptr<const OGMatrix<T>> arg0, shared_ptr<const OGMatrix<T>> arg1)
+{
+  int4 colsArray1 = arg0->getCols();
+  int4 colsArray2 = arg1->getCols();
+  int4 rowsArray1 = arg0->getRows();
+  int4 rowsArray2 = arg1->getRows();
+  OGNumeric::Ptr ret;
+  if (colsArray1 == 1 && rowsArray1 == 1) { // We have scalar * matrix
+    ret = scale_dense(arg0->getData()[0], *arg1);
+  } else if (colsArray2 == 1 && rowsArray2 == 1) { // We have matrix * scalar
+    ret = scale_dense(arg1->getData()[0], *arg0);
+  } else {
+    checkMixedCommute(rowsArray1, colsArray1, rowsArray2, colsArray2);
+    int4 fm = rowsArray1;
+    int4 fn = colsArray2;
+    int4 fk = colsArray1;
+    T fp_one = 1.e0;
+    T beta = 0.e0;
+    T * tmp = new T[fm * fn];
+    lapack::xgemm(lapack::N, lapack::N, &fm, &fn, &fk, &fp_one, arg0->getData(), &fm,
+                  arg1->getData(), &fk, &beta, tmp, &fm);
+    ret = makeConcreteDenseMatrix(tmp, fm, fn, OWNER);
+  }
+  reg0.push_back(ret);
+}
+
+/**
+ * An operand of xGEMM: its data as stored, the shape of the matrix it stands for and how
+ * BLAS is to read the data to get that matrix.
+ */
+template<typename T>
+struct GemmOperand
+{
+  T * data;
+  int4 rows;
+  int4 cols;
+  int4 ld;
+  char * trans;
+};
 
+template<typename T>
+GemmOperand<T> gemm_operand(typename OGMatrix<T>::Ptr arg)
+{
+  return { arg->getData(), static_cast<int4>(arg->getRows()), static_cast<int4>(arg->getCols()),
+           static_cast<int4>(arg->getRows()), lapack::N };
+}
+
+// the data of a view is its source, which is cols x rows
+template<typename T>
+GemmOperand<T> gemm_operand(typename OGTransposedMatrix<T>::Ptr arg)
+{
+  return { arg->getData(), static_cast<int4>(arg->getRows()), static_cast<int4>(arg->getCols()),
+           static_cast<int4>(arg->getCols()), arg->isConjugate() ? lapack::C : lapack::T };
+}
+
+template<typename T>
+typename OGMatrix<T>::Ptr dense_operand(typename OGMatrix<T>::Ptr arg)
+{
+  return arg;
+}
+
+template<typename T>
+typename OGMatrix<T>::Ptr dense_operand(typename OGTransposedMatrix<T>::Ptr arg)
+{
+  T * data = new T[arg->getDatalen()];
+  arg->materialise(data);
+  return static_pointer_cast<const OGMatrix<T>, const OGNumeric>(
+    makeConcreteDenseMatrix(data, arg->getRows(), arg->getCols(), OWNER));
+}
+
+/**
+ * Computes arg0 * arg1 where either is a transposed view, passing the transposition on
+ * to xGEMM as its TRANS arguments rather than forming the transpose.
+ */
+template<typename T, typename A0, typename A1>
+void
+mtimes_transposed_runner(RegContainer& reg0, A0 arg0, A1 arg1)
+{
+  GemmOperand<T> a = gemm_operand<T>(arg0);
+  GemmOperand<T> b = gemm_operand<T>(arg1);
+  if ((a.rows == 1 && a.cols == 1) || (b.rows == 1 && b.cols == 1))
+  {
+    // scaling gains nothing from the view
+    mtimes_dense_runner<T>(reg0, dense_operand<T>(arg0), dense_operand<T>(arg1));
+    return;
+  }
+  checkMixedCommute(a.rows, a.cols, b.rows, b.cols);
+  T fp_one = 1.e0;
+  T beta = 0.e0;
+  T * tmp = new T[a.rows * b.cols];
+  int4 ldc = a.rows;
+  lapack::xgemm(a.trans, b.trans, &a.rows, &b.cols, &a.cols, &fp_one, a.data, &a.ld,
+                b.data, &b.ld, &beta, tmp, &ldc);
+  OGNumeric::Ptr ret = makeConcreteDenseMatrix(tmp, a.rows, b.cols, OWNER);
+  // A.' * A and A * A.' are symmetric for real A, as A' * A and A * A' are Hermitian, so
+  // their consumers need not check
+  bool gram = a.data == b.data && (a.trans == lapack::N) != (b.trans == lapack::N);
+  if (gram && (std::is_same<T, real8>::value || a.trans == lapack::C || b.trans == lapack::C))
+  {
+    ret->asOGTerminal()->setStructure(Structure(Structure::HERMITIAN));
+  }
+  reg0.push_back(ret);
+}
 
 // MTIMES runner:
 void * MTIMESRunner::run(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
@@ -111,4 +348,313 @@ MTIMESRunner::run(RegContainer& reg0, OGRealScalar::Ptr arg0, OGRealScalar::Ptr
     return nullptr;
 }
 
+// Scalar MTIMES runners, the scalar is used as it is rather than converted to a 1x1
+// matrix
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexScalar::Ptr arg0, OGComplexScalar::Ptr arg1) const
+{
+  reg0.push_back(makeConcreteScalar(scalar_value(*arg0) * scalar_value(*arg1)));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexScalar::Ptr arg0, OGIntegerScalar::Ptr arg1) const
+{
+  reg0.push_back(makeConcreteScalar(scalar_value(*arg0) * scalar_value(*arg1)));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexScalar::Ptr arg0, OGRealScalar::Ptr arg1) const
+{
+  reg0.push_back(makeConcreteScalar(scalar_value(*arg0) * scalar_value(*arg1)));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGIntegerScalar::Ptr arg0, OGComplexScalar::Ptr arg1) const
+{
+  reg0.push_back(makeConcreteScalar(scalar_value(*arg0) * scalar_value(*arg1)));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGIntegerScalar::Ptr arg0, OGIntegerScalar::Ptr arg1) const
+{
+  reg0.push_back(makeConcreteScalar(scalar_value(*arg0) * scalar_value(*arg1)));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGIntegerScalar::Ptr arg0, OGRealScalar::Ptr arg1) const
+{
+  reg0.push_back(makeConcreteScalar(scalar_value(*arg0) * scalar_value(*arg1)));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealScalar::Ptr arg0, OGComplexScalar::Ptr arg1) const
+{
+  reg0.push_back(makeConcreteScalar(scalar_value(*arg0) * scalar_value(*arg1)));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealScalar::Ptr arg0, OGIntegerScalar::Ptr arg1) const
+{
+  reg0.push_back(makeConcreteScalar(scalar_value(*arg0) * scalar_value(*arg1)));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexScalar::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg0), *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexScalar::Ptr arg0, OGRealDenseMatrix::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg0), *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGIntegerScalar::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg0), *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGIntegerScalar::Ptr arg0, OGRealDenseMatrix::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg0), *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealScalar::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg0), *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealScalar::Ptr arg0, OGRealDenseMatrix::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg0), *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGComplexScalar::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg1), *arg0));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealDenseMatrix::Ptr arg0, OGComplexScalar::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg1), *arg0));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGIntegerScalar::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg1), *arg0));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealDenseMatrix::Ptr arg0, OGIntegerScalar::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg1), *arg0));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGRealScalar::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg1), *arg0));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealDenseMatrix::Ptr arg0, OGRealScalar::Ptr arg1) const
+{
+  reg0.push_back(scale_dense(scalar_value(*arg1), *arg0));
+  return nullptr;
+}
+
+// Mixed real and complex MTIMES runners
+void * MTIMESRunner::run(RegContainer& reg0, OGRealDenseMatrix::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
+{
+  mtimes_real_complex_runner(reg0, arg0, arg1);
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGRealDenseMatrix::Ptr arg1) const
+{
+  mtimes_complex_real_runner(reg0, arg0, arg1);
+  return nullptr;
+}
+
+// Single precision MTIMES runners
+void * MTIMESRunner::run(RegContainer& reg0, OGRealSingleDenseMatrix::Ptr arg0, OGRealSingleDenseMatrix::Ptr arg1) const
+{
+  mtimes_single_runner<real4>(reg0, arg0, arg1);
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexSingleDenseMatrix::Ptr arg0, OGComplexSingleDenseMatrix::Ptr arg1) const
+{
+  mtimes_single_runner<complex8>(reg0, arg0, arg1);
+  return nullptr;
+}
+
+// Sparse MTIMES runners, the result is dense unless both arguments are sparse or one is
+// a scalar
+void * MTIMESRunner::run(RegContainer& reg0, OGRealSparseMatrix::Ptr arg0, OGRealSparseMatrix::Ptr arg1) const
+{
+  reg0.push_back(sparse::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexSparseMatrix::Ptr arg0, OGComplexSparseMatrix::Ptr arg1) const
+{
+  reg0.push_back(sparse::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealSparseMatrix::Ptr arg0, OGRealDenseMatrix::Ptr arg1) const
+{
+  reg0.push_back(sparse::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexSparseMatrix::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
+{
+  reg0.push_back(sparse::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealDenseMatrix::Ptr arg0, OGRealSparseMatrix::Ptr arg1) const
+{
+  reg0.push_back(sparse::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGComplexSparseMatrix::Ptr arg1) const
+{
+  reg0.push_back(sparse::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealSparseMatrix::Ptr arg0, OGRealScalar::Ptr arg1) const
+{
+  reg0.push_back(sparse::scale(*arg0, arg1->getValue()));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexSparseMatrix::Ptr arg0, OGComplexScalar::Ptr arg1) const
+{
+  reg0.push_back(sparse::scale(*arg0, arg1->getValue()));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealScalar::Ptr arg0, OGRealSparseMatrix::Ptr arg1) const
+{
+  reg0.push_back(sparse::scale(*arg1, arg0->getValue()));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexScalar::Ptr arg0, OGComplexSparseMatrix::Ptr arg1) const
+{
+  reg0.push_back(sparse::scale(*arg1, arg0->getValue()));
+  return nullptr;
+}
+
+// Diagonal MTIMES runners, the result is dense unless both arguments are diagonal or one
+// is a scalar
+void * MTIMESRunner::run(RegContainer& reg0, OGRealDiagonalMatrix::Ptr arg0, OGRealDiagonalMatrix::Ptr arg1) const
+{
+  reg0.push_back(diagonal::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexDiagonalMatrix::Ptr arg0, OGComplexDiagonalMatrix::Ptr arg1) const
+{
+  reg0.push_back(diagonal::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealDiagonalMatrix::Ptr arg0, OGRealDenseMatrix::Ptr arg1) const
+{
+  reg0.push_back(diagonal::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexDiagonalMatrix::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
+{
+  reg0.push_back(diagonal::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealDenseMatrix::Ptr arg0, OGRealDiagonalMatrix::Ptr arg1) const
+{
+  reg0.push_back(diagonal::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGComplexDiagonalMatrix::Ptr arg1) const
+{
+  reg0.push_back(diagonal::mtimes(*arg0, *arg1));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealDiagonalMatrix::Ptr arg0, OGRealScalar::Ptr arg1) const
+{
+  reg0.push_back(diagonal::scale(*arg0, arg1->getValue()));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexDiagonalMatrix::Ptr arg0, OGComplexScalar::Ptr arg1) const
+{
+  reg0.push_back(diagonal::scale(*arg0, arg1->getValue()));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealScalar::Ptr arg0, OGRealDiagonalMatrix::Ptr arg1) const
+{
+  reg0.push_back(diagonal::scale(*arg1, arg0->getValue()));
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexScalar::Ptr arg0, OGComplexDiagonalMatrix::Ptr arg1) const
+{
+  reg0.push_back(diagonal::scale(*arg1, arg0->getValue()));
+  return nullptr;
+}
+
+// Transposed view MTIMES runners
+void * MTIMESRunner::run(RegContainer& reg0, OGRealTransposedMatrix::Ptr arg0, OGRealDenseMatrix::Ptr arg1) const
+{
+  mtimes_transposed_runner<real8>(reg0, arg0, arg1);
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexTransposedMatrix::Ptr arg0, OGComplexDenseMatrix::Ptr arg1) const
+{
+  mtimes_transposed_runner<complex16>(reg0, arg0, arg1);
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealDenseMatrix::Ptr arg0, OGRealTransposedMatrix::Ptr arg1) const
+{
+  mtimes_transposed_runner<real8>(reg0, arg0, arg1);
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexDenseMatrix::Ptr arg0, OGComplexTransposedMatrix::Ptr arg1) const
+{
+  mtimes_transposed_runner<complex16>(reg0, arg0, arg1);
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGRealTransposedMatrix::Ptr arg0, OGRealTransposedMatrix::Ptr arg1) const
+{
+  mtimes_transposed_runner<real8>(reg0, arg0, arg1);
+  return nullptr;
+}
+
+void * MTIMESRunner::run(RegContainer& reg0, OGComplexTransposedMatrix::Ptr arg0, OGComplexTransposedMatrix::Ptr arg1) const
+{
+  mtimes_transposed_runner<complex16>(reg0, arg0, arg1);
+  return nullptr;
+}
+
 }
@@ -19,6 +19,7 @@
 #include <complex>
 #include <sstream>
 #include <limits>
+#include <algorithm>
 
 using namespace std;
 
@@ -190,6 +191,40 @@ pinv_dense_runner(RegContainer& reg, shared_ptr<const OGMatrix<T>> arg)
   reg.push_back(ret);
 }
 
+/**
+ * The pseudo-inverse of a diagonal matrix is its transpose with the entries that are
+ * not numerically zero inverted, its singular values being those entries' magnitudes.
+ * The result stays diagonal and the cost is O(n).
+ */
+template<typename T>
+void
+pinv_diagonal_runner(RegContainer& reg, shared_ptr<const OGDiagonalMatrix<T>> arg)
+{
+  const size_t m = arg->getRows();
+  const size_t n = arg->getCols();
+  const size_t minmn = arg->getDatalen();
+  const T * d = arg->getData();
+
+  real8 msv = 0.e0;
+  for(size_t i = 0; i < minmn; i++)
+  {
+    msv = std::max(msv, static_cast<real8>(std::abs(d[i])));
+  }
+  real8 thres = pinv_threshold(msv, m, n);
+
+  // an all zero matrix has an all zero pseudo-inverse
+  unique_ptr<T[]> data (new T[std::max(minmn, static_cast<size_t>(1))]());
+  for(size_t i = 0; i < minmn; i++)
+  {
+    if(std::abs(d[i]) > thres)
+    {
+      data[i] = 1.e0/d[i];
+    }
+  }
+
+  reg.push_back(makeConcreteDiagonalMatrix(data.release(), n, m, OWNER));
+}
+
 void *
 PINVRunner::run(RegContainer& reg, OGRealDenseMatrix::Ptr arg) const
 {
@@ -204,4 +239,18 @@ PINVRunner::run(RegContainer& reg, OGComplexDenseMatrix::Ptr arg) const
   return nullptr;
 }
 
+void *
+PINVRunner::run(RegContainer& reg, OGRealDiagonalMatrix::Ptr arg) const
+{
+  pinv_diagonal_runner<real8>(reg, arg);
+  return nullptr;
+}
+
+void *
+PINVRunner::run(RegContainer& reg, OGComplexDiagonalMatrix::Ptr arg) const
+{
+  pinv_diagonal_runner<complex16>(reg, arg);
+  return nullptr;
+}
+
 } // end namespace
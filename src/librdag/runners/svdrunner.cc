@@ -12,6 +12,7 @@
 #include "terminal.hh"
 #include "uncopyable.hh"
 #include "lapack.hh"
+#include "demand.hh"
 #include "debug.h"
 
 using namespace std;
@@ -26,13 +27,18 @@ template<typename T> void svd_dense_runner(RegContainer& reg, shared_ptr<const O
   int4 m = arg->getRows();
   int4 n = arg->getCols();
   int4 lda = m > 1 ? m : 1;
-  int4 ldu = lda;
   int4 minmn = m > n ? n : m;
-  int4 ldvt = n;
   int4 info = 0;
 
-  unique_ptr<T[]> Uptr (new T[ldu*m]);
-  unique_ptr<T[]> VTptr (new T[ldvt*n]);
+  // U and VT are only computed if they are selected, S always is as LAPACK computes
+  // it regardless
+  bool wantU = ResultDemand::isNeeded(0);
+  bool wantVT = ResultDemand::isNeeded(2);
+  int4 ldu = wantU ? lda : 1;
+  int4 ldvt = wantVT ? n : 1;
+
+  unique_ptr<T[]> Uptr (new T[wantU ? ldu*m : 1]);
+  unique_ptr<T[]> VTptr (new T[wantVT ? ldvt*n : 1]);
   unique_ptr<real8[]> Sptr ( new real8[minmn]);
   T * U = Uptr.get();
   T * VT = VTptr.get();
@@ -46,7 +52,8 @@ template<typename T> void svd_dense_runner(RegContainer& reg, shared_ptr<const O
   // call lapack
   try
   {
-    lapack::xgesvd<T, lapack::OnInputCheck::isfinite>(lapack::A, lapack::A, &m, &n, A, &lda, S, U, &ldu, VT, &ldvt, &info);
+    lapack::xgesvd<T, lapack::OnInputCheck::isfinite>(wantU ? lapack::A : lapack::N, wantVT ? lapack::A : lapack::N,
+                                                      &m, &n, A, &lda, S, U, &ldu, VT, &ldvt, &info);
   }
   catch (rdag_recoverable_error& e)
   {
@@ -55,9 +62,9 @@ template<typename T> void svd_dense_runner(RegContainer& reg, shared_ptr<const O
   }
   // Else, exception propagates, stack unwinds
 
-  reg.push_back(makeConcreteDenseMatrix(Uptr.release(), m, m, OWNER));
+  reg.push_back(wantU ? makeConcreteDenseMatrix(Uptr.release(), m, m, OWNER) : OGNumeric::Ptr{});
   reg.push_back(OGRealDiagonalMatrix::create(Sptr.release(), m, n, OWNER));
-  reg.push_back(makeConcreteDenseMatrix(VTptr.release(), n, n, OWNER));
+  reg.push_back(wantVT ? makeConcreteDenseMatrix(VTptr.release(), n, n, OWNER) : OGNumeric::Ptr{});
 }
 
 void *
@@ -43,29 +43,10 @@ transpose_dense_runner(RegContainer& reg, shared_ptr<const OGMatrix<T>> arg)
   {
     ret = makeConcreteScalar(arg->getData()[0]);
   }
-  else // Matrix is a full matrix
+  else // Matrix is a full matrix, view it transposed rather than moving the data
   {
-    size_t m = arg->getRows();
-    size_t n = arg->getCols();
-    size_t retRows = n, retCols = m;
-    T * data = arg->getData();
-    T * tmp = new T[m * n];
-    if(isVector(arg))
-    {
-      size_t len = m > n ? m : n;
-      std::copy(data, data+len, tmp);
-    }
-    else
-    {
-      size_t ir;
-      for (size_t i = 0; i < n; i++) {
-        ir = i * m;
-        for (size_t j = 0; j < m; j++) {
-          tmp[j * n + i] = data[ir + j];
-        }
-      }
-    }
-    ret = makeConcreteDenseMatrix(tmp, retRows, retCols, OWNER);
+    ret = makeConcreteTransposedMatrix<T>(arg, false);
+    ret->asOGTerminal()->setStructure(arg->getStructure().transposed());
   }
 
   // shove ret into register
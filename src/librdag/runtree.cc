@@ -7,17 +7,15 @@
 #include "runtree.hh"
 #include "dispatch.hh"
 #include "execution.hh"
+#include "executor.hh"
 
 namespace librdag {
 
 void runtree(const OGNumeric::Ptr& root)
 {
-  Dispatcher d;
+  const Dispatcher& d = Dispatcher::getInstance();
   ExecutionList el{root};
-  for (auto it = el.begin(); it != el.end(); ++it)
-  {
-    d.dispatch(*it);
-  }
+  execute(el, d);
 }
 
 } // end namespace librdag
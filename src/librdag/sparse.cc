@@ -0,0 +1,568 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <vector>
+#include "sparse.hh"
+#include "exceptions.hh"
+
+namespace librdag {
+
+namespace sparse {
+
+namespace detail {
+
+template<typename T> bool isScalar(const OGArray<T>& a)
+{
+  return a.getRows() == 1 && a.getCols() == 1;
+}
+
+/**
+ * The value of a 1x1 sparse matrix, which may have no entries or several.
+ */
+template<typename T> T getScalarValue(const OGSparseMatrix<T>& a)
+{
+  T value = T();
+  for (int4 p = 0; p < a.getColPtr()[1]; p++)
+  {
+    value += a.getData()[p];
+  }
+  return value;
+}
+
+bool isFinite(real8 x)
+{
+  return std::isfinite(x);
+}
+
+bool isFinite(complex16 x)
+{
+  return std::isfinite(x.real()) && std::isfinite(x.imag());
+}
+
+/**
+ * The positions of the entries of a dense column major array that are Inf or NaN.
+ * These are the entries that make a product with an implicit zero of a sparse
+ * operand nonzero.
+ */
+template<typename T> std::vector<size_t> nonFinite(const T * data, size_t n)
+{
+  std::vector<size_t> ret;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (!isFinite(data[i]))
+    {
+      ret.push_back(i);
+    }
+  }
+  return ret;
+}
+
+template<typename T> void throwMismatch(const OGArray<T>& a, const OGArray<T>& b, const char * symbol)
+{
+  std::stringstream s;
+  s << "Matrix dimensions ";
+  s << "(" << a.getRows() << "," << a.getCols() << ")";
+  s << " and ";
+  s << "(" << b.getRows() << "," << b.getCols() << ")";
+  s << " mismatch for operation: " << symbol;
+  throw rdag_error(s.str());
+}
+
+template<typename T> void checkCommute(const OGArray<T>& a, const OGArray<T>& b)
+{
+  if (a.getCols() != b.getRows())
+  {
+    std::stringstream message;
+    message << "Matrices do not commute. First is: " << a.getRows() << "x" << a.getCols() << ". Second is: " << b.getRows() << "x" << b.getCols();
+    throw rdag_error(message.str());
+  }
+}
+
+/**
+ * Builds a sparse matrix a column at a time. Entries of a column may be added in any
+ * order and a row more than once; they are summed, sorted by row and zeros dropped
+ * when the column is finished.
+ */
+template<typename T> class SparseBuilder
+{
+  public:
+    SparseBuilder(size_t rows, size_t cols): _rows{rows}, _cols{cols}, _values(rows), _marks(rows, -1)
+    {
+      _colPtr.reserve(cols + 1);
+      _colPtr.push_back(0);
+    }
+    void add(int4 row, T value)
+    {
+      int4 col = static_cast<int4>(_colPtr.size() - 1);
+      if (_marks[row] != col)
+      {
+        _marks[row] = col;
+        _values[row] = value;
+        _column.push_back(row);
+      }
+      else
+      {
+        _values[row] += value;
+      }
+    }
+    void endColumn()
+    {
+      std::sort(_column.begin(), _column.end());
+      for (int4 row: _column)
+      {
+        if (_values[row] != T())
+        {
+          _rowIdx.push_back(row);
+          _data.push_back(_values[row]);
+        }
+      }
+      _column.clear();
+      if (_data.size() > static_cast<size_t>(std::numeric_limits<int4>::max()))
+      {
+        throw rdag_error("Sparse result has too many entries to be indexed.");
+      }
+      _colPtr.push_back(static_cast<int4>(_data.size()));
+    }
+    /**
+     * Whether an entry has been added in the given row of the current column.
+     */
+    bool has(int4 row) const
+    {
+      return _marks[row] == static_cast<int4>(_colPtr.size() - 1);
+    }
+    OGNumeric::Ptr build()
+    {
+      size_t nnz = _data.size();
+      // The terminal requires data even when there are no entries
+      std::unique_ptr<int4[]> colPtr(new int4[_cols + 1]);
+      std::unique_ptr<int4[]> rowIdx(new int4[std::max(nnz, static_cast<size_t>(1))]());
+      std::unique_ptr<T[]> data(new T[std::max(nnz, static_cast<size_t>(1))]());
+      std::copy(_colPtr.begin(), _colPtr.end(), colPtr.get());
+      std::copy(_rowIdx.begin(), _rowIdx.end(), rowIdx.get());
+      std::copy(_data.begin(), _data.end(), data.get());
+      OGNumeric::Ptr ret = makeConcreteSparseMatrix(colPtr.get(), rowIdx.get(), data.get(), _rows, _cols, OWNER);
+      colPtr.release();
+      rowIdx.release();
+      data.release();
+      return ret;
+    }
+  private:
+    size_t _rows;
+    size_t _cols;
+    std::vector<T> _values;
+    std::vector<int4> _marks;
+    std::vector<int4> _column;
+    std::vector<int4> _colPtr;
+    std::vector<int4> _rowIdx;
+    std::vector<T> _data;
+};
+
+/**
+ * Writes the entries of a sparse matrix, scaled, into a zeroed dense column major array.
+ */
+template<typename T> void scatter(const OGSparseMatrix<T>& a, T scale, T * dense)
+{
+  size_t rows = a.getRows();
+  int4 * colPtr = a.getColPtr();
+  int4 * rowIdx = a.getRowIdx();
+  T * data = a.getData();
+  for (size_t j = 0; j < a.getCols(); j++)
+  {
+    for (int4 p = colPtr[j]; p < colPtr[j + 1]; p++)
+    {
+      dense[rowIdx[p] + j * rows] += scale * data[p];
+    }
+  }
+}
+
+} // end namespace detail
+
+template<typename T>
+OGNumeric::Ptr plus(const OGSparseMatrix<T>& a, const OGSparseMatrix<T>& b, bool subtract)
+{
+  T sign = subtract ? -1.e0 : 1.e0;
+  bool sameShape = a.getRows() == b.getRows() && a.getCols() == b.getCols();
+  if (!sameShape && (detail::isScalar(a) || detail::isScalar(b)))
+  {
+    // Adding a scalar fills in every entry
+    const OGSparseMatrix<T>& m = detail::isScalar(a) ? b : a;
+    T s = detail::isScalar(a) ? detail::getScalarValue(a) : sign * detail::getScalarValue(b);
+    size_t n = m.getRows() * m.getCols();
+    std::unique_ptr<T[]> data(new T[n]);
+    std::fill(data.get(), data.get() + n, s);
+    detail::scatter(m, detail::isScalar(a) ? sign : static_cast<T>(1.e0), data.get());
+    return makeConcreteDenseMatrix(data.release(), m.getRows(), m.getCols(), OWNER);
+  }
+  if (!sameShape)
+  {
+    detail::throwMismatch(a, b, subtract ? "-" : "+");
+  }
+  detail::SparseBuilder<T> builder(a.getRows(), a.getCols());
+  for (size_t j = 0; j < a.getCols(); j++)
+  {
+    for (int4 p = a.getColPtr()[j]; p < a.getColPtr()[j + 1]; p++)
+    {
+      builder.add(a.getRowIdx()[p], a.getData()[p]);
+    }
+    for (int4 p = b.getColPtr()[j]; p < b.getColPtr()[j + 1]; p++)
+    {
+      builder.add(b.getRowIdx()[p], sign * b.getData()[p]);
+    }
+    builder.endColumn();
+  }
+  return builder.build();
+}
+
+template<typename T>
+OGNumeric::Ptr times(const OGSparseMatrix<T>& a, const OGSparseMatrix<T>& b)
+{
+  if (detail::isScalar(a))
+  {
+    return scale(b, detail::getScalarValue(a));
+  }
+  if (detail::isScalar(b))
+  {
+    return scale(a, detail::getScalarValue(b));
+  }
+  if (a.getRows() != b.getRows() || a.getCols() != b.getCols())
+  {
+    detail::throwMismatch(a, b, "*");
+  }
+  // Sum each column of b into a dense vector, then pick out the rows a has. An Inf or
+  // NaN held by only one of the two makes NaN against the other's implicit zero.
+  size_t rows = a.getRows();
+  std::vector<T> column(rows);
+  std::vector<int4> marks(rows, -1);
+  std::vector<int4> amarks(rows, -1);
+  detail::SparseBuilder<T> builder(rows, a.getCols());
+  for (size_t j = 0; j < a.getCols(); j++)
+  {
+    int4 col = static_cast<int4>(j);
+    for (int4 p = b.getColPtr()[j]; p < b.getColPtr()[j + 1]; p++)
+    {
+      int4 row = b.getRowIdx()[p];
+      column[row] = marks[row] == col ? column[row] + b.getData()[p] : b.getData()[p];
+      marks[row] = col;
+    }
+    for (int4 p = a.getColPtr()[j]; p < a.getColPtr()[j + 1]; p++)
+    {
+      int4 row = a.getRowIdx()[p];
+      amarks[row] = col;
+      builder.add(row, a.getData()[p] * (marks[row] == col ? column[row] : T()));
+    }
+    for (int4 p = b.getColPtr()[j]; p < b.getColPtr()[j + 1]; p++)
+    {
+      int4 row = b.getRowIdx()[p];
+      if (amarks[row] != col && !detail::isFinite(b.getData()[p]))
+      {
+        builder.add(row, T() * b.getData()[p]);
+      }
+    }
+    builder.endColumn();
+  }
+  return builder.build();
+}
+
+template<typename T>
+OGNumeric::Ptr times(const OGSparseMatrix<T>& a, const OGMatrix<T>& b)
+{
+  if (detail::isScalar(b))
+  {
+    return scale(a, b.getData()[0]);
+  }
+  if (detail::isScalar(a))
+  {
+    T s = detail::getScalarValue(a);
+    size_t n = b.getDatalen();
+    std::unique_ptr<T[]> data(new T[n]);
+    for (size_t i = 0; i < n; i++)
+    {
+      data[i] = s * b.getData()[i];
+    }
+    return makeConcreteDenseMatrix(data.release(), b.getRows(), b.getCols(), OWNER);
+  }
+  if (a.getRows() != b.getRows() || a.getCols() != b.getCols())
+  {
+    detail::throwMismatch(a, b, "*");
+  }
+  size_t rows = a.getRows();
+  const T * bdata = b.getData();
+  // An Inf or NaN in b makes NaN against an implicit zero of a
+  std::vector<size_t> nonFinite = detail::nonFinite(bdata, b.getDatalen());
+  auto next = nonFinite.begin();
+  detail::SparseBuilder<T> builder(rows, a.getCols());
+  for (size_t j = 0; j < a.getCols(); j++)
+  {
+    for (int4 p = a.getColPtr()[j]; p < a.getColPtr()[j + 1]; p++)
+    {
+      int4 row = a.getRowIdx()[p];
+      builder.add(row, a.getData()[p] * bdata[row + j * rows]);
+    }
+    for (; next != nonFinite.end() && *next < (j + 1) * rows; ++next)
+    {
+      int4 row = static_cast<int4>(*next - j * rows);
+      if (!builder.has(row))
+      {
+        builder.add(row, T() * bdata[*next]);
+      }
+    }
+    builder.endColumn();
+  }
+  return builder.build();
+}
+
+template<typename T>
+OGNumeric::Ptr scale(const OGSparseMatrix<T>& a, T s)
+{
+  // Every entry is multiplied, even by zero, so stored Infs and NaNs become NaN; an
+  // Inf or NaN scale makes NaN of the implicit zeros too
+  bool fill = !detail::isFinite(s);
+  detail::SparseBuilder<T> builder(a.getRows(), a.getCols());
+  for (size_t j = 0; j < a.getCols(); j++)
+  {
+    for (int4 p = a.getColPtr()[j]; p < a.getColPtr()[j + 1]; p++)
+    {
+      builder.add(a.getRowIdx()[p], s * a.getData()[p]);
+    }
+    for (size_t i = 0; fill && i < a.getRows(); i++)
+    {
+      int4 row = static_cast<int4>(i);
+      if (!builder.has(row))
+      {
+        builder.add(row, s * T());
+      }
+    }
+    builder.endColumn();
+  }
+  return builder.build();
+}
+
+template<typename T>
+OGNumeric::Ptr mtimes(const OGSparseMatrix<T>& a, const OGMatrix<T>& b)
+{
+  if (detail::isScalar(a))
+  {
+    T s = detail::getScalarValue(a);
+    size_t n = b.getDatalen();
+    std::unique_ptr<T[]> data(new T[n]);
+    for (size_t i = 0; i < n; i++)
+    {
+      data[i] = s * b.getData()[i];
+    }
+    return makeConcreteDenseMatrix(data.release(), b.getRows(), b.getCols(), OWNER);
+  }
+  if (detail::isScalar(b))
+  {
+    return scale(a, b.getData()[0]);
+  }
+  detail::checkCommute(a, b);
+  size_t m = a.getRows();
+  size_t k = a.getCols();
+  size_t n = b.getCols();
+  std::unique_ptr<T[]> data(new T[m * n]());
+  T * c = data.get();
+  const T * bdata = b.getData();
+  int4 * colPtr = a.getColPtr();
+  int4 * rowIdx = a.getRowIdx();
+  T * adata = a.getData();
+  // A zero of b may only be skipped against a column of a holding no Inf or NaN
+  std::vector<bool> finiteCol(k, true);
+  for (size_t kk = 0; kk < k; kk++)
+  {
+    for (int4 p = colPtr[kk]; p < colPtr[kk + 1]; p++)
+    {
+      if (!detail::isFinite(adata[p]))
+      {
+        finiteCol[kk] = false;
+      }
+    }
+  }
+  std::vector<size_t> marks(m, k);
+  for (size_t j = 0; j < n; j++)
+  {
+    for (size_t kk = 0; kk < k; kk++)
+    {
+      T bkj = bdata[kk + j * k];
+      if (bkj == T() && finiteCol[kk])
+      {
+        continue;
+      }
+      for (int4 p = colPtr[kk]; p < colPtr[kk + 1]; p++)
+      {
+        c[rowIdx[p] + j * m] += adata[p] * bkj;
+      }
+      if (!detail::isFinite(bkj))
+      {
+        // An Inf or NaN in b makes NaN against the implicit zeros of the column of a
+        for (int4 p = colPtr[kk]; p < colPtr[kk + 1]; p++)
+        {
+          marks[rowIdx[p]] = kk;
+        }
+        for (size_t i = 0; i < m; i++)
+        {
+          if (marks[i] != kk)
+          {
+            c[i + j * m] += T() * bkj;
+          }
+        }
+        std::fill(marks.begin(), marks.end(), k);
+      }
+    }
+  }
+  return makeConcreteDenseMatrix(data.release(), m, n, OWNER);
+}
+
+template<typename T>
+OGNumeric::Ptr mtimes(const OGMatrix<T>& a, const OGSparseMatrix<T>& b)
+{
+  if (detail::isScalar(a))
+  {
+    return scale(b, a.getData()[0]);
+  }
+  if (detail::isScalar(b))
+  {
+    T s = detail::getScalarValue(b);
+    size_t n = a.getDatalen();
+    std::unique_ptr<T[]> data(new T[n]);
+    for (size_t i = 0; i < n; i++)
+    {
+      data[i] = a.getData()[i] * s;
+    }
+    return makeConcreteDenseMatrix(data.release(), a.getRows(), a.getCols(), OWNER);
+  }
+  detail::checkCommute(a, b);
+  size_t m = a.getRows();
+  size_t n = b.getCols();
+  std::unique_ptr<T[]> data(new T[m * n]());
+  T * c = data.get();
+  const T * adata = a.getData();
+  int4 * colPtr = b.getColPtr();
+  int4 * rowIdx = b.getRowIdx();
+  T * bdata = b.getData();
+  // An Inf or NaN in a makes NaN against the implicit zeros of b
+  std::vector<size_t> nonFinite = detail::nonFinite(adata, a.getDatalen());
+  std::vector<int4> marks(b.getRows(), -1);
+  for (size_t j = 0; j < n; j++)
+  {
+    T * cj = c + j * m;
+    for (int4 p = colPtr[j]; p < colPtr[j + 1]; p++)
+    {
+      const T * ak = adata + rowIdx[p] * m;
+      T v = bdata[p];
+      marks[rowIdx[p]] = static_cast<int4>(j);
+      for (size_t i = 0; i < m; i++)
+      {
+        cj[i] += ak[i] * v;
+      }
+    }
+    for (size_t ik: nonFinite)
+    {
+      if (marks[ik / m] != static_cast<int4>(j))
+      {
+        cj[ik % m] += adata[ik] * T();
+      }
+    }
+  }
+  return makeConcreteDenseMatrix(data.release(), m, n, OWNER);
+}
+
+template<typename T>
+OGNumeric::Ptr mtimes(const OGSparseMatrix<T>& a, const OGSparseMatrix<T>& b)
+{
+  if (detail::isScalar(a))
+  {
+    return scale(b, detail::getScalarValue(a));
+  }
+  if (detail::isScalar(b))
+  {
+    return scale(a, detail::getScalarValue(b));
+  }
+  detail::checkCommute(a, b);
+  int4 * acolPtr = a.getColPtr();
+  int4 * arowIdx = a.getRowIdx();
+  T * adata = a.getData();
+  size_t m = a.getRows();
+  // An Inf or NaN stored in either operand makes NaN against the implicit zeros of the other
+  // Each held as its index into the data of a and its column
+  std::vector<std::pair<int4, int4>> aNonFinite;
+  for (size_t k = 0; k < a.getCols(); k++)
+  {
+    for (int4 q = acolPtr[k]; q < acolPtr[k + 1]; q++)
+    {
+      if (!detail::isFinite(adata[q]))
+      {
+        aNonFinite.push_back(std::make_pair(q, static_cast<int4>(k)));
+      }
+    }
+  }
+  std::vector<int4> bmarks(b.getRows(), -1);
+  std::vector<int4> amarks(m, -1);
+  detail::SparseBuilder<T> builder(m, b.getCols());
+  for (size_t j = 0; j < b.getCols(); j++)
+  {
+    // Column j of the result is a combination of the columns of a that b selects
+    for (int4 p = b.getColPtr()[j]; p < b.getColPtr()[j + 1]; p++)
+    {
+      int4 k = b.getRowIdx()[p];
+      T v = b.getData()[p];
+      bmarks[k] = static_cast<int4>(j);
+      for (int4 q = acolPtr[k]; q < acolPtr[k + 1]; q++)
+      {
+        builder.add(arowIdx[q], adata[q] * v);
+      }
+      if (!detail::isFinite(v))
+      {
+        for (int4 q = acolPtr[k]; q < acolPtr[k + 1]; q++)
+        {
+          amarks[arowIdx[q]] = p;
+        }
+        for (size_t i = 0; i < m; i++)
+        {
+          if (amarks[i] != p)
+          {
+            builder.add(static_cast<int4>(i), T() * v);
+          }
+        }
+      }
+    }
+    for (const std::pair<int4, int4>& qk: aNonFinite)
+    {
+      if (bmarks[qk.second] != static_cast<int4>(j))
+      {
+        builder.add(arowIdx[qk.first], adata[qk.first] * T());
+      }
+    }
+    builder.endColumn();
+  }
+  return builder.build();
+}
+
+/**
+ * Template instantiations
+ */
+
+template OGNumeric::Ptr plus<real8>(const OGSparseMatrix<real8>& a, const OGSparseMatrix<real8>& b, bool subtract);
+template OGNumeric::Ptr plus<complex16>(const OGSparseMatrix<complex16>& a, const OGSparseMatrix<complex16>& b, bool subtract);
+template OGNumeric::Ptr times<real8>(const OGSparseMatrix<real8>& a, const OGSparseMatrix<real8>& b);
+template OGNumeric::Ptr times<complex16>(const OGSparseMatrix<complex16>& a, const OGSparseMatrix<complex16>& b);
+template OGNumeric::Ptr times<real8>(const OGSparseMatrix<real8>& a, const OGMatrix<real8>& b);
+template OGNumeric::Ptr times<complex16>(const OGSparseMatrix<complex16>& a, const OGMatrix<complex16>& b);
+template OGNumeric::Ptr scale<real8>(const OGSparseMatrix<real8>& a, real8 s);
+template OGNumeric::Ptr scale<complex16>(const OGSparseMatrix<complex16>& a, complex16 s);
+template OGNumeric::Ptr mtimes<real8>(const OGSparseMatrix<real8>& a, const OGMatrix<real8>& b);
+template OGNumeric::Ptr mtimes<complex16>(const OGSparseMatrix<complex16>& a, const OGMatrix<complex16>& b);
+template OGNumeric::Ptr mtimes<real8>(const OGMatrix<real8>& a, const OGSparseMatrix<real8>& b);
+template OGNumeric::Ptr mtimes<complex16>(const OGMatrix<complex16>& a, const OGSparseMatrix<complex16>& b);
+template OGNumeric::Ptr mtimes<real8>(const OGSparseMatrix<real8>& a, const OGSparseMatrix<real8>& b);
+template OGNumeric::Ptr mtimes<complex16>(const OGSparseMatrix<complex16>& a, const OGSparseMatrix<complex16>& b);
+
+} // end namespace sparse
+
+} // end namespace librdag
@@ -20,10 +20,87 @@ using namespace std;
 
 namespace librdag {
 
+/**
+ * Structure
+ */
+
+constexpr size_t Structure::UNKNOWN_BANDWIDTH;
+
+Structure::Structure(): Structure(0) {}
+
+Structure::Structure(unsigned properties, size_t lowerBandwidth, size_t upperBandwidth):
+  _properties{properties}, _lowerBandwidth{lowerBandwidth}, _upperBandwidth{upperBandwidth}
+{
+  if (_properties & UPPER_TRIANGULAR)
+  {
+    _lowerBandwidth = 0;
+  }
+  if (_properties & LOWER_TRIANGULAR)
+  {
+    _upperBandwidth = 0;
+  }
+  if (_properties & POSITIVE_DEFINITE)
+  {
+    _properties |= HERMITIAN;
+  }
+}
+
+bool
+Structure::has(Property property) const
+{
+  return (_properties & property) != 0;
+}
+
+unsigned
+Structure::getProperties() const
+{
+  return _properties;
+}
+
+size_t
+Structure::getLowerBandwidth() const
+{
+  return _lowerBandwidth;
+}
+
+size_t
+Structure::getUpperBandwidth() const
+{
+  return _upperBandwidth;
+}
+
+Structure
+Structure::transposed() const
+{
+  // Upper and lower swap, the rest holds for the conjugate of a matrix as well
+  unsigned properties = _properties & ~(UPPER_TRIANGULAR | LOWER_TRIANGULAR);
+  if (has(UPPER_TRIANGULAR))
+  {
+    properties |= LOWER_TRIANGULAR;
+  }
+  if (has(LOWER_TRIANGULAR))
+  {
+    properties |= UPPER_TRIANGULAR;
+  }
+  return Structure(properties, _upperBandwidth, _lowerBandwidth);
+}
+
 /**
  * OGTerminal
  */
 
+const Structure&
+OGTerminal::getStructure() const
+{
+  return _structure;
+}
+
+void
+OGTerminal::setStructure(const Structure& structure) const
+{
+  _structure = structure;
+}
+
 real8*
 OGTerminal::toReal8Array() const
 {
@@ -512,6 +589,18 @@ OGArray<T>::toArray() const
   return tmp;
 }
 
+template<typename T>
+T*
+OGArray<T>::releaseData()
+{
+  if (_data_access != OWNER)
+  {
+    throw rdag_error("Cannot release data that is not owned by the array.");
+  }
+  _data_access = VIEWER;
+  return _data;
+}
+
 template<typename T>
 size_t
 OGArray<T>::getRows() const
@@ -703,6 +792,8 @@ createComplexOwningCopy() const
 
 template class OGArray<real8>;
 template class OGArray<complex16>;
+template class OGArray<real4>;
+template class OGArray<complex8>;
 
 /**
  * OGMatrix
@@ -905,6 +996,32 @@ OGMatrix<complex16>::toReal8ArrayOfArrays() const
   throw rdag_error("Error in in partial template specialisation for OGMatrix<complex16>::toReal8ArrayOfArrays(). Cannot convert a matrix backed by complex16 type to a real8 type.");
 }
 
+template<>
+real8 **
+OGMatrix<real4>::toReal8ArrayOfArrays() const
+{
+  size_t const rows = this->getRows();
+  size_t const cols = this->getCols();
+  real4 * const data = this->getData();
+  real8 ** tmp = new real8 * [rows];
+  for(size_t i=0; i < rows; i++)
+  {
+    tmp[i] = new real8 [cols];
+    for(size_t j = 0; j < cols; j++)
+    {
+      tmp[i][j] = data[j*rows+i];
+    }
+  }
+  return tmp;
+}
+
+template<>
+real8 **
+OGMatrix<complex8>::toReal8ArrayOfArrays() const
+{
+  throw rdag_error("Error in in partial template specialisation for OGMatrix<complex8>::toReal8ArrayOfArrays(). Cannot convert a matrix backed by complex8 type to a real8 type.");
+}
+
 template<>
 ExprType_t
 OGMatrix<real8>::getType() const
@@ -919,8 +1036,24 @@ OGMatrix<complex16>::getType() const
   return COMPLEX_DENSE_MATRIX_ENUM;
 }
 
+template<>
+ExprType_t
+OGMatrix<real4>::getType() const
+{
+  return REAL_SINGLE_DENSE_MATRIX_ENUM;
+}
+
+template<>
+ExprType_t
+OGMatrix<complex8>::getType() const
+{
+  return COMPLEX_SINGLE_DENSE_MATRIX_ENUM;
+}
+
 template class OGMatrix<real8>;
 template class OGMatrix<complex16>;
+template class OGMatrix<real4>;
+template class OGMatrix<complex8>;
 
 /**
  * OGRealDenseMatrix
@@ -992,6 +1125,128 @@ OGRealDenseMatrix::createComplexOwningCopy() const
   return OGComplexDenseMatrix::create(newdata, this->getRows(), this->getCols(), OWNER);
 }
 
+/**
+ * OGRealSingleDenseMatrix
+ */
+
+OGNumeric::Ptr
+OGRealSingleDenseMatrix::copy() const
+{
+  return create(this->getData(), this->getRows(), this->getCols());
+}
+
+OGRealSingleDenseMatrix::Ptr
+OGRealSingleDenseMatrix::create(real4* data, size_t rows, size_t cols, DATA_ACCESS access_spec)
+{
+  return OGRealSingleDenseMatrix::Ptr{new OGRealSingleDenseMatrix{data, rows, cols, access_spec}};
+}
+
+OGRealSingleDenseMatrix::Ptr
+OGRealSingleDenseMatrix::create(std::initializer_list<std::initializer_list<real4>> list)
+{
+  return OGRealSingleDenseMatrix::Ptr{new OGRealSingleDenseMatrix{list}};
+}
+
+OGRealSingleDenseMatrix::Ptr
+OGRealSingleDenseMatrix::asOGRealSingleDenseMatrix() const
+{
+  return static_pointer_cast<const OGRealSingleDenseMatrix, const OGNumeric>(shared_from_this());
+}
+
+ExprType_t
+OGRealSingleDenseMatrix::getType() const
+{
+  return REAL_SINGLE_DENSE_MATRIX_ENUM;
+}
+
+OGRealDenseMatrix::Ptr
+OGRealSingleDenseMatrix::asFullOGRealDenseMatrix() const
+{
+  return _converter.convertToOGRealDenseMatrix(asOGRealSingleDenseMatrix());
+}
+
+OGComplexDenseMatrix::Ptr
+OGRealSingleDenseMatrix::asFullOGComplexDenseMatrix() const
+{
+  return _converter.convertToOGComplexDenseMatrix(asOGRealSingleDenseMatrix());
+}
+
+OGTerminal::Ptr
+OGRealSingleDenseMatrix::createOwningCopy() const
+{
+  real4 * newdata =  new real4[this->getDatalen()];
+  std::copy(this->getData(), this->getData()+this->getDatalen(), newdata);
+  return OGRealSingleDenseMatrix::create(newdata, this->getRows(), this->getCols(), OWNER);
+}
+
+OGTerminal::Ptr
+OGRealSingleDenseMatrix::createComplexOwningCopy() const
+{
+  complex8 * newdata =  new complex8[this->getDatalen()];
+  std::copy(this->getData(), this->getData()+this->getDatalen(), newdata);
+  return OGComplexSingleDenseMatrix::create(newdata, this->getRows(), this->getCols(), OWNER);
+}
+
+/**
+ * OGComplexSingleDenseMatrix
+ */
+
+OGNumeric::Ptr
+OGComplexSingleDenseMatrix::copy() const
+{
+  return create(this->getData(), this->getRows(), this->getCols());
+}
+
+OGComplexSingleDenseMatrix::Ptr
+OGComplexSingleDenseMatrix::create(complex8* data, size_t rows, size_t cols, DATA_ACCESS access_spec)
+{
+  return OGComplexSingleDenseMatrix::Ptr{new OGComplexSingleDenseMatrix{data, rows, cols, access_spec}};
+}
+
+OGComplexSingleDenseMatrix::Ptr
+OGComplexSingleDenseMatrix::create(std::initializer_list<std::initializer_list<complex8>> list)
+{
+  return OGComplexSingleDenseMatrix::Ptr{new OGComplexSingleDenseMatrix{list}};
+}
+
+OGComplexSingleDenseMatrix::Ptr
+OGComplexSingleDenseMatrix::asOGComplexSingleDenseMatrix() const
+{
+  return static_pointer_cast<const OGComplexSingleDenseMatrix, const OGNumeric>(shared_from_this());
+}
+
+ExprType_t
+OGComplexSingleDenseMatrix::getType() const
+{
+  return COMPLEX_SINGLE_DENSE_MATRIX_ENUM;
+}
+
+OGRealDenseMatrix::Ptr
+OGComplexSingleDenseMatrix::asFullOGRealDenseMatrix() const
+{
+  throw rdag_error("Cannot represent complex data in linear memory of type real8");
+}
+
+OGComplexDenseMatrix::Ptr
+OGComplexSingleDenseMatrix::asFullOGComplexDenseMatrix() const
+{
+  return _converter.convertToOGComplexDenseMatrix(asOGComplexSingleDenseMatrix());
+}
+
+OGTerminal::Ptr
+OGComplexSingleDenseMatrix::createOwningCopy() const
+{
+  complex8 * newdata =  new complex8[this->getDatalen()];
+  std::copy(this->getData(), this->getData()+this->getDatalen(), newdata);
+  return OGComplexSingleDenseMatrix::create(newdata, this->getRows(), this->getCols(), OWNER);
+}
+
+OGTerminal::Ptr
+OGComplexSingleDenseMatrix::createComplexOwningCopy() const
+{
+  return createOwningCopy();
+}
+
 /**
  * Logical Matrix
  */
@@ -1668,6 +1923,246 @@ OGComplexSparseMatrix::createComplexOwningCopy() const
   return createOwningCopy();
 }
 
+/**
+ * OGTransposedMatrix
+ */
+
+template<typename T>
+OGTransposedMatrix<T>::OGTransposedMatrix(typename OGMatrix<T>::Ptr source, bool conjugate): _source{source}, _conjugate{conjugate}
+{
+  if (source == nullptr)
+  {
+    throw rdag_error("Null source passed to TransposedMatrix constructor");
+  }
+  this->setData(source->getData());
+  this->setRows(source->getCols());
+  this->setCols(source->getRows());
+  this->setDatalen(source->getDatalen());
+  this->setDataAccess(VIEWER);
+}
+
+template<typename T>
+typename OGMatrix<T>::Ptr
+OGTransposedMatrix<T>::getSource() const
+{
+  return _source;
+}
+
+template<typename T>
+bool
+OGTransposedMatrix<T>::isConjugate() const
+{
+  return _conjugate;
+}
+
+/**
+ * The conjugate of a value, which for real data is the value.
+ */
+static inline real8 conjugate(real8 value)
+{
+  return value;
+}
+
+static inline complex16 conjugate(complex16 value)
+{
+  return std::conj(value);
+}
+
+template<typename T>
+void
+OGTransposedMatrix<T>::materialise(T * dest) const
+{
+  // the source is cols x rows, so the entry (i, j) of this is at data[i * cols + j]
+  size_t const rows = this->getRows();
+  size_t const cols = this->getCols();
+  size_t const datalen = this->getDatalen();
+  T * const data = this->getData();
+  if (rows == 1 || cols == 1)
+  {
+    // a vector is laid out the same either way
+    std::copy(data, data + datalen, dest);
+  }
+  else
+  {
+    for (size_t i = 0; i < rows; i++)
+    {
+      for (size_t j = 0; j < cols; j++)
+      {
+        dest[j * rows + i] = data[i * cols + j];
+      }
+    }
+  }
+  if (_conjugate)
+  {
+    for (size_t k = 0; k < datalen; k++)
+    {
+      dest[k] = conjugate(dest[k]);
+    }
+  }
+}
+
+template<typename T>
+bool
+OGTransposedMatrix<T>::equals(const OGTerminal::Ptr& other) const
+{
+  if(!OGArray<T>::equals(other)) return false;
+  return static_pointer_cast<const OGTransposedMatrix<T>, const OGTerminal>(other)->isConjugate() == _conjugate;
+}
+
+template<typename T>
+bool
+OGTransposedMatrix<T>::fuzzyequals(const OGTerminal::Ptr& other, real8 maxabserror, real8 maxrelerror) const
+{
+  if(!OGArray<T>::fuzzyequals(other, maxabserror, maxrelerror)) return false;
+  return static_pointer_cast<const OGTransposedMatrix<T>, const OGTerminal>(other)->isConjugate() == _conjugate;
+}
+
+template<typename T>
+bool
+OGTransposedMatrix<T>::fuzzyequals(const OGTerminal::Ptr& other) const
+{
+  return fuzzyequals(other, FuzzyEquals_default_maxabserror, FuzzyEquals_default_maxrelerror);
+}
+
+template class OGTransposedMatrix<real8>;
+template class OGTransposedMatrix<complex16>;
+
+/**
+ * OGRealTransposedMatrix
+ */
+
+OGRealTransposedMatrix::Ptr
+OGRealTransposedMatrix::create(OGMatrix<real8>::Ptr source)
+{
+  return OGRealTransposedMatrix::Ptr{new OGRealTransposedMatrix{source, false}};
+}
+
+void
+OGRealTransposedMatrix::debug_print() const
+{
+  printf("\nTransposed view of:");
+  getSource()->debug_print();
+}
+
+real8**
+OGRealTransposedMatrix::toReal8ArrayOfArrays() const
+{
+  return asFullOGRealDenseMatrix()->toReal8ArrayOfArrays();
+}
+
+complex16**
+OGRealTransposedMatrix::toComplex16ArrayOfArrays() const
+{
+  return asFullOGRealDenseMatrix()->toComplex16ArrayOfArrays();
+}
+
+OGNumeric::Ptr
+OGRealTransposedMatrix::copy() const
+{
+  return create(getSource());
+}
+
+OGRealTransposedMatrix::Ptr
+OGRealTransposedMatrix::asOGRealTransposedMatrix() const
+{
+  return static_pointer_cast<const OGRealTransposedMatrix, const OGNumeric>(shared_from_this());
+}
+
+ExprType_t
+OGRealTransposedMatrix::getType() const
+{
+  return REAL_TRANSPOSED_MATRIX_ENUM;
+}
+
+OGRealDenseMatrix::Ptr
+OGRealTransposedMatrix::asFullOGRealDenseMatrix() const
+{
+  return _converter.convertToOGRealDenseMatrix(asOGRealTransposedMatrix());
+}
+
+OGComplexDenseMatrix::Ptr
+OGRealTransposedMatrix::asFullOGComplexDenseMatrix() const
+{
+  return _converter.convertToOGComplexDenseMatrix(asOGRealTransposedMatrix());
+}
+
+OGTerminal::Ptr
+OGRealTransposedMatrix::createOwningCopy() const
+{
+  return asFullOGRealDenseMatrix();
+}
+
+OGTerminal::Ptr
+OGRealTransposedMatrix::createComplexOwningCopy() const
+{
+  return asFullOGComplexDenseMatrix();
+}
+
+/**
+ * OGComplexTransposedMatrix
+ */
+
+OGComplexTransposedMatrix::Ptr
+OGComplexTransposedMatrix::create(OGMatrix<complex16>::Ptr source, bool conjugate)
+{
+  return OGComplexTransposedMatrix::Ptr{new OGComplexTransposedMatrix{source, conjugate}};
+}
+
+void
+OGComplexTransposedMatrix::debug_print() const
+{
+  printf("\n%s view of:", isConjugate() ? "Conjugate transposed" : "Transposed");
+  getSource()->debug_print();
+}
+
+complex16**
+OGComplexTransposedMatrix::toComplex16ArrayOfArrays() const
+{
+  return asFullOGComplexDenseMatrix()->toComplex16ArrayOfArrays();
+}
+
+OGNumeric::Ptr
+OGComplexTransposedMatrix::copy() const
+{
+  return create(getSource(), isConjugate());
+}
+
+OGComplexTransposedMatrix::Ptr
+OGComplexTransposedMatrix::asOGComplexTransposedMatrix() const
+{
+  return static_pointer_cast<const OGComplexTransposedMatrix, const OGNumeric>(shared_from_this());
+}
+
+ExprType_t
+OGComplexTransposedMatrix::getType() const
+{
+  return COMPLEX_TRANSPOSED_MATRIX_ENUM;
+}
+
+OGRealDenseMatrix::Ptr
+OGComplexTransposedMatrix::asFullOGRealDenseMatrix() const
+{
+  throw rdag_error("Cannot represent complex data in linear memory of type real8");
+}
+
+OGComplexDenseMatrix::Ptr
+OGComplexTransposedMatrix::asFullOGComplexDenseMatrix() const
+{
+  return _converter.convertToOGComplexDenseMatrix(asOGComplexTransposedMatrix());
+}
+
+OGTerminal::Ptr
+OGComplexTransposedMatrix::createOwningCopy() const
+{
+  return asFullOGComplexDenseMatrix();
+}
+
+OGTerminal::Ptr
+OGComplexTransposedMatrix::createComplexOwningCopy() const
+{
+  return createOwningCopy();
+}
+
 
 // Concrete template factory for dense matrices
 template<>
@@ -1682,6 +2177,70 @@ OGNumeric::Ptr makeConcreteDenseMatrix(complex16 * data, size_t rows, size_t col
   return OGComplexDenseMatrix::create(data, rows, cols, access);
 }
 
+template<>
+OGNumeric::Ptr makeConcreteDenseMatrix(real4 * data, size_t rows, size_t cols, DATA_ACCESS access)
+{
+  return OGRealSingleDenseMatrix::create(data, rows, cols, access);
+}
+
+template<>
+OGNumeric::Ptr makeConcreteDenseMatrix(complex8 * data, size_t rows, size_t cols, DATA_ACCESS access)
+{
+  return OGComplexSingleDenseMatrix::create(data, rows, cols, access);
+}
+
+// Concrete template factory for diagonal matrices
+template<>
+OGNumeric::Ptr makeConcreteDiagonalMatrix(real8 * data, size_t rows, size_t cols, DATA_ACCESS access)
+{
+  return OGRealDiagonalMatrix::create(data, rows, cols, access);
+}
+
+template<>
+OGNumeric::Ptr makeConcreteDiagonalMatrix(complex16 * data, size_t rows, size_t cols, DATA_ACCESS access)
+{
+  return OGComplexDiagonalMatrix::create(data, rows, cols, access);
+}
+
+// Concrete template factory for sparse matrices
+template<>
+OGNumeric::Ptr makeConcreteSparseMatrix(int4 * colPtr, int4 * rowIdx, real8 * data, size_t rows, size_t cols, DATA_ACCESS access)
+{
+  return OGRealSparseMatrix::create(colPtr, rowIdx, data, rows, cols, access);
+}
+
+template<>
+OGNumeric::Ptr makeConcreteSparseMatrix(int4 * colPtr, int4 * rowIdx, complex16 * data, size_t rows, size_t cols, DATA_ACCESS access)
+{
+  return OGComplexSparseMatrix::create(colPtr, rowIdx, data, rows, cols, access);
+}
+
+// Concrete template factory for transposed views
+template<>
+OGNumeric::Ptr makeConcreteTransposedMatrix<real8>(OGMatrix<real8>::Ptr source, bool)
+{
+  return OGRealTransposedMatrix::create(source);
+}
+
+template<>
+OGNumeric::Ptr makeConcreteTransposedMatrix<complex16>(OGMatrix<complex16>::Ptr source, bool conjugate)
+{
+  return OGComplexTransposedMatrix::create(source, conjugate);
+}
+
+OGTerminal::Ptr materialiseView(const OGTerminal::Ptr& terminal)
+{
+  switch (terminal->getType())
+  {
+    case REAL_TRANSPOSED_MATRIX_ENUM:
+      return terminal->asFullOGRealDenseMatrix();
+    case COMPLEX_TRANSPOSED_MATRIX_ENUM:
+      return terminal->asFullOGComplexDenseMatrix();
+    default:
+      return terminal;
+  }
+}
+
 // Concrete template factory for scalars
 template<>
 OGNumeric::Ptr makeConcreteScalar(real8 data)
@@ -0,0 +1,151 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include "cse.hh"
+#include "entrypt.hh"
+#include "execution.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+TEST(CSETest, TerminalUnchanged)
+{
+  OGNumeric::Ptr real = OGRealScalar::create(1.0);
+  EXPECT_EQ(real, eliminateCommonSubexpressions(real));
+}
+
+TEST(CSETest, NoCommonSubexpressions)
+{
+  real8 data[4] = {1.0, 2.0, 3.0, 4.0};
+  OGNumeric::Ptr m = OGRealDenseMatrix::create(data, 2, 2);
+  OGNumeric::Ptr tree = PLUS::create(TRANSPOSE::create(m), NEGATE::create(m));
+  // Nothing to do, so the tree is returned as is
+  EXPECT_EQ(tree, eliminateCommonSubexpressions(tree));
+}
+
+TEST(CSETest, SameTerminalObject)
+{
+  real8 data[4] = {1.0, 2.0, 3.0, 4.0};
+  OGNumeric::Ptr m = OGRealDenseMatrix::create(data, 2, 2);
+  OGNumeric::Ptr t1 = TRANSPOSE::create(m);
+  OGNumeric::Ptr t2 = TRANSPOSE::create(m);
+  OGNumeric::Ptr tree = MTIMES::create(t1, t2);
+  OGNumeric::Ptr cse = eliminateCommonSubexpressions(tree);
+  ASSERT_NE(tree, cse);
+  ASSERT_EQ(MTIMES_ENUM, cse->getType());
+  const ArgContainer& args = cse->asOGExpr()->getArgs();
+  EXPECT_EQ(args[0], args[1]);
+  EXPECT_EQ(t1, args[0]);
+  // MTIMES, TRANSPOSE and the matrix
+  EXPECT_EQ(3, ExecutionList{cse}.size());
+  // The input tree is untouched
+  EXPECT_NE(tree->asOGExpr()->getArgs()[0], tree->asOGExpr()->getArgs()[1]);
+}
+
+TEST(CSETest, SameTerminalData)
+{
+  // Distinct terminal objects viewing the same data are the same terminal
+  real8 data[4] = {1.0, 2.0, 3.0, 4.0};
+  OGNumeric::Ptr m1 = OGRealDenseMatrix::create(data, 2, 2);
+  OGNumeric::Ptr m2 = OGRealDenseMatrix::create(data, 2, 2);
+  OGNumeric::Ptr tree = PLUS::create(INV::create(m1), INV::create(m2));
+  OGNumeric::Ptr cse = eliminateCommonSubexpressions(tree);
+  const ArgContainer& args = cse->asOGExpr()->getArgs();
+  EXPECT_EQ(args[0], args[1]);
+  EXPECT_EQ(3, ExecutionList{cse}.size());
+}
+
+TEST(CSETest, DifferentTerminals)
+{
+  real8 data[4] = {1.0, 2.0, 3.0, 4.0};
+  // Same data, different shape
+  OGNumeric::Ptr m1 = OGRealDenseMatrix::create(data, 2, 2);
+  OGNumeric::Ptr m2 = OGRealDenseMatrix::create(data, 4, 1);
+  OGNumeric::Ptr tree1 = PLUS::create(NEGATE::create(m1), NEGATE::create(m2));
+  EXPECT_EQ(tree1, eliminateCommonSubexpressions(tree1));
+  // Same data, different type
+  OGNumeric::Ptr d = OGRealDiagonalMatrix::create(data, 2, 2);
+  OGNumeric::Ptr tree2 = PLUS::create(NEGATE::create(m1), NEGATE::create(d));
+  EXPECT_EQ(tree2, eliminateCommonSubexpressions(tree2));
+  // Scalars with different values
+  OGNumeric::Ptr s1 = OGRealScalar::create(1.0);
+  OGNumeric::Ptr s2 = OGRealScalar::create(2.0);
+  OGNumeric::Ptr tree3 = PLUS::create(NEGATE::create(s1), NEGATE::create(s2));
+  EXPECT_EQ(tree3, eliminateCommonSubexpressions(tree3));
+}
+
+TEST(CSETest, EqualScalars)
+{
+  OGNumeric::Ptr s1 = OGRealScalar::create(3.0);
+  OGNumeric::Ptr s2 = OGRealScalar::create(3.0);
+  OGNumeric::Ptr tree = TIMES::create(NEGATE::create(s1), NEGATE::create(s2));
+  OGNumeric::Ptr cse = eliminateCommonSubexpressions(tree);
+  const ArgContainer& args = cse->asOGExpr()->getArgs();
+  EXPECT_EQ(args[0], args[1]);
+}
+
+TEST(CSETest, DifferentOperations)
+{
+  real8 data[4] = {1.0, 2.0, 3.0, 4.0};
+  OGNumeric::Ptr m = OGRealDenseMatrix::create(data, 2, 2);
+  // Same args, different node types
+  OGNumeric::Ptr tree1 = PLUS::create(TRANSPOSE::create(m), CTRANSPOSE::create(m));
+  EXPECT_EQ(tree1, eliminateCommonSubexpressions(tree1));
+  // Same node type, args in a different order
+  OGNumeric::Ptr n = NEGATE::create(m);
+  OGNumeric::Ptr tree2 = PLUS::create(MINUS::create(m, n), MINUS::create(n, m));
+  EXPECT_EQ(tree2, eliminateCommonSubexpressions(tree2));
+}
+
+TEST(CSETest, NestedCommonSubexpressions)
+{
+  // Two copies of NEGATE(SVD(m)) built independently
+  real8 data[4] = {1.0, 2.0, 3.0, 4.0};
+  OGNumeric::Ptr m = OGRealDenseMatrix::create(data, 2, 2);
+  OGNumeric::Ptr one = OGIntegerScalar::create(1);
+  OGNumeric::Ptr left = NEGATE::create(SELECTRESULT::create(SVD::create(m), one));
+  OGNumeric::Ptr right = NEGATE::create(SELECTRESULT::create(SVD::create(m),
+                                                             OGIntegerScalar::create(1)));
+  OGNumeric::Ptr tree = PLUS::create(left, right);
+  OGNumeric::Ptr cse = eliminateCommonSubexpressions(tree);
+  const ArgContainer& args = cse->asOGExpr()->getArgs();
+  EXPECT_EQ(args[0], args[1]);
+  EXPECT_EQ(left, args[0]);
+  // PLUS, NEGATE, SELECTRESULT, SVD, m, 1
+  EXPECT_EQ(6, ExecutionList{cse}.size());
+}
+
+TEST(CSETest, EntryptResult)
+{
+  real8 data[4] = {1.0, 2.0, 3.0, 4.0};
+  OGNumeric::Ptr m = OGRealDenseMatrix::create(data, 2, 2);
+  OGNumeric::Ptr tree = MINUS::create(MTIMES::create(TRANSPOSE::create(m), m),
+                                      MTIMES::create(TRANSPOSE::create(m), m));
+  OGTerminal::Ptr result = entrypt(tree);
+  real8 zeros[4] = {0.0, 0.0, 0.0, 0.0};
+  EXPECT_TRUE(result->mathsequals(OGRealDenseMatrix::create(zeros, 2, 2)));
+}
+
+TEST(CSETest, MultipleTrees)
+{
+  real8 data[4] = {1.0, 2.0, 3.0, 4.0};
+  OGNumeric::Ptr m1 = OGRealDenseMatrix::create(data, 2, 2);
+  OGNumeric::Ptr m2 = OGRealDenseMatrix::create(data, 2, 2);
+  OGNumeric::Ptr tree1 = NEGATE::create(MTIMES::create(m1, m1));
+  OGNumeric::Ptr tree2 = EXP::create(MTIMES::create(m2, m2));
+  OGNumeric::Ptr tree3 = NEGATE::create(MTIMES::create(m2, m1));
+  vector<OGNumeric::Ptr> cse = eliminateCommonSubexpressions(vector<OGNumeric::Ptr>{tree1, tree2, tree3});
+  ASSERT_EQ(3, cse.size());
+  EXPECT_EQ(tree1, cse[0]);
+  EXPECT_EQ(tree1, cse[2]);
+  // The product is shared with the first tree
+  EXPECT_EQ(tree1->asOGExpr()->getArgs()[0], cse[1]->asOGExpr()->getArgs()[0]);
+  // m, MTIMES, NEGATE, EXP
+  EXPECT_EQ(4, ExecutionList{cse}.size());
+}
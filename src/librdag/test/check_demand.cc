@@ -0,0 +1,159 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include "demand.hh"
+#include "plan.hh"
+#include "entrypt.hh"
+#include "execution.hh"
+#include "executor.hh"
+#include "dispatch.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+namespace {
+
+OGRealDenseMatrix::Ptr realMatrix(size_t rows, size_t cols)
+{
+  real8 * data = new real8[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = 1.0 + i * i;
+  }
+  return OGRealDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+OGNumeric::Ptr select(const OGNumeric::Ptr& node, int4 index)
+{
+  return SELECTRESULT::create(node, OGIntegerScalar::create(index));
+}
+
+size_t positionOf(ExecutionList& el, const OGNumeric::Ptr& node)
+{
+  for (size_t i = 0; i < el.size(); i++)
+  {
+    if (el[i].get() == node.get())
+    {
+      return i;
+    }
+  }
+  return el.size();
+}
+
+} // end anonymous namespace
+
+TEST(ResultDemandTest, SelectedResults)
+{
+  OGNumeric::Ptr svd = SVD::create(realMatrix(3, 2));
+  OGNumeric::Ptr tree = PLUS::create(select(svd, 1), select(svd, 1));
+  ExecutionList el{tree};
+  vector<uint64_t> demand = ResultDemand::analyse(el);
+  ASSERT_EQ(el.size(), demand.size());
+  EXPECT_EQ(2, demand[positionOf(el, svd)]);
+
+  OGNumeric::Ptr lu = LU::create(realMatrix(3, 3));
+  OGNumeric::Ptr both = MTIMES::create(select(lu, 0), select(lu, 1));
+  ExecutionList el2{both};
+  EXPECT_EQ(3, ResultDemand::analyse(el2)[positionOf(el2, lu)]);
+}
+
+TEST(ResultDemandTest, OtherConsumersAndRoots)
+{
+  // Any consumer other than SELECTRESULT reads the first result
+  OGNumeric::Ptr svd = SVD::create(realMatrix(3, 2));
+  OGNumeric::Ptr tree = PLUS::create(NEGATE::create(svd), select(svd, 2));
+  ExecutionList el{tree};
+  vector<uint64_t> demand = ResultDemand::analyse(el);
+  EXPECT_EQ(5, demand[positionOf(el, svd)]);
+  // Nodes without several results compute everything
+  EXPECT_EQ(ResultDemand::ALL, demand[positionOf(el, tree)]);
+
+  // A root is returned whole
+  OGNumeric::Ptr root = SVD::create(realMatrix(3, 2));
+  ExecutionList el2{vector<OGNumeric::Ptr>{root, select(root, 1)}};
+  EXPECT_EQ(ResultDemand::ALL, ResultDemand::analyse(el2)[positionOf(el2, root)]);
+}
+
+TEST(ResultDemandTest, ScopeIsRestored)
+{
+  EXPECT_EQ(ResultDemand::ALL, ResultDemand::get());
+  {
+    ResultDemand::Scope outer(2);
+    EXPECT_FALSE(ResultDemand::isNeeded(0));
+    EXPECT_TRUE(ResultDemand::isNeeded(1));
+    {
+      ResultDemand::Scope inner(1);
+      EXPECT_TRUE(ResultDemand::isNeeded(0));
+      EXPECT_FALSE(ResultDemand::isNeeded(1));
+    }
+    EXPECT_EQ(2, ResultDemand::get());
+  }
+  EXPECT_EQ(ResultDemand::ALL, ResultDemand::get());
+  EXPECT_TRUE(ResultDemand::isNeeded(64));
+}
+
+TEST(ResultDemandTest, PlanHoldsDemand)
+{
+  OGNumeric::Ptr svd = SVD::create(realMatrix(3, 2));
+  OGNumeric::Ptr tree = NEGATE::create(select(svd, 1));
+  ExecutionList el{tree};
+  ExecutionPlan::Ptr plan = ExecutionPlan::create(el, false);
+  for (size_t n = 0; n < plan->size(); n++)
+  {
+    uint64_t expected = el[plan->getPosition(n)] == svd ? 2 : ResultDemand::ALL;
+    EXPECT_EQ(expected, plan->getDemand(n));
+  }
+}
+
+TEST(ResultDemandTest, RunnersSkipResultsNotDemanded)
+{
+  Dispatcher disp;
+  OGNumeric::Ptr svd = SVD::create(realMatrix(3, 2));
+  {
+    ResultDemand::Scope scope(2);
+    disp.dispatch(svd);
+  }
+  const RegContainer& regs = svd->asOGExpr()->getRegs();
+  ASSERT_EQ(3, regs.size());
+  EXPECT_EQ(OGNumeric::Ptr{}, regs[0]);
+  EXPECT_NE(OGNumeric::Ptr{}, regs[1]);
+  EXPECT_EQ(OGNumeric::Ptr{}, regs[2]);
+
+  OGNumeric::Ptr lu = LU::create(realMatrix(3, 3));
+  {
+    ResultDemand::Scope scope(2);
+    disp.dispatch(lu);
+  }
+  ASSERT_EQ(2, lu->asOGExpr()->getRegs().size());
+  EXPECT_EQ(OGNumeric::Ptr{}, lu->asOGExpr()->getRegs()[0]);
+  EXPECT_NE(OGNumeric::Ptr{}, lu->asOGExpr()->getRegs()[1]);
+}
+
+TEST(ResultDemandTest, ResultsMatchFullComputation)
+{
+  // The singular values, and the U factor, agree with those computed alongside everything
+  OGNumeric::Ptr A = realMatrix(4, 3);
+  OGNumeric::Ptr full = SVD::create(A);
+  ExecutionList el{full};
+  executeSerial(el, Dispatcher());
+  const RegContainer& regs = full->asOGExpr()->getRegs();
+
+  OGTerminal::Ptr S = entrypt(select(SVD::create(A), 1));
+  EXPECT_TRUE(S->fuzzyequals(regs[1]->asOGTerminal()));
+
+  OGNumeric::Ptr lu = LU::create(realMatrix(3, 3));
+  OGTerminal::Ptr U = entrypt(NEGATE::create(select(lu, 1)));
+  OGNumeric::Ptr lufull = LU::create(realMatrix(3, 3));
+  ExecutionList el2{lufull};
+  executeSerial(el2, Dispatcher());
+  EXPECT_TRUE(U->fuzzyequals(entrypt(NEGATE::create(lufull->asOGExpr()->getRegs()[1]))));
+
+  full->asOGExpr()->getRegs().clear();
+  lufull->asOGExpr()->getRegs().clear();
+}
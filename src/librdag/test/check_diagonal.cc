@@ -0,0 +1,247 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include "diagonal.hh"
+#include "inference.hh"
+#include "entrypt.hh"
+#include "execution.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "exceptions.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+namespace {
+
+template<typename T>
+typename OGDiagonalMatrix<T>::Ptr diagonalFrom(const vector<T>& diagonal, size_t rows, size_t cols)
+{
+  T * data = new T[diagonal.size()];
+  std::copy(diagonal.begin(), diagonal.end(), data);
+  return static_pointer_cast<const OGDiagonalMatrix<T>>(makeConcreteDiagonalMatrix(data, rows, cols, OWNER));
+}
+
+template<typename T>
+OGNumeric::Ptr denseFrom(const vector<T>& dense, size_t rows, size_t cols)
+{
+  T * data = new T[rows * cols];
+  std::copy(dense.begin(), dense.end(), data);
+  return makeConcreteDenseMatrix(data, rows, cols, OWNER);
+}
+
+OGNumeric::Ptr toDense(const OGNumeric::Ptr& arg)
+{
+  const OGTerminal::Ptr terminal = arg->asOGTerminal();
+  if (terminal == OGTerminal::Ptr{} || (terminal->getType() != REAL_DIAGONAL_MATRIX_ENUM &&
+                                        terminal->getType() != COMPLEX_DIAGONAL_MATRIX_ENUM))
+  {
+    return arg;
+  }
+  return terminal->getType() == REAL_DIAGONAL_MATRIX_ENUM ? terminal->asFullOGRealDenseMatrix()->createOwningCopy()
+                                                          : terminal->asFullOGComplexDenseMatrix()->createOwningCopy();
+}
+
+/**
+ * Checks that the inferred type of a node is that of its result. A diagonal product is
+ * inferred as unknown, as an Inf or NaN would make it dense.
+ */
+OGTerminal::Ptr checkInferred(const OGNumeric::Ptr& tree)
+{
+  ExecutionList el{tree};
+  ExprType_t inferred = TypeInference(el).getResult(tree).type;
+  OGTerminal::Ptr actual = entrypt(tree);
+  bool diagonalProduct = tree->getType() == MTIMES_ENUM &&
+                         (actual->getType() == REAL_DIAGONAL_MATRIX_ENUM ||
+                          actual->getType() == COMPLEX_DIAGONAL_MATRIX_ENUM);
+  EXPECT_EQ(diagonalProduct ? UNKNOWN_EXPR_ENUM : actual->getType(), inferred);
+  return actual;
+}
+
+/**
+ * Checks a binary node with diagonal arguments against the same node with the
+ * arguments made dense.
+ * @return the type of the result.
+ */
+template<typename Node>
+ExprType_t checkAgainstDense(const OGNumeric::Ptr& a, const OGNumeric::Ptr& b)
+{
+  OGTerminal::Ptr actual = checkInferred(Node::create(a, b));
+  OGTerminal::Ptr expected = entrypt(Node::create(toDense(a), toDense(b)));
+  EXPECT_TRUE(actual->mathsequals(expected));
+  return actual->getType();
+}
+
+template<typename Node>
+ExprType_t checkAgainstDense(const OGNumeric::Ptr& a)
+{
+  OGTerminal::Ptr actual = checkInferred(Node::create(a));
+  OGTerminal::Ptr expected = entrypt(Node::create(toDense(a)));
+  EXPECT_TRUE(actual->mathsequals(expected));
+  return actual->getType();
+}
+
+/**
+ * Checks the entries of a result against those expected, a NaN matching any NaN.
+ */
+void expectEntries(const OGTerminal::Ptr& result, const vector<real8>& expected)
+{
+  shared_ptr<const OGRealDenseMatrix> dense = result->asFullOGRealDenseMatrix();
+  ASSERT_EQ(expected.size(), dense->getDatalen());
+  for (size_t i = 0; i < expected.size(); i++)
+  {
+    if (std::isnan(expected[i]))
+    {
+      EXPECT_TRUE(std::isnan(dense->getData()[i]));
+    }
+    else
+    {
+      EXPECT_EQ(expected[i], dense->getData()[i]);
+    }
+  }
+}
+
+const vector<real8> rD = {2, -4, 0.5};
+const vector<real8> rE = {1, 3, -2};
+
+vector<complex16> toComplex(const vector<real8>& values)
+{
+  vector<complex16> ret;
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    ret.push_back(complex16(values[i], i + 1.0));
+  }
+  return ret;
+}
+
+} // end anonymous namespace
+
+TEST(DiagonalTest, PlusMinus)
+{
+  OGNumeric::Ptr d = diagonalFrom(rD, 3, 4);
+  OGNumeric::Ptr e = diagonalFrom(rE, 3, 4);
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, checkAgainstDense<PLUS>(d, e));
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, checkAgainstDense<MINUS>(d, e));
+  EXPECT_EQ(COMPLEX_DIAGONAL_MATRIX_ENUM, checkAgainstDense<PLUS>(diagonalFrom(toComplex(rD), 3, 3),
+                                                                  diagonalFrom(toComplex(rE), 3, 3)));
+
+  // A 1x1 diagonal matrix is broadcast, which fills in the result
+  OGNumeric::Ptr one = diagonalFrom(vector<real8>{2}, 1, 1);
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<PLUS>(one, d));
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MINUS>(d, one));
+
+  EXPECT_THROW(entrypt(PLUS::create(d, diagonalFrom(rE, 3, 3))), rdag_error);
+}
+
+TEST(DiagonalTest, Scaling)
+{
+  OGNumeric::Ptr d = diagonalFrom(rD, 3, 4);
+  OGNumeric::Ptr left = denseFrom(vector<real8>{1, 2, 3, 4, 5, 6}, 2, 3);
+  OGNumeric::Ptr right = denseFrom(vector<real8>{1, 2, 3, 4, 5, 6, 7, 8}, 4, 2);
+  // Scales the rows, or the columns, of the dense matrix
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(d, right));
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(left, d));
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, checkAgainstDense<MTIMES>(OGRealScalar::create(3.0), d));
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, checkAgainstDense<MTIMES>(d, denseFrom(vector<real8>{-2}, 1, 1)));
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(diagonalFrom(vector<real8>{-2}, 1, 1), right));
+
+  OGNumeric::Ptr cd = diagonalFrom(toComplex(rD), 3, 3);
+  EXPECT_EQ(COMPLEX_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(cd, denseFrom(toComplex({1, 2, 3}), 3, 1)));
+  EXPECT_EQ(COMPLEX_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(denseFrom(toComplex({1, 2, 3}), 1, 3), cd));
+  EXPECT_EQ(COMPLEX_DIAGONAL_MATRIX_ENUM, checkAgainstDense<MTIMES>(cd, OGComplexScalar::create(complex16(0, 1))));
+
+  EXPECT_THROW(entrypt(MTIMES::create(d, left)), rdag_error);
+}
+
+TEST(DiagonalTest, Product)
+{
+  OGNumeric::Ptr d = diagonalFrom(rD, 3, 4);
+  OGNumeric::Ptr e = diagonalFrom(vector<real8>{1, 3}, 4, 2);
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, checkAgainstDense<MTIMES>(d, e));
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, checkAgainstDense<MTIMES>(e, diagonalFrom(vector<real8>{5, 6}, 2, 3)));
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, checkAgainstDense<MTIMES>(diagonalFrom(vector<real8>{7}, 1, 1), d));
+  EXPECT_EQ(COMPLEX_DIAGONAL_MATRIX_ENUM, checkAgainstDense<MTIMES>(diagonalFrom(toComplex(rD), 3, 3),
+                                                                    diagonalFrom(toComplex(rE), 3, 3)));
+}
+
+TEST(DiagonalTest, NonFiniteValues)
+{
+  const real8 inf = std::numeric_limits<real8>::infinity();
+  const real8 nan = std::numeric_limits<real8>::quiet_NaN();
+  OGNumeric::Ptr d = diagonalFrom(vector<real8>{1, 2}, 2, 2);
+  OGNumeric::Ptr e = diagonalFrom(vector<real8>{inf, 1}, 2, 2);
+
+  // An implicit zero times Inf or NaN is NaN
+  expectEntries(entrypt(MTIMES::create(d, OGRealScalar::create(inf))), {inf, nan, nan, inf});
+  expectEntries(entrypt(MTIMES::create(denseFrom(vector<real8>{nan}, 1, 1), d)), {nan, nan, nan, nan});
+  expectEntries(entrypt(MTIMES::create(diagonalFrom(vector<real8>{inf}, 1, 1), d)), {inf, nan, nan, inf});
+
+  // Scaling by zero keeps a stored Inf as NaN
+  expectEntries(entrypt(MTIMES::create(e, OGRealScalar::create(0.0))), {nan, 0, 0, 0});
+
+  // Matrix products
+  expectEntries(entrypt(MTIMES::create(d, denseFrom(vector<real8>{nan, 1}, 2, 1))), {nan, nan});
+  expectEntries(entrypt(MTIMES::create(d, denseFrom(vector<real8>{1, 0, inf, 2}, 2, 2))), {1, 0, inf, nan});
+  expectEntries(entrypt(MTIMES::create(e, denseFrom(vector<real8>{0, 1}, 2, 1))), {nan, 1});
+  expectEntries(entrypt(MTIMES::create(denseFrom(vector<real8>{inf, 1}, 1, 2), d)), {inf, nan});
+  expectEntries(entrypt(MTIMES::create(denseFrom(vector<real8>{1, 2}, 1, 2), e)), {inf, 2});
+  expectEntries(entrypt(MTIMES::create(d, e)), {inf, nan, 0, 2});
+  expectEntries(entrypt(MTIMES::create(diagonalFrom(vector<real8>{1, nan}, 2, 3),
+                                       diagonalFrom(vector<real8>{2, 3}, 3, 2))), {2, nan, 0, nan});
+
+  // Finite values keep the products diagonal
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, entrypt(MTIMES::create(d, OGRealScalar::create(0.0)))->getType());
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, entrypt(MTIMES::create(d, d))->getType());
+}
+
+TEST(DiagonalTest, Inverses)
+{
+  OGNumeric::Ptr d = diagonalFrom(rD, 3, 3);
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, checkAgainstDense<INV>(d));
+  EXPECT_EQ(COMPLEX_DIAGONAL_MATRIX_ENUM, checkAgainstDense<INV>(diagonalFrom(toComplex(rD), 3, 3)));
+  EXPECT_THROW(entrypt(INV::create(diagonalFrom(rD, 3, 4))), rdag_error);
+
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, checkAgainstDense<PINV>(diagonalFrom(rD, 3, 4)));
+  EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, checkAgainstDense<PINV>(diagonalFrom(vector<real8>{2, 0, 1e-300}, 4, 3)));
+  EXPECT_EQ(COMPLEX_DIAGONAL_MATRIX_ENUM, checkAgainstDense<PINV>(diagonalFrom(toComplex(rD), 5, 3)));
+  OGTerminal::Ptr zero = entrypt(PINV::create(diagonalFrom(vector<real8>{0, 0}, 2, 3)));
+  EXPECT_TRUE(zero->mathsequals(denseFrom(vector<real8>(6, 0.0), 3, 2)->asOGTerminal()));
+}
+
+TEST(DiagonalTest, ZeroPreservingFunctions)
+{
+  vector<function<OGNumeric::Ptr(const OGNumeric::Ptr&)>> functions = {
+    &NEGATE::create, &SIN::create, &TAN::create, &SINH::create, &ASINH::create, &ATAN::create, &TANH::create
+  };
+  for (auto fn: functions)
+  {
+    OGNumeric::Ptr d = diagonalFrom(rD, 3, 4);
+    OGTerminal::Ptr actual = checkInferred(fn(d));
+    EXPECT_EQ(REAL_DIAGONAL_MATRIX_ENUM, actual->getType());
+    EXPECT_TRUE(actual->mathsequals(entrypt(fn(toDense(d)))));
+    OGNumeric::Ptr cd = diagonalFrom(toComplex(rD), 4, 3);
+    actual = checkInferred(fn(cd));
+    EXPECT_EQ(COMPLEX_DIAGONAL_MATRIX_ENUM, actual->getType());
+    EXPECT_TRUE(actual->mathsequals(entrypt(fn(toDense(cd)))));
+  }
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkInferred(EXP::create(diagonalFrom(rD, 3, 3)))->getType());
+}
+
+TEST(DiagonalTest, Solve)
+{
+  OGNumeric::Ptr d = diagonalFrom(rD, 3, 3);
+  OGNumeric::Ptr b = denseFrom(vector<real8>{1, 2, 3, 4, 5, 6}, 3, 2);
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MLDIVIDE>(d, b));
+  EXPECT_EQ(COMPLEX_DENSE_MATRIX_ENUM, checkAgainstDense<MLDIVIDE>(diagonalFrom(toComplex(rD), 3, 3),
+                                                                   denseFrom(toComplex({1, 2, 3}), 3, 1)));
+  // Singular and non-square systems are solved as dense ones
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MLDIVIDE>(diagonalFrom(vector<real8>{2, 0, 1}, 3, 3), b));
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MLDIVIDE>(diagonalFrom(vector<real8>{2, 4}, 3, 2), b));
+}
@@ -13,6 +13,8 @@
 #include "execution.hh"
 #include "dispatch.hh"
 #include <stdio.h>
+#include <thread>
+#include <vector>
 
 using namespace std;
 using namespace librdag;
@@ -40,3 +42,125 @@ TEST(DispatchTest, SimpleTest) {
   OGNumeric::Ptr answer = reg[0];
   answer->debug_print();
 }
+
+TEST(DispatchTest, SharedInstance) {
+  const Dispatcher& disp = Dispatcher::getInstance();
+  EXPECT_EQ(&disp, &Dispatcher::getInstance());
+
+  // Many threads dispatch through the one instance at once
+  const size_t nthreads = 8;
+  vector<OGNumeric::Ptr> nodes;
+  for (size_t i = 0; i < nthreads; i++)
+  {
+    OGNumeric::Ptr value = OGRealScalar::create(static_cast<real8>(i));
+    nodes.push_back(PLUS::create(value, NEGATE::create(value)));
+  }
+  vector<thread> threads;
+  for (size_t i = 0; i < nthreads; i++)
+  {
+    threads.push_back(thread([&disp, &nodes, i]() {
+      for (size_t j = 0; j < 100; j++)
+      {
+        ExecutionList el{nodes[i]};
+        for (auto it: el)
+        {
+          if (it->asOGExpr() != OGExpr::Ptr{})
+          {
+            it->asOGExpr()->getRegs().clear();
+          }
+          disp.dispatch(it);
+        }
+      }
+    }));
+  }
+  for (thread& t: threads)
+  {
+    t.join();
+  }
+  for (const OGNumeric::Ptr& node: nodes)
+  {
+    const RegContainer& reg = node->asOGExpr()->getRegs();
+    ASSERT_EQ(1, reg.size());
+    EXPECT_EQ(0.0, reg[0]->asOGRealScalar()->getValue());
+  }
+}
+
+TEST(DispatchTest, UnaryConversionKeepsRealDataReal) {
+  // Terminals with no unary runner of their own are converted to the cheapest type
+  // holding them
+  vector<pair<OGTerminal::Ptr, ExprType_t>> conversions = {
+    {OGIntegerScalar::create(2), REAL_SCALAR_ENUM},
+    {OGComplexScalar::create(complex16(1.0, 2.0)), COMPLEX_DENSE_MATRIX_ENUM},
+    {OGLogicalMatrix::create(new real8[2]{1.0, 0.0}, 2, 1, OWNER), REAL_DENSE_MATRIX_ENUM},
+    {OGRealDiagonalMatrix::create(new real8[2]{1.0, 2.0}, 2, 2, OWNER), REAL_DENSE_MATRIX_ENUM},
+    {OGComplexDiagonalMatrix::create(new complex16[2]{{1.0, 1.0}, {2.0, 0.0}}, 2, 2, OWNER), COMPLEX_DENSE_MATRIX_ENUM},
+    {OGRealSparseMatrix::create(new int4[3]{0, 1, 1}, new int4[1]{1}, new real8[1]{3.0}, 2, 2, OWNER), REAL_DENSE_MATRIX_ENUM},
+    {OGComplexSparseMatrix::create(new int4[3]{0, 0, 1}, new int4[1]{0}, new complex16[1]{{0.0, 3.0}}, 2, 2, OWNER), COMPLEX_DENSE_MATRIX_ENUM}
+  };
+  const Dispatcher& disp = Dispatcher::getInstance();
+  for (auto& conversion: conversions)
+  {
+    OGNumeric::Ptr node = COS::create(conversion.first);
+    disp.dispatch(node);
+    OGTerminal::Ptr result = node->asOGExpr()->getRegs()[0]->asOGTerminal();
+    EXPECT_EQ(conversion.second, result->getType());
+    OGTerminal::Ptr expected = conversion.first->asFullOGComplexDenseMatrix()->createComplexOwningCopy();
+    OGNumeric::Ptr complexNode = COS::create(expected);
+    disp.dispatch(complexNode);
+    EXPECT_TRUE(result->mathsequals(complexNode->asOGExpr()->getRegs()[0]->asOGTerminal()));
+  }
+}
+
+TEST(DispatchTest, EveryPairOfTerminals) {
+  // One of each terminal type that can be added to the others, all holding the value 1
+  vector<OGTerminal::Ptr> terminals = {
+    OGRealScalar::create(1.0),
+    OGComplexScalar::create(complex16(1.0, 0.0)),
+    OGIntegerScalar::create(1),
+    OGRealDenseMatrix::create(new real8[1]{1.0}, 1, 1, OWNER),
+    OGLogicalMatrix::create(new real8[1]{1.0}, 1, 1, OWNER),
+    OGComplexDenseMatrix::create(new complex16[1]{{1.0, 0.0}}, 1, 1, OWNER),
+    OGRealDiagonalMatrix::create(new real8[1]{1.0}, 1, 1, OWNER),
+    OGComplexDiagonalMatrix::create(new complex16[1]{{1.0, 0.0}}, 1, 1, OWNER)
+  };
+  const Dispatcher& disp = Dispatcher::getInstance();
+  for (const OGTerminal::Ptr& arg0: terminals)
+  {
+    OGNumeric::Ptr negate = NEGATE::create(arg0);
+    disp.dispatch(negate);
+    EXPECT_EQ(complex16(-1.0, 0.0),
+              negate->asOGExpr()->getRegs()[0]->asOGTerminal()->asFullOGComplexDenseMatrix()->getData()[0]);
+    for (const OGTerminal::Ptr& arg1: terminals)
+    {
+      OGNumeric::Ptr plus = PLUS::create(arg0, arg1);
+      disp.dispatch(plus);
+      EXPECT_EQ(complex16(2.0, 0.0),
+                plus->asOGExpr()->getRegs()[0]->asOGTerminal()->asFullOGComplexDenseMatrix()->getData()[0]);
+    }
+  }
+}
+
+TEST(DispatchTest, ScalarsAreNotConvertedToMatrices) {
+  // Scalars of every kind are computed with directly, so pairs of them give scalars
+  OGNumeric::Ptr integer = OGIntegerScalar::create(3);
+  OGNumeric::Ptr real = OGRealScalar::create(0.5);
+  OGNumeric::Ptr cplx = OGComplexScalar::create(complex16(1.0, 2.0));
+  vector<pair<OGNumeric::Ptr, OGTerminal::Ptr>> cases = {
+    {RDIVIDE::create(integer, OGIntegerScalar::create(2)), OGRealScalar::create(1.5)},
+    {MINUS::create(real, integer), OGRealScalar::create(-2.5)},
+    {TIMES::create(integer, cplx), OGComplexScalar::create(complex16(3.0, 6.0))},
+    {MTIMES::create(cplx, real), OGComplexScalar::create(complex16(0.5, 1.0))},
+    {PLUS::create(integer, OGRealDenseMatrix::create(new real8[2]{1.0, 2.0}, 2, 1, OWNER)),
+     OGRealDenseMatrix::create(new real8[2]{4.0, 5.0}, 2, 1, OWNER)},
+    {MTIMES::create(OGRealDenseMatrix::create(new real8[2]{1.0, 2.0}, 1, 2, OWNER), cplx),
+     OGComplexDenseMatrix::create(new complex16[2]{{1.0, 2.0}, {2.0, 4.0}}, 1, 2, OWNER)}
+  };
+  const Dispatcher& disp = Dispatcher::getInstance();
+  for (auto& c: cases)
+  {
+    disp.dispatch(c.first);
+    OGTerminal::Ptr result = c.first->asOGExpr()->getRegs()[0]->asOGTerminal();
+    EXPECT_EQ(c.second->getType(), result->getType());
+    EXPECT_TRUE(result->mathsequals(c.second));
+  }
+}
@@ -6,6 +6,7 @@
 
 #include "gtest/gtest.h"
 #include "entrypt.hh"
+#include "exceptions.hh"
 #include "expression.hh"
 #include "terminal.hh"
 #include "test/terminals.hh"
@@ -154,3 +155,105 @@ TreeResultPair pluses[] = { plustestsimple(), plustesttwoplus(), plustestbigtree
 
 INSTANTIATE_TEST_CASE_P(ValueParam, EntryptPlusTest, ::testing::ValuesIn(pluses));
 
+/**
+ * Entrypt with a batch of trees
+ */
+TEST(EntryptBatchTest, Empty)
+{
+  EXPECT_EQ(0, entrypt(vector<OGNumeric::Ptr>{}).size());
+}
+
+TEST(EntryptBatchTest, MixedTrees)
+{
+  OGTerminal::Ptr m = OGRealDenseMatrix::create(realData, 2, 3);
+  OGNumeric::Ptr negate = NEGATE::create(m);
+  OGTerminal::Ptr scalar = OGRealScalar::create(2.0);
+  vector<OGNumeric::Ptr> trees{
+    negate,
+    scalar,
+    PLUS::create(OGRealScalar::create(2.0), OGRealScalar::create(3.0)),
+    // Shares its argument with the first tree
+    NEGATE::create(negate),
+    // Simplifies to a terminal
+    NEGATE::create(NEGATE::create(scalar)),
+    negate
+  };
+  vector<OGTerminal::Ptr> results = entrypt(trees);
+  ASSERT_EQ(trees.size(), results.size());
+  EXPECT_TRUE((*results[0]) == OGRealDenseMatrix::create(realNegData, 2, 3));
+  EXPECT_EQ(scalar, results[1]);
+  EXPECT_TRUE((*results[2]) == OGRealScalar::create(5.0));
+  EXPECT_TRUE((*results[3]) == m);
+  EXPECT_EQ(scalar, results[4]);
+  EXPECT_TRUE((*results[5]) == OGRealDenseMatrix::create(realNegData, 2, 3));
+}
+
+TEST(EntryptBatchTest, ManyTrees)
+{
+  // Lots of small trees over the same terminal, evaluated together and one by one
+  OGNumeric::Ptr m = OGComplexDenseMatrix::create(complexData, 2, 3);
+  vector<OGNumeric::Ptr> trees;
+  for (size_t i = 0; i < 1000; i++)
+  {
+    OGNumeric::Ptr tree = TIMES::create(m, OGRealScalar::create(static_cast<real8>(i % 100)));
+    trees.push_back(i % 2 == 0 ? tree : PLUS::create(tree, NEGATE::create(m)));
+  }
+  vector<OGTerminal::Ptr> results = entrypt(trees);
+  ASSERT_EQ(trees.size(), results.size());
+  for (size_t i = 0; i < trees.size(); i++)
+  {
+    EXPECT_TRUE((*results[i]) == entrypt(trees[i]));
+  }
+}
+
+TEST(EntryptBatchTest, ErrorIsRethrown)
+{
+  OGNumeric::Ptr good = NEGATE::create(OGRealScalar::create(1.0));
+  OGNumeric::Ptr bad = PLUS::create(OGRealDenseMatrix::create(realData, 2, 3),
+                                    OGRealDenseMatrix::create(realData, 3, 2));
+  EXPECT_THROW(entrypt(vector<OGNumeric::Ptr>{good, bad}), rdag_error);
+}
+
+/**
+ * Asynchronous entrypt
+ */
+TEST(EntryptAsyncTest, MatchesSync)
+{
+  OGNumeric::Ptr m = OGRealDenseMatrix::create(realData, 2, 3);
+  future<OGTerminal::Ptr> single = entryptAsync(NEGATE::create(m));
+  future<vector<OGTerminal::Ptr>> batch = entryptAsync(vector<OGNumeric::Ptr>{NEGATE::create(m), m});
+  EXPECT_TRUE((*single.get()) == OGRealDenseMatrix::create(realNegData, 2, 3));
+  vector<OGTerminal::Ptr> results = batch.get();
+  ASSERT_EQ(2, results.size());
+  EXPECT_TRUE((*results[0]) == OGRealDenseMatrix::create(realNegData, 2, 3));
+  EXPECT_EQ(m, results[1]);
+}
+
+TEST(EntryptAsyncTest, ManyInFlight)
+{
+  // Build and submit trees while earlier ones are being evaluated
+  OGNumeric::Ptr m = OGComplexDenseMatrix::create(complexData, 2, 3);
+  vector<OGNumeric::Ptr> trees;
+  vector<future<OGTerminal::Ptr>> futures;
+  for (size_t i = 0; i < 200; i++)
+  {
+    OGNumeric::Ptr tree = TIMES::create(m, OGRealScalar::create(static_cast<real8>(i)));
+    trees.push_back(PLUS::create(tree, NEGATE::create(m)));
+    futures.push_back(entryptAsync(trees.back()));
+  }
+  for (size_t i = 0; i < trees.size(); i++)
+  {
+    OGTerminal::Ptr result = futures[i].get();
+    EXPECT_TRUE((*result) == entrypt(trees[i]));
+  }
+}
+
+TEST(EntryptAsyncTest, ErrorIsPassedToFuture)
+{
+  OGNumeric::Ptr bad = PLUS::create(OGRealDenseMatrix::create(realData, 2, 3),
+                                    OGRealDenseMatrix::create(realData, 3, 2));
+  future<OGTerminal::Ptr> single = entryptAsync(bad);
+  EXPECT_THROW(single.get(), rdag_error);
+  future<vector<OGTerminal::Ptr>> batch = entryptAsync(vector<OGNumeric::Ptr>{NEGATE::create(bad)});
+  EXPECT_THROW(batch.get(), rdag_error);
+}
@@ -123,3 +123,80 @@ TEST(LinearisationTest, BinaryUnaryLinearisation)
     EXPECT_EQ(nodes[j], el1[j]);
   }
 }
+
+TEST(LinearisationTest, SharedNodeLinearisation)
+{
+  /*
+   * A diamond: both args of the PLUS are the same COPY node
+   *
+   *       +
+   *      / \
+   *      \ /
+   *     COPY
+   *       |
+   *      1.0
+   */
+  OGNumeric::Ptr real = OGRealScalar::create(1.0);
+  OGNumeric::Ptr copy = COPY::create(real);
+  OGNumeric::Ptr plus = PLUS::create(copy, copy);
+  ExecutionList el1 = ExecutionList(plus);
+  ASSERT_EQ(3, el1.size());
+  EXPECT_EQ(real, el1[0]);
+  EXPECT_EQ(copy, el1[1]);
+  EXPECT_EQ(plus, el1[2]);
+}
+
+TEST(LinearisationTest, SharedTerminalLinearisation)
+{
+  // The same terminal in two places
+  OGNumeric::Ptr real1 = OGRealScalar::create(1.0);
+  OGNumeric::Ptr real2 = OGRealScalar::create(2.0);
+  OGNumeric::Ptr plus1 = PLUS::create(real1, real2);
+  OGNumeric::Ptr plus2 = PLUS::create(plus1, real1);
+  ExecutionList el1 = ExecutionList(plus2);
+  ASSERT_EQ(4, el1.size());
+  EXPECT_EQ(real1, el1[0]);
+  EXPECT_EQ(real2, el1[1]);
+  EXPECT_EQ(plus1, el1[2]);
+  EXPECT_EQ(plus2, el1[3]);
+}
+
+TEST(LinearisationTest, DeepDiamondLinearisation)
+{
+  // Each level uses the level below twice, so a traversal that does not
+  // recognise shared nodes would visit 2^depth nodes.
+  const size_t depth = 64;
+  OGNumeric::Ptr node = OGRealScalar::create(1.0);
+  vector<OGNumeric::Ptr> levels{node};
+  for (size_t i = 0; i < depth; i++)
+  {
+    node = PLUS::create(node, node);
+    levels.push_back(node);
+  }
+  ExecutionList el1 = ExecutionList(node);
+  ASSERT_EQ(depth + 1, el1.size());
+  for (size_t i = 0; i <= depth; i++)
+  {
+    EXPECT_EQ(levels[i], el1[i]);
+  }
+}
+
+TEST(LinearisationTest, MultipleTreeLinearisation)
+{
+  // The second tree shares the first tree's root, the third is the first again
+  OGNumeric::Ptr real1 = OGRealScalar::create(1.0);
+  OGNumeric::Ptr real2 = OGRealScalar::create(2.0);
+  OGNumeric::Ptr plus = PLUS::create(real1, real2);
+  OGNumeric::Ptr negate = NEGATE::create(plus);
+  ExecutionList el1 = ExecutionList(vector<OGNumeric::Ptr>{plus, negate, plus, real2});
+  ASSERT_EQ(4, el1.size());
+  EXPECT_EQ(real1, el1[0]);
+  EXPECT_EQ(real2, el1[1]);
+  EXPECT_EQ(plus, el1[2]);
+  EXPECT_EQ(negate, el1[3]);
+  vector<size_t> roots{2, 3, 2, 1};
+  EXPECT_EQ(roots, el1.getRoots());
+
+  ExecutionList el2 = ExecutionList(negate);
+  EXPECT_EQ(vector<size_t>{3}, el2.getRoots());
+}
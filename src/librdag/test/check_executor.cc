@@ -0,0 +1,245 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include "execution.hh"
+#include "executor.hh"
+#include "dispatch.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "threadpool.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+namespace {
+
+/**
+ * Builds a balanced tree of PLUS nodes summing \a nleaves matrices, the i'th of which
+ * has all elements equal to i.
+ */
+OGNumeric::Ptr buildSumTree(int lo, int hi)
+{
+  if (hi - lo == 1)
+  {
+    real8 * data = new real8[4];
+    std::fill(data, data + 4, static_cast<real8>(lo));
+    return OGRealDenseMatrix::create(data, 2, 2, OWNER);
+  }
+  int mid = (lo + hi) / 2;
+  return PLUS::create(buildSumTree(lo, mid), buildSumTree(mid, hi));
+}
+
+OGTerminal::Ptr expectedSum(int nleaves)
+{
+  real8 sum = nleaves * (nleaves - 1) / 2;
+  return OGRealDenseMatrix::create(new real8[4]{sum, sum, sum, sum}, 2, 2, OWNER);
+}
+
+/**
+ * Restores the process-wide execution options at the end of a test.
+ */
+class ExecutionOptionsGuard
+{
+  public:
+    ExecutionOptionsGuard(): _mode(ExecutionOptions::getMode()), _nthreads(ExecutionOptions::getThreadCount()) {}
+    ~ExecutionOptionsGuard()
+    {
+      ExecutionOptions::setMode(_mode);
+      ExecutionOptions::setThreadCount(_nthreads);
+    }
+  private:
+    ExecutionMode _mode;
+    size_t _nthreads;
+};
+
+} // end anonymous namespace
+
+TEST(ExecutionOptionsTest, SetAndGet)
+{
+  ExecutionOptionsGuard guard;
+  ExecutionOptions::setMode(ExecutionMode::SERIAL);
+  EXPECT_EQ(ExecutionMode::SERIAL, ExecutionOptions::getMode());
+  ExecutionOptions::setMode(ExecutionMode::PARALLEL);
+  EXPECT_EQ(ExecutionMode::PARALLEL, ExecutionOptions::getMode());
+  ExecutionOptions::setThreadCount(3);
+  EXPECT_EQ(3, ExecutionOptions::getThreadCount());
+  ExecutionOptions::setThreadCount(0);
+  EXPECT_EQ(ThreadPool::getHardwareThreadCount(), ExecutionOptions::getThreadCount());
+}
+
+TEST(DependencyGraphTest, Terminal)
+{
+  OGNumeric::Ptr real = OGRealScalar::create(1.0);
+  ExecutionList el{real};
+  DependencyGraph graph(el);
+  EXPECT_EQ(0, graph.size());
+  EXPECT_TRUE(graph.isSequential());
+}
+
+TEST(DependencyGraphTest, Chain)
+{
+  OGNumeric::Ptr real = OGRealScalar::create(1.0);
+  OGNumeric::Ptr neg1 = NEGATE::create(real);
+  OGNumeric::Ptr neg2 = NEGATE::create(neg1);
+  OGNumeric::Ptr plus = PLUS::create(neg2, real);
+  ExecutionList el{plus};
+  DependencyGraph graph(el);
+  ASSERT_EQ(3, graph.size());
+  EXPECT_EQ(neg1, graph.getNode(0));
+  EXPECT_EQ(neg2, graph.getNode(1));
+  EXPECT_EQ(plus, graph.getNode(2));
+  EXPECT_EQ(0, graph.getDependencyCount(0));
+  EXPECT_EQ(1, graph.getDependencyCount(1));
+  EXPECT_EQ(1, graph.getDependencyCount(2));
+  EXPECT_EQ(vector<size_t>{2}, graph.getDependents(1));
+  EXPECT_TRUE(graph.isSequential());
+}
+
+TEST(DependencyGraphTest, SharedNode)
+{
+  // The same node used twice appears once in the graph with a single dependent
+  OGNumeric::Ptr real = OGRealScalar::create(1.0);
+  OGNumeric::Ptr neg = NEGATE::create(real);
+  OGNumeric::Ptr plus = PLUS::create(neg, neg);
+  ExecutionList el{plus};
+  DependencyGraph graph(el);
+  ASSERT_EQ(2, graph.size());
+  EXPECT_EQ(vector<size_t>{1}, graph.getDependents(0));
+  EXPECT_EQ(1, graph.getDependencyCount(1));
+}
+
+TEST(DependencyGraphTest, Branching)
+{
+  OGNumeric::Ptr tree = buildSumTree(0, 4);
+  ExecutionList el{tree};
+  DependencyGraph graph(el);
+  ASSERT_EQ(3, graph.size());
+  EXPECT_EQ(2, graph.getDependencyCount(2));
+  EXPECT_FALSE(graph.isSequential());
+}
+
+class ExecutorModeTest: public ::testing::TestWithParam<ExecutionMode> {};
+
+TEST_P(ExecutorModeTest, WideTree)
+{
+  ExecutionOptionsGuard guard;
+  ExecutionOptions::setMode(GetParam());
+  ExecutionOptions::setThreadCount(4);
+  const int nleaves = 256;
+  OGNumeric::Ptr tree = buildSumTree(0, nleaves);
+  ExecutionList el{tree};
+  Dispatcher disp;
+  execute(el, disp);
+  const RegContainer& regs = tree->asOGExpr()->getRegs();
+  ASSERT_EQ(1, regs.size());
+  EXPECT_TRUE(regs[0]->asOGTerminal()->mathsequals(expectedSum(nleaves)));
+}
+
+TEST_P(ExecutorModeTest, ErrorIsRethrown)
+{
+  ExecutionOptionsGuard guard;
+  ExecutionOptions::setMode(GetParam());
+  ExecutionOptions::setThreadCount(4);
+  // Non-conformant MTIMES in one branch of an otherwise valid tree
+  OGNumeric::Ptr m1 = OGRealDenseMatrix::create(new real8[2]{1, 2}, 2, 1, OWNER);
+  OGNumeric::Ptr m2 = OGRealDenseMatrix::create(new real8[2]{1, 2}, 2, 1, OWNER);
+  OGNumeric::Ptr bad = MTIMES::create(m1, m2);
+  OGNumeric::Ptr tree = PLUS::create(buildSumTree(0, 16), NEGATE::create(bad));
+  ExecutionList el{tree};
+  Dispatcher disp;
+  EXPECT_THROW(execute(el, disp), rdag_error);
+}
+
+INSTANTIATE_TEST_CASE_P(ValueParam, ExecutorModeTest,
+                        ::testing::Values(ExecutionMode::SERIAL, ExecutionMode::PARALLEL));
+
+TEST(ExecuteParallelTest, ExplicitPool)
+{
+  ThreadPool pool(3);
+  const int nleaves = 64;
+  OGNumeric::Ptr tree = buildSumTree(0, nleaves);
+  ExecutionList el{tree};
+  Dispatcher disp;
+  executeParallel(el, disp, pool);
+  const RegContainer& regs = tree->asOGExpr()->getRegs();
+  EXPECT_TRUE(regs[0]->asOGTerminal()->mathsequals(expectedSum(nleaves)));
+}
+
+TEST(ExecuteParallelTest, ResultsMatchSerial)
+{
+  ThreadPool pool(4);
+  Dispatcher disp;
+  for (int nleaves = 2; nleaves < 40; nleaves++)
+  {
+    OGNumeric::Ptr tree = buildSumTree(0, nleaves);
+    ExecutionList el{tree};
+    executeParallel(el, disp, pool);
+    EXPECT_TRUE(tree->asOGExpr()->getRegs()[0]->asOGTerminal()->mathsequals(expectedSum(nleaves)));
+  }
+}
+
+TEST(LivenessTest, IntermediatesReleased)
+{
+  ExecutionOptionsGuard guard;
+  ExecutionOptions::setMode(ExecutionMode::PARALLEL);
+  OGNumeric::Ptr A = OGRealDenseMatrix::create(new real8[4]{1, 2, 3, 4}, 2, 2, OWNER);
+  OGNumeric::Ptr B = OGRealDenseMatrix::create(new real8[4]{5, 6, 7, 8}, 2, 2, OWNER);
+  OGNumeric::Ptr transpose = TRANSPOSE::create(A);
+  OGNumeric::Ptr plus = PLUS::create(A, B);
+  OGNumeric::Ptr tree = MTIMES::create(transpose, plus);
+  for (size_t nthreads: {1, 4})
+  {
+    ExecutionOptions::setThreadCount(nthreads);
+    ExecutionList el{tree};
+    Dispatcher disp;
+    execute(el, disp);
+    EXPECT_EQ(0, transpose->asOGExpr()->getRegs().size());
+    EXPECT_EQ(0, plus->asOGExpr()->getRegs().size());
+    const RegContainer& regs = tree->asOGExpr()->getRegs();
+    ASSERT_EQ(1, regs.size());
+    EXPECT_TRUE(regs[0]->asOGTerminal()->mathsequals(
+                OGRealDenseMatrix::create(new real8[4]{22, 50, 34, 78}, 2, 2, OWNER)));
+    tree->asOGExpr()->getRegs().clear();
+  }
+}
+
+TEST(LivenessTest, SerialKeepsIntermediates)
+{
+  OGNumeric::Ptr A = OGRealDenseMatrix::create(new real8[4]{1, 2, 3, 4}, 2, 2, OWNER);
+  OGNumeric::Ptr transpose = TRANSPOSE::create(A);
+  OGNumeric::Ptr tree = MTIMES::create(transpose, A);
+  ExecutionList el{tree};
+  Dispatcher disp;
+  executeSerial(el, disp);
+  EXPECT_EQ(1, transpose->asOGExpr()->getRegs().size());
+  EXPECT_EQ(1, tree->asOGExpr()->getRegs().size());
+}
+
+TEST(LivenessTest, ResultsKept)
+{
+  // Every root keeps its result, even if another tree consumes it
+  ExecutionOptionsGuard guard;
+  ExecutionOptions::setMode(ExecutionMode::PARALLEL);
+  OGNumeric::Ptr A = OGRealDenseMatrix::create(new real8[4]{1, 2, 3, 4}, 2, 2, OWNER);
+  for (size_t nthreads: {1, 4})
+  {
+    ExecutionOptions::setThreadCount(nthreads);
+    OGNumeric::Ptr negate = NEGATE::create(A);
+    OGNumeric::Ptr transpose = TRANSPOSE::create(negate);
+    OGNumeric::Ptr tree = PLUS::create(transpose, negate);
+    ExecutionList el{vector<OGNumeric::Ptr>{tree, negate}};
+    Dispatcher disp;
+    execute(el, disp);
+    EXPECT_EQ(0, transpose->asOGExpr()->getRegs().size());
+    ASSERT_EQ(1, negate->asOGExpr()->getRegs().size());
+    EXPECT_TRUE(negate->asOGExpr()->getRegs()[0]->asOGTerminal()->mathsequals(
+                OGRealDenseMatrix::create(new real8[4]{-1, -2, -3, -4}, 2, 2, OWNER)));
+    ASSERT_EQ(1, tree->asOGExpr()->getRegs().size());
+    EXPECT_TRUE(tree->asOGExpr()->getRegs()[0]->asOGTerminal()->mathsequals(
+                OGRealDenseMatrix::create(new real8[4]{-2, -5, -5, -8}, 2, 2, OWNER)));
+  }
+}
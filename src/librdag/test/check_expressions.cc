@@ -35,10 +35,19 @@ TYPED_TEST_P(BinaryExprTest, Functionality){
   // Constructor with null args
   EXPECT_THROW(TypeParam::create(OGNumeric::Ptr{}, real), rdag_error);
   EXPECT_THROW(TypeParam::create(real, OGNumeric::Ptr{}), rdag_error);
+
+  // Rebuild with new args
+  OGNumeric::Ptr other = OGRealScalar::create(1.0);
+  OGExpr::Ptr rebuilt = expr->withArgs(ArgContainer{complx, other});
+  ASSERT_NE(expr, rebuilt);
+  EXPECT_EQ(expr->getType(), rebuilt->getType());
+  EXPECT_EQ(complx, rebuilt->getArgs()[0]);
+  EXPECT_EQ(other, rebuilt->getArgs()[1]);
+  EXPECT_THROW(expr->withArgs(ArgContainer{real}), rdag_error);
 }
 
 REGISTER_TYPED_TEST_CASE_P(BinaryExprTest, Functionality);
-typedef ::testing::Types<PLUS> BinaryExprTypes;
+typedef ::testing::Types<PLUS, MTIMES, MLDIVIDE> BinaryExprTypes;
 INSTANTIATE_TYPED_TEST_CASE_P(Binary, BinaryExprTest, BinaryExprTypes);
 
 /**
@@ -62,10 +71,18 @@ TYPED_TEST_P(UnaryExprTest, Functionality){
 
   // Constructor with null args
   EXPECT_THROW(TypeParam::create(OGNumeric::Ptr{}), rdag_error);
+
+  // Rebuild with new args
+  OGNumeric::Ptr other = OGRealScalar::create(1.0);
+  OGExpr::Ptr rebuilt = expr->withArgs(ArgContainer{other});
+  ASSERT_NE(expr, rebuilt);
+  EXPECT_EQ(expr->getType(), rebuilt->getType());
+  EXPECT_EQ(other, rebuilt->getArgs()[0]);
+  EXPECT_THROW(expr->withArgs(ArgContainer{real, other}), rdag_error);
 }
 
 REGISTER_TYPED_TEST_CASE_P(UnaryExprTest, Functionality);
-typedef ::testing::Types<NEGATE, SVD, COPY> UnaryExprTypes;
+typedef ::testing::Types<NEGATE, SVD, COPY, TRANSPOSE, INV> UnaryExprTypes;
 INSTANTIATE_TYPED_TEST_CASE_P(Unary, UnaryExprTest, UnaryExprTypes);
 
 /**
@@ -92,6 +109,12 @@ TEST(OGExprTest, SELECTRESULT){
   // Constructor where second argument is not an integer type
   OGNumeric::Ptr realcopy = real->copy();
   EXPECT_THROW(SELECTRESULT::create(real, realcopy), rdag_error);
+
+  // Rebuild with new args, checks are still applied
+  OGExpr::Ptr rebuilt = selectresult->asOGExpr()->withArgs(ArgContainer{realcopy, index});
+  ASSERT_NE(SELECTRESULT::Ptr{}, rebuilt->asSELECTRESULT());
+  EXPECT_EQ(realcopy, rebuilt->getArgs()[0]);
+  EXPECT_THROW(selectresult->asOGExpr()->withArgs(ArgContainer{real, realcopy}), rdag_error);
 }
 
 TEST(VirtualCopyTest, OGRealScalar){
@@ -0,0 +1,356 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <functional>
+#include "fusion.hh"
+#include "execution.hh"
+#include "executor.hh"
+#include "dispatch.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+namespace {
+
+OGNumeric::Ptr realMatrix(size_t rows, size_t cols, real8 offset)
+{
+  real8 * data = new real8[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = offset + 0.001 * i;
+  }
+  return OGRealDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+OGNumeric::Ptr complexMatrix(size_t rows, size_t cols, real8 offset)
+{
+  complex16 * data = new complex16[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = complex16(offset + 0.001 * i, offset - 0.002 * i);
+  }
+  return OGComplexDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+/**
+ * Executes a tree with and without fusion, checking the results agree.
+ */
+void checkFusedMatchesUnfused(const function<OGNumeric::Ptr()>& build)
+{
+  Dispatcher disp;
+  OGNumeric::Ptr unfused = build();
+  ExecutionList el1{unfused};
+  executeSerial(el1, disp);
+  OGTerminal::Ptr expected = unfused->asOGExpr()->getRegs()[0]->asOGTerminal();
+
+  OGNumeric::Ptr fused = build();
+  ExecutionList el2{fused};
+  DependencyGraph graph(el2, true);
+  ASSERT_EQ(1, graph.size());
+  ASSERT_NE(nullptr, graph.getKernel(0));
+  EXPECT_TRUE(graph.getKernel(0)->executeFused());
+  const RegContainer& regs = fused->asOGExpr()->getRegs();
+  ASSERT_EQ(1, regs.size());
+  OGTerminal::Ptr actual = regs[0]->asOGTerminal();
+  EXPECT_EQ(expected->getType(), actual->getType());
+  EXPECT_TRUE(expected->fuzzyequals(actual));
+}
+
+} // end anonymous namespace
+
+TEST(FusedKernelTest, IsFusible)
+{
+  OGNumeric::Ptr m = realMatrix(2, 2, 1.0);
+  EXPECT_TRUE(FusedKernel::isFusible(PLUS::create(m, m)));
+  EXPECT_TRUE(FusedKernel::isFusible(NEGATE::create(m)));
+  EXPECT_TRUE(FusedKernel::isFusible(EXP::create(m)));
+  EXPECT_FALSE(FusedKernel::isFusible(MTIMES::create(m, m)));
+  EXPECT_FALSE(FusedKernel::isFusible(TRANSPOSE::create(m)));
+  EXPECT_FALSE(FusedKernel::isFusible(m));
+}
+
+TEST(FusedKernelTest, Structure)
+{
+  // exp(-(A.*B)+C)
+  OGNumeric::Ptr A = realMatrix(3, 2, 1.0);
+  OGNumeric::Ptr B = realMatrix(3, 2, 2.0);
+  OGNumeric::Ptr C = realMatrix(3, 2, 3.0);
+  OGNumeric::Ptr times = TIMES::create(A, B);
+  OGNumeric::Ptr negate = NEGATE::create(times);
+  OGNumeric::Ptr plus = PLUS::create(negate, C);
+  OGNumeric::Ptr tree = EXP::create(plus);
+  ExecutionList el{tree};
+
+  DependencyGraph unfused(el);
+  EXPECT_EQ(4, unfused.size());
+  EXPECT_EQ(nullptr, unfused.getKernel(3));
+
+  DependencyGraph graph(el, true);
+  ASSERT_EQ(1, graph.size());
+  EXPECT_EQ(tree, graph.getNode(0));
+  const FusedKernel * kernel = graph.getKernel(0);
+  ASSERT_NE(nullptr, kernel);
+  EXPECT_EQ(tree, kernel->getRoot());
+  EXPECT_EQ((vector<OGNumeric::Ptr>{times, negate, plus, tree}), kernel->getMembers());
+  EXPECT_EQ((vector<OGNumeric::Ptr>{A, B, C}), kernel->getLeaves());
+}
+
+TEST(FusedKernelTest, StructureAtBoundaries)
+{
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  OGNumeric::Ptr B = realMatrix(2, 2, 2.0);
+  // The shared node is computed once and dispatched on its own, and each MTIMES
+  // argument is a separate kernel.
+  OGNumeric::Ptr shared = PLUS::create(A, B);
+  OGNumeric::Ptr left = NEGATE::create(TIMES::create(shared, A));
+  OGNumeric::Ptr right = SIN::create(MINUS::create(shared, B));
+  OGNumeric::Ptr tree = MTIMES::create(left, right);
+  ExecutionList el{tree};
+  DependencyGraph graph(el, true);
+  ASSERT_EQ(4, graph.size());
+  EXPECT_EQ(shared, graph.getNode(0));
+  EXPECT_EQ(nullptr, graph.getKernel(0));
+  EXPECT_EQ(left, graph.getNode(1));
+  ASSERT_NE(nullptr, graph.getKernel(1));
+  EXPECT_EQ((vector<OGNumeric::Ptr>{shared, A}), graph.getKernel(1)->getLeaves());
+  EXPECT_EQ(right, graph.getNode(2));
+  ASSERT_NE(nullptr, graph.getKernel(2));
+  EXPECT_EQ(tree, graph.getNode(3));
+  EXPECT_EQ(nullptr, graph.getKernel(3));
+  EXPECT_EQ(vector<size_t>({1, 2}), graph.getDependents(0));
+  EXPECT_EQ(2, graph.getDependencyCount(3));
+
+  EXPECT_EQ(vector<size_t>({1, 2}), graph.getDependencies(3));
+
+  Dispatcher disp;
+  graph.dispatch(0, disp);
+  graph.dispatch(1, disp);
+  // Only the roots of kernels hold results
+  EXPECT_EQ(1, left->asOGExpr()->getRegs().size());
+  EXPECT_EQ(0, left->asOGExpr()->getArgs()[0]->asOGExpr()->getRegs().size());
+}
+
+TEST(FusedKernelTest, Real)
+{
+  checkFusedMatchesUnfused([]{
+    return EXP::create(PLUS::create(NEGATE::create(TIMES::create(realMatrix(3, 4, 0.1), realMatrix(3, 4, 0.2))),
+                                    realMatrix(3, 4, 0.3)));
+  });
+}
+
+TEST(FusedKernelTest, AllUnaryFunctions)
+{
+  checkFusedMatchesUnfused([]{
+    OGNumeric::Ptr x = realMatrix(4, 3, 0.1);
+    OGNumeric::Ptr t = ACOS::create(x);
+    t = ASINH::create(t);
+    t = ATAN::create(t);
+    t = COS::create(t);
+    t = EXP::create(t);
+    t = SIN::create(t);
+    t = SINH::create(t);
+    t = TAN::create(t);
+    return TANH::create(t);
+  });
+  checkFusedMatchesUnfused([]{
+    OGNumeric::Ptr x = complexMatrix(4, 3, 0.1);
+    OGNumeric::Ptr t = ACOS::create(x);
+    t = ASINH::create(t);
+    t = ATAN::create(t);
+    t = COS::create(t);
+    t = EXP::create(t);
+    t = SIN::create(t);
+    t = SINH::create(t);
+    t = TAN::create(t);
+    return TANH::create(t);
+  });
+}
+
+TEST(FusedKernelTest, Complex)
+{
+  checkFusedMatchesUnfused([]{
+    return RDIVIDE::create(MINUS::create(complexMatrix(5, 3, 0.5), complexMatrix(5, 3, 0.25)),
+                           complexMatrix(5, 3, 1.0));
+  });
+}
+
+TEST(FusedKernelTest, MixedRealAndComplex)
+{
+  // The real subtree is computed as real, then promoted
+  checkFusedMatchesUnfused([]{
+    return TIMES::create(ACOS::create(PLUS::create(realMatrix(3, 3, 0.1), realMatrix(3, 3, 0.2))),
+                         complexMatrix(3, 3, 0.5));
+  });
+  checkFusedMatchesUnfused([]{
+    return MINUS::create(complexMatrix(3, 3, 0.5), NEGATE::create(realMatrix(3, 3, 1.0)));
+  });
+}
+
+TEST(FusedKernelTest, Broadcast)
+{
+  checkFusedMatchesUnfused([]{
+    return TIMES::create(PLUS::create(OGRealScalar::create(2.0), OGRealScalar::create(0.5)),
+                         RDIVIDE::create(realMatrix(4, 4, 1.0), realMatrix(1, 1, 3.0)));
+  });
+  checkFusedMatchesUnfused([]{
+    return PLUS::create(OGComplexScalar::create(complex16(1.0, 2.0)), SIN::create(realMatrix(2, 5, 1.0)));
+  });
+}
+
+TEST(FusedKernelTest, LargerThanABlock)
+{
+  checkFusedMatchesUnfused([]{
+    return TANH::create(MINUS::create(TIMES::create(realMatrix(37, 41, 0.1), realMatrix(37, 41, 0.2)),
+                                      complexMatrix(37, 41, 0.3)));
+  });
+}
+
+TEST(FusedKernelTest, SingleNodesNotFused)
+{
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  OGNumeric::Ptr tree = PLUS::create(A, complexMatrix(2, 2, 1.0));
+  ExecutionList el{tree};
+  DependencyGraph graph(el, true);
+  ASSERT_EQ(1, graph.size());
+  EXPECT_EQ(nullptr, graph.getKernel(0));
+  OGNumeric::Ptr product = MTIMES::create(SIN::create(A), COS::create(A));
+  ExecutionList el2{product};
+  DependencyGraph graph2(el2, true);
+  ASSERT_EQ(3, graph2.size());
+  for (size_t i = 0; i < graph2.size(); i++)
+  {
+    EXPECT_EQ(nullptr, graph2.getKernel(i));
+  }
+}
+
+TEST(FusedKernelTest, FallsBackForScalars)
+{
+  // Individually, scalar nodes produce scalars, so these are not fused
+  OGNumeric::Ptr tree = NEGATE::create(PLUS::create(OGRealScalar::create(1.0), OGRealScalar::create(2.0)));
+  ExecutionList el{tree};
+  DependencyGraph graph(el, true);
+  ASSERT_EQ(1, graph.size());
+  ASSERT_NE(nullptr, graph.getKernel(0));
+  EXPECT_FALSE(graph.getKernel(0)->executeFused());
+  Dispatcher disp;
+  graph.dispatch(0, disp);
+  const RegContainer& regs = tree->asOGExpr()->getRegs();
+  ASSERT_EQ(1, regs.size());
+  EXPECT_TRUE(regs[0]->asOGTerminal()->mathsequals(OGRealScalar::create(-3.0)));
+}
+
+TEST(FusedKernelTest, FallsBackForOtherTypes)
+{
+  OGNumeric::Ptr tree = NEGATE::create(PLUS::create(realMatrix(2, 2, 1.0), OGIntegerScalar::create(2)));
+  ExecutionList el{tree};
+  DependencyGraph graph(el, true);
+  ASSERT_NE(nullptr, graph.getKernel(0));
+  EXPECT_FALSE(graph.getKernel(0)->executeFused());
+  Dispatcher disp;
+  graph.dispatch(0, disp);
+  const RegContainer& regs = tree->asOGExpr()->getRegs();
+  ASSERT_EQ(1, regs.size());
+  real8 expected[4] = {-3.0, -3.001, -3.002, -3.003};
+  EXPECT_TRUE(regs[0]->asOGTerminal()->fuzzyequals(OGRealDenseMatrix::create(expected, 2, 2)));
+}
+
+TEST(FusedKernelTest, DimensionMismatchThrows)
+{
+  OGNumeric::Ptr plus = PLUS::create(realMatrix(2, 2, 1.0), realMatrix(2, 3, 1.0));
+  OGNumeric::Ptr tree = NEGATE::create(plus);
+  // Rejected when planned
+  ExecutionList el{tree};
+  EXPECT_THROW(DependencyGraph(el, true), rdag_error);
+  // The fused loop leaves the runner to report it
+  FusedKernel kernel(vector<OGNumeric::Ptr>{plus, tree});
+  EXPECT_FALSE(kernel.executeFused());
+  Dispatcher disp;
+  EXPECT_THROW(kernel.execute(disp), rdag_error);
+}
+
+TEST(FusedKernelTest, ExecuteHonoursOption)
+{
+  bool fusion = ExecutionOptions::getFusion();
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  Dispatcher disp;
+  ExecutionOptions::setFusion(false);
+  EXPECT_FALSE(ExecutionOptions::getFusion());
+  OGNumeric::Ptr tree = PLUS::create(NEGATE::create(A), A);
+  ExecutionList el{tree};
+  execute(el, disp);
+  ExecutionOptions::setFusion(true);
+  EXPECT_TRUE(ExecutionOptions::getFusion());
+  OGNumeric::Ptr tree2 = PLUS::create(NEGATE::create(A), A);
+  ExecutionList el2{tree2};
+  execute(el2, disp);
+  EXPECT_TRUE(tree->asOGExpr()->getRegs()[0]->asOGTerminal()->mathsequals(
+              tree2->asOGExpr()->getRegs()[0]->asOGTerminal()));
+  ExecutionOptions::setFusion(fusion);
+}
+
+TEST(FusedKernelTest, InPlace)
+{
+  OGNumeric::Ptr A = realMatrix(3, 3, 1.0);
+  OGNumeric::Ptr B = realMatrix(3, 3, 2.0);
+  Dispatcher disp;
+  OGNumeric::Ptr reference = EXP::create(NEGATE::create(MTIMES::create(A, B)));
+  ExecutionList el0{reference};
+  executeSerial(el0, disp);
+  OGTerminal::Ptr expected = reference->asOGExpr()->getRegs()[0]->asOGTerminal();
+
+  OGNumeric::Ptr product = MTIMES::create(A, B);
+  OGNumeric::Ptr tree = EXP::create(NEGATE::create(product));
+  ExecutionList el{tree};
+  DependencyGraph graph(el, true);
+  ASSERT_EQ(2, graph.size());
+  graph.dispatch(0, disp);
+  real8 * data = product->asOGExpr()->getRegs()[0]->asOGTerminal()->asOGRealDenseMatrix()->getData();
+
+  // Expiring, and only referenced by its register, so the result takes over its buffer
+  graph.dispatch(1, disp, {product.get()});
+  OGTerminal::Ptr result = tree->asOGExpr()->getRegs()[0]->asOGTerminal();
+  EXPECT_EQ(data, result->asOGRealDenseMatrix()->getData());
+  EXPECT_EQ(OWNER, result->asOGRealDenseMatrix()->getDataAccess());
+  EXPECT_EQ(VIEWER, product->asOGExpr()->getRegs()[0]->asOGTerminal()->asOGRealDenseMatrix()->getDataAccess());
+  EXPECT_TRUE(expected->fuzzyequals(result));
+}
+
+TEST(FusedKernelTest, NotInPlace)
+{
+  OGNumeric::Ptr A = realMatrix(3, 3, 1.0);
+  OGNumeric::Ptr B = realMatrix(3, 3, 2.0);
+  OGNumeric::Ptr product = MTIMES::create(A, B);
+  OGNumeric::Ptr tree = SIN::create(product);
+  ExecutionList el{tree};
+  DependencyGraph graph(el, true);
+  ASSERT_EQ(2, graph.size());
+  Dispatcher disp;
+  graph.dispatch(0, disp);
+  OGTerminal::Ptr intermediate = product->asOGExpr()->getRegs()[0]->asOGTerminal();
+
+  // Not expiring
+  graph.dispatch(1, disp);
+  EXPECT_NE(intermediate->asOGRealDenseMatrix()->getData(),
+            tree->asOGExpr()->getRegs()[0]->asOGTerminal()->asOGRealDenseMatrix()->getData());
+
+  // Expiring, but referenced from elsewhere
+  tree->asOGExpr()->getRegs().clear();
+  graph.dispatch(1, disp, {product.get()});
+  EXPECT_NE(intermediate->asOGRealDenseMatrix()->getData(),
+            tree->asOGExpr()->getRegs()[0]->asOGTerminal()->asOGRealDenseMatrix()->getData());
+  EXPECT_EQ(OWNER, intermediate->asOGRealDenseMatrix()->getDataAccess());
+
+  // Terminals of the tree are never written to
+  OGNumeric::Ptr tree2 = SIN::create(NEGATE::create(A));
+  ExecutionList el2{tree2};
+  DependencyGraph graph2(el2, true);
+  graph2.dispatch(0, disp, {A.get()});
+  EXPECT_NE(A->asOGRealDenseMatrix()->getData(),
+            tree2->asOGExpr()->getRegs()[0]->asOGTerminal()->asOGRealDenseMatrix()->getData());
+}
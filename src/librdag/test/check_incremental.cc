@@ -0,0 +1,144 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include "incremental.hh"
+#include "entrypt.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "exceptions.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+namespace {
+
+OGRealDenseMatrix::Ptr realMatrix(size_t rows, size_t cols, real8 offset)
+{
+  real8 * data = new real8[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = offset + i;
+  }
+  return OGRealDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+} // end anonymous namespace
+
+TEST(IncrementalEvaluatorTest, FirstEvaluationComputesEverything)
+{
+  OGNumeric::Ptr product = MTIMES::create(realMatrix(2, 3, 1.0), realMatrix(3, 2, 2.0));
+  OGNumeric::Ptr tree = PLUS::create(product, NEGATE::create(realMatrix(2, 2, 3.0)));
+  IncrementalEvaluator evaluator(tree);
+  EXPECT_EQ(3, evaluator.getDirtyCount());
+  vector<OGTerminal::Ptr> results = evaluator.evaluate();
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ(0, evaluator.getDirtyCount());
+  // Intermediate results are kept
+  EXPECT_EQ(1, product->asOGExpr()->getRegs().size());
+
+  OGNumeric::Ptr expected = PLUS::create(MTIMES::create(realMatrix(2, 3, 1.0), realMatrix(3, 2, 2.0)),
+                                         NEGATE::create(realMatrix(2, 2, 3.0)));
+  EXPECT_TRUE(results[0]->fuzzyequals(entrypt(expected)));
+
+  // Nothing has changed, so nothing is recomputed
+  const OGNumeric * value = product->asOGExpr()->getRegs()[0].get();
+  EXPECT_TRUE(evaluator.evaluate()[0]->fuzzyequals(results[0]));
+  EXPECT_EQ(value, product->asOGExpr()->getRegs()[0].get());
+}
+
+TEST(IncrementalEvaluatorTest, TransposedRootIsDense)
+{
+  OGNumeric::Ptr tree = TRANSPOSE::create(realMatrix(2, 3, 1.0));
+  IncrementalEvaluator evaluator(tree);
+  vector<OGTerminal::Ptr> results = evaluator.evaluate();
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, results[0]->getType());
+  OGTerminal::Ptr expected = OGRealDenseMatrix::create(new real8[6]{1, 3, 5, 2, 4, 6}, 3, 2, OWNER);
+  EXPECT_TRUE(results[0]->mathsequals(expected));
+  EXPECT_TRUE(evaluator.evaluate()[0]->mathsequals(expected));
+}
+
+TEST(IncrementalEvaluatorTest, ChangedRecomputesCone)
+{
+  OGRealDenseMatrix::Ptr bumped = realMatrix(2, 2, 3.0);
+  OGNumeric::Ptr product = MTIMES::create(realMatrix(2, 3, 1.0), realMatrix(3, 2, 2.0));
+  OGNumeric::Ptr negate = NEGATE::create(bumped);
+  OGNumeric::Ptr tree = PLUS::create(product, negate);
+  IncrementalEvaluator evaluator(tree);
+  evaluator.evaluate();
+  const OGNumeric * value = product->asOGExpr()->getRegs()[0].get();
+
+  bumped->getData()[0] += 0.5;
+  evaluator.changed(bumped);
+  EXPECT_EQ(2, evaluator.getDirtyCount());
+  OGTerminal::Ptr result = evaluator.evaluate()[0];
+  // The product is not downstream of the bump and keeps its value
+  EXPECT_EQ(value, product->asOGExpr()->getRegs()[0].get());
+
+  OGRealDenseMatrix::Ptr expectedBumped = realMatrix(2, 2, 3.0);
+  expectedBumped->getData()[0] += 0.5;
+  OGNumeric::Ptr expected = PLUS::create(MTIMES::create(realMatrix(2, 3, 1.0), realMatrix(3, 2, 2.0)),
+                                         NEGATE::create(expectedBumped));
+  EXPECT_TRUE(result->fuzzyequals(entrypt(expected)));
+}
+
+TEST(IncrementalEvaluatorTest, ReplaceScalar)
+{
+  OGNumeric::Ptr rate = OGRealScalar::create(2.0);
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  OGNumeric::Ptr inverse = INV::create(A);
+  OGNumeric::Ptr scaled = TIMES::create(rate, A);
+  OGNumeric::Ptr tree = PLUS::create(inverse, scaled);
+  // A second tree sharing the unbumped inverse
+  OGNumeric::Ptr other = NEGATE::create(inverse);
+  IncrementalEvaluator evaluator(vector<OGNumeric::Ptr>{tree, other});
+  vector<OGTerminal::Ptr> before = evaluator.evaluate();
+  const OGNumeric * value = inverse->asOGExpr()->getRegs()[0].get();
+
+  OGTerminal::Ptr bumped = OGRealScalar::create(2.5);
+  evaluator.replace(rate->asOGTerminal(), bumped);
+  EXPECT_EQ(2, evaluator.getDirtyCount());
+  EXPECT_NE(tree, evaluator.getRoots()[0]);
+  EXPECT_EQ(other, evaluator.getRoots()[1]);
+  // The replaced nodes no longer hold results
+  EXPECT_EQ(0, scaled->asOGExpr()->getRegs().size());
+
+  vector<OGTerminal::Ptr> after = evaluator.evaluate();
+  EXPECT_EQ(value, inverse->asOGExpr()->getRegs()[0].get());
+  EXPECT_TRUE(after[0]->fuzzyequals(entrypt(PLUS::create(INV::create(realMatrix(2, 2, 1.0)),
+                                                         TIMES::create(bumped, realMatrix(2, 2, 1.0))))));
+  EXPECT_TRUE(after[1]->fuzzyequals(before[1]));
+}
+
+TEST(IncrementalEvaluatorTest, ReplaceRoot)
+{
+  OGTerminal::Ptr scalar = OGRealScalar::create(1.0);
+  IncrementalEvaluator evaluator(scalar);
+  EXPECT_EQ(scalar, evaluator.evaluate()[0]);
+  OGTerminal::Ptr replacement = OGRealScalar::create(2.0);
+  evaluator.replace(scalar, replacement);
+  EXPECT_EQ(replacement, evaluator.evaluate()[0]);
+}
+
+TEST(IncrementalEvaluatorTest, BadChanges)
+{
+  OGTerminal::Ptr A = realMatrix(2, 3, 1.0);
+  OGNumeric::Ptr tree = NEGATE::create(A);
+  IncrementalEvaluator evaluator(tree);
+  OGTerminal::Ptr result = evaluator.evaluate()[0];
+  EXPECT_THROW(evaluator.changed(realMatrix(2, 3, 1.0)), rdag_error);
+  EXPECT_THROW(evaluator.replace(realMatrix(2, 3, 1.0), A), rdag_error);
+  EXPECT_THROW(evaluator.replace(A, OGTerminal::Ptr{}), rdag_error);
+
+  // A replacement whose shape does not conform leaves the evaluator as it was
+  OGNumeric::Ptr product = MTIMES::create(NEGATE::create(A), realMatrix(3, 2, 1.0));
+  IncrementalEvaluator productEvaluator(product);
+  productEvaluator.evaluate();
+  EXPECT_THROW(productEvaluator.replace(A, realMatrix(2, 2, 1.0)), rdag_error);
+  EXPECT_EQ(0, productEvaluator.getDirtyCount());
+  EXPECT_EQ(product, productEvaluator.getRoots()[0]);
+}
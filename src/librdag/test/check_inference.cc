@@ -0,0 +1,215 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include "inference.hh"
+#include "execution.hh"
+#include "executor.hh"
+#include "dispatch.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "exceptions.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+namespace {
+
+OGNumeric::Ptr realMatrix(size_t rows, size_t cols, real8 offset)
+{
+  real8 * data = new real8[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = offset + i;
+  }
+  return OGRealDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+OGNumeric::Ptr complexMatrix(size_t rows, size_t cols, real8 offset)
+{
+  complex16 * data = new complex16[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = complex16(offset + i, offset - i);
+  }
+  return OGComplexDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+/**
+ * Infers the result of a tree, checking it against the result of executing it if the
+ * type is known.
+ */
+ValueInfo inferResult(const OGNumeric::Ptr& tree)
+{
+  ExecutionList el{tree};
+  TypeInference types(el);
+  ValueInfo value = types.getResult(tree);
+  if (value.type != UNKNOWN_EXPR_ENUM && value.shapeKnown)
+  {
+    Dispatcher disp;
+    executeSerial(el, disp);
+    OGTerminal::Ptr actual = tree->asOGExpr()->getRegs()[0]->asOGTerminal();
+    EXPECT_EQ(value.type, actual->getType());
+    EXPECT_EQ(value.rows, actual->getRows());
+    EXPECT_EQ(value.cols, actual->getCols());
+  }
+  return value;
+}
+
+void expectValue(ExprType_t type, size_t rows, size_t cols, const ValueInfo& value)
+{
+  EXPECT_EQ(type, value.type);
+  EXPECT_TRUE(value.shapeKnown);
+  EXPECT_EQ(rows, value.rows);
+  EXPECT_EQ(cols, value.cols);
+}
+
+} // end anonymous namespace
+
+TEST(TypeInferenceTest, Terminals)
+{
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 3, TypeInference::infer(realMatrix(2, 3, 1.0), {})[0]);
+  expectValue(COMPLEX_SCALAR_ENUM, 1, 1, TypeInference::infer(OGComplexScalar::create(complex16(1, 2)), {})[0]);
+  ValueInfo unknown;
+  EXPECT_EQ(UNKNOWN_EXPR_ENUM, unknown.type);
+  EXPECT_FALSE(unknown.shapeKnown);
+  EXPECT_FALSE(unknown.isDense());
+}
+
+TEST(TypeInferenceTest, Elementwise)
+{
+  OGNumeric::Ptr A = realMatrix(2, 3, 1.0);
+  OGNumeric::Ptr s = OGRealScalar::create(2.0);
+  OGNumeric::Ptr z = OGComplexScalar::create(complex16(1, 2));
+
+  // Broadcasting
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 3, inferResult(PLUS::create(A, s)));
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 3, inferResult(TIMES::create(s, A)));
+  expectValue(REAL_SCALAR_ENUM, 1, 1, inferResult(MINUS::create(s, s)));
+  // Scalars of every kind are computed with directly
+  expectValue(COMPLEX_SCALAR_ENUM, 1, 1, inferResult(PLUS::create(z, z)));
+  expectValue(REAL_SCALAR_ENUM, 1, 1, inferResult(RDIVIDE::create(OGIntegerScalar::create(1), s)));
+  expectValue(COMPLEX_DENSE_MATRIX_ENUM, 2, 3, inferResult(MINUS::create(OGIntegerScalar::create(1), complexMatrix(2, 3, 1.0))));
+  // Conversions made by the dispatcher
+  expectValue(COMPLEX_DENSE_MATRIX_ENUM, 2, 3, inferResult(RDIVIDE::create(A, z)));
+  expectValue(COMPLEX_DENSE_MATRIX_ENUM, 1, 1, inferResult(NEGATE::create(z)));
+  expectValue(REAL_SCALAR_ENUM, 1, 1, inferResult(EXP::create(s)));
+  expectValue(COMPLEX_DENSE_MATRIX_ENUM, 2, 3, inferResult(SIN::create(PLUS::create(complexMatrix(2, 3, 1.0), A))));
+  expectValue(REAL_SCALAR_ENUM, 1, 1, inferResult(SIN::create(OGIntegerScalar::create(2))));
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 2,
+              inferResult(COS::create(OGRealDiagonalMatrix::create(new real8[2]{1, 2}, 2, 2, OWNER))));
+
+  EXPECT_THROW(inferResult(PLUS::create(A, realMatrix(3, 2, 1.0))), rdag_error);
+}
+
+TEST(TypeInferenceTest, Products)
+{
+  OGNumeric::Ptr A = realMatrix(2, 3, 1.0);
+  OGNumeric::Ptr B = realMatrix(3, 4, 1.0);
+  OGNumeric::Ptr s = OGRealScalar::create(2.0);
+
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 4, inferResult(MTIMES::create(A, B)));
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 3, inferResult(MTIMES::create(s, A)));
+  expectValue(COMPLEX_DENSE_MATRIX_ENUM, 2, 4, inferResult(MTIMES::create(A, complexMatrix(3, 4, 1.0))));
+  expectValue(REAL_SCALAR_ENUM, 1, 1, inferResult(MTIMES::create(s, s)));
+  expectValue(COMPLEX_SCALAR_ENUM, 1, 1, inferResult(MTIMES::create(OGComplexScalar::create(complex16(1, 2)), s)));
+  EXPECT_THROW(inferResult(MTIMES::create(B, A)), rdag_error);
+
+  expectValue(REAL_DENSE_MATRIX_ENUM, 3, 3, inferResult(MTIMES::create(TRANSPOSE::create(A), A)));
+  expectValue(REAL_DENSE_MATRIX_ENUM, 3, 2, inferResult(MTIMES::create(TRANSPOSE::create(A), s)));
+  EXPECT_THROW(inferResult(MTIMES::create(TRANSPOSE::create(A), B)), rdag_error);
+
+  // The shape of a least squares solution is not inferred
+  OGNumeric::Ptr square = realMatrix(3, 3, 1.0);
+  expectValue(REAL_DENSE_MATRIX_ENUM, 3, 4, inferResult(MLDIVIDE::create(square, B)));
+  ValueInfo solution = inferResult(MLDIVIDE::create(TRANSPOSE::create(A), B));
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, solution.type);
+  EXPECT_FALSE(solution.shapeKnown);
+  EXPECT_THROW(inferResult(MLDIVIDE::create(A, B)), rdag_unrecoverable_error);
+}
+
+TEST(TypeInferenceTest, SinglePrecision)
+{
+  OGNumeric::Ptr A = OGRealSingleDenseMatrix::create({{4.f,1.f},{1.f,3.f}});
+  OGNumeric::Ptr Z = OGComplexSingleDenseMatrix::create({{{1.f,2.f},{3.f,4.f}},{{5.f,6.f},{7.f,8.f}}});
+
+  // Elementwise operations and products of like single precision arguments stay single
+  expectValue(REAL_SINGLE_DENSE_MATRIX_ENUM, 2, 2, inferResult(PLUS::create(A, A)));
+  expectValue(REAL_SINGLE_DENSE_MATRIX_ENUM, 2, 2, inferResult(TIMES::create(A, A)));
+  expectValue(REAL_SINGLE_DENSE_MATRIX_ENUM, 2, 2, inferResult(MTIMES::create(A, A)));
+  expectValue(COMPLEX_SINGLE_DENSE_MATRIX_ENUM, 2, 2, inferResult(MINUS::create(Z, Z)));
+  expectValue(COMPLEX_SINGLE_DENSE_MATRIX_ENUM, 2, 2, inferResult(MTIMES::create(Z, Z)));
+
+  // Everything else is widened to double precision
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 2, inferResult(PLUS::create(A, realMatrix(2, 2, 1.0))));
+  expectValue(COMPLEX_DENSE_MATRIX_ENUM, 2, 2, inferResult(MTIMES::create(A, Z)));
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 2, inferResult(MLDIVIDE::create(A, A)));
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 2, inferResult(SIN::create(A)));
+}
+
+TEST(TypeInferenceTest, MatrixFunctions)
+{
+  OGNumeric::Ptr A = realMatrix(2, 3, 1.0);
+
+  expectValue(REAL_TRANSPOSED_MATRIX_ENUM, 3, 2, inferResult(TRANSPOSE::create(A)));
+  expectValue(COMPLEX_TRANSPOSED_MATRIX_ENUM, 3, 2, inferResult(CTRANSPOSE::create(complexMatrix(2, 3, 1.0))));
+  expectValue(REAL_SCALAR_ENUM, 1, 1, inferResult(TRANSPOSE::create(realMatrix(1, 1, 1.0))));
+  expectValue(COMPLEX_SCALAR_ENUM, 1, 1, inferResult(CTRANSPOSE::create(complexMatrix(1, 1, 1.0))));
+  expectValue(REAL_DENSE_MATRIX_ENUM, 3, 2, inferResult(PINV::create(A)));
+  expectValue(REAL_SCALAR_ENUM, 1, 1, inferResult(NORM2::create(complexMatrix(2, 2, 1.0))));
+  expectValue(COMPLEX_DENSE_MATRIX_ENUM, 2, 2, inferResult(INV::create(complexMatrix(2, 2, 1.0))));
+  EXPECT_THROW(inferResult(INV::create(A)), rdag_error);
+
+  // The inverse of a complex scalar is real if it is zero
+  ValueInfo inverse = inferResult(INV::create(complexMatrix(1, 1, 1.0)));
+  EXPECT_EQ(UNKNOWN_EXPR_ENUM, inverse.type);
+  EXPECT_TRUE(inverse.shapeKnown);
+}
+
+TEST(TypeInferenceTest, Decompositions)
+{
+  OGNumeric::Ptr A = realMatrix(2, 3, 1.0);
+  OGNumeric::Ptr svd = SVD::create(A);
+  vector<ValueInfo> results = TypeInference::infer(svd, {{ValueInfo(REAL_DENSE_MATRIX_ENUM, 2, 3)}});
+  ASSERT_EQ(3, results.size());
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 2, results[0]);
+  expectValue(REAL_DIAGONAL_MATRIX_ENUM, 2, 3, results[1]);
+  expectValue(REAL_DENSE_MATRIX_ENUM, 3, 3, results[2]);
+
+  expectValue(REAL_DIAGONAL_MATRIX_ENUM, 2, 3, inferResult(SELECTRESULT::create(svd, OGIntegerScalar::create(1))));
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 2, inferResult(SELECTRESULT::create(LU::create(A), OGIntegerScalar::create(0))));
+  expectValue(COMPLEX_DENSE_MATRIX_ENUM, 2, 3,
+              inferResult(SELECTRESULT::create(LU::create(complexMatrix(2, 3, 1.0)), OGIntegerScalar::create(1))));
+  EXPECT_THROW(inferResult(SELECTRESULT::create(svd, OGIntegerScalar::create(3))), rdag_error);
+  EXPECT_THROW(inferResult(SELECTRESULT::create(LU::create(A), OGIntegerScalar::create(-1))), rdag_error);
+}
+
+TEST(TypeInferenceTest, UnknownPropagates)
+{
+  // ABS has no runner, so nothing is known downstream of it
+  OGNumeric::Ptr A = realMatrix(2, 3, 1.0);
+  OGNumeric::Ptr tree = MTIMES::create(NEGATE::create(ABS::create(A)), realMatrix(4, 4, 1.0));
+  ExecutionList el{tree};
+  TypeInference types(el);
+  EXPECT_EQ(UNKNOWN_EXPR_ENUM, types.getResult(tree).type);
+  EXPECT_FALSE(types.getResult(tree).shapeKnown);
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 3, types.getResult(A));
+  EXPECT_THROW(types.getResult(realMatrix(1, 1, 1.0)), rdag_error);
+}
+
+TEST(TypeInferenceTest, RejectedBeforeExecution)
+{
+  // An expensive node that would be run before the bad one
+  OGNumeric::Ptr product = MTIMES::create(realMatrix(50, 50, 1.0), realMatrix(50, 50, 2.0));
+  OGNumeric::Ptr bad = MTIMES::create(realMatrix(2, 1, 1.0), realMatrix(2, 1, 1.0));
+  OGNumeric::Ptr tree = PLUS::create(NEGATE::create(product), NORM2::create(bad));
+  Dispatcher disp;
+  ExecutionList el{tree};
+  EXPECT_THROW(execute(el, disp), rdag_error);
+  EXPECT_EQ(0, product->asOGExpr()->getRegs().size());
+  EXPECT_THROW(executeSerial(el, disp), rdag_error);
+  EXPECT_EQ(0, product->asOGExpr()->getRegs().size());
+}
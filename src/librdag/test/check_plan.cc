@@ -0,0 +1,397 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include "plan.hh"
+#include "execution.hh"
+#include "executor.hh"
+#include "dispatch.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "threadpool.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+namespace {
+
+OGNumeric::Ptr realMatrix(size_t rows, size_t cols, real8 offset)
+{
+  real8 * data = new real8[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = offset + i;
+  }
+  return OGRealDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+OGNumeric::Ptr complexMatrix(size_t rows, size_t cols, real8 offset)
+{
+  complex16 * data = new complex16[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = complex16(offset + i, offset - i);
+  }
+  return OGComplexDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+// exp(-(A*B)) + A, a GEMM feeding a fused kernel
+OGNumeric::Ptr buildTree(const OGNumeric::Ptr& A, const OGNumeric::Ptr& B)
+{
+  return PLUS::create(EXP::create(NEGATE::create(MTIMES::create(A, B))), A);
+}
+
+bool keysEqual(const OGNumeric::Ptr& tree1, const OGNumeric::Ptr& tree2, bool fuse = true)
+{
+  ExecutionList el1{tree1};
+  ExecutionList el2{tree2};
+  return PlanKey(el1, fuse) == PlanKey(el2, fuse);
+}
+
+/**
+ * Restores the cache settings and empties the cache around each test.
+ */
+class PlanCacheTest: public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+      _enabled = PlanCache::getEnabled();
+      _capacity = PlanCache::getCapacity();
+      PlanCache::setEnabled(true);
+      PlanCache::clear();
+    }
+    virtual void TearDown()
+    {
+      PlanCache::setEnabled(_enabled);
+      PlanCache::setCapacity(_capacity);
+      PlanCache::clear();
+    }
+  private:
+    bool _enabled;
+    size_t _capacity;
+};
+
+} // end anonymous namespace
+
+TEST(PlanKeyTest, SameStructureDifferentData)
+{
+  OGNumeric::Ptr tree1 = buildTree(realMatrix(2, 2, 1.0), realMatrix(2, 2, 2.0));
+  OGNumeric::Ptr tree2 = buildTree(realMatrix(2, 2, 5.0), realMatrix(2, 2, 7.0));
+  ExecutionList el1{tree1};
+  ExecutionList el2{tree2};
+  PlanKey key1(el1, true);
+  PlanKey key2(el2, true);
+  EXPECT_TRUE(key1 == key2);
+  EXPECT_EQ(key1.getHash(), key2.getHash());
+}
+
+TEST(PlanKeyTest, Differences)
+{
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  OGNumeric::Ptr B = realMatrix(2, 2, 2.0);
+  OGNumeric::Ptr tree = buildTree(A, B);
+
+  // Fusion
+  ExecutionList el{tree};
+  EXPECT_FALSE(PlanKey(el, true) == PlanKey(el, false));
+
+  // Shape
+  EXPECT_FALSE(keysEqual(tree, buildTree(realMatrix(3, 3, 1.0), realMatrix(3, 3, 2.0))));
+  EXPECT_FALSE(keysEqual(PLUS::create(A, B), PLUS::create(A, realMatrix(4, 1, 2.0))));
+
+  // Type of a terminal
+  EXPECT_FALSE(keysEqual(tree, buildTree(complexMatrix(2, 2, 1.0), realMatrix(2, 2, 2.0))));
+
+  // Type of an expression
+  EXPECT_FALSE(keysEqual(SIN::create(A), COS::create(A)));
+
+  // Argument order
+  EXPECT_FALSE(keysEqual(MTIMES::create(A, realMatrix(2, 3, 1.0)), MTIMES::create(realMatrix(2, 3, 1.0), A)));
+
+  // Sharing: A+A uses one terminal twice, A+B two distinct terminals
+  EXPECT_FALSE(keysEqual(PLUS::create(A, A), PLUS::create(A, B)));
+  OGNumeric::Ptr neg = NEGATE::create(A);
+  EXPECT_FALSE(keysEqual(PLUS::create(neg, neg), PLUS::create(NEGATE::create(A), NEGATE::create(A))));
+
+  // Selected result
+  EXPECT_FALSE(keysEqual(SELECTRESULT::create(SVD::create(A), OGIntegerScalar::create(0)),
+                         SELECTRESULT::create(SVD::create(A), OGIntegerScalar::create(1))));
+}
+
+TEST(ExecutionPlanTest, Structure)
+{
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  OGNumeric::Ptr B = realMatrix(2, 2, 2.0);
+  OGNumeric::Ptr product = MTIMES::create(A, B);
+  OGNumeric::Ptr tree = PLUS::create(EXP::create(NEGATE::create(product)), A);
+  ExecutionList el{tree};
+  ExecutionPlan::Ptr plan = ExecutionPlan::create(el, true);
+  ASSERT_EQ(2, plan->size());
+  EXPECT_EQ(product, el[plan->getPosition(0)]);
+  EXPECT_EQ(tree, el[plan->getPosition(1)]);
+  EXPECT_EQ(nullptr, plan->getKernel(0));
+  const ExecutionPlan::Kernel * kernel = plan->getKernel(1);
+  ASSERT_NE(nullptr, kernel);
+  EXPECT_EQ(3, kernel->members.size());
+  EXPECT_EQ(3, kernel->code.size());
+  EXPECT_EQ(plan->getPosition(1), kernel->members.back());
+  ASSERT_EQ(2, kernel->leaves.size());
+  EXPECT_EQ(product, el[kernel->leaves[0]]);
+  EXPECT_EQ(A, el[kernel->leaves[1]]);
+  EXPECT_EQ(1, plan->getDependencyCount(1));
+  EXPECT_TRUE(plan->isSequential());
+
+  ExecutionPlan::Ptr unfused = ExecutionPlan::create(el, false);
+  EXPECT_EQ(4, unfused->size());
+  for (size_t i = 0; i < unfused->size(); i++)
+  {
+    EXPECT_EQ(nullptr, unfused->getKernel(i));
+  }
+}
+
+TEST_F(PlanCacheTest, HitsAndMisses)
+{
+  EXPECT_EQ(0, PlanCache::size());
+  ExecutionList el1{buildTree(realMatrix(2, 2, 1.0), realMatrix(2, 2, 2.0))};
+  ExecutionPlan::Ptr plan1 = PlanCache::getPlan(el1, true);
+  EXPECT_EQ(0, PlanCache::getHits());
+  EXPECT_EQ(1, PlanCache::getMisses());
+  EXPECT_EQ(1, PlanCache::size());
+
+  ExecutionList el2{buildTree(realMatrix(2, 2, 3.0), realMatrix(2, 2, 4.0))};
+  ExecutionPlan::Ptr plan2 = PlanCache::getPlan(el2, true);
+  EXPECT_EQ(plan1, plan2);
+  EXPECT_EQ(1, PlanCache::getHits());
+  EXPECT_EQ(1, PlanCache::getMisses());
+
+  // A different shape or fusion setting is a different plan
+  ExecutionList el3{buildTree(realMatrix(3, 3, 1.0), realMatrix(3, 3, 2.0))};
+  EXPECT_NE(plan1, PlanCache::getPlan(el3, true));
+  EXPECT_NE(plan1, PlanCache::getPlan(el1, false));
+  EXPECT_EQ(1, PlanCache::getHits());
+  EXPECT_EQ(3, PlanCache::getMisses());
+  EXPECT_EQ(3, PlanCache::size());
+
+  PlanCache::clear();
+  EXPECT_EQ(0, PlanCache::size());
+  EXPECT_EQ(0, PlanCache::getHits());
+  EXPECT_EQ(0, PlanCache::getMisses());
+}
+
+TEST_F(PlanCacheTest, Eviction)
+{
+  PlanCache::setCapacity(2);
+  EXPECT_EQ(2, PlanCache::getCapacity());
+  ExecutionList el1{SIN::create(realMatrix(1, 1, 1.0))};
+  ExecutionList el2{SIN::create(realMatrix(2, 2, 1.0))};
+  ExecutionList el3{SIN::create(realMatrix(3, 3, 1.0))};
+  ExecutionPlan::Ptr plan1 = PlanCache::getPlan(el1, true);
+  PlanCache::getPlan(el2, true);
+  // Using plan 1 makes plan 2 the least recently used
+  EXPECT_EQ(plan1, PlanCache::getPlan(el1, true));
+  PlanCache::getPlan(el3, true);
+  EXPECT_EQ(2, PlanCache::size());
+  EXPECT_EQ(3, PlanCache::getMisses());
+  EXPECT_EQ(plan1, PlanCache::getPlan(el1, true));
+  EXPECT_EQ(3, PlanCache::getMisses());
+  PlanCache::getPlan(el2, true);
+  EXPECT_EQ(4, PlanCache::getMisses());
+
+  // Shrinking the cache evicts plans
+  PlanCache::setCapacity(1);
+  EXPECT_EQ(1, PlanCache::size());
+  PlanCache::setCapacity(0);
+  EXPECT_EQ(0, PlanCache::size());
+  PlanCache::getPlan(el1, true);
+  EXPECT_EQ(0, PlanCache::size());
+}
+
+TEST_F(PlanCacheTest, Disabled)
+{
+  ExecutionList el{SIN::create(realMatrix(2, 2, 1.0))};
+  PlanCache::getPlan(el, true);
+  EXPECT_EQ(1, PlanCache::size());
+  PlanCache::setEnabled(false);
+  EXPECT_FALSE(PlanCache::getEnabled());
+  EXPECT_EQ(0, PlanCache::size());
+  ExecutionPlan::Ptr plan1 = PlanCache::getPlan(el, true);
+  ExecutionPlan::Ptr plan2 = PlanCache::getPlan(el, true);
+  EXPECT_NE(plan1, plan2);
+  EXPECT_EQ(0, PlanCache::size());
+  EXPECT_EQ(1, PlanCache::getMisses());
+  PlanCache::setEnabled(true);
+  EXPECT_TRUE(PlanCache::getEnabled());
+}
+
+TEST_F(PlanCacheTest, CachedPlanExecutesWithNewData)
+{
+  Dispatcher disp;
+  for (int i = 0; i < 3; i++)
+  {
+    OGNumeric::Ptr A = realMatrix(3, 3, 0.1 * i);
+    OGNumeric::Ptr B = realMatrix(3, 3, -0.2 * i);
+    OGNumeric::Ptr reference = buildTree(A, B);
+    ExecutionList el0{reference};
+    executeSerial(el0, disp);
+    OGTerminal::Ptr expected = reference->asOGExpr()->getRegs()[0]->asOGTerminal();
+
+    OGNumeric::Ptr tree = buildTree(A, B);
+    ExecutionList el{tree};
+    execute(el, disp);
+    OGTerminal::Ptr actual = tree->asOGExpr()->getRegs()[0]->asOGTerminal();
+    EXPECT_TRUE(expected->fuzzyequals(actual));
+  }
+  EXPECT_EQ(1, PlanCache::size());
+  EXPECT_EQ(2, PlanCache::getHits());
+}
+
+TEST_F(PlanCacheTest, BoundGraphComputesInPlace)
+{
+  Dispatcher disp;
+  OGNumeric::Ptr A = realMatrix(3, 3, 1.0);
+  OGNumeric::Ptr B = realMatrix(3, 3, 2.0);
+  ExecutionList el1{EXP::create(NEGATE::create(MTIMES::create(A, B)))};
+  ExecutionPlan::Ptr plan = PlanCache::getPlan(el1, true);
+
+  OGNumeric::Ptr product = MTIMES::create(B, A);
+  OGNumeric::Ptr tree = EXP::create(NEGATE::create(product));
+  ExecutionList el2{tree};
+  ExecutionPlan::Ptr cached = PlanCache::getPlan(el2, true);
+  EXPECT_EQ(plan, cached);
+  DependencyGraph graph(el2, cached);
+  ASSERT_EQ(2, graph.size());
+  EXPECT_EQ(product, graph.getNode(0));
+  EXPECT_EQ(tree, graph.getNode(1));
+  ASSERT_NE(nullptr, graph.getKernel(1));
+  EXPECT_EQ(tree, graph.getKernel(1)->getRoot());
+  ASSERT_EQ(1, graph.getKernel(1)->getLeaves().size());
+  EXPECT_EQ(product, graph.getKernel(1)->getLeaves()[0]);
+
+  graph.dispatch(0, disp);
+  real8 * data = product->asOGExpr()->getRegs()[0]->asOGTerminal()->asOGRealDenseMatrix()->getData();
+  graph.dispatch(1, disp, {product.get()});
+  EXPECT_EQ(data, tree->asOGExpr()->getRegs()[0]->asOGTerminal()->asOGRealDenseMatrix()->getData());
+}
+
+TEST(ExecutionPlanTest, RootsAreResults)
+{
+  // The first tree is fusible into the second, but is a result in its own right
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  OGNumeric::Ptr negate = NEGATE::create(A);
+  OGNumeric::Ptr tree = EXP::create(negate);
+  ExecutionList el{vector<OGNumeric::Ptr>{negate, tree}};
+  ExecutionPlan::Ptr plan = ExecutionPlan::create(el, true);
+  ASSERT_EQ(2, plan->size());
+  EXPECT_EQ(negate, el[plan->getPosition(0)]);
+  EXPECT_TRUE(plan->isResult(0));
+  EXPECT_TRUE(plan->isResult(1));
+  // Which leaves the second on its own, so not a kernel
+  EXPECT_EQ(nullptr, plan->getKernel(1));
+
+  // Alone, it is fused
+  ExecutionList el2{tree};
+  ExecutionPlan::Ptr plan2 = ExecutionPlan::create(el2, true);
+  ASSERT_EQ(1, plan2->size());
+  EXPECT_TRUE(plan2->isResult(0));
+
+  // The same nodes with different roots have different plans
+  EXPECT_FALSE(PlanKey(el, true) == PlanKey(el2, true));
+}
+
+TEST(ExecutionPlanTest, ArenaSharedAlongChain)
+{
+  // exp(-A) and sin(-(exp(-A)*B)) are intermediates. The first is consumed before the
+  // second is computed, so they share space.
+  OGNumeric::Ptr A = realMatrix(4, 4, 1.0);
+  OGNumeric::Ptr B = realMatrix(4, 4, 2.0);
+  OGNumeric::Ptr first = EXP::create(NEGATE::create(A));
+  OGNumeric::Ptr second = SIN::create(NEGATE::create(MTIMES::create(first, B)));
+  OGNumeric::Ptr tree = MTIMES::create(second, B);
+  ExecutionList el{tree};
+  ExecutionPlan::Ptr plan = ExecutionPlan::create(el, true);
+  ASSERT_EQ(4, plan->size());
+  EXPECT_EQ(16 * sizeof(real8), plan->getArenaSize());
+  size_t offset = 1, bytes = 0;
+  ASSERT_TRUE(plan->getArenaSlot(0, offset, bytes));
+  EXPECT_EQ(0, offset);
+  EXPECT_EQ(16 * sizeof(real8), bytes);
+  EXPECT_FALSE(plan->getArenaSlot(1, offset, bytes));
+  ASSERT_TRUE(plan->getArenaSlot(2, offset, bytes));
+  EXPECT_EQ(0, offset);
+  EXPECT_FALSE(plan->getArenaSlot(3, offset, bytes));
+
+  // The kernel computes into the arena, and what refers to it goes with the graph
+  Dispatcher disp;
+  {
+    DependencyGraph graph(el, plan);
+    graph.dispatch(0, disp);
+    const RegContainer& regs = first->asOGExpr()->getRegs();
+    ASSERT_EQ(1, regs.size());
+    EXPECT_EQ(VIEWER, regs[0]->asOGTerminal()->asOGRealDenseMatrix()->getDataAccess());
+  }
+  EXPECT_EQ(0, first->asOGExpr()->getRegs().size());
+
+  // Nothing is placed in the arena without fusion
+  EXPECT_EQ(0, ExecutionPlan::create(el, false)->getArenaSize());
+}
+
+TEST(ExecutionPlanTest, ArenaNotSharedAcrossBranches)
+{
+  // The branches may run concurrently, so their intermediates must not share space.
+  // Space is rounded up to a cache line.
+  OGNumeric::Ptr A = complexMatrix(3, 1, 1.0);
+  OGNumeric::Ptr B = complexMatrix(1, 3, 2.0);
+  OGNumeric::Ptr left = MTIMES::create(EXP::create(NEGATE::create(A)), B);
+  OGNumeric::Ptr right = MTIMES::create(SIN::create(NEGATE::create(A)), B);
+  OGNumeric::Ptr tree = PLUS::create(left, right);
+  ExecutionList el{tree};
+  ExecutionPlan::Ptr plan = ExecutionPlan::create(el, true);
+  ASSERT_EQ(5, plan->size());
+  EXPECT_EQ(128, plan->getArenaSize());
+  size_t offset0 = 0, offset1 = 0, bytes = 0;
+  ASSERT_TRUE(plan->getArenaSlot(0, offset0, bytes));
+  EXPECT_EQ(64, bytes);
+  ASSERT_TRUE(plan->getArenaSlot(2, offset1, bytes));
+  EXPECT_NE(offset0, offset1);
+}
+
+TEST(ExecutionPlanTest, ArenaExecution)
+{
+  auto build = []()
+  {
+    OGNumeric::Ptr A = realMatrix(4, 4, 1.0);
+    OGNumeric::Ptr B = realMatrix(4, 4, 2.0);
+    OGNumeric::Ptr shared = EXP::create(NEGATE::create(MTIMES::create(A, B)));
+    OGNumeric::Ptr left = MTIMES::create(SIN::create(shared), B);
+    OGNumeric::Ptr right = MTIMES::create(A, COS::create(shared));
+    return PLUS::create(MTIMES::create(TANH::create(left), right), A);
+  };
+  Dispatcher disp;
+  OGNumeric::Ptr reference = build();
+  ExecutionList el1{reference};
+  executeSerial(el1, disp);
+  OGTerminal::Ptr expected = reference->asOGExpr()->getRegs()[0]->asOGTerminal();
+
+  OGNumeric::Ptr tree = build();
+  ExecutionList el2{tree};
+  ExecutionPlan::Ptr plan = ExecutionPlan::create(el2, true);
+  EXPECT_NE(0, plan->getArenaSize());
+  ThreadPool pool(4);
+  executeParallel(el2, disp, pool);
+  const RegContainer& regs = tree->asOGExpr()->getRegs();
+  ASSERT_EQ(1, regs.size());
+  EXPECT_TRUE(expected->fuzzyequals(regs[0]->asOGTerminal()));
+  // The result is not in the arena, and nothing else refers to it
+  EXPECT_EQ(OWNER, regs[0]->asOGTerminal()->asOGRealDenseMatrix()->getDataAccess());
+  for (auto it = el2.begin(); it != el2.end(); ++it)
+  {
+    if ((*it)->asOGExpr() != OGExpr::Ptr{} && *it != tree)
+    {
+      EXPECT_EQ(0, (*it)->asOGExpr()->getRegs().size());
+    }
+  }
+}
@@ -0,0 +1,362 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include "rewrite.hh"
+#include "entrypt.hh"
+#include "dispatch.hh"
+#include "execution.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+namespace {
+
+OGNumeric::Ptr realMatrix(size_t rows, size_t cols, real8 offset)
+{
+  real8 * data = new real8[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = offset + i * i;
+  }
+  return OGRealDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+OGNumeric::Ptr complexMatrix(size_t rows, size_t cols, real8 offset)
+{
+  complex16 * data = new complex16[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = complex16(offset + i * i, offset - i);
+  }
+  return OGComplexDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+OGTerminal::Ptr evaluate(const OGNumeric::Ptr& tree)
+{
+  OGTerminal::Ptr term = tree->asOGTerminal();
+  if (term != OGTerminal::Ptr{})
+  {
+    return term;
+  }
+  Dispatcher disp;
+  ExecutionList el{tree};
+  for (auto it = el.begin(); it != el.end(); ++it)
+  {
+    disp.dispatch(*it);
+  }
+  // As entrypt does, so a transposed view compares equal to the matrix it stands for
+  return materialiseView(tree->asOGExpr()->getRegs()[0]->asOGTerminal());
+}
+
+/**
+ * Rewrites a tree, checking the rewritten tree computes the same value.
+ */
+OGNumeric::Ptr checkRewrite(const OGNumeric::Ptr& tree)
+{
+  OGNumeric::Ptr rewritten = Rewriter().rewrite(tree);
+  OGTerminal::Ptr expected = evaluate(tree->copy());
+  OGTerminal::Ptr actual = evaluate(rewritten);
+  // A solve and a multiplication by the inverse round differently
+  EXPECT_TRUE(expected->fuzzyequals(actual, 1e-10, 1e-10));
+  return rewritten;
+}
+
+/**
+ * Replaces SIN(x) by COS(x), to check user rules are applied.
+ */
+class SinToCosRule: public RewriteRule
+{
+  public:
+    virtual const char * getName() const override
+    {
+      return "SinToCos";
+    }
+    virtual OGNumeric::Ptr apply(const OGExpr::Ptr& node, const RewriteContext&) const override
+    {
+      if (node->getType() != SIN_ENUM)
+      {
+        return OGNumeric::Ptr{};
+      }
+      return COS::create(node->getArgs()[0]);
+    }
+};
+
+} // end anonymous namespace
+
+TEST(RewriteTest, NothingToDo)
+{
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  EXPECT_EQ(A, Rewriter().rewrite(A));
+  OGNumeric::Ptr tree = PLUS::create(TRANSPOSE::create(A), NEGATE::create(A));
+  EXPECT_EQ(tree, Rewriter().rewrite(tree));
+}
+
+TEST(RewriteTest, DoubleTranspose)
+{
+  OGNumeric::Ptr A = realMatrix(2, 3, 1.0);
+  EXPECT_EQ(A, checkRewrite(TRANSPOSE::create(TRANSPOSE::create(A))));
+  OGNumeric::Ptr C = complexMatrix(2, 3, 1.0);
+  EXPECT_EQ(C, checkRewrite(CTRANSPOSE::create(CTRANSPOSE::create(C))));
+  // Four transposes cancel, three leave one
+  EXPECT_EQ(A, checkRewrite(TRANSPOSE::create(TRANSPOSE::create(TRANSPOSE::create(TRANSPOSE::create(A))))));
+  OGNumeric::Ptr three = checkRewrite(TRANSPOSE::create(TRANSPOSE::create(TRANSPOSE::create(A))));
+  ASSERT_EQ(TRANSPOSE_ENUM, three->getType());
+  EXPECT_EQ(A, three->asOGExpr()->getArgs()[0]);
+  // The transpose of a conjugate transpose is a conjugate
+  OGNumeric::Ptr mixed = TRANSPOSE::create(CTRANSPOSE::create(C));
+  EXPECT_EQ(mixed, checkRewrite(mixed));
+  // Expressions with dense values cancel too
+  OGNumeric::Ptr product = MTIMES::create(A, TRANSPOSE::create(A));
+  EXPECT_EQ(product, checkRewrite(TRANSPOSE::create(TRANSPOSE::create(product))));
+
+  // Transposing a logical matrix gives a real dense matrix, and a 1x1 matrix a scalar
+  OGNumeric::Ptr tree = TRANSPOSE::create(TRANSPOSE::create(
+                          OGLogicalMatrix::create(new real8[2]{1.0, 0.0}, 2, 1, OWNER)));
+  EXPECT_EQ(tree, checkRewrite(tree));
+  tree = TRANSPOSE::create(TRANSPOSE::create(realMatrix(1, 1, 2.0)));
+  EXPECT_EQ(tree, checkRewrite(tree));
+}
+
+TEST(RewriteTest, DoubleNegate)
+{
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  OGNumeric::Ptr B = realMatrix(2, 2, 3.0);
+  OGNumeric::Ptr rewritten = checkRewrite(PLUS::create(NEGATE::create(NEGATE::create(A)), B));
+  ASSERT_EQ(PLUS_ENUM, rewritten->getType());
+  EXPECT_EQ(A, rewritten->asOGExpr()->getArgs()[0]);
+  EXPECT_EQ(B, rewritten->asOGExpr()->getArgs()[1]);
+  OGNumeric::Ptr product = MTIMES::create(A, B);
+  EXPECT_EQ(product, checkRewrite(NEGATE::create(NEGATE::create(product))));
+
+  // Negating an integer scalar, or a 1x1 matrix, gives a real scalar
+  OGNumeric::Ptr tree = NEGATE::create(NEGATE::create(OGIntegerScalar::create(3)));
+  EXPECT_EQ(tree, checkRewrite(tree));
+  tree = NEGATE::create(NEGATE::create(realMatrix(1, 1, 2.0)));
+  EXPECT_EQ(tree, checkRewrite(tree));
+}
+
+TEST(RewriteTest, RealCTranspose)
+{
+  OGNumeric::Ptr A = realMatrix(2, 3, 1.0);
+  OGNumeric::Ptr rewritten = checkRewrite(CTRANSPOSE::create(A));
+  ASSERT_EQ(TRANSPOSE_ENUM, rewritten->getType());
+  EXPECT_EQ(A, rewritten->asOGExpr()->getArgs()[0]);
+
+  // Realness is followed through the tree
+  rewritten = checkRewrite(CTRANSPOSE::create(EXP::create(MTIMES::create(A, TRANSPOSE::create(A)))));
+  EXPECT_EQ(TRANSPOSE_ENUM, rewritten->getType());
+
+  // Complex values are left alone
+  OGNumeric::Ptr C = complexMatrix(2, 3, 1.0);
+  OGNumeric::Ptr tree = CTRANSPOSE::create(C);
+  EXPECT_EQ(tree, checkRewrite(tree));
+  tree = CTRANSPOSE::create(PLUS::create(A, C));
+  EXPECT_EQ(tree, checkRewrite(tree));
+}
+
+TEST(RewriteTest, InverseTimes)
+{
+  OGNumeric::Ptr A = realMatrix(3, 3, 1.0);
+  OGNumeric::Ptr B = realMatrix(3, 2, 2.0);
+  OGNumeric::Ptr rewritten = checkRewrite(MTIMES::create(INV::create(A), B));
+  ASSERT_EQ(MLDIVIDE_ENUM, rewritten->getType());
+  EXPECT_EQ(A, rewritten->asOGExpr()->getArgs()[0]);
+  EXPECT_EQ(B, rewritten->asOGExpr()->getArgs()[1]);
+
+  // Shapes are followed through the tree
+  rewritten = checkRewrite(MTIMES::create(INV::create(PLUS::create(A, OGRealScalar::create(1.0))),
+                                          MTIMES::create(A, B)));
+  EXPECT_EQ(MLDIVIDE_ENUM, rewritten->getType());
+
+  // The product broadcasts a scalar, the solve would not
+  OGNumeric::Ptr tree = MTIMES::create(INV::create(A), OGRealScalar::create(2.0));
+  EXPECT_EQ(tree, checkRewrite(tree));
+  // The shape of a PINV is not that of a square matrix
+  tree = MTIMES::create(INV::create(PINV::create(realMatrix(3, 2, 1.0))), realMatrix(2, 2, 1.0));
+  EXPECT_EQ(tree, Rewriter().rewrite(tree));
+  // The shape of a SELECTRESULT is that of the result selected
+  rewritten = checkRewrite(MTIMES::create(INV::create(SELECTRESULT::create(SVD::create(A),
+                                                                           OGIntegerScalar::create(0))), B));
+  EXPECT_EQ(MLDIVIDE_ENUM, rewritten->getType());
+  // An inverse used elsewhere is formed anyway
+  OGNumeric::Ptr inverse = INV::create(A);
+  tree = PLUS::create(MTIMES::create(inverse, B), MTIMES::create(inverse, B));
+  rewritten = checkRewrite(tree);
+  ASSERT_EQ(PLUS_ENUM, rewritten->getType());
+  EXPECT_EQ(MTIMES_ENUM, rewritten->asOGExpr()->getArgs()[0]->getType());
+}
+
+TEST(RewriteTest, MatrixChainVectorAtEnd)
+{
+  OGNumeric::Ptr A = realMatrix(4, 4, 1.0);
+  OGNumeric::Ptr B = realMatrix(4, 4, 2.0);
+  OGNumeric::Ptr x = realMatrix(4, 1, 3.0);
+  // (A*B)*x is A*(B*x), two matrix-vector products
+  OGNumeric::Ptr rewritten = checkRewrite(MTIMES::create(MTIMES::create(A, B), x));
+  ASSERT_EQ(MTIMES_ENUM, rewritten->getType());
+  const ArgContainer& args = rewritten->asOGExpr()->getArgs();
+  EXPECT_EQ(A, args[0]);
+  ASSERT_EQ(MTIMES_ENUM, args[1]->getType());
+  EXPECT_EQ(B, args[1]->asOGExpr()->getArgs()[0]);
+  EXPECT_EQ(x, args[1]->asOGExpr()->getArgs()[1]);
+
+  // y*(A*B) is (y*A)*B
+  OGNumeric::Ptr y = realMatrix(1, 4, 3.0);
+  rewritten = checkRewrite(MTIMES::create(y, MTIMES::create(A, B)));
+  ASSERT_EQ(MTIMES_ENUM, rewritten->getType());
+  const ArgContainer& args2 = rewritten->asOGExpr()->getArgs();
+  ASSERT_EQ(MTIMES_ENUM, args2[0]->getType());
+  EXPECT_EQ(y, args2[0]->asOGExpr()->getArgs()[0]);
+  EXPECT_EQ(A, args2[0]->asOGExpr()->getArgs()[1]);
+  EXPECT_EQ(B, args2[1]);
+
+  // Already the best order
+  OGNumeric::Ptr tree = MTIMES::create(A, MTIMES::create(B, x));
+  EXPECT_EQ(tree, checkRewrite(tree));
+}
+
+TEST(RewriteTest, MatrixChainOrder)
+{
+  // A*(B*C) costs 75000 multiplications, (A*B)*C 7500
+  OGNumeric::Ptr A = realMatrix(10, 100, 1.0);
+  OGNumeric::Ptr B = realMatrix(100, 5, 2.0);
+  OGNumeric::Ptr C = realMatrix(5, 50, 3.0);
+  OGNumeric::Ptr rewritten = checkRewrite(MTIMES::create(A, MTIMES::create(B, C)));
+  const ArgContainer& args = rewritten->asOGExpr()->getArgs();
+  ASSERT_EQ(MTIMES_ENUM, args[0]->getType());
+  EXPECT_EQ(A, args[0]->asOGExpr()->getArgs()[0]);
+  EXPECT_EQ(B, args[0]->asOGExpr()->getArgs()[1]);
+  EXPECT_EQ(C, args[1]);
+
+  // Longer chains, through other nodes of known shape
+  OGNumeric::Ptr D = realMatrix(50, 1, 4.0);
+  rewritten = checkRewrite(NEGATE::create(MTIMES::create(MTIMES::create(MTIMES::create(A, B),
+                                                                      EXP::create(C)), D)));
+  // A*(B*(exp(C)*D))
+  const ArgContainer& args2 = rewritten->asOGExpr()->getArgs()[0]->asOGExpr()->getArgs();
+  EXPECT_EQ(A, args2[0]);
+  ASSERT_EQ(MTIMES_ENUM, args2[1]->getType());
+  EXPECT_EQ(B, args2[1]->asOGExpr()->getArgs()[0]);
+}
+
+TEST(RewriteTest, MatrixChainTransposedFactor)
+{
+  // (A.'*B)*x is A.'*(B*x), the transpose being a factor in its own right
+  OGNumeric::Ptr A = realMatrix(4, 4, 1.0);
+  OGNumeric::Ptr B = realMatrix(4, 4, 2.0);
+  OGNumeric::Ptr x = realMatrix(4, 1, 3.0);
+  OGNumeric::Ptr At = TRANSPOSE::create(A);
+  OGNumeric::Ptr rewritten = checkRewrite(MTIMES::create(MTIMES::create(At, B), x));
+  ASSERT_EQ(MTIMES_ENUM, rewritten->getType());
+  const ArgContainer& args = rewritten->asOGExpr()->getArgs();
+  EXPECT_EQ(At, args[0]);
+  ASSERT_EQ(MTIMES_ENUM, args[1]->getType());
+  EXPECT_EQ(B, args[1]->asOGExpr()->getArgs()[0]);
+  EXPECT_EQ(x, args[1]->asOGExpr()->getArgs()[1]);
+}
+
+TEST(RewriteTest, MatrixChainLeftAlone)
+{
+  OGNumeric::Ptr A = realMatrix(4, 4, 1.0);
+  OGNumeric::Ptr B = realMatrix(4, 4, 2.0);
+  OGNumeric::Ptr x = realMatrix(4, 1, 3.0);
+
+  // A shared product is computed anyway, so is not split up
+  OGNumeric::Ptr AB = MTIMES::create(A, B);
+  OGNumeric::Ptr tree = PLUS::create(MTIMES::create(AB, x), MTIMES::create(AB, x));
+  EXPECT_EQ(tree, checkRewrite(tree));
+
+  // Scalar factors broadcast
+  tree = MTIMES::create(MTIMES::create(A, OGRealScalar::create(2.0)), x);
+  EXPECT_EQ(tree, checkRewrite(tree));
+
+  // Unknown shapes, the shape of a least squares solution is left to the runner
+  tree = MTIMES::create(MTIMES::create(A, MLDIVIDE::create(realMatrix(5, 4, 1.0), realMatrix(5, 4, 2.0))), x);
+  EXPECT_EQ(tree, Rewriter().rewrite(tree));
+
+  // Non-conformant, the runner reports it
+  tree = MTIMES::create(MTIMES::create(A, B), realMatrix(3, 1, 1.0));
+  EXPECT_EQ(tree, Rewriter().rewrite(tree));
+}
+
+TEST(RewriteTest, SharedNodesRewrittenOnce)
+{
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  OGNumeric::Ptr shared = EXP::create(NEGATE::create(NEGATE::create(A)));
+  OGNumeric::Ptr tree = PLUS::create(shared, SIN::create(shared));
+  OGNumeric::Ptr rewritten = checkRewrite(tree);
+  const ArgContainer& args = rewritten->asOGExpr()->getArgs();
+  EXPECT_EQ(args[0], args[1]->asOGExpr()->getArgs()[0]);
+  EXPECT_EQ(A, args[0]->asOGExpr()->getArgs()[0]);
+  // The input tree is untouched
+  EXPECT_EQ(NEGATE_ENUM, shared->asOGExpr()->getArgs()[0]->getType());
+}
+
+TEST(RewriteTest, Rules)
+{
+  EXPECT_EQ(6, Rewriter::getDefaultRules().size());
+  EXPECT_EQ(Rewriter::getDefaultRules(), Rewriter().getRules());
+
+  // No rules, no change
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  OGNumeric::Ptr tree = SIN::create(NEGATE::create(NEGATE::create(A)));
+  EXPECT_EQ(tree, Rewriter(vector<RewriteRule::Ptr>{}).rewrite(tree));
+
+  // Extra rules
+  vector<RewriteRule::Ptr> rules = Rewriter::getDefaultRules();
+  rules.push_back(make_shared<SinToCosRule>());
+  OGNumeric::Ptr rewritten = Rewriter(rules).rewrite(tree);
+  ASSERT_EQ(COS_ENUM, rewritten->getType());
+  EXPECT_EQ(A, rewritten->asOGExpr()->getArgs()[0]);
+}
+
+TEST(RewriteTest, Context)
+{
+  RewriteContext context;
+  OGNumeric::Ptr A = realMatrix(3, 2, 1.0);
+  OGNumeric::Ptr tree = MTIMES::create(TRANSPOSE::create(A), A);
+  EXPECT_THROW(context.add(tree), rdag_error);
+  ExecutionList el{tree};
+  for (auto it = el.begin(); it != el.end(); ++it)
+  {
+    context.add(*it);
+  }
+  size_t rows = 0, cols = 0;
+  EXPECT_TRUE(context.isReal(tree));
+  ASSERT_TRUE(context.getShape(tree, rows, cols));
+  EXPECT_EQ(2, rows);
+  EXPECT_EQ(2, cols);
+  EXPECT_THROW(context.isReal(realMatrix(1, 1, 1.0)), rdag_error);
+}
+
+TEST(RewriteTest, EntryptHonoursSwitch)
+{
+  bool enabled = Rewriter::getEnabled();
+  OGNumeric::Ptr A = realMatrix(2, 3, 1.0);
+  Rewriter::setEnabled(true);
+  EXPECT_TRUE(Rewriter::getEnabled());
+  // The tree simplifies to its terminal
+  EXPECT_EQ(A, entrypt(TRANSPOSE::create(TRANSPOSE::create(A))));
+  Rewriter::setEnabled(false);
+  EXPECT_FALSE(Rewriter::getEnabled());
+  OGTerminal::Ptr result = entrypt(TRANSPOSE::create(TRANSPOSE::create(A)));
+  EXPECT_NE(A, result);
+  EXPECT_TRUE(A->asOGTerminal()->mathsequals(result));
+  Rewriter::setEnabled(enabled);
+}
+
+TEST(RewriteTest, EntryptMaterialisesViews)
+{
+  // TRANSPOSE computes a view, which entrypt hands back as a dense matrix
+  OGNumeric::Ptr A = realMatrix(2, 3, 1.0);
+  OGTerminal::Ptr result = entrypt(TRANSPOSE::create(A));
+  ASSERT_EQ(REAL_DENSE_MATRIX_ENUM, result->getType());
+  EXPECT_EQ(3, result->getRows());
+  EXPECT_TRUE(evaluate(TRANSPOSE::create(A))->fuzzyequals(result));
+}
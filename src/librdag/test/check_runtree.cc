@@ -40,3 +40,19 @@ TEST(RunTree, ExecOk)
     OGTerminal::Ptr expected = OGRealScalar::create(50);
     EXPECT_TRUE(s1m1m2->getRegs()[0]->asOGTerminal()->mathsequals(expected));
 }
+
+TEST(RunTree, SharedNodeRunOnce)
+{
+    OGNumeric::Ptr m1 = OGRealDenseMatrix::create(new real8[2]{1,2},1,2,OWNER);
+    OGExpr::Ptr neg = NEGATE::create(m1);
+    OGExpr::Ptr plus1 = PLUS::create(neg, neg);
+    OGExpr::Ptr plus2 = PLUS::create(plus1, neg);
+
+    runtree(plus2);
+
+    // The shared node's result is released once its last consumer is complete
+    EXPECT_EQ(0, neg->getRegs().size());
+    EXPECT_EQ(1, plus2->getRegs().size());
+    OGTerminal::Ptr expected = OGRealDenseMatrix::create(new real8[2]{-3,-6},1,2,OWNER);
+    EXPECT_TRUE(plus2->getRegs()[0]->asOGTerminal()->mathsequals(expected));
+}
@@ -0,0 +1,287 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include "sparse.hh"
+#include "inference.hh"
+#include "entrypt.hh"
+#include "execution.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "exceptions.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+namespace {
+
+/**
+ * Makes a sparse matrix holding the nonzero entries of a column major array.
+ */
+template<typename T>
+typename OGSparseMatrix<T>::Ptr sparseFrom(const vector<T>& dense, size_t rows, size_t cols)
+{
+  int4 * colPtr = new int4[cols + 1];
+  int4 * rowIdx = new int4[dense.size() + 1];
+  T * data = new T[dense.size() + 1];
+  int4 nnz = 0;
+  for (size_t j = 0; j < cols; j++)
+  {
+    colPtr[j] = nnz;
+    for (size_t i = 0; i < rows; i++)
+    {
+      if (dense[j * rows + i] != T(0))
+      {
+        rowIdx[nnz] = i;
+        data[nnz++] = dense[j * rows + i];
+      }
+    }
+  }
+  colPtr[cols] = nnz;
+  return static_pointer_cast<const OGSparseMatrix<T>>(makeConcreteSparseMatrix(colPtr, rowIdx, data, rows, cols, OWNER));
+}
+
+template<typename T>
+OGNumeric::Ptr denseFrom(const vector<T>& dense, size_t rows, size_t cols)
+{
+  T * data = new T[rows * cols];
+  std::copy(dense.begin(), dense.end(), data);
+  return makeConcreteDenseMatrix(data, rows, cols, OWNER);
+}
+
+OGNumeric::Ptr toDense(const OGNumeric::Ptr& arg)
+{
+  const OGTerminal::Ptr terminal = arg->asOGTerminal();
+  if (terminal == OGTerminal::Ptr{} || (terminal->getType() != REAL_SPARSE_MATRIX_ENUM &&
+                                        terminal->getType() != COMPLEX_SPARSE_MATRIX_ENUM))
+  {
+    return arg;
+  }
+  return terminal->getType() == REAL_SPARSE_MATRIX_ENUM ? terminal->asFullOGRealDenseMatrix()->createOwningCopy()
+                                                        : terminal->asFullOGComplexDenseMatrix()->createOwningCopy();
+}
+
+/**
+ * Checks a tree with sparse leaves against the same tree with the leaves made dense,
+ * and that the inferred type is that of the result.
+ * @return the type of the result.
+ */
+ExprType_t checkAgainstDense(const OGNumeric::Ptr& tree, const OGNumeric::Ptr& denseTree)
+{
+  ExecutionList el{tree};
+  ExprType_t inferred = TypeInference(el).getResult(tree).type;
+  OGTerminal::Ptr actual = entrypt(tree);
+  OGTerminal::Ptr expected = entrypt(denseTree);
+  EXPECT_TRUE(actual->mathsequals(expected));
+  EXPECT_EQ(inferred, actual->getType());
+  return actual->getType();
+}
+
+template<typename Node>
+ExprType_t checkAgainstDense(const OGNumeric::Ptr& a, const OGNumeric::Ptr& b)
+{
+  return checkAgainstDense(Node::create(a, b), Node::create(toDense(a), toDense(b)));
+}
+
+/**
+ * Checks the entries of a result against those expected, a NaN matching any NaN.
+ */
+void expectEntries(const OGTerminal::Ptr& result, const vector<real8>& expected)
+{
+  shared_ptr<const OGRealDenseMatrix> dense = result->asFullOGRealDenseMatrix();
+  ASSERT_EQ(expected.size(), dense->getDatalen());
+  for (size_t i = 0; i < expected.size(); i++)
+  {
+    if (std::isnan(expected[i]))
+    {
+      EXPECT_TRUE(std::isnan(dense->getData()[i]));
+    }
+    else
+    {
+      EXPECT_EQ(expected[i], dense->getData()[i]);
+    }
+  }
+}
+
+// 4x3, with an empty column and an explicit zero made by cancellation against sB
+const vector<real8> rA = {1, 0, 2, 0,
+                          0, 0, 0, 0,
+                          0, 3, 0, -4};
+const vector<real8> rB = {0, 5, -2, 0,
+                          6, 0, 0, 0,
+                          0, 0, 7, 4};
+
+vector<complex16> toComplex(const vector<real8>& values)
+{
+  vector<complex16> ret;
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    ret.push_back(complex16(values[i], values[i] == 0 ? 0 : i));
+  }
+  return ret;
+}
+
+} // end anonymous namespace
+
+TEST(SparseTest, PlusMinus)
+{
+  OGNumeric::Ptr a = sparseFrom(rA, 4, 3);
+  OGNumeric::Ptr b = sparseFrom(rB, 4, 3);
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<PLUS>(a, b));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<MINUS>(a, b));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<MINUS>(a, a));
+
+  OGNumeric::Ptr ca = sparseFrom(toComplex(rA), 4, 3);
+  OGNumeric::Ptr cb = sparseFrom(toComplex(rB), 4, 3);
+  EXPECT_EQ(COMPLEX_SPARSE_MATRIX_ENUM, checkAgainstDense<PLUS>(ca, cb));
+  EXPECT_EQ(COMPLEX_SPARSE_MATRIX_ENUM, checkAgainstDense<MINUS>(cb, ca));
+
+  // A 1x1 sparse matrix is broadcast, which fills in the result
+  OGNumeric::Ptr one = sparseFrom(vector<real8>{2}, 1, 1);
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<PLUS>(one, a));
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MINUS>(a, one));
+}
+
+TEST(SparseTest, PlusOmitsZeros)
+{
+  OGNumeric::Ptr a = sparseFrom(rA, 4, 3);
+  OGTerminal::Ptr zero = entrypt(MINUS::create(a, a));
+  OGRealSparseMatrix::Ptr result = zero->asOGRealSparseMatrix();
+  ASSERT_NE(OGRealSparseMatrix::Ptr{}, result);
+  for (size_t j = 0; j <= 3; j++)
+  {
+    EXPECT_EQ(0, result->getColPtr()[j]);
+  }
+}
+
+TEST(SparseTest, Times)
+{
+  OGNumeric::Ptr a = sparseFrom(rA, 4, 3);
+  OGNumeric::Ptr b = sparseFrom(rB, 4, 3);
+  OGNumeric::Ptr d = denseFrom(rB, 4, 3);
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<TIMES>(a, b));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<TIMES>(a, d));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<TIMES>(d, a));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<TIMES>(OGRealScalar::create(3.0), a));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<TIMES>(a, OGRealScalar::create(0.0)));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<TIMES>(a, denseFrom(vector<real8>{-2}, 1, 1)));
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<TIMES>(sparseFrom(vector<real8>{-2}, 1, 1), d));
+
+  OGNumeric::Ptr ca = sparseFrom(toComplex(rA), 4, 3);
+  EXPECT_EQ(COMPLEX_SPARSE_MATRIX_ENUM, checkAgainstDense<TIMES>(ca, denseFrom(toComplex(rB), 4, 3)));
+  EXPECT_EQ(COMPLEX_SPARSE_MATRIX_ENUM, checkAgainstDense<TIMES>(OGComplexScalar::create(complex16(1, 2)), ca));
+}
+
+TEST(SparseTest, MatrixVectorAndMatrixMatrix)
+{
+  OGNumeric::Ptr a = sparseFrom(rA, 4, 3);
+  OGNumeric::Ptr v = denseFrom(vector<real8>{1, -2, 3}, 3, 1);
+  OGNumeric::Ptr m = denseFrom(vector<real8>{1, 2, 3, 4, 5, 6}, 3, 2);
+  OGNumeric::Ptr left = denseFrom(vector<real8>{1, 2, 3, 4, 5, 6, 7, 8}, 2, 4);
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(a, v));
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(a, m));
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(left, a));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(a, denseFrom(vector<real8>{4}, 1, 1)));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(OGRealScalar::create(4.0), a));
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(sparseFrom(vector<real8>{4}, 1, 1), m));
+
+  OGNumeric::Ptr ca = sparseFrom(toComplex(rA), 4, 3);
+  EXPECT_EQ(COMPLEX_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(ca, denseFrom(toComplex({1, -2, 3}), 3, 1)));
+  EXPECT_EQ(COMPLEX_DENSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(denseFrom(toComplex({1, 2, 3, 4}), 1, 4), ca));
+}
+
+TEST(SparseTest, SparseMatrixProduct)
+{
+  OGNumeric::Ptr a = sparseFrom(rA, 4, 3);
+  OGNumeric::Ptr b = sparseFrom(vector<real8>{0, 1, 0, 2, 0, 0, 0, 0, 3, 0, 0, 0}, 3, 4);
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(a, b));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(b, a));
+  EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(a, sparseFrom(vector<real8>{-1}, 1, 1)));
+
+  OGNumeric::Ptr ca = sparseFrom(toComplex(rA), 4, 3);
+  OGNumeric::Ptr cb = sparseFrom(toComplex({0, 1, 0, 2, 0, 0, 0, 0, 3, 0, 0, 0}), 3, 4);
+  EXPECT_EQ(COMPLEX_SPARSE_MATRIX_ENUM, checkAgainstDense<MTIMES>(ca, cb));
+}
+
+TEST(SparseTest, NonFiniteValues)
+{
+  const real8 inf = std::numeric_limits<real8>::infinity();
+  const real8 nan = std::numeric_limits<real8>::quiet_NaN();
+  OGNumeric::Ptr a = sparseFrom(vector<real8>{1, 0, 0, 0}, 2, 2);
+  OGNumeric::Ptr b = sparseFrom(vector<real8>{inf, 0, 0, 1}, 2, 2);
+
+  // An implicit zero times Inf or NaN is NaN
+  expectEntries(entrypt(TIMES::create(a, OGRealScalar::create(inf))), {inf, nan, nan, nan});
+  expectEntries(entrypt(TIMES::create(denseFrom(vector<real8>{nan}, 1, 1), a)), {nan, nan, nan, nan});
+  expectEntries(entrypt(TIMES::create(a, denseFrom(vector<real8>{2, inf, 0, 3}, 2, 2))), {2, nan, 0, 0});
+  expectEntries(entrypt(TIMES::create(a, sparseFrom(vector<real8>{2, 0, 0, nan}, 2, 2))), {2, 0, 0, nan});
+  expectEntries(entrypt(TIMES::create(b, a)), {inf, 0, 0, 0});
+  expectEntries(entrypt(TIMES::create(b, sparseFrom(vector<real8>{0, 0, 0, 1}, 2, 2))), {nan, 0, 0, 1});
+
+  // Scaling by zero keeps a stored Inf as NaN
+  expectEntries(entrypt(TIMES::create(b, OGRealScalar::create(0.0))), {nan, 0, 0, 0});
+  expectEntries(entrypt(MTIMES::create(OGRealScalar::create(0.0), b)), {nan, 0, 0, 0});
+
+  // Matrix products
+  expectEntries(entrypt(MTIMES::create(a, denseFrom(vector<real8>{nan, 1}, 2, 1))), {nan, nan});
+  expectEntries(entrypt(MTIMES::create(b, denseFrom(vector<real8>{0, 1}, 2, 1))), {nan, 1});
+  expectEntries(entrypt(MTIMES::create(denseFrom(vector<real8>{inf, 1}, 1, 2), a)), {inf, nan});
+  expectEntries(entrypt(MTIMES::create(a, sparseFrom(vector<real8>{nan, 0}, 2, 1))), {nan, nan});
+  expectEntries(entrypt(MTIMES::create(b, sparseFrom(vector<real8>{0, 1}, 2, 1))), {nan, 1});
+}
+
+TEST(SparseTest, RowIndicesAreSorted)
+{
+  OGNumeric::Ptr a = sparseFrom(vector<real8>{0, 0, 1, 1, 1, 0, 1, 0, 1}, 3, 3);
+  OGTerminal::Ptr product = entrypt(MTIMES::create(a, a));
+  OGRealSparseMatrix::Ptr result = product->asOGRealSparseMatrix();
+  ASSERT_NE(OGRealSparseMatrix::Ptr{}, result);
+  for (size_t j = 0; j < result->getCols(); j++)
+  {
+    for (int4 k = result->getColPtr()[j] + 1; k < result->getColPtr()[j + 1]; k++)
+    {
+      EXPECT_LT(result->getRowIdx()[k - 1], result->getRowIdx()[k]);
+    }
+  }
+}
+
+TEST(SparseTest, ZeroPreservingFunctions)
+{
+  OGNumeric::Ptr a = sparseFrom(rA, 4, 3);
+  OGNumeric::Ptr ca = sparseFrom(toComplex(rA), 4, 3);
+  vector<function<OGNumeric::Ptr(const OGNumeric::Ptr&)>> functions = {
+    &NEGATE::create, &SIN::create, &TAN::create, &SINH::create, &ASINH::create, &ATAN::create, &TANH::create
+  };
+  for (auto fn: functions)
+  {
+    EXPECT_EQ(REAL_SPARSE_MATRIX_ENUM, checkAgainstDense(fn(a), fn(toDense(a))));
+    EXPECT_EQ(COMPLEX_SPARSE_MATRIX_ENUM, checkAgainstDense(fn(ca), fn(toDense(ca))));
+  }
+  // The pattern is kept
+  OGRealSparseMatrix::Ptr result = entrypt(SIN::create(a))->asOGRealSparseMatrix();
+  OGRealSparseMatrix::Ptr input = a->asOGRealSparseMatrix();
+  EXPECT_TRUE(std::equal(input->getColPtr(), input->getColPtr() + 4, result->getColPtr()));
+  EXPECT_TRUE(std::equal(input->getRowIdx(), input->getRowIdx() + 4, result->getRowIdx()));
+  // Functions not mapping zero to zero make a dense matrix
+  EXPECT_EQ(REAL_DENSE_MATRIX_ENUM, checkAgainstDense(COS::create(a), COS::create(toDense(a))));
+}
+
+TEST(SparseTest, ShapesMismatch)
+{
+  OGSparseMatrix<real8>::Ptr a = sparseFrom(rA, 4, 3);
+  OGSparseMatrix<real8>::Ptr b = sparseFrom(rB, 4, 3);
+  OGSparseMatrix<real8>::Ptr c = sparseFrom(vector<real8>{1, 0, 0, 1, 2, 0}, 2, 3);
+  EXPECT_THROW(sparse::plus(*a, *c, false), rdag_error);
+  EXPECT_THROW(sparse::times(*a, *c), rdag_error);
+  EXPECT_THROW(sparse::mtimes(*a, *b), rdag_error);
+  OGRealDenseMatrix::Ptr d = denseFrom(rB, 4, 3)->asOGRealDenseMatrix();
+  EXPECT_THROW(sparse::times(*c, *d), rdag_error);
+  EXPECT_THROW(sparse::mtimes(*a, *d), rdag_error);
+  EXPECT_THROW(sparse::mtimes(*d, *c), rdag_error);
+}
@@ -73,6 +73,44 @@ TEST(TerminalsTest, OGTerminalTest) {
   EXPECT_THROW(terminal->toComplex16Array(), rdag_error);
 }
 
+/*
+ * Check Structure normalises its properties and transposes
+ */
+TEST(TerminalsTest, StructureTest) {
+  Structure unknown;
+  ASSERT_EQ(0u, unknown.getProperties());
+  ASSERT_EQ(Structure::UNKNOWN_BANDWIDTH, unknown.getLowerBandwidth());
+  ASSERT_EQ(Structure::UNKNOWN_BANDWIDTH, unknown.getUpperBandwidth());
+
+  // triangular matrices have no bandwidth on their zero side
+  Structure upper(Structure::UPPER_TRIANGULAR | Structure::UNIT_DIAGONAL);
+  ASSERT_TRUE(upper.has(Structure::UPPER_TRIANGULAR));
+  ASSERT_TRUE(upper.has(Structure::UNIT_DIAGONAL));
+  ASSERT_FALSE(upper.has(Structure::LOWER_TRIANGULAR));
+  ASSERT_EQ(0u, upper.getLowerBandwidth());
+  ASSERT_EQ(Structure::UNKNOWN_BANDWIDTH, upper.getUpperBandwidth());
+
+  // transposing swaps the triangle and the bandwidths
+  Structure lower = upper.transposed();
+  ASSERT_TRUE(lower.has(Structure::LOWER_TRIANGULAR));
+  ASSERT_TRUE(lower.has(Structure::UNIT_DIAGONAL));
+  ASSERT_FALSE(lower.has(Structure::UPPER_TRIANGULAR));
+  ASSERT_EQ(Structure::UNKNOWN_BANDWIDTH, lower.getLowerBandwidth());
+  ASSERT_EQ(0u, lower.getUpperBandwidth());
+
+  // positive definite implies Hermitian, which survives transposition
+  Structure spd(Structure::POSITIVE_DEFINITE, 1, 1);
+  ASSERT_TRUE(spd.has(Structure::HERMITIAN));
+  ASSERT_TRUE(spd.transposed().has(Structure::POSITIVE_DEFINITE));
+  ASSERT_EQ(1u, spd.transposed().getLowerBandwidth());
+
+  // terminals start with nothing known and carry what they are given
+  OGTerminal::Ptr terminal = OGRealDenseMatrix::create(new real8[4]{1,0,2,3},2,2, OWNER);
+  ASSERT_EQ(0u, terminal->getStructure().getProperties());
+  terminal->setStructure(upper);
+  ASSERT_TRUE(terminal->getStructure().has(Structure::UPPER_TRIANGULAR));
+}
+
 /*
  * Test OGScalar<T>
  */
@@ -566,6 +604,88 @@ TEST(TerminalsTest, OGComplexDenseMatrixTest) {
 }
 
 
+/*
+ * Test OGRealSingleDenseMatrix and OGComplexSingleDenseMatrix
+ */
+TEST(TerminalsTest, OGSingleDenseMatrixTest) {
+  OGRealSingleDenseMatrix::Ptr rs = OGRealSingleDenseMatrix::create({{1.f,3.f},{2.f,4.f}});
+  OGComplexSingleDenseMatrix::Ptr cs = OGComplexSingleDenseMatrix::create({{{1.f,2.f},{3.f,4.f}},{{5.f,6.f},{7.f,8.f}}});
+
+  // check types and casts
+  ASSERT_EQ(rs->getType(), REAL_SINGLE_DENSE_MATRIX_ENUM);
+  ASSERT_EQ(cs->getType(), COMPLEX_SINGLE_DENSE_MATRIX_ENUM);
+  ASSERT_EQ(rs->asOGRealSingleDenseMatrix(), rs);
+  ASSERT_EQ(cs->asOGComplexSingleDenseMatrix(), cs);
+  ASSERT_EQ(rs->asOGRealDenseMatrix(), OGRealDenseMatrix::Ptr{});
+  ASSERT_EQ(cs->asOGComplexDenseMatrix(), OGComplexDenseMatrix::Ptr{});
+
+  // check widening to double precision
+  OGRealDenseMatrix::Ptr rd = rs->asFullOGRealDenseMatrix();
+  ASSERT_TRUE(*rd==~*OGRealDenseMatrix::create({{1e0,3e0},{2e0,4e0}}));
+  OGComplexDenseMatrix::Ptr cd = cs->asFullOGComplexDenseMatrix();
+  ASSERT_TRUE(*cd==~*OGComplexDenseMatrix::create({{{1e0,2e0},{3e0,4e0}},{{5e0,6e0},{7e0,8e0}}}));
+  ASSERT_THROW(cs->asFullOGRealDenseMatrix(), rdag_error);
+
+  // single and double precision of the same values are mathematically equal
+  ASSERT_TRUE(rs->mathsequals(rd));
+  ASSERT_TRUE(cs->mathsequals(cd));
+
+  // owning copies stay in single precision
+  OGTerminal::Ptr owningCopy = rs->createOwningCopy();
+  ASSERT_EQ(owningCopy->getType(), REAL_SINGLE_DENSE_MATRIX_ENUM);
+  ASSERT_TRUE(*owningCopy==~*rs);
+  OGTerminal::Ptr owningComplexCopy = rs->createComplexOwningCopy();
+  ASSERT_EQ(owningComplexCopy->getType(), COMPLEX_SINGLE_DENSE_MATRIX_ENUM);
+  ASSERT_TRUE(owningComplexCopy->mathsequals(rd));
+}
+
+
+/*
+ * Test OGRealTransposedMatrix and OGComplexTransposedMatrix
+ */
+TEST(TerminalsTest, OGTransposedMatrixTest) {
+  OGRealDenseMatrix::Ptr rsource = OGRealDenseMatrix::create({{1e0,2e0,3e0},{4e0,5e0,6e0}});
+  OGComplexDenseMatrix::Ptr csource = OGComplexDenseMatrix::create({{{1e0,2e0},{3e0,4e0}},{{5e0,6e0},{7e0,8e0}}});
+  OGRealTransposedMatrix::Ptr rt = OGRealTransposedMatrix::create(rsource);
+  OGComplexTransposedMatrix::Ptr ct = OGComplexTransposedMatrix::create(csource, false);
+  OGComplexTransposedMatrix::Ptr cct = OGComplexTransposedMatrix::create(csource, true);
+
+  // check types, casts and shapes
+  ASSERT_EQ(rt->getType(), REAL_TRANSPOSED_MATRIX_ENUM);
+  ASSERT_EQ(ct->getType(), COMPLEX_TRANSPOSED_MATRIX_ENUM);
+  ASSERT_EQ(rt->asOGRealTransposedMatrix(), rt);
+  ASSERT_EQ(ct->asOGComplexTransposedMatrix(), ct);
+  ASSERT_EQ(rt->asOGRealDenseMatrix(), OGRealDenseMatrix::Ptr{});
+  ASSERT_EQ(rt->getRows(), 3);
+  ASSERT_EQ(rt->getCols(), 2);
+
+  // the data is that of the source, not a copy
+  ASSERT_EQ(rt->getData(), rsource->getData());
+  ASSERT_EQ(rt->getDataAccess(), VIEWER);
+  ASSERT_EQ(rt->getSource(), rsource);
+  ASSERT_TRUE(cct->isConjugate());
+
+  // check materialising
+  ASSERT_TRUE(*rt->asFullOGRealDenseMatrix()==~*OGRealDenseMatrix::create({{1e0,4e0},{2e0,5e0},{3e0,6e0}}));
+  ASSERT_TRUE(*ct->asFullOGComplexDenseMatrix()==~*OGComplexDenseMatrix::create({{{1e0,2e0},{5e0,6e0}},{{3e0,4e0},{7e0,8e0}}}));
+  ASSERT_TRUE(*cct->asFullOGComplexDenseMatrix()==~*OGComplexDenseMatrix::create({{{1e0,-2e0},{5e0,-6e0}},{{3e0,-4e0},{7e0,-8e0}}}));
+  ASSERT_THROW(ct->asFullOGRealDenseMatrix(), rdag_error);
+  ASSERT_TRUE(rt->mathsequals(rt->asFullOGComplexDenseMatrix()));
+
+  // the transpose and conjugate transpose differ
+  ASSERT_FALSE(*ct==~*cct);
+  ASSERT_TRUE(*ct==~*ct->copy()->asOGTerminal());
+
+  // owning copies are dense
+  OGTerminal::Ptr owningCopy = rt->createOwningCopy();
+  ASSERT_EQ(owningCopy->getType(), REAL_DENSE_MATRIX_ENUM);
+  ASSERT_TRUE(owningCopy->mathsequals(rt));
+  OGTerminal::Ptr owningComplexCopy = cct->createComplexOwningCopy();
+  ASSERT_EQ(owningComplexCopy->getType(), COMPLEX_DENSE_MATRIX_ENUM);
+  ASSERT_TRUE(owningComplexCopy->mathsequals(cct));
+}
+
+
 /*
  * Test OGRealDiagonalMatrix
  */
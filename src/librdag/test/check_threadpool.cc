@@ -0,0 +1,94 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "threadpool.hh"
+#include "exceptions.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+TEST(ThreadPoolTest, ZeroThreads)
+{
+  EXPECT_THROW(ThreadPool(0), rdag_error);
+}
+
+TEST(ThreadPoolTest, ThreadCount)
+{
+  ThreadPool pool(3);
+  EXPECT_EQ(3, pool.getThreadCount());
+  EXPECT_LE(1, ThreadPool::getHardwareThreadCount());
+}
+
+TEST(ThreadPoolTest, RunsAllTasks)
+{
+  ThreadPool pool(4);
+  const int ntasks = 1000;
+  atomic<int> count{0};
+  for (int i = 0; i < ntasks; i++)
+  {
+    pool.submit([&count]{ ++count; });
+  }
+  pool.runUntil([&count]{ return count.load() == ntasks; });
+  EXPECT_EQ(ntasks, count.load());
+}
+
+TEST(ThreadPoolTest, NestedSubmitAndWait)
+{
+  // Tasks submitting and waiting on their own subtasks must not deadlock, even
+  // when there are more waiting tasks than threads.
+  ThreadPool pool(2);
+  const int nouter = 8;
+  const int ninner = 16;
+  atomic<int> count{0};
+  atomic<int> outerDone{0};
+  for (int i = 0; i < nouter; i++)
+  {
+    pool.submit([&]{
+      auto innerCount = make_shared<atomic<int>>(0);
+      for (int j = 0; j < ninner; j++)
+      {
+        pool.submit([&count, innerCount]{ ++count; ++*innerCount; });
+      }
+      pool.runUntil([&]{ return innerCount->load() == ninner; });
+      ++outerDone;
+    });
+  }
+  pool.runUntil([&outerDone]{ return outerDone.load() == nouter; });
+  EXPECT_EQ(nouter * ninner, count.load());
+}
+
+TEST(ThreadPoolTest, WaiterWokenWhenWorkerCompletesTask)
+{
+  // The caller has nothing to run, so must be woken by the worker finishing the task
+  ThreadPool pool(1);
+  atomic<bool> started{false};
+  atomic<bool> done{false};
+  pool.submit([&]{
+    started = true;
+    this_thread::sleep_for(chrono::milliseconds(50));
+    done = true;
+  });
+  while (!started.load())
+  {
+    this_thread::yield();
+  }
+  pool.runUntil([&done]{ return done.load(); });
+  EXPECT_TRUE(done.load());
+}
+
+TEST(ThreadPoolTest, ThrowingTaskDoesNotKillWorker)
+{
+  ThreadPool pool(1);
+  atomic<bool> ran{false};
+  pool.submit([]{ throw rdag_error("Task failure"); });
+  pool.submit([&ran]{ ran = true; });
+  pool.runUntil([&ran]{ return ran.load(); });
+  EXPECT_TRUE(ran.load());
+}
@@ -0,0 +1,160 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <sstream>
+#include "trace.hh"
+#include "entrypt.hh"
+#include "execution.hh"
+#include "executor.hh"
+#include "dispatch.hh"
+#include "expression.hh"
+#include "terminal.hh"
+#include "exceptions.hh"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace librdag;
+
+namespace {
+
+OGNumeric::Ptr realMatrix(size_t rows, size_t cols, real8 offset)
+{
+  real8 * data = new real8[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = offset + i;
+  }
+  return OGRealDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+OGNumeric::Ptr complexMatrix(size_t rows, size_t cols, real8 offset)
+{
+  complex16 * data = new complex16[rows * cols];
+  for (size_t i = 0; i < rows * cols; i++)
+  {
+    data[i] = complex16(offset + i, offset - i);
+  }
+  return OGComplexDenseMatrix::create(data, rows, cols, OWNER);
+}
+
+/**
+ * Enables tracing for the lifetime of a test, starting with no events.
+ */
+class TracingOn
+{
+  public:
+    TracingOn()
+    {
+      Tracer::clear();
+      Tracer::setEnabled(true);
+    }
+    ~TracingOn()
+    {
+      Tracer::setEnabled(false);
+      Tracer::clear();
+    }
+};
+
+void expectValue(ExprType_t type, size_t rows, size_t cols, const ValueInfo& value)
+{
+  EXPECT_EQ(type, value.type);
+  EXPECT_TRUE(value.shapeKnown);
+  EXPECT_EQ(rows, value.rows);
+  EXPECT_EQ(cols, value.cols);
+}
+
+} // end anonymous namespace
+
+TEST(TracerTest, TypeNames)
+{
+  EXPECT_STREQ("OGRealDenseMatrix", Tracer::getTypeName(REAL_DENSE_MATRIX_ENUM));
+  EXPECT_STREQ("MTIMES", Tracer::getTypeName(MTIMES_ENUM));
+  EXPECT_STREQ("SIN", Tracer::getTypeName(SIN_ENUM));
+  EXPECT_STREQ("COPY", Tracer::getTypeName(COPY_ENUM));
+  EXPECT_STREQ("UNKNOWN", Tracer::getTypeName(UNKNOWN_EXPR_ENUM));
+}
+
+TEST(TracerTest, DisabledRecordsNothing)
+{
+  Tracer::clear();
+  EXPECT_FALSE(Tracer::getEnabled());
+  entrypt(NEGATE::create(realMatrix(2, 2, 1.0)));
+  EXPECT_EQ(0, Tracer::getEvents().size());
+}
+
+TEST(TracerTest, RecordsNodes)
+{
+  TracingOn tracing;
+  OGNumeric::Ptr tree = PLUS::create(MTIMES::create(realMatrix(2, 3, 1.0), realMatrix(3, 2, 1.0)),
+                                     complexMatrix(2, 2, 1.0));
+  ExecutionList el{tree};
+  Dispatcher disp;
+  executeSerial(el, disp);
+
+  vector<TraceEvent> events = Tracer::getEvents();
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ(MTIMES_ENUM, events[0].type);
+  ASSERT_EQ(2, events[0].args.size());
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 3, events[0].args[0]);
+  expectValue(REAL_DENSE_MATRIX_ENUM, 3, 2, events[0].args[1]);
+  ASSERT_EQ(1, events[0].results.size());
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 2, events[0].results[0]);
+  EXPECT_EQ(0, events[0].conversions);
+  EXPECT_EQ(4 * sizeof(real8), events[0].bytes);
+  EXPECT_FALSE(events[0].failed);
+
+  // The real product is added to the complex matrix without converting it
+  EXPECT_EQ(PLUS_ENUM, events[1].type);
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 2, events[1].args[0]);
+  expectValue(COMPLEX_DENSE_MATRIX_ENUM, 2, 2, events[1].results[0]);
+  EXPECT_EQ(0, events[1].conversions);
+  EXPECT_EQ(4 * sizeof(complex16), events[1].bytes);
+  EXPECT_EQ(events[0].thread, events[1].thread);
+  EXPECT_LE(events[0].start + events[0].duration, events[1].start);
+}
+
+TEST(TracerTest, RecordsFusedKernels)
+{
+  TracingOn tracing;
+  OGNumeric::Ptr A = realMatrix(2, 2, 1.0);
+  entrypt(PLUS::create(NEGATE::create(A), SIN::create(A)));
+  vector<TraceEvent> events = Tracer::getEvents();
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ(PLUS_ENUM, events[0].type);
+  EXPECT_EQ(3, events[0].nodes);
+  ASSERT_EQ(1, events[0].args.size());
+  expectValue(REAL_DENSE_MATRIX_ENUM, 2, 2, events[0].args[0]);
+}
+
+TEST(TracerTest, RecordsFailures)
+{
+  TracingOn tracing;
+  // ABS has no runner
+  EXPECT_THROW(entrypt(ABS::create(realMatrix(2, 2, 1.0))), rdag_error);
+  vector<TraceEvent> events = Tracer::getEvents();
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ(ABS_ENUM, events[0].type);
+  EXPECT_TRUE(events[0].failed);
+  EXPECT_EQ(0, events[0].results.size());
+}
+
+TEST(TracerTest, ChromeTrace)
+{
+  TracingOn tracing;
+  entrypt(MTIMES::create(realMatrix(2, 3, 1.0), realMatrix(3, 2, 1.0)));
+  stringstream out;
+  Tracer::writeChromeTrace(out);
+  string json = out.str();
+  EXPECT_EQ(0, json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+  EXPECT_NE(string::npos, json.find("\"name\":\"MTIMES\""));
+  EXPECT_NE(string::npos, json.find("\"ph\":\"X\""));
+  EXPECT_NE(string::npos, json.find("\"ts\":0.000,"));
+  EXPECT_NE(string::npos, json.find("\"args\":[\"OGRealDenseMatrix 2x3\",\"OGRealDenseMatrix 3x2\"]"));
+  EXPECT_NE(string::npos, json.find("\"results\":[\"OGRealDenseMatrix 2x2\"]"));
+  EXPECT_EQ("]}\n", json.substr(json.size() - 3));
+
+  EXPECT_THROW(Tracer::writeChromeTrace("/nonexistent/directory/trace.json"), rdag_error);
+}
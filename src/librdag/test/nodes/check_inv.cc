@@ -163,3 +163,30 @@ TEST_P(ReconstructInvNodeTest, TerminalTypes)
 
 INSTANTIATE_TEST_CASE_P(INVTests, ReconstructInvNodeTest, ::testing::ValuesIn(terminals));
 
+
+// Structured inputs take the triangular and Cholesky paths and must agree with LU
+
+TEST(INVTests, StructuredInput)
+{
+  real8 upper[9] = {2,0,0,1,3,0,4,5,6};
+  real8 spd[9] = {4,1,0,1,3,1,0,1,2};
+  OGTerminal::Ptr expected, mat;
+  OGExpr::Ptr inv;
+
+  // reference answers from the general path
+  for (real8 * data : {upper, spd})
+  {
+    mat = OGRealDenseMatrix::create(data,3,3,VIEWER);
+    inv = INV::create(mat);
+    runtree(inv);
+    expected = inv->getRegs()[0]->asOGTerminal();
+
+    mat = OGRealDenseMatrix::create(data,3,3,VIEWER);
+    mat->setStructure(Structure(data == upper ? Structure::UPPER_TRIANGULAR : Structure::POSITIVE_DEFINITE));
+    inv = INV::create(mat);
+    runtree(inv);
+    OGTerminal::Ptr result = inv->getRegs()[0]->asOGTerminal();
+    EXPECT_TRUE(result->mathsequals(expected, 1e-14, 1e-14));
+    EXPECT_EQ(mat->getStructure().getProperties(), result->getStructure().getProperties());
+  }
+}
@@ -105,7 +105,19 @@ new CheckBinary<MINUS>(OGRealDenseMatrix::create({{1.0,4.0,3.0,2.0,1.0},{2.0,1.0
 // complex 5x4 matrix minus complex 5x4 matrix
 new CheckBinary<MINUS>(OGComplexDenseMatrix::create({{{1.0,5.0},{3.0,2.0},{2.0,3.0},{1.0,4.0}},{{2.0,4.0},{1.0,5.0},{3.0,2.0},{2.0,3.0}},{{3.0,3.0},{2.0,4.0},{1.0,5.0},{3.0,2.0}},{{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{5.0,1.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}}}), OGComplexDenseMatrix::create({{{1.0,5.0},{3.0,2.0},{2.0,3.0},{1.0,4.0}},{{2.0,4.0},{1.0,5.0},{3.0,2.0},{2.0,3.0}},{{3.0,3.0},{2.0,4.0},{1.0,5.0},{3.0,2.0}},{{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{5.0,1.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}}}), OGRealDenseMatrix::create({{0.0,0.0,0.0,0.0},{0.0,0.0,0.0,0.0},{0.0,0.0,0.0,0.0},{0.0,0.0,0.0,0.0},{0.0,0.0,0.0,0.0}}), MATHSEQUAL),
 // complex 4x5 matrix minus complex 4x5 matrix
-new CheckBinary<MINUS>(OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGRealDenseMatrix::create({{0.0,0.0,0.0,0.0,0.0},{0.0,0.0,0.0,0.0,0.0},{0.0,0.0,0.0,0.0,0.0},{0.0,0.0,0.0,0.0,0.0}}), MATHSEQUAL)
+new CheckBinary<MINUS>(OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGRealDenseMatrix::create({{0.0,0.0,0.0,0.0,0.0},{0.0,0.0,0.0,0.0,0.0},{0.0,0.0,0.0,0.0,0.0},{0.0,0.0,0.0,0.0,0.0}}), MATHSEQUAL),
+// single matrix minus single matrix
+new CheckBinary<MINUS>(OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealSingleDenseMatrix::create(new real4[4]{5,7,6,8},2,2,OWNER), OGRealDenseMatrix::create(new real8[4]{-4,-5,-2,0},2,2,OWNER), MATHSEQUAL),
+// single 1x1 matrix minus single matrix
+new CheckBinary<MINUS>(OGRealSingleDenseMatrix::create(new real4[1]{2},1,1,OWNER), OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealDenseMatrix::create(new real8[4]{1,0,-2,-6},2,2,OWNER), MATHSEQUAL),
+// single matrix minus single 1x1 matrix
+new CheckBinary<MINUS>(OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealSingleDenseMatrix::create(new real4[1]{2},1,1,OWNER), OGRealDenseMatrix::create(new real8[4]{-1,0,2,6},2,2,OWNER), MATHSEQUAL),
+// single complex matrix minus single complex matrix
+new CheckBinary<MINUS>(OGComplexSingleDenseMatrix::create(new complex8[4]{{1,2},{2,-1},{4,0},{0,1}},2,2,OWNER), OGComplexSingleDenseMatrix::create(new complex8[4]{{1,1},{3,0},{0,2},{1,-1}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{0,1},{-1,-1},{4,-2},{-1,2}},2,2,OWNER), MATHSEQUAL),
+// single complex 1x1 matrix minus single complex matrix
+new CheckBinary<MINUS>(OGComplexSingleDenseMatrix::create(new complex8[1]{{0,1}},1,1,OWNER), OGComplexSingleDenseMatrix::create(new complex8[4]{{1,2},{2,-1},{4,0},{0,1}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{-1,-1},{-2,2},{-4,1},{0,0}},2,2,OWNER), MATHSEQUAL),
+// single complex matrix minus single complex 1x1 matrix
+new CheckBinary<MINUS>(OGComplexSingleDenseMatrix::create(new complex8[4]{{1,2},{2,-1},{4,0},{0,1}},2,2,OWNER), OGComplexSingleDenseMatrix::create(new complex8[1]{{0,1}},1,1,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{1,1},{2,-2},{4,-1},{0,0}},2,2,OWNER), MATHSEQUAL)
 
 )
 );
@@ -597,3 +597,20 @@ TEST(MLDIVIDETests, CheckNonFiniteSystemMatrixThrows) {
   rdag_unrecoverable_error);
 }
 
+
+// A transposed view is solved as the matrix it stands for
+TEST(MLDIVIDETests, TransposedSystem) {
+  OGTerminal::Ptr b = OGRealDenseMatrix::create({{1.},{2.},{3.}});
+  OGExpr::Ptr viewed = MLDIVIDE::create(TRANSPOSE::create(REAL_A_3), b);
+  OGExpr::Ptr copied = MLDIVIDE::create(OGRealDenseMatrix::create({ { 10.00, 2.00, 4.00 }, { 2.00, 3.00, 10.00 }, { 1.00, 10.00, 1.00 } }), b);
+  runtree(viewed);
+  runtree(copied);
+  EXPECT_TRUE(viewed->getRegs()[0]->asOGTerminal()->mathsequals(copied->getRegs()[0]->asOGTerminal()));
+
+  OGTerminal::Ptr cb = OGComplexDenseMatrix::create({{{1.,1.}},{{2.,0.}},{{0.,3.}}});
+  OGExpr::Ptr cviewed = MLDIVIDE::create(CTRANSPOSE::create(CMPLX_A_3), cb);
+  OGExpr::Ptr ccopied = MLDIVIDE::create(OGComplexDenseMatrix::create({{{10.0,-100.0},{2.0,-20.0},{4.0,-40.0}},{{2.0,-20.0},{3.0,-30.0},{10.0,-100.0}},{{1.0,-10.0},{10.0,-100.0},{1.0,-10.0}}}), cb);
+  runtree(cviewed);
+  runtree(ccopied);
+  EXPECT_TRUE(cviewed->getRegs()[0]->asOGTerminal()->mathsequals(ccopied->getRegs()[0]->asOGTerminal()));
+}
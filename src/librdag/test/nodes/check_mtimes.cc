@@ -53,7 +53,39 @@ INSTANTIATE_NODE_TEST_CASE_P(MTIMESTests,MTIMES,
   // cmatrix * cvector
   new CheckBinary<MTIMES>( OGComplexDenseMatrix::create(new complex16[6]{{1.,10.}, {3.,30.}, {5.,50.}, {2.,20.}, {4.,40.}, {6.,60.}},3,2,OWNER), OGComplexDenseMatrix::create(new complex16[2]{{1,10},{2,20}},2,1,OWNER), OGComplexDenseMatrix::create(new complex16[3]{{-495.,100.}, {-1089.,220.}, {-1683.,340.}},3,1,OWNER),MATHSEQUAL),
    // cmatrix * cmatrix
-  new CheckBinary<MTIMES>( OGComplexDenseMatrix::create(new complex16[6]{{1.,10.}, {3.,30.}, {5.,50.}, {2.,20.}, {4.,40.}, {6.,60.}},3,2,OWNER), OGComplexDenseMatrix::create(new complex16[4] {{1.,10.}, {3.,30.}, {2.,20.}, {5.,50.}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[6]{{-693.,140.}, {-1485.,300.}, {-2277.,460.}, {-1188.,240.}, {-2574.,520.}, {-3960.,800.}},3,2,OWNER),MATHSEQUAL)
+  new CheckBinary<MTIMES>( OGComplexDenseMatrix::create(new complex16[6]{{1.,10.}, {3.,30.}, {5.,50.}, {2.,20.}, {4.,40.}, {6.,60.}},3,2,OWNER), OGComplexDenseMatrix::create(new complex16[4] {{1.,10.}, {3.,30.}, {2.,20.}, {5.,50.}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[6]{{-693.,140.}, {-1485.,300.}, {-2277.,460.}, {-1188.,240.}, {-2574.,520.}, {-3960.,800.}},3,2,OWNER),MATHSEQUAL),
+  // rscalar matrix * cmatrix
+  new CheckBinary<MTIMES>( OGRealDenseMatrix::create(new real8[1]{2},1,1,OWNER), OGComplexDenseMatrix::create(new complex16[2]{{1,10},{2,20}},2,1,OWNER), OGComplexDenseMatrix::create(new complex16[2]{{2,20},{4,40}},2,1,OWNER),MATHSEQUAL),
+  // cscalar matrix * rmatrix
+  new CheckBinary<MTIMES>( OGComplexDenseMatrix::create(new complex16[1]{{0,1}},1,1,OWNER), OGRealDenseMatrix::create(new real8[2]{10,20},2,1,OWNER), OGComplexDenseMatrix::create(new complex16[2]{{0,10},{0,20}},2,1,OWNER),MATHSEQUAL),
+  // rmatrix * cvector
+  new CheckBinary<MTIMES>( OGRealDenseMatrix::create(new real8[6]{1,3,5,2,4,6},3,2,OWNER), OGComplexDenseMatrix::create(new complex16[2]{{1,2},{0,1}},2,1,OWNER), OGComplexDenseMatrix::create(new complex16[3]{{1,4},{3,10},{5,16}},3,1,OWNER),MATHSEQUAL),
+  // rmatrix * cmatrix
+  new CheckBinary<MTIMES>( OGRealDenseMatrix::create(new real8[6]{1,3,5,2,4,6},3,2,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{1,2},{0,1},{3,-1},{2,0}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[6]{{1,4},{3,10},{5,16},{7,-1},{17,-3},{27,-5}},3,2,OWNER),MATHSEQUAL),
+  // cmatrix * rmatrix
+  new CheckBinary<MTIMES>( OGComplexDenseMatrix::create(new complex16[6]{{1,2},{0,1},{1,-1},{3,-1},{2,0},{0,3}},3,2,OWNER), OGRealDenseMatrix::create(new real8[4]{10,30,20,40},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[6]{{100,-10},{60,10},{10,80},{140,0},{80,20},{20,100}},3,2,OWNER),MATHSEQUAL),
+  // single scalar matrix * single matrix
+  new CheckBinary<MTIMES>( OGRealSingleDenseMatrix::create(new real4[1]{2},1,1,OWNER), OGRealSingleDenseMatrix::create(new real4[2]{10,20},2,1,OWNER),OGRealDenseMatrix::create(new real8[2]{20,40},2,1,OWNER), MATHSEQUAL),
+  // single matrix * single vector
+  new CheckBinary<MTIMES>( OGRealSingleDenseMatrix::create(new real4[6]{1,3,5,2,4,6},3,2,OWNER), OGRealSingleDenseMatrix::create(new real4[2]{10,20},2,1,OWNER),OGRealDenseMatrix::create(new real8[3]{50,110,170},3,1,OWNER), MATHSEQUAL),
+  // single matrix * single matrix
+  new CheckBinary<MTIMES>( OGRealSingleDenseMatrix::create(new real4[6]{1,3,5,2,4,6},3,2,OWNER), OGRealSingleDenseMatrix::create(new real4[4]{10,30,20,40},2,2,OWNER),OGRealDenseMatrix::create(new real8[6]{70,150,230,100,220,340},3,2,OWNER), MATHSEQUAL),
+  // single cmatrix * single cmatrix
+  new CheckBinary<MTIMES>( OGComplexSingleDenseMatrix::create(new complex8[6]{{1.,10.}, {3.,30.}, {5.,50.}, {2.,20.}, {4.,40.}, {6.,60.}},3,2,OWNER), OGComplexSingleDenseMatrix::create(new complex8[4] {{1.,10.}, {3.,30.}, {2.,20.}, {5.,50.}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[6]{{-693.,140.}, {-1485.,300.}, {-2277.,460.}, {-1188.,240.}, {-2574.,520.}, {-3960.,800.}},3,2,OWNER),MATHSEQUAL),
+  // transposed matrix * matrix
+  new CheckBinary<MTIMES>( OGRealTransposedMatrix::create(OGRealDenseMatrix::create(new real8[6]{1,2,3,4,5,6},2,3,OWNER)), OGRealDenseMatrix::create(new real8[4]{10,30,20,40},2,2,OWNER),OGRealDenseMatrix::create(new real8[6]{70,150,230,100,220,340},3,2,OWNER), MATHSEQUAL),
+  // matrix * transposed matrix
+  new CheckBinary<MTIMES>( OGRealDenseMatrix::create(new real8[6]{1,3,5,2,4,6},3,2,OWNER), OGRealTransposedMatrix::create(OGRealDenseMatrix::create(new real8[4]{10,20,30,40},2,2,OWNER)),OGRealDenseMatrix::create(new real8[6]{70,150,230,100,220,340},3,2,OWNER), MATHSEQUAL),
+  // transposed matrix * transposed matrix
+  new CheckBinary<MTIMES>( OGRealTransposedMatrix::create(OGRealDenseMatrix::create(new real8[6]{1,2,3,4,5,6},2,3,OWNER)), OGRealTransposedMatrix::create(OGRealDenseMatrix::create(new real8[4]{10,20,30,40},2,2,OWNER)),OGRealDenseMatrix::create(new real8[6]{70,150,230,100,220,340},3,2,OWNER), MATHSEQUAL),
+  // vector * transposed vector
+  new CheckBinary<MTIMES>( OGRealDenseMatrix::create(new real8[2]{1,2},2,1,OWNER), OGRealTransposedMatrix::create(OGRealDenseMatrix::create(new real8[2]{3,4},2,1,OWNER)),OGRealDenseMatrix::create(new real8[4]{3,6,4,8},2,2,OWNER), MATHSEQUAL),
+  // transposed scalar matrix * matrix
+  new CheckBinary<MTIMES>( OGRealTransposedMatrix::create(OGRealDenseMatrix::create(new real8[1]{2},1,1,OWNER)), OGRealDenseMatrix::create(new real8[2]{10,20},2,1,OWNER),OGRealDenseMatrix::create(new real8[2]{20,40},2,1,OWNER), MATHSEQUAL),
+  // conjugate transposed cmatrix * cvector
+  new CheckBinary<MTIMES>( OGComplexTransposedMatrix::create(OGComplexDenseMatrix::create(new complex16[4]{{1,1},{2,0},{0,1},{3,-1}},2,2,OWNER), true), OGComplexDenseMatrix::create(new complex16[2]{{1,0},{0,1}},2,1,OWNER), OGComplexDenseMatrix::create(new complex16[2]{{1,1},{-1,2}},2,1,OWNER),MATHSEQUAL),
+  // cmatrix * transposed cmatrix
+  new CheckBinary<MTIMES>( OGComplexDenseMatrix::create(new complex16[6]{{1.,10.}, {3.,30.}, {5.,50.}, {2.,20.}, {4.,40.}, {6.,60.}},3,2,OWNER), OGComplexTransposedMatrix::create(OGComplexDenseMatrix::create(new complex16[4] {{1.,10.}, {2.,20.}, {3.,30.}, {5.,50.}},2,2,OWNER), false), OGComplexDenseMatrix::create(new complex16[6]{{-693.,140.}, {-1485.,300.}, {-2277.,460.}, {-1188.,240.}, {-2574.,520.}, {-3960.,800.}},3,2,OWNER),MATHSEQUAL)
   )
 );
 
@@ -71,3 +103,22 @@ TEST(MTIMESTests, CheckBadCommuteThrows) {
   }
   , rdag_error);
 }
+
+TEST(MTIMESTests, GramProductIsHermitian) {
+  OGRealDenseMatrix::Ptr A = OGRealDenseMatrix::create(new real8[6]{1,3,5,2,4,6},3,2,OWNER);
+  OGExpr::Ptr gram = MTIMES::create(OGRealTransposedMatrix::create(A), A);
+  OGExpr::Ptr other = MTIMES::create(OGRealTransposedMatrix::create(A), OGRealDenseMatrix::create(new real8[6]{1,3,5,2,4,6},3,2,OWNER));
+  Dispatcher v;
+  v.dispatch(gram);
+  v.dispatch(other);
+  EXPECT_TRUE(gram->getRegs()[0]->asOGTerminal()->getStructure().has(Structure::HERMITIAN));
+  EXPECT_FALSE(other->getRegs()[0]->asOGTerminal()->getStructure().has(Structure::HERMITIAN));
+}
+
+TEST(MTIMESTests, CheckMixedBadCommuteThrows) {
+  OGNumeric::Ptr r = OGRealDenseMatrix::create(new real8[6]{1,3,5,2,4,6},3,2,OWNER);
+  OGNumeric::Ptr c = OGComplexDenseMatrix::create(new complex16[3]{{1,2},{0,1},{3,-1}},3,1,OWNER);
+  Dispatcher v;
+  ASSERT_THROW(v.dispatch(MTIMES::create(r, c)), rdag_error);
+  ASSERT_THROW(v.dispatch(MTIMES::create(c, r)), rdag_error);
+}
@@ -105,7 +105,19 @@ new CheckBinary<PLUS>(OGRealDenseMatrix::create({{1.0,4.0,3.0,2.0,1.0},{2.0,1.0,
 // complex 5x4 matrix plus complex 5x4 matrix
 new CheckBinary<PLUS>(OGComplexDenseMatrix::create({{{1.0,5.0},{3.0,2.0},{2.0,3.0},{1.0,4.0}},{{2.0,4.0},{1.0,5.0},{3.0,2.0},{2.0,3.0}},{{3.0,3.0},{2.0,4.0},{1.0,5.0},{3.0,2.0}},{{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{5.0,1.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}}}), OGComplexDenseMatrix::create({{{1.0,5.0},{3.0,2.0},{2.0,3.0},{1.0,4.0}},{{2.0,4.0},{1.0,5.0},{3.0,2.0},{2.0,3.0}},{{3.0,3.0},{2.0,4.0},{1.0,5.0},{3.0,2.0}},{{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{5.0,1.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}}}), OGComplexDenseMatrix::create({{{2.0,10.0},{6.0,4.0},{4.0,6.0},{2.0,8.0}},{{4.0,8.0},{2.0,10.0},{6.0,4.0},{4.0,6.0}},{{6.0,6.0},{4.0,8.0},{2.0,10.0},{6.0,4.0}},{{8.0,4.0},{6.0,6.0},{4.0,8.0},{2.0,10.0}},{{10.0,2.0},{8.0,4.0},{6.0,6.0},{4.0,8.0}}}), MATHSEQUAL),
 // complex 4x5 matrix plus complex 4x5 matrix
-new CheckBinary<PLUS>(OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{2.0,8.0},{8.0,4.0},{6.0,6.0},{4.0,8.0},{2.0,10.0}},{{4.0,6.0},{2.0,8.0},{8.0,4.0},{6.0,6.0},{4.0,8.0}},{{6.0,4.0},{4.0,6.0},{2.0,8.0},{8.0,4.0},{6.0,6.0}},{{8.0,2.0},{6.0,4.0},{4.0,6.0},{2.0,8.0},{8.0,4.0}}}), MATHSEQUAL)
+new CheckBinary<PLUS>(OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{2.0,8.0},{8.0,4.0},{6.0,6.0},{4.0,8.0},{2.0,10.0}},{{4.0,6.0},{2.0,8.0},{8.0,4.0},{6.0,6.0},{4.0,8.0}},{{6.0,4.0},{4.0,6.0},{2.0,8.0},{8.0,4.0},{6.0,6.0}},{{8.0,2.0},{6.0,4.0},{4.0,6.0},{2.0,8.0},{8.0,4.0}}}), MATHSEQUAL),
+// single matrix plus single matrix
+new CheckBinary<PLUS>(OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealSingleDenseMatrix::create(new real4[4]{5,7,6,8},2,2,OWNER), OGRealDenseMatrix::create(new real8[4]{6,9,10,16},2,2,OWNER), MATHSEQUAL),
+// single 1x1 matrix plus single matrix
+new CheckBinary<PLUS>(OGRealSingleDenseMatrix::create(new real4[1]{2},1,1,OWNER), OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealDenseMatrix::create(new real8[4]{3,4,6,10},2,2,OWNER), MATHSEQUAL),
+// single matrix plus single 1x1 matrix
+new CheckBinary<PLUS>(OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealSingleDenseMatrix::create(new real4[1]{2},1,1,OWNER), OGRealDenseMatrix::create(new real8[4]{3,4,6,10},2,2,OWNER), MATHSEQUAL),
+// single complex matrix plus single complex matrix
+new CheckBinary<PLUS>(OGComplexSingleDenseMatrix::create(new complex8[4]{{1,2},{2,-1},{4,0},{0,1}},2,2,OWNER), OGComplexSingleDenseMatrix::create(new complex8[4]{{1,1},{3,0},{0,2},{1,-1}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{2,3},{5,-1},{4,2},{1,0}},2,2,OWNER), MATHSEQUAL),
+// single complex 1x1 matrix plus single complex matrix
+new CheckBinary<PLUS>(OGComplexSingleDenseMatrix::create(new complex8[1]{{0,1}},1,1,OWNER), OGComplexSingleDenseMatrix::create(new complex8[4]{{1,2},{2,-1},{4,0},{0,1}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{1,3},{2,0},{4,1},{0,2}},2,2,OWNER), MATHSEQUAL),
+// single complex matrix plus single complex 1x1 matrix
+new CheckBinary<PLUS>(OGComplexSingleDenseMatrix::create(new complex8[4]{{1,2},{2,-1},{4,0},{0,1}},2,2,OWNER), OGComplexSingleDenseMatrix::create(new complex8[1]{{0,1}},1,1,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{1,3},{2,0},{4,1},{0,2}},2,2,OWNER), MATHSEQUAL)
 
 )
 );
@@ -105,7 +105,19 @@ new CheckBinary<RDIVIDE>(OGRealDenseMatrix::create({{1.0,4.0,3.0,2.0,1.0},{2.0,1
 // complex 5x4 matrix rdivide complex 5x4 matrix
 new CheckBinary<RDIVIDE>(OGComplexDenseMatrix::create({{{1.0,5.0},{3.0,2.0},{2.0,3.0},{1.0,4.0}},{{2.0,4.0},{1.0,5.0},{3.0,2.0},{2.0,3.0}},{{3.0,3.0},{2.0,4.0},{1.0,5.0},{3.0,2.0}},{{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{5.0,1.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}}}), OGComplexDenseMatrix::create({{{1.0,5.0},{3.0,2.0},{2.0,3.0},{1.0,4.0}},{{2.0,4.0},{1.0,5.0},{3.0,2.0},{2.0,3.0}},{{3.0,3.0},{2.0,4.0},{1.0,5.0},{3.0,2.0}},{{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{5.0,1.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}}}), OGRealDenseMatrix::create({{1.0,1.0,1.0,1.0},{1.0,1.0,1.0,1.0},{1.0,1.0,1.0,1.0},{1.0,1.0,1.0,1.0},{1.0,1.0,1.0,1.0}}), MATHSEQUAL),
 // complex 4x5 matrix rdivide complex 4x5 matrix
-new CheckBinary<RDIVIDE>(OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGRealDenseMatrix::create({{1.0,1.0,1.0,1.0,1.0},{1.0,1.0,1.0,1.0,1.0},{1.0,1.0,1.0,1.0,1.0},{1.0,1.0,1.0,1.0,1.0}}), MATHSEQUAL)
+new CheckBinary<RDIVIDE>(OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGRealDenseMatrix::create({{1.0,1.0,1.0,1.0,1.0},{1.0,1.0,1.0,1.0,1.0},{1.0,1.0,1.0,1.0,1.0},{1.0,1.0,1.0,1.0,1.0}}), MATHSEQUAL),
+// single matrix rdivide single matrix
+new CheckBinary<RDIVIDE>(OGRealSingleDenseMatrix::create(new real4[4]{5,7,6,8},2,2,OWNER), OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealDenseMatrix::create(new real8[4]{5,3.5,1.5,1},2,2,OWNER), MATHSEQUAL),
+// single 1x1 matrix rdivide single matrix
+new CheckBinary<RDIVIDE>(OGRealSingleDenseMatrix::create(new real4[1]{2},1,1,OWNER), OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealDenseMatrix::create(new real8[4]{2,1,0.5,0.25},2,2,OWNER), MATHSEQUAL),
+// single matrix rdivide single 1x1 matrix
+new CheckBinary<RDIVIDE>(OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealSingleDenseMatrix::create(new real4[1]{2},1,1,OWNER), OGRealDenseMatrix::create(new real8[4]{0.5,1,2,4},2,2,OWNER), MATHSEQUAL),
+// single complex matrix rdivide single complex matrix
+new CheckBinary<RDIVIDE>(OGComplexSingleDenseMatrix::create(new complex8[4]{{1,2},{2,-1},{4,0},{0,1}},2,2,OWNER), OGComplexSingleDenseMatrix::create(new complex8[4]{{1,1},{2,0},{0,2},{1,-1}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{1.5,0.5},{1,-0.5},{0,-2},{-0.5,0.5}},2,2,OWNER), MATHSEQUAL),
+// single complex 1x1 matrix rdivide single complex matrix
+new CheckBinary<RDIVIDE>(OGComplexSingleDenseMatrix::create(new complex8[1]{{0,1}},1,1,OWNER), OGComplexSingleDenseMatrix::create(new complex8[4]{{1,1},{2,0},{0,2},{1,-1}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{0.5,0.5},{0,0.5},{0.5,0},{-0.5,0.5}},2,2,OWNER), MATHSEQUAL),
+// single complex matrix rdivide single complex 1x1 matrix
+new CheckBinary<RDIVIDE>(OGComplexSingleDenseMatrix::create(new complex8[4]{{1,1},{2,0},{0,2},{1,-1}},2,2,OWNER), OGComplexSingleDenseMatrix::create(new complex8[1]{{0,1}},1,1,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{1,-1},{0,-2},{2,0},{-1,-1}},2,2,OWNER), MATHSEQUAL)
 
 )
 );
@@ -105,7 +105,19 @@ new CheckBinary<TIMES>(OGRealDenseMatrix::create({{1.0,4.0,3.0,2.0,1.0},{2.0,1.0
 // complex 5x4 matrix times complex 5x4 matrix
 new CheckBinary<TIMES>(OGComplexDenseMatrix::create({{{1.0,5.0},{3.0,2.0},{2.0,3.0},{1.0,4.0}},{{2.0,4.0},{1.0,5.0},{3.0,2.0},{2.0,3.0}},{{3.0,3.0},{2.0,4.0},{1.0,5.0},{3.0,2.0}},{{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{5.0,1.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}}}), OGComplexDenseMatrix::create({{{1.0,5.0},{3.0,2.0},{2.0,3.0},{1.0,4.0}},{{2.0,4.0},{1.0,5.0},{3.0,2.0},{2.0,3.0}},{{3.0,3.0},{2.0,4.0},{1.0,5.0},{3.0,2.0}},{{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{5.0,1.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}}}), OGComplexDenseMatrix::create({{{-24.0,10.0},{5.0,12.0},{-5.0,12.0},{-15.0,8.0}},{{-12.0,16.0},{-24.0,10.0},{5.0,12.0},{-5.0,12.0}},{{0.0,18.0},{-12.0,16.0},{-24.0,10.0},{5.0,12.0}},{{12.0,16.0},{0.0,18.0},{-12.0,16.0},{-24.0,10.0}},{{24.0,10.0},{12.0,16.0},{0.0,18.0},{-12.0,16.0}}}), MATHSEQUAL),
 // complex 4x5 matrix times complex 4x5 matrix
-new CheckBinary<TIMES>(OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{-15.0,8.0},{12.0,16.0},{0.0,18.0},{-12.0,16.0},{-24.0,10.0}},{{-5.0,12.0},{-15.0,8.0},{12.0,16.0},{0.0,18.0},{-12.0,16.0}},{{5.0,12.0},{-5.0,12.0},{-15.0,8.0},{12.0,16.0},{0.0,18.0}},{{15.0,8.0},{5.0,12.0},{-5.0,12.0},{-15.0,8.0},{12.0,16.0}}}), MATHSEQUAL)
+new CheckBinary<TIMES>(OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0},{1.0,5.0}},{{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0},{2.0,4.0}},{{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0},{3.0,3.0}},{{4.0,1.0},{3.0,2.0},{2.0,3.0},{1.0,4.0},{4.0,2.0}}}), OGComplexDenseMatrix::create({{{-15.0,8.0},{12.0,16.0},{0.0,18.0},{-12.0,16.0},{-24.0,10.0}},{{-5.0,12.0},{-15.0,8.0},{12.0,16.0},{0.0,18.0},{-12.0,16.0}},{{5.0,12.0},{-5.0,12.0},{-15.0,8.0},{12.0,16.0},{0.0,18.0}},{{15.0,8.0},{5.0,12.0},{-5.0,12.0},{-15.0,8.0},{12.0,16.0}}}), MATHSEQUAL),
+// single matrix times single matrix
+new CheckBinary<TIMES>(OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealSingleDenseMatrix::create(new real4[4]{5,7,6,8},2,2,OWNER), OGRealDenseMatrix::create(new real8[4]{5,14,24,64},2,2,OWNER), MATHSEQUAL),
+// single 1x1 matrix times single matrix
+new CheckBinary<TIMES>(OGRealSingleDenseMatrix::create(new real4[1]{2},1,1,OWNER), OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealDenseMatrix::create(new real8[4]{2,4,8,16},2,2,OWNER), MATHSEQUAL),
+// single matrix times single 1x1 matrix
+new CheckBinary<TIMES>(OGRealSingleDenseMatrix::create(new real4[4]{1,2,4,8},2,2,OWNER), OGRealSingleDenseMatrix::create(new real4[1]{2},1,1,OWNER), OGRealDenseMatrix::create(new real8[4]{2,4,8,16},2,2,OWNER), MATHSEQUAL),
+// single complex matrix times single complex matrix
+new CheckBinary<TIMES>(OGComplexSingleDenseMatrix::create(new complex8[4]{{1,2},{2,-1},{4,0},{0,1}},2,2,OWNER), OGComplexSingleDenseMatrix::create(new complex8[4]{{1,1},{3,0},{0,2},{1,-1}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{-1,3},{6,-3},{0,8},{1,1}},2,2,OWNER), MATHSEQUAL),
+// single complex 1x1 matrix times single complex matrix
+new CheckBinary<TIMES>(OGComplexSingleDenseMatrix::create(new complex8[1]{{0,1}},1,1,OWNER), OGComplexSingleDenseMatrix::create(new complex8[4]{{1,2},{2,-1},{4,0},{0,1}},2,2,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{-2,1},{1,2},{0,4},{-1,0}},2,2,OWNER), MATHSEQUAL),
+// single complex matrix times single complex 1x1 matrix
+new CheckBinary<TIMES>(OGComplexSingleDenseMatrix::create(new complex8[4]{{1,2},{2,-1},{4,0},{0,1}},2,2,OWNER), OGComplexSingleDenseMatrix::create(new complex8[1]{{0,1}},1,1,OWNER), OGComplexDenseMatrix::create(new complex16[4]{{-2,1},{1,2},{0,4},{-1,0}},2,2,OWNER), MATHSEQUAL)
 
 )
 );
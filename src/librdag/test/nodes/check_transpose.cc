@@ -111,3 +111,31 @@ TEST_P(ReconstructTransposeNodeTest, TerminalTypes)
 }
 
 INSTANTIATE_TEST_CASE_P(TRANSPOSETests, ReconstructTransposeNodeTest, ::testing::ValuesIn(terminals));
+
+// Known structure follows the transpose
+
+TEST(TRANSPOSETests, StructureIsTransposed)
+{
+  OGTerminal::Ptr A = OGRealDenseMatrix::create(new real8[4]{1,0,2,3},2,2, OWNER);
+  A->setStructure(Structure(Structure::UPPER_TRIANGULAR));
+  OGExpr::Ptr t = TRANSPOSE::create(A);
+  runtree(t);
+  const Structure& structure = t->getRegs()[0]->asOGTerminal()->getStructure();
+  EXPECT_TRUE(structure.has(Structure::LOWER_TRIANGULAR));
+  EXPECT_FALSE(structure.has(Structure::UPPER_TRIANGULAR));
+}
+
+// The transpose of a matrix views its data, and keeps it alive
+
+TEST(TRANSPOSETests, ResultIsView)
+{
+  OGTerminal::Ptr A = OGRealDenseMatrix::create(new real8[6]{1,2,3,4,5,6},2,3, OWNER);
+  OGExpr::Ptr t = TRANSPOSE::create(A);
+  runtree(t);
+  OGTerminal::Ptr result = t->getRegs()[0]->asOGTerminal();
+  ASSERT_EQ(result->getType(), REAL_TRANSPOSED_MATRIX_ENUM);
+  EXPECT_EQ(result->asOGRealTransposedMatrix()->getData(), A->asOGRealDenseMatrix()->getData());
+  A.reset();
+  t.reset();
+  EXPECT_TRUE(result->mathsequals(OGRealDenseMatrix::create(new real8[6]{1,3,5,2,4,6},3,2, OWNER)));
+}
@@ -0,0 +1,185 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include "threadpool.hh"
+#include "exceptions.hh"
+
+namespace librdag {
+
+namespace detail {
+// The pool the current thread is a worker of, and its index in that pool.
+static thread_local const ThreadPool * current_pool = nullptr;
+static thread_local size_t current_worker = 0;
+} // end namespace detail
+
+ThreadPool::ThreadPool(size_t nthreads): _queued{0}, _shutdown{false}
+{
+  if (nthreads == 0)
+  {
+    throw rdag_error("ThreadPool requires at least one thread.");
+  }
+  // One queue per worker, plus the injection queue at index nthreads
+  for (size_t i = 0; i <= nthreads; i++)
+  {
+    _queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+  }
+  for (size_t i = 0; i < nthreads; i++)
+  {
+    _threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lk(_sleepLock);
+    _shutdown = true;
+  }
+  _wakeup.notify_all();
+  for (auto& t: _threads)
+  {
+    t.join();
+  }
+}
+
+size_t
+ThreadPool::getThreadCount() const
+{
+  return _threads.size();
+}
+
+size_t
+ThreadPool::getHardwareThreadCount()
+{
+  size_t n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+size_t
+ThreadPool::getOwnQueue() const
+{
+  return detail::current_pool == this ? detail::current_worker : _threads.size();
+}
+
+void
+ThreadPool::submit(Task task)
+{
+  WorkQueue& q = *_queues[getOwnQueue()];
+  {
+    std::lock_guard<std::mutex> lk(q.lock);
+    q.tasks.push_back(std::move(task));
+  }
+  // _queued is incremented before taking the sleep lock, and sleepers test it
+  // whilst holding the sleep lock, so a wakeup cannot be missed.
+  ++_queued;
+  {
+    std::lock_guard<std::mutex> lk(_sleepLock);
+  }
+  _wakeup.notify_one();
+}
+
+bool
+ThreadPool::tryPop(size_t self, Task& task)
+{
+  if (_queued.load() == 0)
+  {
+    return false;
+  }
+  // Own queue first, newest task
+  {
+    WorkQueue& q = *_queues[self];
+    std::lock_guard<std::mutex> lk(q.lock);
+    if (!q.tasks.empty())
+    {
+      task = std::move(q.tasks.back());
+      q.tasks.pop_back();
+      --_queued;
+      return true;
+    }
+  }
+  // Then steal the oldest task from someone else
+  size_t nqueues = _queues.size();
+  for (size_t i = 1; i < nqueues; i++)
+  {
+    WorkQueue& q = *_queues[(self + i) % nqueues];
+    std::lock_guard<std::mutex> lk(q.lock);
+    if (!q.tasks.empty())
+    {
+      task = std::move(q.tasks.front());
+      q.tasks.pop_front();
+      --_queued;
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+ThreadPool::runTask(Task& task)
+{
+  try
+  {
+    task();
+  }
+  catch (...)
+  {
+    // Tasks are responsible for their own errors.
+  }
+  // Callers of runUntil test their condition whilst holding the sleep lock, so
+  // notifying under it means a completion cannot be missed.
+  std::lock_guard<std::mutex> lk(_sleepLock);
+  _wakeup.notify_all();
+}
+
+void
+ThreadPool::workerLoop(size_t id)
+{
+  detail::current_pool = this;
+  detail::current_worker = id;
+  for (;;)
+  {
+    Task task;
+    if (tryPop(id, task))
+    {
+      runTask(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lk(_sleepLock);
+    _wakeup.wait(lk, [this]{ return _shutdown.load() || _queued.load() > 0; });
+    if (_shutdown)
+    {
+      return;
+    }
+  }
+}
+
+void
+ThreadPool::runUntil(const std::function<bool()>& done)
+{
+  size_t self = getOwnQueue();
+  while (!done())
+  {
+    Task task;
+    if (tryPop(self, task))
+    {
+      runTask(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lk(_sleepLock);
+    _wakeup.wait(lk, [this, &done]{ return _queued.load() > 0 || done(); });
+  }
+}
+
+void
+ThreadPool::wakeAll()
+{
+  {
+    std::lock_guard<std::mutex> lk(_sleepLock);
+  }
+  _wakeup.notify_all();
+}
+
+} // end namespace librdag
@@ -0,0 +1,255 @@
+/**
+ * Copyright (C) 2014 - present by OpenGamma Inc. and the OpenGamma group of companies
+ *
+ * Please see distribution for license.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include "trace.hh"
+#include "expression.hh"
+#include "exceptions.hh"
+
+namespace librdag {
+
+namespace detail {
+
+std::atomic<bool> trace_enabled{false};
+
+static std::mutex trace_lock;
+static std::vector<TraceEvent> trace_events;
+static std::atomic<size_t> trace_threads{0};
+
+// Conversions made on this thread while tracing. A node's share is the difference
+// between the counts before and after it is computed.
+static thread_local size_t thread_conversions = 0;
+static thread_local size_t thread_conversion_bytes = 0;
+
+struct TypeName
+{
+  ExprType_t type;
+  const char * name;
+};
+
+static const TypeName type_names[] = {
+{ COPY_ENUM, "COPY" },
+#include "exprnames.hh"
+};
+
+static size_t getTraceThread()
+{
+  static thread_local size_t thread = trace_threads++;
+  return thread;
+}
+
+static uint64_t now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * The bytes of array data owned by a value. Views of data held elsewhere, such as
+ * results placed in an arena, allocate nothing.
+ */
+static size_t getOwnedBytes(const OGNumeric::Ptr& value)
+{
+  const OGNumeric * numeric = value.get();
+  const OGArray<real8> * real = dynamic_cast<const OGArray<real8> *>(numeric);
+  if (real != nullptr)
+  {
+    return real->getDataAccess() == OWNER ? real->getDatalen() * sizeof(real8) : 0;
+  }
+  const OGArray<complex16> * complex = dynamic_cast<const OGArray<complex16> *>(numeric);
+  if (complex != nullptr)
+  {
+    return complex->getDataAccess() == OWNER ? complex->getDatalen() * sizeof(complex16) : 0;
+  }
+  return 0;
+}
+
+/**
+ * The value of an argument, which is in the first register of an expression.
+ */
+static ValueInfo describe(const OGNumeric::Ptr& arg)
+{
+  OGTerminal::Ptr terminal = arg->asOGTerminal();
+  if (terminal == OGTerminal::Ptr{})
+  {
+    const RegContainer& regs = arg->asOGExpr()->getRegs();
+    if (regs.empty() || regs[0] == OGNumeric::Ptr{})
+    {
+      return ValueInfo();
+    }
+    terminal = regs[0]->asOGTerminal();
+  }
+  return ValueInfo(terminal->getType(), terminal->getRows(), terminal->getCols());
+}
+
+static void writeValues(std::ostream& out, const std::vector<ValueInfo>& values)
+{
+  out << "[";
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    out << (i == 0 ? "" : ",") << "\"" << Tracer::getTypeName(values[i].type);
+    if (values[i].shapeKnown)
+    {
+      out << " " << values[i].rows << "x" << values[i].cols;
+    }
+    out << "\"";
+  }
+  out << "]";
+}
+
+static void writeMicroseconds(std::ostream& out, uint64_t nanoseconds)
+{
+  out << nanoseconds / 1000 << "." << (nanoseconds % 1000) / 100 << (nanoseconds % 100) / 10 << nanoseconds % 10;
+}
+
+/*
+ * NodeTrace
+ */
+
+NodeTrace::NodeTrace(const OGNumeric::Ptr& node, const std::vector<OGNumeric::Ptr>& args, size_t nodes): _node{node}
+{
+  _event.type = node->getType();
+  _event.nodes = nodes;
+  for (const OGNumeric::Ptr& arg: args)
+  {
+    _event.args.push_back(describe(arg));
+  }
+  _event.conversions = thread_conversions;
+  _event.bytes = thread_conversion_bytes;
+  _event.thread = getTraceThread();
+  _event.failed = true;
+  _event.start = now();
+}
+
+void
+NodeTrace::complete()
+{
+  _event.failed = false;
+}
+
+NodeTrace::~NodeTrace()
+{
+  _event.duration = now() - _event.start;
+  _event.conversions = thread_conversions - _event.conversions;
+  _event.bytes = thread_conversion_bytes - _event.bytes;
+  try
+  {
+    if (!_event.failed)
+    {
+      for (const OGNumeric::Ptr& reg: _node->asOGExpr()->getRegs())
+      {
+        // Results that were not demanded are not computed
+        if (reg == OGNumeric::Ptr{})
+        {
+          _event.results.push_back(ValueInfo());
+          continue;
+        }
+        OGTerminal::Ptr result = reg->asOGTerminal();
+        _event.results.push_back(ValueInfo(result->getType(), result->getRows(), result->getCols()));
+        _event.bytes += getOwnedBytes(reg);
+      }
+    }
+    std::lock_guard<std::mutex> lk(trace_lock);
+    trace_events.push_back(std::move(_event));
+  }
+  catch (...)
+  {
+    // Losing an event is better than failing the execution
+  }
+}
+
+void traceConversion(const OGTerminal::Ptr& converted)
+{
+  thread_conversions++;
+  thread_conversion_bytes += getOwnedBytes(converted);
+}
+
+} // end namespace detail
+
+/*
+ * Tracer
+ */
+
+void
+Tracer::setEnabled(bool enabled)
+{
+  detail::trace_enabled = enabled;
+}
+
+std::vector<TraceEvent>
+Tracer::getEvents()
+{
+  std::lock_guard<std::mutex> lk(detail::trace_lock);
+  return detail::trace_events;
+}
+
+void
+Tracer::clear()
+{
+  std::lock_guard<std::mutex> lk(detail::trace_lock);
+  detail::trace_events.clear();
+}
+
+void
+Tracer::writeChromeTrace(std::ostream& out)
+{
+  std::vector<TraceEvent> events = getEvents();
+  // Times are written relative to the first event
+  uint64_t epoch = std::numeric_limits<uint64_t>::max();
+  for (const TraceEvent& event: events)
+  {
+    epoch = std::min(epoch, event.start);
+  }
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  for (size_t i = 0; i < events.size(); i++)
+  {
+    const TraceEvent& event = events[i];
+    out << (i == 0 ? "" : ",") << "\n{\"name\":\"" << getTypeName(event.type) << "\",";
+    out << "\"cat\":\"" << (event.nodes > 1 ? "fused" : "node") << "\",\"ph\":\"X\",";
+    out << "\"pid\":0,\"tid\":" << event.thread << ",\"ts\":";
+    detail::writeMicroseconds(out, event.start - epoch);
+    out << ",\"dur\":";
+    detail::writeMicroseconds(out, event.duration);
+    out << ",\"args\":{\"args\":";
+    detail::writeValues(out, event.args);
+    out << ",\"results\":";
+    detail::writeValues(out, event.results);
+    out << ",\"nodes\":" << event.nodes << ",\"conversions\":" << event.conversions;
+    out << ",\"bytes\":" << event.bytes << ",\"failed\":" << (event.failed ? "true" : "false") << "}}";
+  }
+  out << "\n]}\n";
+}
+
+void
+Tracer::writeChromeTrace(const std::string& filename)
+{
+  std::ofstream out(filename);
+  writeChromeTrace(out);
+  out.close();
+  if (out.fail())
+  {
+    throw rdag_error("Failed to write trace to " + filename);
+  }
+}
+
+const char *
+Tracer::getTypeName(ExprType_t type)
+{
+  for (const detail::TypeName& name: detail::type_names)
+  {
+    if (name.type == type)
+    {
+      return name.name;
+    }
+  }
+  return "UNKNOWN";
+}
+
+} // end namespace librdag